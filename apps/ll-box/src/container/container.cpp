@@ -10,6 +10,8 @@
 #include "container/mount/filesystem_driver.h"
 #include "container/mount/host_mount.h"
 #include "container/seccomp.h"
+#include "linglong/box/state.h"
+#include "linglong/tracing/tracing.h"
 #include "util/debug/debug.h"
 #include "util/filesystem.h"
 #include "util/logger.h"
@@ -26,6 +28,8 @@
 #include <cerrno>
 #include <filesystem>
 #include <map>
+#include <set>
+#include <string_view>
 #include <utility>
 
 #include <fcntl.h>
@@ -87,6 +91,79 @@ int ConfigUserNamespace(const linglong::Linux &linux, int initPid)
     logDbg() << "new uid:" << getuid() << "gid:" << getgid();
     return 0;
 }
+
+// MoveSkeleton moves the mounts in the skeleton prepared by PrepareSkeleton to the same paths in
+// root, the symlinks and the directories containing the mounts are created again in root.
+int MoveSkeleton(const std::filesystem::path &skeleton,
+                 const std::filesystem::path &root,
+                 dev_t skeletonDev)
+{
+    std::error_code ec;
+    for (const auto &entry : std::filesystem::directory_iterator(skeleton, ec)) {
+        const auto &source = entry.path();
+        auto target = root / source.filename();
+
+        struct stat sourceStat
+        {
+        };
+
+        if (lstat(source.c_str(), &sourceStat) == -1) {
+            logErr() << "lstat" << source << "failed:" << util::errnoString();
+            return -1;
+        }
+
+        if (S_ISLNK(sourceStat.st_mode)) {
+            auto link = std::filesystem::read_symlink(source, ec);
+            if (!ec) {
+                std::filesystem::create_symlink(link, target, ec);
+            }
+            if (ec) {
+                logErr() << "copy symlink" << source << "failed:" << ec.message();
+                return -1;
+            }
+            continue;
+        }
+
+        // the mount points are on other filesystems than the tmpfs of the skeleton
+        if (sourceStat.st_dev == skeletonDev) {
+            if (!S_ISDIR(sourceStat.st_mode)) {
+                continue;
+            }
+
+            if (mkdir(target.c_str(), sourceStat.st_mode & 07777) == -1 && errno != EEXIST) {
+                logErr() << "mkdir" << target << "failed:" << util::errnoString();
+                return -1;
+            }
+
+            if (MoveSkeleton(source, target, skeletonDev) != 0) {
+                return -1;
+            }
+            continue;
+        }
+
+        if (S_ISDIR(sourceStat.st_mode)) {
+            if (mkdir(target.c_str(), 0755) == -1 && errno != EEXIST) {
+                logErr() << "mkdir" << target << "failed:" << util::errnoString();
+                return -1;
+            }
+        } else if (!util::fs::path(target.string()).touch()) {
+            logErr() << "create" << target << "failed";
+            return -1;
+        }
+
+        if (mount(source.c_str(), target.c_str(), nullptr, MS_MOVE, nullptr) == -1) {
+            logErr() << "move" << source << "to" << target << "failed:" << util::errnoString();
+            return -1;
+        }
+    }
+
+    if (ec) {
+        logErr() << "list" << skeleton << "failed:" << ec.message();
+        return -1;
+    }
+
+    return 0;
+}
 } // namespace
 
 // FIXME(iceyer): not work now
@@ -251,6 +328,29 @@ struct ContainerPrivate
 
     std::map<int, std::string> pidMap;
 
+    // the indices of the mounts moved from the skeleton of the zygote, see StartFromSkeleton
+    std::set<std::size_t> skeletonMounts;
+
+    // the socket to notify ll-box the pid of the init process, see createNotifySocket
+    int notifyFd = -1;
+
+    // the filter loaded right before exec of the process, see PrepareSeccomp
+    std::optional<SeccompFilter> seccompFilter;
+
+    // PrepareSeccomp compiles the seccomp filter before the root is changed, the cache in the
+    // state directory is only accessible here. LINGLONG_BOX_SECCOMP_CACHE=0 disables the cache.
+    [[nodiscard]] bool PrepareSeccomp(const std::string &stateDir)
+    {
+        if (!this->runtime.linux.seccomp) {
+            return true;
+        }
+
+        tracing::Span span("seccomp");
+        this->seccompFilter =
+          linglong::PrepareSeccomp(*this->runtime.linux.seccomp, SeccompCacheDir(stateDir));
+        return this->seccompFilter.has_value();
+    }
+
     [[nodiscard]] static int DropPermissions()
     {
         __gid_t newgid[1] = { getgid() };
@@ -449,6 +549,11 @@ struct ContainerPrivate
             }
 
             logInf() << "start exec process";
+            tracing::setProcessName("ll-box: process");
+            tracing::instant("exec " + process.args[0]);
+            if (seccompFilter && LoadSeccomp(*seccompFilter) != 0) {
+                exit(-1);
+            }
             if (auto ret = util::Exec(process.args, process.env); ret != 0) {
                 logErr() << "exec failed" << util::RetErrString(ret);
                 exit(ret);
@@ -531,8 +636,12 @@ struct ContainerPrivate
     int MountContainerPath()
     {
         if (runtime.mounts.has_value()) {
-            for (auto const &mount : runtime.mounts.value()) {
-                if (containerMounter->MountNode(mount) != 0) {
+            for (std::size_t i = 0; i < runtime.mounts->size(); ++i) {
+                if (skeletonMounts.count(i) != 0) {
+                    continue;
+                }
+
+                if (containerMounter->MountNode(runtime.mounts->at(i)) != 0) {
                     logWan() << "failed to Mount:" << util::RetErrString(errno);
                 }
             }
@@ -567,6 +676,7 @@ int HookExec(const Hook &hook)
 int NonePrivilegeProc(void *arg)
 {
     auto &containerPrivate = *reinterpret_cast<ContainerPrivate *>(arg);
+    tracing::setProcessName("ll-box: init");
 
     // TODO(iceyer): use option
 
@@ -587,13 +697,21 @@ int NonePrivilegeProc(void *arg)
         return ret;
     }
 
+    tracing::Span procSpan("mount proc");
     auto ret = mount("proc", "/proc", "proc", 0, nullptr);
     if (0 != ret) {
         logErr() << "mount proc failed" << util::RetErrString(ret);
         return -1;
     }
+    procSpan.end();
+
+    if (containerPrivate.notifyFd != -1) {
+        notifyContainerReady(containerPrivate.notifyFd);
+        close(containerPrivate.notifyFd);
+    }
 
     if (containerPrivate.runtime.hooks.has_value()) {
+        tracing::Span hooksSpan("hooks");
         for (auto const &preStart :
              containerPrivate.runtime.hooks->prestart.value_or(std::vector<Hook>{})) {
             HookExec(preStart);
@@ -617,33 +735,10 @@ void sigtermHandler(int)
     exit(-1);
 }
 
-int EntryProc(void *arg)
+// StartInit sets up the root of the container prepared by the entry process, and starts the init
+// process in it
+int StartInit(ContainerPrivate &containerPrivate)
 {
-    auto &containerPrivate = *reinterpret_cast<ContainerPrivate *>(arg);
-
-    if (auto ret = ConfigUserNamespace(containerPrivate.runtime.linux, 0); ret != 0) {
-        return ret;
-    }
-
-    // FIXME: change HOSTNAME will broken XAUTH
-    auto new_hostname = containerPrivate.runtime.hostname;
-    //    if (sethostname(new_hostname.c_str(), strlen(new_hostname.c_str())) == -1) {
-    //        logErr() << "sethostname failed" << util::errnoString();
-    //        return -1;
-    //    }
-
-    uint32_t flags = MS_REC | MS_SLAVE;
-    int ret = mount(nullptr, "/", nullptr, flags, nullptr);
-    if (0 != ret) {
-        logErr() << "mount / failed" << util::RetErrString(ret);
-        return -1;
-    }
-
-    // NOTE(iceyer): it's not standard oci action
-    containerPrivate.PrepareRootfs();
-
-    containerPrivate.MountContainerPath();
-
     if (containerPrivate.useNewCgroupNs) {
         auto ret = ConfigCgroupV2(containerPrivate.runtime.linux.cgroupsPath,
                                   containerPrivate.runtime.linux.resources,
@@ -658,10 +753,12 @@ int EntryProc(void *arg)
         logWan() << "prepare default devices failed";
     }
 
+    tracing::Span pivotRootSpan("pivot_root");
     if (auto ret = containerPrivate.PivotRoot(); ret == -1) {
         logErr() << "pivotRoot failed";
         return -1;
     }
+    pivotRootSpan.end();
 
     if (auto ret = linglong::ContainerPrivate::PrepareLinks(); ret == -1) {
         logWan() << "prepareLinks failed";
@@ -670,7 +767,10 @@ int EntryProc(void *arg)
 
     int nonePrivilegeProcFlag = SIGCHLD | CLONE_NEWUSER | CLONE_NEWPID | CLONE_NEWNS;
 
-    int noPrivilegePid = util::PlatformClone(NonePrivilegeProc, nonePrivilegeProcFlag, arg);
+    tracing::Span cloneSpan("clone init");
+    int noPrivilegePid =
+      util::PlatformClone(NonePrivilegeProc, nonePrivilegeProcFlag, &containerPrivate);
+    cloneSpan.end();
     if (noPrivilegePid < 0) {
         logErr() << "clone failed" << util::RetErrString(noPrivilegePid);
         return -1;
@@ -689,6 +789,39 @@ int EntryProc(void *arg)
     return util::WaitAllUntil(noPrivilegePid);
 }
 
+int EntryProc(void *arg)
+{
+    auto &containerPrivate = *reinterpret_cast<ContainerPrivate *>(arg);
+    tracing::setProcessName("ll-box: entry");
+
+    if (auto ret = ConfigUserNamespace(containerPrivate.runtime.linux, 0); ret != 0) {
+        return ret;
+    }
+
+    // FIXME: change HOSTNAME will broken XAUTH
+    auto new_hostname = containerPrivate.runtime.hostname;
+    //    if (sethostname(new_hostname.c_str(), strlen(new_hostname.c_str())) == -1) {
+    //        logErr() << "sethostname failed" << util::errnoString();
+    //        return -1;
+    //    }
+
+    uint32_t flags = MS_REC | MS_SLAVE;
+    int ret = mount(nullptr, "/", nullptr, flags, nullptr);
+    if (0 != ret) {
+        logErr() << "mount / failed" << util::RetErrString(ret);
+        return -1;
+    }
+
+    // NOTE(iceyer): it's not standard oci action
+    containerPrivate.PrepareRootfs();
+
+    tracing::Span mountSpan("mounts");
+    containerPrivate.MountContainerPath();
+    mountSpan.end();
+
+    return StartInit(containerPrivate);
+}
+
 Container::Container(const std::string &bundle,
                      const std::string &id,
                      const std::string &stateDir,
@@ -731,7 +864,25 @@ int Container::Start()
 
     flags |= CLONE_NEWUSER;
 
+    // the processes started by exec load the same filter as the init process
+    if (!contanerPrivate.PrepareSeccomp(stateDir)
+        || (contanerPrivate.seccompFilter
+            && !RecordSeccomp(*contanerPrivate.seccompFilter, stateDir, this->id))) {
+        logErr() << "prepare seccomp failed";
+        return -1;
+    }
+
+    std::array<int, 2> notify{ -1, -1 };
+    if (createNotifySocket(notify)) {
+        contanerPrivate.notifyFd = notify[1];
+    }
+
+    tracing::Span cloneSpan("clone entry");
     int entryPid = util::PlatformClone(EntryProc, flags, (void *)dd_ptr.get());
+    cloneSpan.end();
+    if (notify[1] != -1) {
+        close(notify[1]);
+    }
     if (entryPid < 0) {
         logErr() << "clone failed" << util::RetErrString(entryPid);
         return -1;
@@ -746,19 +897,155 @@ int Container::Start()
     // FIXME: parent may dead before this return.
     prctl(PR_SET_PDEATHSIG, SIGKILL);
 
-    writeContainerJson(stateDir, this->bundle, this->id, entryPid);
+    const auto &seccomp = contanerPrivate.seccompFilter;
+    auto seccompProgram = seccomp ? seccomp->file : std::filesystem::path{};
+    auto seccompFlags = seccomp ? seccomp->flags : 0;
+    writeContainerJson(stateDir,
+                       this->bundle,
+                       this->id,
+                       entryPid,
+                       -1,
+                       seccompProgram,
+                       seccompFlags);
+    if (notify[0] != -1) {
+        if (auto initPid = receiveContainerReady(notify[0]); initPid != -1) {
+            writeContainerJson(stateDir,
+                               this->bundle,
+                               this->id,
+                               entryPid,
+                               initPid,
+                               seccompProgram,
+                               seccompFlags);
+        }
+        close(notify[0]);
+    }
 
     // FIXME(interactive bash): if need keep interactive shell
     auto ret = util::WaitAllUntil(entryPid);
 
     std::filesystem::path dir = stateDir;
-    if (!std::filesystem::remove(dir / (this->id + ".json"))) {
-        logErr() << "remove" << dir / (this->id + ".json") << "failed";
+    if (auto stateFile = box::stateFile(dir, this->id); !std::filesystem::remove(stateFile)) {
+        logErr() << "remove" << stateFile << "failed";
     }
+    RemoveSeccompRecord(dir, this->id);
 
     return ret;
 }
 
+int Container::StartFromSkeleton(const std::string &skeletonRoot,
+                                 const std::vector<std::size_t> &skeletonMounts,
+                                 int notifyFd)
+{
+    auto &containerPrivate = *dd_ptr;
+
+    containerPrivate.notifyFd = notifyFd;
+
+    containerPrivate.hostUid = geteuid();
+    containerPrivate.hostGid = getegid();
+    containerPrivate.skeletonMounts = { skeletonMounts.cbegin(), skeletonMounts.cend() };
+    for (auto const &n : containerPrivate.runtime.linux.namespaces) {
+        if (n.type == CLONE_NEWCGROUP) {
+            containerPrivate.useNewCgroupNs = true;
+        }
+    }
+
+    if (!containerPrivate.PrepareSeccomp(stateDir)) {
+        logErr() << "prepare seccomp failed";
+        return -1;
+    }
+
+    containerPrivate.PrepareRootfs();
+
+    tracing::Span moveSpan("move skeleton");
+    auto staging = std::filesystem::path(skeletonRoot) / "staging";
+    if (mount(staging.c_str(), containerPrivate.hostRoot.c_str(), nullptr, MS_MOVE, nullptr)
+        == -1) {
+        logErr() << "move" << staging << "to" << containerPrivate.hostRoot
+                 << "failed:" << util::errnoString();
+        return -1;
+    }
+    moveSpan.end();
+
+    tracing::Span mountSpan("mounts");
+    containerPrivate.MountContainerPath();
+    mountSpan.end();
+
+    return StartInit(containerPrivate);
+}
+
 Container::~Container() = default;
 
+int PrepareSkeleton(const Runtime &runtime,
+                    const std::vector<std::size_t> &mounts,
+                    const std::string &skeletonRoot)
+{
+    if (unshare(CLONE_NEWUSER | CLONE_NEWNS) == -1) {
+        logErr() << "unshare failed:" << util::errnoString();
+        return -1;
+    }
+
+    if (auto ret = ConfigUserNamespace(runtime.linux, 0); ret != 0) {
+        return ret;
+    }
+
+    if (mount(nullptr, "/", nullptr, MS_REC | MS_SLAVE, nullptr) == -1) {
+        logErr() << "mount / failed:" << util::errnoString();
+        return -1;
+    }
+
+    if (mount("tmpfs", skeletonRoot.c_str(), "tmpfs", MS_NODEV | MS_NOSUID, "mode=755") == -1) {
+        logErr() << "mount tmpfs to" << skeletonRoot << "failed:" << util::errnoString();
+        return -1;
+    }
+
+    auto skeleton = std::filesystem::path(skeletonRoot) / "skeleton";
+    auto staging = std::filesystem::path(skeletonRoot) / "staging";
+    if (mkdir(skeleton.c_str(), 0755) == -1 || mkdir(staging.c_str(), 0755) == -1) {
+        logErr() << "mkdir in" << skeletonRoot << "failed:" << util::errnoString();
+        return -1;
+    }
+
+    HostMount mounter;
+    mounter.Setup(new NativeFilesystemDriver(skeleton));
+    for (auto index : mounts) {
+        if (mounter.MountNode(runtime.mounts->at(index)) != 0) {
+            logErr() << "failed to mount" << runtime.mounts->at(index).destination;
+            return -1;
+        }
+    }
+    mounter.finalizeMounts();
+
+    // the mounts can't be moved out of a shared mount
+    if (mount(nullptr, skeletonRoot.c_str(), nullptr, MS_REC | MS_PRIVATE, nullptr) == -1) {
+        logErr() << "make" << skeletonRoot << "private failed:" << util::errnoString();
+        return -1;
+    }
+
+    return 0;
+}
+
+int StageSkeleton(const std::string &skeletonRoot)
+{
+    auto skeleton = std::filesystem::path(skeletonRoot) / "skeleton";
+    auto staging = std::filesystem::path(skeletonRoot) / "staging";
+
+    struct stat skeletonStat
+    {
+    };
+
+    if (stat(skeleton.c_str(), &skeletonStat) == -1) {
+        logErr() << "stat" << skeleton << "failed:" << util::errnoString();
+        return -1;
+    }
+
+    // the root of the container is a tmpfs, the mount points created in it are invisible to the
+    // other containers
+    if (mount("tmpfs", staging.c_str(), "tmpfs", MS_NODEV | MS_NOSUID, "mode=755") == -1) {
+        logErr() << "mount tmpfs to" << staging << "failed:" << util::errnoString();
+        return -1;
+    }
+
+    return MoveSkeleton(skeleton, staging, skeletonStat.st_dev);
+}
+
 } // namespace linglong
@@ -10,6 +10,7 @@
 #include "util/oci_runtime.h"
 
 #include <memory>
+#include <vector>
 
 namespace linglong {
 
@@ -27,6 +28,13 @@ public:
 
     int Start();
 
+    // StartFromSkeleton starts the container in the current process cloned from a zygote, whose
+    // root is staged by StageSkeleton. The given mounts are in the skeleton, and aren't mounted
+    // again. notifyFd is the end of the notify socket for the container, or -1.
+    int StartFromSkeleton(const std::string &skeletonRoot,
+                          const std::vector<std::size_t> &skeletonMounts,
+                          int notifyFd);
+
 private:
     std::string stateDir;
     std::string bundle;
@@ -34,4 +42,14 @@ private:
     std::unique_ptr<ContainerPrivate> dd_ptr;
 };
 
+// PrepareSkeleton enters new user and mount namespaces, and mounts the given mounts of the runtime
+// to skeletonRoot, which are shared by the containers started from the current process.
+int PrepareSkeleton(const Runtime &runtime,
+                    const std::vector<std::size_t> &mounts,
+                    const std::string &skeletonRoot);
+
+// StageSkeleton moves the mounts prepared by PrepareSkeleton to a new root in the mount namespace
+// of the current process.
+int StageSkeleton(const std::string &skeletonRoot);
+
 } // namespace linglong
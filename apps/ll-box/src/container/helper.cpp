@@ -6,16 +6,26 @@
 
 #include "container/helper.h"
 
+#include "linglong/box/state.h"
 #include "ocppi/types/Generators.hpp"
 #include "util/logger.h"
 
+#include <sys/socket.h>
+
+#include <cerrno>
+#include <cstring>
 #include <filesystem>
 
+#include <unistd.h>
+
 namespace linglong {
 void writeContainerJson(const std::filesystem::path &stateRoot,
                         const std::string &bundle,
                         const std::string &id,
-                        pid_t pid)
+                        pid_t pid,
+                        pid_t initPid,
+                        const std::filesystem::path &seccompProgram,
+                        unsigned int seccompFlags)
 {
     ocppi::types::ContainerListItem item = {
         .bundle = bundle,
@@ -30,11 +40,19 @@ void writeContainerJson(const std::filesystem::path &stateRoot,
         assert(false);
     }
 
-    std::ofstream file(stateRoot / (id + ".json"));
+    auto stateFile = box::stateFile(stateRoot, id);
+    std::ofstream file(stateFile);
     if (file.is_open()) {
-        file << nlohmann::json(item).dump(4);
+        auto json = nlohmann::json(item);
+        if (initPid != -1) {
+            json["initPid"] = initPid;
+        }
+        if (!seccompProgram.empty()) {
+            box::setSeccompRecord(json, { .program = seccompProgram, .flags = seccompFlags });
+        }
+        file << json.dump(4);
     } else {
-        logErr() << "open" << stateRoot / (id + ".json") << "failed";
+        logErr() << "open" << stateFile << "failed";
         assert(false);
     }
 }
@@ -51,6 +69,11 @@ nlohmann::json readAllContainerJson(const std::filesystem::path &stateRoot) noex
     }
 
     for (const auto &entry : std::filesystem::directory_iterator{ stateRoot }) {
+        // the directory of the zygotes
+        if (!entry.is_regular_file(ec)) {
+            continue;
+        }
+
         std::ifstream containerInfo = entry.path();
         if (!containerInfo.is_open()) {
             continue;
@@ -66,4 +89,62 @@ nlohmann::json readAllContainerJson(const std::filesystem::path &stateRoot) noex
 
     return result;
 }
+
+bool createNotifySocket(std::array<int, 2> &fds) noexcept
+{
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, fds.data()) == -1) {
+        logWan() << "socketpair failed:" << util::errnoString();
+        return false;
+    }
+
+    // the credentials of the sender are attached to the messages
+    int on{ 1 };
+    if (setsockopt(fds[0], SOL_SOCKET, SO_PASSCRED, &on, sizeof(on)) == -1) {
+        logWan() << "setsockopt SO_PASSCRED failed:" << util::errnoString();
+        close(fds[0]);
+        close(fds[1]);
+        return false;
+    }
+
+    return true;
+}
+
+void notifyContainerReady(int fd) noexcept
+{
+    char ready{ 0 };
+    while (send(fd, &ready, 1, MSG_NOSIGNAL) == -1) {
+        if (errno != EINTR) {
+            logWan() << "notify ll-box failed:" << util::errnoString();
+            return;
+        }
+    }
+}
+
+pid_t receiveContainerReady(int fd) noexcept
+{
+    char ready{ 0 };
+    iovec iov{ &ready, 1 };
+    std::array<char, CMSG_SPACE(sizeof(ucred))> control{};
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.data();
+    msg.msg_controllen = control.size();
+
+    ssize_t len{ -1 };
+    while ((len = recvmsg(fd, &msg, 0)) == -1 && errno == EINTR) { }
+    if (len <= 0) {
+        return -1;
+    }
+
+    for (auto *cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_CREDENTIALS) {
+            ucred cred{};
+            std::memcpy(&cred, CMSG_DATA(cmsg), sizeof(cred));
+            return cred.pid;
+        }
+    }
+
+    return -1;
+}
 } // namespace linglong
@@ -8,13 +8,28 @@
 
 #include <nlohmann/json.hpp>
 
+#include <array>
 #include <filesystem>
 #include <string>
 
 namespace linglong {
+// initPid is the pid of the init process of the container, whose namespaces are entered by exec.
+// seccompProgram is the file of the seccomp filter loaded by exec as well, see RecordSeccomp.
 void writeContainerJson(const std::filesystem::path &stateRoot,
                         const std::string &bundle,
                         const std::string &id,
-                        pid_t pid);
+                        pid_t pid,
+                        pid_t initPid = -1,
+                        const std::filesystem::path &seccompProgram = {},
+                        unsigned int seccompFlags = 0);
 nlohmann::json readAllContainerJson(const std::filesystem::path &stateRoot) noexcept;
+
+// createNotifySocket creates the socket pair between ll-box and the init process of the
+// container, ll-box receives from fds[0] and the container sends to fds[1].
+bool createNotifySocket(std::array<int, 2> &fds) noexcept;
+// notifyContainerReady is called by the init process after its namespaces are set up.
+void notifyContainerReady(int fd) noexcept;
+// receiveContainerReady returns the pid of the init process in the pid namespace of ll-box, which
+// is translated by the kernel, or -1 if the container exits before it's ready.
+pid_t receiveContainerReady(int fd) noexcept;
 }; // namespace linglong
@@ -67,7 +67,8 @@ int OverlayfsFuseFilesystemDriver::Setup()
         args.push_back("workdir=" + work_dir_);
         args.push_back(mount_point_);
 
-        logErr() << util::Exec(args, {});
+        auto ret = util::Exec(args, {});
+        logErr() << ret;
         logErr() << util::errnoString();
 
         exit(0);
@@ -170,7 +171,8 @@ int FuseProxyFilesystemDriver::Setup()
         args.push_back("112");
         args.push_back(mount_point_);
 
-        logErr() << util::Exec(args, {});
+        auto ret = util::Exec(args, {});
+        logErr() << ret;
 
         exit(0);
     } else {
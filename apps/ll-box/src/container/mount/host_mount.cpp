@@ -9,11 +9,13 @@
 #include "filesystem_driver.h"
 #include "util/debug/debug.h"
 #include "util/logger.h"
+#include "util/mount_api.h"
 #include "util/oci_runtime.h"
 
 #include <linux/limits.h>
 #include <sys/vfs.h>
 
+#include <string_view>
 #include <utility>
 
 #include <fcntl.h>
@@ -26,10 +28,69 @@ struct remountNode
     int targetFd{ -1 };
     std::string targetPath;
     std::string data;
+    // targetFd is the mount cloned by open_tree, the flags are set with mount_setattr
+    bool mountAttr{ false };
 };
 
 namespace linglong {
 
+namespace {
+
+// newMountAPISupported checks mount_setattr, the latest syscall of the new mount API used by
+// ll-box, which is added in linux 5.12. LINGLONG_BOX_MOUNT_API=0 disables the new mount API.
+bool newMountAPISupported()
+{
+    static const bool supported = []() {
+        const auto *env = ::getenv("LINGLONG_BOX_MOUNT_API");
+        if (env != nullptr && std::string_view(env) == "0") {
+            return false;
+        }
+
+        // the empty attributes are accepted without looking up the path
+        return util::mountSetattr(-1, "", 0, util::MountAttr{}) == 0 || errno != ENOSYS;
+    }();
+    return supported;
+}
+
+// mountAttr converts the flags of mount(2) to the attributes of mount_setattr(2)
+util::MountAttr mountAttr(uint32_t set, uint32_t clear)
+{
+    const static std::pair<uint32_t, uint64_t> attrs[] = {
+        { MS_RDONLY, MOUNT_ATTR_RDONLY },
+        { MS_NOSUID, MOUNT_ATTR_NOSUID },
+        { MS_NODEV, MOUNT_ATTR_NODEV },
+        { MS_NOEXEC, MOUNT_ATTR_NOEXEC },
+        { MS_NODIRATIME, MOUNT_ATTR_NODIRATIME },
+        { LINGLONG_MS_NOSYMFOLLOW, MOUNT_ATTR_NOSYMFOLLOW },
+    };
+
+    util::MountAttr attr;
+    for (const auto &[flag, value] : attrs) {
+        if ((set & flag) != 0U) {
+            attr.attrSet |= value;
+        }
+        if ((clear & flag) != 0U) {
+            attr.attrClr |= value;
+        }
+    }
+
+    // the atime attributes are exclusive, they're cleared together, see mount_setattr(2)
+    if (((set | clear) & (MS_NOATIME | MS_STRICTATIME | MS_RELATIME)) != 0U) {
+        attr.attrClr |= MOUNT_ATTR__ATIME;
+        if ((set & MS_NOATIME) != 0U) {
+            attr.attrSet |= MOUNT_ATTR_NOATIME;
+        } else if ((set & MS_STRICTATIME) != 0U) {
+            attr.attrSet |= MOUNT_ATTR_STRICTATIME;
+        } else {
+            attr.attrSet |= MOUNT_ATTR_RELATIME;
+        }
+    }
+
+    return attr;
+}
+
+} // namespace
+
 class HostMountPrivate
 {
 public:
@@ -145,6 +206,27 @@ public:
 
         switch (m.fsType) {
         case Mount::Bind: {
+            if (data.empty() && newMountAPISupported()) {
+                // the sources which can't be cloned are reported by the old way
+                auto treeFlags = OPEN_TREE_CLONE | OPEN_TREE_CLOEXEC
+                  | ((m.flags & MS_REC) != 0U ? AT_RECURSIVE : 0U);
+                int treeFd = sourceFd != -1
+                  ? util::openTree(sourceFd, "", treeFlags | AT_EMPTY_PATH)
+                  : util::openTree(AT_FDCWD, source.c_str(), treeFlags);
+                if (treeFd != -1) {
+                    ret = BindTree(m, treeFd, root.string(), host_dest_full_path.string());
+                    if (ret == 0 && source == "/sys") {
+                        sysfs_is_binded = true;
+                    }
+                    break;
+                }
+            }
+
+            if (m.recursiveFlags != 0U || m.recursiveClearFlags != 0U) {
+                logWan() << "recursive mount attributes of" << m.destination
+                         << "are ignored, they need linux 5.12";
+            }
+
             // make sure m.flags always have MS_BIND
             real_flags |= MS_BIND;
 
@@ -291,6 +373,74 @@ public:
         return ret;
     }
 
+    // BindTree attaches the tree cloned by open_tree to the target. The attributes are set with
+    // mount_setattr on treeFd, so the target isn't resolved again, and the recursive ones are set
+    // in one call. Like the old way, MS_RDONLY is set by finalizeMounts after the mount points in
+    // the tree are created.
+    int BindTree(const Mount &m,
+                 int treeFd,
+                 const std::string &root,
+                 const std::string &target) const
+    {
+        constexpr uint32_t all_propagations = (MS_SHARED | MS_PRIVATE | MS_SLAVE | MS_UNBINDABLE);
+
+        auto setattr = [treeFd, &m](unsigned int flags, const util::MountAttr &attr) {
+            if (util::mountSetattr(treeFd, "", AT_EMPTY_PATH | flags, attr) == 0) {
+                return true;
+            }
+
+            logErr() << "failed to set mount attributes of" << m.destination
+                     << util::errnoString();
+            ::close(treeFd);
+            return false;
+        };
+
+        // the recursive attributes are set before the tree is attached, the mounts in the container
+        // aren't affected
+        if (m.recursiveFlags != 0U || m.recursiveClearFlags != 0U) {
+            if (!setattr(AT_RECURSIVE, mountAttr(m.recursiveFlags, m.recursiveClearFlags))) {
+                return -1;
+            }
+        }
+
+        auto flags = m.flags & ~static_cast<uint32_t>(MS_BIND | MS_REC | MS_REMOUNT | MS_RDONLY);
+        auto attr = mountAttr(flags, 0);
+        if (attr.attrSet != 0U || attr.attrClr != 0U) {
+            if (!setattr(0, attr)) {
+                return -1;
+            }
+        }
+
+        if (util::fs::move_mount_with_fd(root.c_str(), treeFd, target.c_str()) == -1) {
+            logErr() << "failed to move mount to" << target << util::errnoString();
+            ::close(treeFd);
+            return -1;
+        }
+
+        if ((m.propagationFlags & all_propagations) != 0U) {
+            util::MountAttr propagation;
+            propagation.propagation = m.propagationFlags & all_propagations;
+            if (!setattr((m.propagationFlags & MS_REC) != 0U ? AT_RECURSIVE : 0U, propagation)) {
+                return -1;
+            }
+        }
+
+        if ((m.flags & MS_RDONLY) == 0U) {
+            ::close(treeFd);
+            return 0;
+        }
+
+        remountList.emplace_back(remountNode{
+          .flags = MS_RDONLY,
+          .extensionFlags = m.extensionFlags,
+          .targetFd = treeFd,
+          .targetPath = target,
+          .data = {},
+          .mountAttr = true,
+        });
+        return 0;
+    }
+
     static int remount(const std::string &target, uint32_t flags, const std::string &data)
     {
         const char *data_ptr = data.c_str();
@@ -340,7 +490,13 @@ public:
     void finalizeMounts()
     {
         for (const auto &node : remountList) {
-            if (remount(node.targetPath, node.flags, node.data) != 0) {
+            if (node.mountAttr) {
+                if (util::mountSetattr(node.targetFd, "", AT_EMPTY_PATH, mountAttr(node.flags, 0))
+                    != 0) {
+                    logWan() << "failed to set mount attributes of" << node.targetPath
+                             << ::strerror(errno);
+                }
+            } else if (remount(node.targetPath, node.flags, node.data) != 0) {
                 logWan() << "failed to remount" << node.targetPath << ::strerror(errno);
             }
 
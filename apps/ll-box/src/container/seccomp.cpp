@@ -6,143 +6,343 @@
 
 #include "seccomp.h"
 
+#include "linglong/box/seccomp.h"
+#include "linglong/box/state.h"
+#include "linglong/digest/sha256.h"
 #include "util/logger.h"
 
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string_view>
+
+#include <linux/seccomp.h>
 #include <seccomp.h>
+#include <unistd.h>
+
+#ifndef SECCOMP_FILTER_FLAG_TSYNC
+#  define SECCOMP_FILTER_FLAG_TSYNC (1UL << 0)
+#endif
+
+#ifndef SECCOMP_FILTER_FLAG_LOG
+#  define SECCOMP_FILTER_FLAG_LOG (1UL << 1)
+#endif
+
+#ifndef SECCOMP_FILTER_FLAG_SPEC_ALLOW
+#  define SECCOMP_FILTER_FLAG_SPEC_ALLOW (1UL << 2)
+#endif
+
+namespace linglong {
 
 namespace {
 
-#define SYSCALL_PAIR(SYSCALL)                   \
-    {                                           \
-        LL_TOSTRING(SYSCALL), SCMP_SYS(SYSCALL) \
+std::optional<uint32_t> toAction(const SeccompAction &action, const std::optional<u_int> &errnoRet)
+{
+    static const std::map<std::string, uint32_t> seccompActionMap = {
+        { "SCMP_ACT_KILL", SCMP_ACT_KILL },
+        { "SCMP_ACT_KILL_PROCESS", SCMP_ACT_KILL_PROCESS },
+        { "SCMP_ACT_KILL_THREAD", SCMP_ACT_KILL_THREAD },
+        { "SCMP_ACT_TRAP", SCMP_ACT_TRAP },
+        { "SCMP_ACT_LOG", SCMP_ACT_LOG },
+        { "SCMP_ACT_ALLOW", SCMP_ACT_ALLOW },
+    };
+
+    if (action == "SCMP_ACT_ERRNO") {
+        return SCMP_ACT_ERRNO(errnoRet.value_or(EPERM));
+    }
+
+    if (action == "SCMP_ACT_TRACE") {
+        return SCMP_ACT_TRACE(errnoRet.value_or(EPERM));
     }
 
-std::vector<struct scmp_arg_cmp> toScmpArgCmpArray(const std::vector<linglong::SyscallArg> &args)
+    // SCMP_ACT_NOTIFY needs a listener, which isn't supported
+    auto it = seccompActionMap.find(action);
+    if (it == seccompActionMap.end()) {
+        return std::nullopt;
+    }
+
+    return it->second;
+}
+
+std::optional<std::vector<scmp_arg_cmp>> toScmpArgCmpArray(const std::vector<SyscallArg> &args)
 {
     static const std::map<std::string, scmp_compare> seccompArgOpMap = {
-        { "_SCMP_CMP_MIN", _SCMP_CMP_MIN }, { "SCMP_CMP_NE", SCMP_CMP_NE },
-        { "SCMP_CMP_LT", SCMP_CMP_LT },     { "SCMP_CMP_LE", SCMP_CMP_LE },
-        { "SCMP_CMP_EQ", SCMP_CMP_EQ },     { "SCMP_CMP_GE", SCMP_CMP_GE },
-        { "SCMP_CMP_GT", SCMP_CMP_GT },     { "SCMP_CMP_MASKED_EQ", SCMP_CMP_MASKED_EQ },
-        { "_SCMP_CMP_MAX", _SCMP_CMP_MAX },
+        { "SCMP_CMP_NE", SCMP_CMP_NE }, { "SCMP_CMP_LT", SCMP_CMP_LT },
+        { "SCMP_CMP_LE", SCMP_CMP_LE }, { "SCMP_CMP_EQ", SCMP_CMP_EQ },
+        { "SCMP_CMP_GE", SCMP_CMP_GE }, { "SCMP_CMP_GT", SCMP_CMP_GT },
+        { "SCMP_CMP_MASKED_EQ", SCMP_CMP_MASKED_EQ },
     };
 
-    std::vector<struct scmp_arg_cmp> scmpArgs;
-
-    unsigned int index = 0;
+    std::vector<scmp_arg_cmp> scmpArgs;
     for (auto const &arg : args) {
+        auto op = seccompArgOpMap.find(arg.op);
+        if (op == seccompArgOpMap.end()) {
+            logErr() << "unsupported seccomp operator" << arg.op;
+            return std::nullopt;
+        }
+
         scmpArgs.push_back({
-          .arg = index,
-          .op = seccompArgOpMap.at(arg.op),
+          .arg = arg.index,
+          .op = op->second,
           .datum_a = arg.value,
           .datum_b = arg.valueTwo,
         });
-        ++index;
     }
 
     return scmpArgs;
 }
 
-int toSyscallNumber(const std::string &name)
+bool writeProgram(const std::filesystem::path &path, const std::vector<sock_filter> &program)
 {
-    // unistd.h for example: __NR_read
-
-    //  FIXME: need full support
-    static const std::map<std::string, int> syscallNameMap = {
-        SYSCALL_PAIR(read),          SYSCALL_PAIR(write),         SYSCALL_PAIR(open),
-        SYSCALL_PAIR(stat),          SYSCALL_PAIR(getcwd),        SYSCALL_PAIR(chmod),
-        SYSCALL_PAIR(syslog),        SYSCALL_PAIR(uselib),        SYSCALL_PAIR(acct),
-        SYSCALL_PAIR(modify_ldt),    SYSCALL_PAIR(quotactl),      SYSCALL_PAIR(add_key),
-        SYSCALL_PAIR(keyctl),        SYSCALL_PAIR(request_key),   SYSCALL_PAIR(move_pages),
-        SYSCALL_PAIR(mbind),         SYSCALL_PAIR(get_mempolicy), SYSCALL_PAIR(set_mempolicy),
-        SYSCALL_PAIR(migrate_pages), SYSCALL_PAIR(unshare),       SYSCALL_PAIR(mount),
-        SYSCALL_PAIR(pivot_root),    SYSCALL_PAIR(clone),         SYSCALL_PAIR(ioctl),
-    };
+    if (!box::writeProgram(path, program)) {
+        logWan() << "failed to write seccomp program" << path;
+        return false;
+    }
 
-    return syscallNameMap.at(name);
+    return true;
 }
 
-} // namespace
+std::string cacheKey(const Seccomp &seccomp)
+{
+    // the same section may be compiled differently by another libseccomp
+    const auto *version = seccomp_version();
+    auto content = nlohmann::json(seccomp).dump() + '\0' + std::to_string(version->major) + '.'
+      + std::to_string(version->minor) + '.' + std::to_string(version->micro);
 
-namespace linglong {
+    digest::SHA256 sha256;
+    sha256.update(content.data(), content.size());
+    return sha256.hexDigest();
+}
+
+} // namespace
 
-int ConfigSeccomp(const std::optional<linglong::Seccomp> &seccomp)
+std::optional<std::vector<sock_filter>> CompileSeccomp(const Seccomp &seccomp)
 {
-    if (!seccomp.has_value()) {
-        return 0;
+    auto defaultAction = toAction(seccomp.defaultAction, seccomp.defaultErrnoRet);
+    if (!defaultAction) {
+        logErr() << "unsupported seccomp action" << seccomp.defaultAction;
+        return std::nullopt;
     }
 
-    static const std::map<std::string, int> seccompActionMap = {
-        { "SCMP_ACT_KILL", SCMP_ACT_KILL },          { "SCMP_ACT_TRAP", SCMP_ACT_TRAP },
-        { "SCMP_ACT_ERRNO", SCMP_ACT_ERRNO(EPERM) }, { "SCMP_ACT_TRACE", SCMP_ACT_TRACE(EPERM) },
-        { "SCMP_ACT_ALLOW", SCMP_ACT_ALLOW },
-    };
+    std::unique_ptr<void, decltype(&seccomp_release)> ctx(seccomp_init(*defaultAction),
+                                                          seccomp_release);
+    if (!ctx) {
+        logErr() << "seccomp_init failed";
+        return std::nullopt;
+    }
 
-    // FIXME: need full support
-    static const std::map<std::string, int> seccompArchMap = {
-        { "SCMP_ARCH_X86", SCMP_ARCH_X86 },
-        { "SCMP_ARCH_X86_64", SCMP_ARCH_X86_64 },
-        { "SCMP_ARCH_X32", SCMP_ARCH_X32 },
-
-        { "SCMP_ARCH_ARM", SCMP_ARCH_ARM },
-        { "SCMP_ARCH_AARCH64", SCMP_ARCH_AARCH64 },
-
-        { "SCMP_ARCH_MIPS", SCMP_ARCH_MIPS },
-        { "SCMP_ARCH_MIPS64", SCMP_ARCH_MIPS64 },
-        { "SCMP_ARCH_MIPS64N32", SCMP_ARCH_MIPS64N32 },
-        { "SCMP_ARCH_MIPSEL", SCMP_ARCH_MIPSEL },
-        { "SCMP_ARCH_MIPSEL64", SCMP_ARCH_MIPSEL64 },
-        { "SCMP_ARCH_MIPSEL64N32", SCMP_ARCH_MIPSEL64N32 },
-    };
+    for (auto const &architecture : seccomp.architectures) {
+        // SCMP_ARCH_X86_64 is x86_64 in libseccomp
+        auto name = architecture.rfind("SCMP_ARCH_", 0) == 0
+          ? architecture.substr(std::string_view("SCMP_ARCH_").size())
+          : architecture;
+        std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) {
+            return std::tolower(c);
+        });
+
+        // the syscalls of the unknown architectures are killed by the filter
+        auto scmpArch = seccomp_arch_resolve_name(name.c_str());
+        if (scmpArch == 0) {
+            logWan() << "skip unknown seccomp architecture" << architecture;
+            continue;
+        }
+
+        if (seccomp_arch_exist(ctx.get(), scmpArch) == -EEXIST) {
+            if (auto ret = seccomp_arch_add(ctx.get(), scmpArch); ret != 0) {
+                logErr() << "add seccomp architecture" << architecture
+                         << "failed:" << std::strerror(-ret);
+                return std::nullopt;
+            }
+        }
+    }
 
-    int ret;
-    scmp_filter_ctx ctx = nullptr;
+    for (auto const &syscall : seccomp.syscalls) {
+        auto action = toAction(syscall.action, syscall.errnoRet);
+        if (!action) {
+            logErr() << "unsupported seccomp action" << syscall.action;
+            return std::nullopt;
+        }
 
-    try {
-        auto defaultAction = seccompActionMap.at(seccomp->defaultAction);
+        // libseccomp refuses the rules with the default action
+        if (*action == *defaultAction) {
+            continue;
+        }
 
-        ctx = seccomp_init(defaultAction);
-        if (ctx == nullptr) {
-            throw std::runtime_error(util::errnoString()
-                                     + " seccomp_init=" + seccomp->defaultAction);
+        auto args = toScmpArgCmpArray(syscall.args);
+        if (!args) {
+            return std::nullopt;
         }
-        for (auto const &architecture : seccomp->architectures) {
-            auto scmpArch = seccompArchMap.at(architecture);
-            if (seccomp_arch_exist(ctx, scmpArch) == -EEXIST) {
-                ret = seccomp_arch_add(ctx, scmpArch);
-                if (ret != 0) {
-                    throw std::runtime_error(util::errnoString() + " architecture=" + architecture);
+
+        // libseccomp can't compare an argument twice in a rule, the conditions are added as
+        // separate rules like runc
+        bool repeated = false;
+        for (std::size_t i = 0; i < args->size() && !repeated; ++i) {
+            for (std::size_t j = i + 1; j < args->size(); ++j) {
+                if (args->at(i).arg == args->at(j).arg) {
+                    repeated = true;
+                    break;
                 }
             }
         }
 
-        for (auto const &syscall : seccomp->syscalls) {
-            auto action = seccompActionMap.at(syscall.action);
-            auto argc = syscall.args.size();
-            auto args = toScmpArgCmpArray(syscall.args);
-
-            for (auto const &name : syscall.names) {
-                auto sysNumber = toSyscallNumber(name);
+        for (auto const &name : syscall.names) {
+            auto sysNumber = seccomp_syscall_resolve_name(name.c_str());
+            if (sysNumber == __NR_SCMP_ERROR) {
+                logDbg() << "skip unknown syscall" << name;
+                continue;
+            }
 
-                ret = seccomp_rule_add_array(ctx, action, sysNumber, argc, args.data());
+            auto addRule = [&](unsigned int argc, const scmp_arg_cmp *argv) {
+                auto ret = seccomp_rule_add_array(ctx.get(), *action, sysNumber, argc, argv);
                 if (ret != 0) {
-                    throw std::runtime_error(util::errnoString() + " syscall.name=" + name);
+                    logErr() << "add seccomp rule of" << name
+                             << "failed:" << std::strerror(-ret);
+                    return false;
+                }
+                return true;
+            };
+
+            if (!repeated) {
+                if (!addRule(args->size(), args->data())) {
+                    return std::nullopt;
+                }
+                continue;
+            }
+
+            for (auto const &arg : *args) {
+                if (!addRule(1, &arg)) {
+                    return std::nullopt;
                 }
             }
         }
-        ret = seccomp_load(ctx);
-    } catch (const std::exception &e) {
-        logErr() << "config seccomp failed:" << e.what();
-        ret = -1;
-    } catch (...) {
-        logErr() << "unknown error";
-        ret = -1;
     }
 
-    if (!ctx) {
-        seccomp_release(ctx);
+    auto fd = memfd_create("ll-box-seccomp", MFD_CLOEXEC);
+    if (fd == -1) {
+        logErr() << "memfd_create failed:" << util::errnoString();
+        return std::nullopt;
+    }
+
+    std::optional<std::vector<sock_filter>> program;
+    if (auto ret = seccomp_export_bpf(ctx.get(), fd); ret != 0) {
+        logErr() << "export seccomp filter failed:" << std::strerror(-ret);
+    } else {
+        program = box::readProgram(fd);
+        if (!program) {
+            logErr() << "invalid seccomp filter exported";
+        }
+    }
+    close(fd);
+
+    return program;
+}
+
+std::optional<SeccompFilter> PrepareSeccomp(const Seccomp &seccomp,
+                                            const std::filesystem::path &cacheDir)
+{
+    static const std::map<std::string, unsigned int> seccompFlagMap = {
+        { "SECCOMP_FILTER_FLAG_TSYNC", SECCOMP_FILTER_FLAG_TSYNC },
+        { "SECCOMP_FILTER_FLAG_LOG", SECCOMP_FILTER_FLAG_LOG },
+        { "SECCOMP_FILTER_FLAG_SPEC_ALLOW", SECCOMP_FILTER_FLAG_SPEC_ALLOW },
+    };
+
+    SeccompFilter filter;
+    for (auto const &flag : seccomp.flags) {
+        auto it = seccompFlagMap.find(flag);
+        if (it == seccompFlagMap.end()) {
+            logWan() << "skip unknown seccomp flag" << flag;
+            continue;
+        }
+        filter.flags |= it->second;
+    }
+
+    std::filesystem::path cacheFile;
+    if (!cacheDir.empty()) {
+        cacheFile = cacheDir / (cacheKey(seccomp) + ".bpf");
+        if (auto program = box::readProgram(cacheFile); program) {
+            logDbg() << "load seccomp filter from" << cacheFile;
+            filter.program = std::move(*program);
+            filter.file = cacheFile;
+            return filter;
+        }
+    }
+
+    auto program = CompileSeccomp(seccomp);
+    if (!program) {
+        return std::nullopt;
+    }
+    filter.program = std::move(*program);
+
+    if (!cacheFile.empty() && writeProgram(cacheFile, filter.program)) {
+        filter.file = cacheFile;
+    }
+
+    return filter;
+}
+
+std::filesystem::path SeccompCacheDir(const std::filesystem::path &stateRoot)
+{
+    const auto *env = ::getenv("LINGLONG_BOX_SECCOMP_CACHE");
+    if (env != nullptr && std::string_view(env) == "0") {
+        return {};
+    }
+
+    return box::seccompCacheDir(stateRoot);
+}
+
+bool RecordSeccomp(SeccompFilter &filter,
+                   const std::filesystem::path &stateRoot,
+                   const std::string &id)
+{
+    if (!filter.file.empty()) {
+        return true;
+    }
+
+    auto file = box::seccompExecFile(stateRoot, id);
+    if (!writeProgram(file, filter.program)) {
+        logErr() << "failed to record seccomp filter of" << id;
+        return false;
+    }
+
+    filter.file = file;
+    return true;
+}
+
+void RemoveSeccompRecord(const std::filesystem::path &stateRoot, const std::string &id)
+{
+    std::error_code ec;
+    std::filesystem::remove(box::seccompExecFile(stateRoot, id), ec);
+}
+
+std::optional<SeccompFilter> ReadSeccomp(const std::filesystem::path &file, unsigned int flags)
+{
+    auto program = box::readProgram(file);
+    if (!program) {
+        logErr() << "failed to read seccomp filter" << file;
+        return std::nullopt;
+    }
+
+    return SeccompFilter{
+        .program = std::move(*program),
+        .flags = flags,
+        .file = file,
+    };
+}
+
+int LoadSeccomp(const SeccompFilter &filter)
+{
+    if (box::loadProgram(filter.program, filter.flags) != 0) {
+        logErr() << "load seccomp filter failed:" << util::errnoString();
+        return -1;
     }
-    return ret;
+
+    return 0;
 }
 
 } // namespace linglong
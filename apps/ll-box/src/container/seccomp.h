@@ -8,6 +8,53 @@
 
 #include "util/oci_runtime.h"
 
+#include <linux/filter.h>
+
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
 namespace linglong {
-int ConfigSeccomp(const std::optional<linglong::Seccomp> &seccomp);
-}
+
+// SeccompFilter is the BPF program compiled from the seccomp section of the config
+struct SeccompFilter
+{
+    std::vector<sock_filter> program;
+    // SECCOMP_FILTER_FLAG_* passed to seccomp(2)
+    unsigned int flags{ 0 };
+    // the file of the program, which is recorded in the state of the container, see RecordSeccomp
+    std::filesystem::path file;
+};
+
+// CompileSeccomp compiles the seccomp section with libseccomp. The syscalls are resolved by the
+// syscall tables of libseccomp, the ones unknown to the native architecture are skipped like other
+// OCI runtimes.
+std::optional<std::vector<sock_filter>> CompileSeccomp(const Seccomp &seccomp);
+
+// PrepareSeccomp returns the filter of the seccomp section. The program is compiled once and cached
+// in cacheDir by the digest of the section and the version of libseccomp, the later containers
+// with the same section load it directly. An empty cacheDir disables the cache.
+std::optional<SeccompFilter> PrepareSeccomp(const Seccomp &seccomp,
+                                            const std::filesystem::path &cacheDir);
+
+// SeccompCacheDir returns the directory of the cached programs in the state directory, or an empty
+// path if LINGLONG_BOX_SECCOMP_CACHE=0 disables the cache.
+std::filesystem::path SeccompCacheDir(const std::filesystem::path &stateRoot);
+
+// RecordSeccomp makes sure the program is in a file, so the processes started by exec load the same
+// filter. The cached program is used if there is one, otherwise it's written to
+// <stateRoot>/seccomp/exec/<id>.bpf, which is removed by RemoveSeccompRecord.
+bool RecordSeccomp(SeccompFilter &filter,
+                   const std::filesystem::path &stateRoot,
+                   const std::string &id);
+void RemoveSeccompRecord(const std::filesystem::path &stateRoot, const std::string &id);
+
+// ReadSeccomp reads the filter recorded in the state of the container
+std::optional<SeccompFilter> ReadSeccomp(const std::filesystem::path &file, unsigned int flags);
+
+// LoadSeccomp installs the filter to the current process with no_new_privs set, it's called right
+// before exec, so the setup of the container isn't filtered.
+int LoadSeccomp(const SeccompFilter &filter);
+
+} // namespace linglong
@@ -0,0 +1,870 @@
+/*
+ * SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#include "container/zygote.h"
+
+#include "container/container.h"
+#include "container/helper.h"
+#include "container/seccomp.h"
+#include "linglong/box/state.h"
+#include "linglong/digest/sha256.h"
+#include "linglong/tracing/tracing.h"
+#include "util/logger.h"
+
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/vfs.h>
+#include <sys/wait.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+#include <fcntl.h>
+#include <linux/magic.h>
+#include <poll.h>
+#include <sched.h>
+#include <unistd.h>
+
+namespace linglong {
+
+namespace {
+
+// the version of the protocol between ll-box and the zygote
+constexpr auto protocolVersion = "2";
+// the zygote exits when no container is started from it in the time
+constexpr int idleTimeoutMs = 10 * 60 * 1000;
+// the spare is cloned after the zygote is idle in the time, so that it doesn't slow down the
+// container being started
+constexpr int spareDelayMs = 100;
+constexpr std::size_t spareStackSize = 1024 * 1024;
+constexpr std::size_t maxMessageSize = 64 * 1024;
+// the request carries the stdin, stdout and stderr of ll-box, and the notify socket
+constexpr std::size_t stdioCount = 3;
+constexpr std::size_t requestFdCount = stdioCount + 1;
+
+// cloneFlags returns the flags to clone the entry processes, the user namespace is shared by the
+// containers started from the same zygote.
+int cloneFlags(const Runtime &runtime)
+{
+    int flags = SIGCHLD | CLONE_NEWNS;
+    for (const auto &n : runtime.linux.namespaces) {
+        switch (n.type) {
+        case CLONE_NEWIPC:
+        case CLONE_NEWUTS:
+        case CLONE_NEWPID:
+        case CLONE_NEWNET:
+            flags |= n.type;
+            break;
+        default:
+            break;
+        }
+    }
+
+    return flags;
+}
+
+bool isUnder(const std::filesystem::path &path, const std::filesystem::path &dir)
+{
+    auto relative = path.lexically_normal().lexically_relative(dir.lexically_normal());
+    return !relative.empty() && *relative.begin() != "..";
+}
+
+// zygoteKey identifies the zygote which is able to start the container, the zygotes are shared
+// by the containers with the same skeleton and id mappings, and started by the same ll-box.
+std::string zygoteKey(const Runtime &runtime, const std::vector<std::size_t> &mounts)
+{
+    std::ostringstream stream;
+    stream << protocolVersion << '\0';
+
+    struct stat exeStat
+    {
+    };
+
+    if (stat("/proc/self/exe", &exeStat) == 0) {
+        stream << exeStat.st_dev << ' ' << exeStat.st_ino << ' ' << exeStat.st_mtime << '\0';
+    }
+
+    stream << cloneFlags(runtime) << '\0';
+
+    for (const auto *idMappings : { &runtime.linux.uidMappings, &runtime.linux.gidMappings }) {
+        for (const auto &idMap : *idMappings) {
+            stream << idMap.containerID << ' ' << idMap.hostID << ' ' << idMap.size << '\0';
+        }
+        stream << '\0';
+    }
+
+    for (auto index : mounts) {
+        const auto &mount = runtime.mounts->at(index);
+        stream << mount.destination << '\0' << mount.source << '\0' << mount.type << '\0'
+               << mount.flags << ' ' << mount.propagationFlags << ' ' << mount.extensionFlags
+               << ' ' << mount.recursiveFlags << ' ' << mount.recursiveClearFlags << '\0'
+               << util::str_vec_join(mount.data, ',') << '\0';
+    }
+
+    auto content = stream.str();
+    digest::SHA256 sha256;
+    sha256.update(content.data(), content.size());
+    // half of the digest is enough, and keeps the socket path within the limit of sockaddr_un
+    return sha256.hexDigest().substr(0, 32);
+}
+
+bool socketAddress(const std::filesystem::path &path, sockaddr_un &addr)
+{
+    addr = {};
+    addr.sun_family = AF_UNIX;
+    const auto &str = path.string();
+    if (str.size() >= sizeof(addr.sun_path)) {
+        logWan() << "socket path is too long:" << str;
+        return false;
+    }
+
+    std::copy(str.cbegin(), str.cend(), addr.sun_path);
+    return true;
+}
+
+int connectZygoteSocket(const std::filesystem::path &path)
+{
+    sockaddr_un addr{};
+    if (!socketAddress(path, addr)) {
+        return -1;
+    }
+
+    int fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (fd == -1) {
+        logWan() << "create socket failed:" << util::errnoString();
+        return -1;
+    }
+
+    if (connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == -1) {
+        logDbg() << "connect" << path << "failed:" << util::errnoString();
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+bool sendMessage(int fd, const nlohmann::json &message, const std::vector<int> &fds = {})
+{
+    auto content = message.dump();
+    iovec iov{ content.data(), content.size() };
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+
+    std::vector<char> control(CMSG_SPACE(sizeof(int) * fds.size()));
+    if (!fds.empty()) {
+        msg.msg_control = control.data();
+        msg.msg_controllen = control.size();
+        auto *cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int) * fds.size());
+        std::memcpy(CMSG_DATA(cmsg), fds.data(), sizeof(int) * fds.size());
+    }
+
+    while (sendmsg(fd, &msg, MSG_NOSIGNAL) == -1) {
+        if (errno != EINTR) {
+            logWan() << "send message failed:" << util::errnoString();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// receiveMessage returns a discarded json if the peer is closed or the message is invalid, the
+// received fds are always returned to be closed by the caller.
+nlohmann::json receiveMessage(int fd, std::vector<int> &fds)
+{
+    std::vector<char> content(maxMessageSize);
+    iovec iov{ content.data(), content.size() };
+    std::array<char, CMSG_SPACE(sizeof(int) * requestFdCount)> control{};
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.data();
+    msg.msg_controllen = control.size();
+
+    ssize_t len{ -1 };
+    while ((len = recvmsg(fd, &msg, MSG_CMSG_CLOEXEC)) == -1 && errno == EINTR) { }
+
+    for (auto *cmsg = CMSG_FIRSTHDR(&msg); len > 0 && cmsg != nullptr;
+         cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) {
+            continue;
+        }
+
+        auto count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+        auto offset = fds.size();
+        fds.resize(offset + count);
+        std::memcpy(fds.data() + offset, CMSG_DATA(cmsg), sizeof(int) * count);
+    }
+
+    if (len <= 0 || (msg.msg_flags & (MSG_TRUNC | MSG_CTRUNC)) != 0) {
+        return nlohmann::json(nlohmann::json::value_t::discarded);
+    }
+
+    return nlohmann::json::parse(content.cbegin(), content.cbegin() + len, nullptr, false);
+}
+
+std::string cgroupOf(const std::string &pid)
+{
+    std::ifstream cgroups("/proc/" + pid + "/cgroup");
+    std::string line;
+    while (std::getline(cgroups, line)) {
+        if (line.rfind("0::", 0) == 0) {
+            return line.substr(3);
+        }
+    }
+
+    return {};
+}
+
+// joinCgroup moves the current process to the cgroup v2 of pid, so that the container is
+// accounted as if it was started by that process directly
+void joinCgroup(pid_t pid)
+{
+    struct statfs fs
+    {
+    };
+
+    if (statfs("/sys/fs/cgroup", &fs) == -1 || fs.f_type != CGROUP2_SUPER_MAGIC) {
+        return;
+    }
+
+    auto cgroup = cgroupOf(std::to_string(pid));
+    if (cgroup.empty() || cgroup == cgroupOf("self")) {
+        return;
+    }
+
+    auto procs = "/sys/fs/cgroup" + cgroup + "/cgroup.procs";
+    std::ofstream file(procs);
+    file << getpid() << std::endl;
+    if (!file) {
+        logWan() << "couldn't join cgroup" << procs;
+    }
+}
+
+struct SpareArgs
+{
+    std::filesystem::path skeletonRoot;
+    // the end of the socket pair where the spare receives the request
+    int fd;
+    // the fds of the zygote
+    std::vector<int> zygoteFds;
+};
+
+// SpareProc is the entry process of the next container, which is cloned by the zygote in advance
+// and waits for the request with its root staged.
+int SpareProc(void *arg)
+{
+    auto &args = *static_cast<SpareArgs *>(arg);
+
+    prctl(PR_SET_PDEATHSIG, SIGKILL);
+
+    sigset_t mask;
+    sigfillset(&mask);
+    sigprocmask(SIG_UNBLOCK, &mask, nullptr);
+
+    for (auto fd : args.zygoteFds) {
+        close(fd);
+    }
+
+    if (StageSkeleton(args.skeletonRoot) != 0) {
+        exit(-1);
+    }
+
+    std::vector<int> fds;
+    auto request = receiveMessage(args.fd, fds);
+    close(args.fd);
+    if (request.is_discarded() || fds.size() != requestFdCount) {
+        exit(-1);
+    }
+
+    for (std::size_t i = 0; i < stdioCount; ++i) {
+        dup2(fds[i], static_cast<int>(i));
+        close(fds[i]);
+    }
+
+    joinCgroup(request.value("peer", 0));
+
+    try {
+        auto bundle = request.at("bundle").get<std::string>();
+        auto id = request.at("id").get<std::string>();
+        auto config = std::filesystem::path(bundle) / request.at("config").get<std::string>();
+        auto runtime = util::json::fromFile(config).get<Runtime>();
+
+        Container container(bundle, id, request.at("stateRoot").get<std::string>(), runtime);
+        exit(container.StartFromSkeleton(args.skeletonRoot,
+                                         skeletonMounts(runtime),
+                                         fds[stdioCount]));
+    } catch (const std::exception &e) {
+        logErr() << "start container failed:" << e.what();
+    }
+
+    exit(-1);
+}
+
+class Zygote
+{
+public:
+    Zygote(std::filesystem::path dir, std::string key, Runtime runtime)
+        : dir(std::move(dir))
+        , key(std::move(key))
+        , runtime(std::move(runtime))
+    {
+    }
+
+    int Serve(int readyFd)
+    {
+        if (this->Listen() != 0) {
+            return -1;
+        }
+
+        char ready{ 0 };
+        if (write(readyFd, &ready, 1) != 1) {
+            logErr() << "notify ll-box failed:" << util::errnoString();
+            return -1;
+        }
+        close(readyFd);
+
+        while (true) {
+            std::vector<pollfd> fds{ { this->listenFd, POLLIN, 0 },
+                                     { this->signalFd, POLLIN, 0 } };
+            for (const auto &[fd, pid] : this->connections) {
+                fds.push_back({ fd, POLLIN, 0 });
+            }
+
+            auto needSpare = this->spare.pid == -1 && !this->spareBroken;
+            auto idle = this->connections.empty() && this->children.empty();
+            auto timeout = needSpare ? spareDelayMs : (idle ? idleTimeoutMs : -1);
+            auto ret = poll(fds.data(), fds.size(), timeout);
+            if (ret == -1) {
+                if (errno == EINTR) {
+                    continue;
+                }
+
+                logErr() << "poll failed:" << util::errnoString();
+                return -1;
+            }
+
+            if (ret == 0) {
+                if (needSpare) {
+                    this->SpawnSpare();
+                } else if (this->TryExit()) {
+                    return 0;
+                }
+                continue;
+            }
+
+            if ((fds[1].revents & POLLIN) != 0) {
+                this->Reap();
+            }
+
+            for (auto it = fds.cbegin() + 2; it != fds.cend(); ++it) {
+                if (it->revents != 0) {
+                    this->Handle(it->fd);
+                }
+            }
+
+            if ((fds[0].revents & POLLIN) != 0) {
+                this->Accept();
+            }
+        }
+    }
+
+private:
+    int Listen()
+    {
+        sigset_t mask;
+        sigemptyset(&mask);
+        sigaddset(&mask, SIGCHLD);
+        if (sigprocmask(SIG_BLOCK, &mask, nullptr) == -1) {
+            logErr() << "sigprocmask failed:" << util::errnoString();
+            return -1;
+        }
+
+        this->signalFd = signalfd(-1, &mask, SFD_CLOEXEC);
+        if (this->signalFd == -1) {
+            logErr() << "signalfd failed:" << util::errnoString();
+            return -1;
+        }
+
+        sockaddr_un addr{};
+        if (!socketAddress(this->SocketPath(), addr)) {
+            return -1;
+        }
+
+        this->listenFd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+        if (this->listenFd == -1) {
+            logErr() << "create socket failed:" << util::errnoString();
+            return -1;
+        }
+
+        // the socket of a dead zygote is left
+        unlink(addr.sun_path);
+        if (bind(this->listenFd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == -1
+            || listen(this->listenFd, SOMAXCONN) == -1) {
+            logErr() << "listen on" << addr.sun_path << "failed:" << util::errnoString();
+            return -1;
+        }
+
+        return 0;
+    }
+
+    [[nodiscard]] std::filesystem::path SocketPath() const
+    {
+        return this->dir / (this->key + ".sock");
+    }
+
+    [[nodiscard]] std::filesystem::path SkeletonRoot() const { return this->dir / this->key; }
+
+    // TryExit exits when no ll-box is connecting to the zygote, ll-box starts the zygote with the
+    // lock file locked.
+    bool TryExit()
+    {
+        int lock = open((this->dir / (this->key + ".lock")).c_str(),
+                        O_RDWR | O_CREAT | O_CLOEXEC,
+                        0600);
+        if (lock == -1) {
+            return false;
+        }
+
+        pollfd pending{ this->listenFd, POLLIN, 0 };
+        auto idle = flock(lock, LOCK_EX | LOCK_NB) == 0 && poll(&pending, 1, 0) == 0;
+        if (idle) {
+            logInf() << "zygote" << this->key << "exits after idle timeout";
+            unlink(this->SocketPath().c_str());
+        }
+
+        close(lock);
+        return idle;
+    }
+
+    void Accept()
+    {
+        int fd = accept4(this->listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd == -1) {
+            logWan() << "accept failed:" << util::errnoString();
+            return;
+        }
+
+        ucred cred{};
+        socklen_t len = sizeof(cred);
+        if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &len) == -1
+            || cred.uid != geteuid()) {
+            logWan() << "reject connection from uid" << cred.uid;
+            close(fd);
+            return;
+        }
+
+        this->connections[fd] = { -1, cred.pid };
+    }
+
+    void Handle(int fd)
+    {
+        auto connection = this->connections.find(fd);
+        if (connection == this->connections.end()) {
+            return;
+        }
+
+        auto &[pid, peer] = connection->second;
+        std::vector<int> fds;
+        auto request = receiveMessage(fd, fds);
+
+        // the container is killed if ll-box exits, like it's started by ll-box directly
+        if (pid != -1 || request.is_discarded() || fds.size() != requestFdCount) {
+            if (pid != -1) {
+                kill(pid, SIGKILL);
+                this->children[pid] = -1;
+            }
+
+            for (auto requestFd : fds) {
+                close(requestFd);
+            }
+            close(fd);
+            this->connections.erase(fd);
+            return;
+        }
+
+        if (this->spare.pid == -1) {
+            this->SpawnSpare();
+        }
+
+        request["peer"] = peer;
+        auto handedOver = this->spare.pid != -1 && sendMessage(this->spare.fd, request, fds);
+        for (auto requestFd : fds) {
+            close(requestFd);
+        }
+
+        if (this->spare.pid != -1) {
+            if (!handedOver) {
+                kill(this->spare.pid, SIGKILL);
+            }
+            pid = this->spare.pid;
+            close(this->spare.fd);
+            this->spare = {};
+        }
+
+        if (!handedOver || !sendMessage(fd, { { "pid", pid } })) {
+            if (pid != -1) {
+                kill(pid, SIGKILL);
+            }
+            close(fd);
+            this->connections.erase(fd);
+            return;
+        }
+
+        this->children[pid] = fd;
+    }
+
+    // SpawnSpare clones the entry process of the next container
+    void SpawnSpare()
+    {
+        std::array<int, 2> fds{};
+        if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, fds.data()) == -1) {
+            logErr() << "socketpair failed:" << util::errnoString();
+            return;
+        }
+
+        SpareArgs args{ this->SkeletonRoot(), fds[1], { this->listenFd, this->signalFd, fds[0] } };
+        for (const auto &[fd, connection] : this->connections) {
+            args.zygoteFds.push_back(fd);
+        }
+
+        auto *stack = mmap(nullptr,
+                           spareStackSize,
+                           PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK,
+                           -1,
+                           0);
+        if (stack == MAP_FAILED) {
+            logErr() << "mmap failed:" << util::errnoString();
+            close(fds[0]);
+            close(fds[1]);
+            return;
+        }
+
+        // the spare has its own copy of the stack
+        util::Logger::Flush();
+        auto pid = clone(SpareProc,
+                         static_cast<char *>(stack) + spareStackSize,
+                         cloneFlags(this->runtime),
+                         &args);
+        munmap(stack, spareStackSize);
+        close(fds[1]);
+        if (pid == -1) {
+            logErr() << "clone spare failed:" << util::errnoString();
+            close(fds[0]);
+            return;
+        }
+
+        this->spare = { pid, fds[0] };
+    }
+
+    void Reap()
+    {
+        signalfd_siginfo info{};
+        while (read(this->signalFd, &info, sizeof(info)) == -1 && errno == EINTR) { }
+
+        int wstatus{ 0 };
+        pid_t pid{ 0 };
+        while ((pid = waitpid(-1, &wstatus, WNOHANG)) > 0) {
+            if (pid == this->spare.pid) {
+                // the spares are cloned only when ll-box connects from now on
+                logWan() << "spare of zygote" << this->key << "exited with status" << wstatus;
+                close(this->spare.fd);
+                this->spare = {};
+                this->spareBroken = true;
+                continue;
+            }
+
+            auto it = this->children.find(pid);
+            if (it == this->children.end()) {
+                continue;
+            }
+
+            if (auto fd = it->second; fd != -1) {
+                sendMessage(fd, { { "wstatus", wstatus } });
+                close(fd);
+                this->connections.erase(fd);
+            }
+            this->children.erase(it);
+        }
+    }
+
+    std::filesystem::path dir;
+    std::string key;
+    // the runtime of the container starting the zygote
+    Runtime runtime;
+    int listenFd{ -1 };
+    int signalFd{ -1 };
+    // the connections from ll-box to the container started by them and the pid of ll-box
+    std::map<int, std::pair<pid_t, pid_t>> connections;
+    // the containers started from the zygote to the connections waiting for them
+    std::map<pid_t, int> children;
+
+    struct
+    {
+        pid_t pid{ -1 };
+        // the socket to hand over the request to the spare
+        int fd{ -1 };
+    } spare;
+
+    bool spareBroken{ false };
+};
+
+// startZygote starts a zygote detached from the current process and waits until it's ready
+int startZygote(const std::filesystem::path &dir,
+                const std::string &key,
+                const Runtime &runtime,
+                const std::vector<std::size_t> &mounts,
+                int lock)
+{
+    std::array<int, 2> ready{};
+    if (pipe2(ready.data(), O_CLOEXEC) == -1) {
+        logWan() << "pipe failed:" << util::errnoString();
+        return -1;
+    }
+
+    auto pid = fork();
+    if (pid == -1) {
+        logWan() << "fork failed:" << util::errnoString();
+        close(ready[0]);
+        close(ready[1]);
+        return -1;
+    }
+
+    if (pid == 0) {
+        // the lock is released by the ll-box after the zygote is ready
+        close(lock);
+        close(ready[0]);
+        if (setsid() == -1 || fork() != 0) {
+            _exit(0);
+        }
+
+        tracing::setProcessName("ll-box: zygote");
+        int null = open("/dev/null", O_RDWR | O_CLOEXEC);
+        for (int fd = 0; null != -1 && fd < static_cast<int>(stdioCount); ++fd) {
+            dup2(null, fd);
+        }
+
+        auto skeletonRoot = dir / key;
+        if ((mkdir(skeletonRoot.c_str(), 0700) == -1 && errno != EEXIST) || chdir("/") == -1) {
+            logErr() << "prepare" << skeletonRoot << "failed:" << util::errnoString();
+            _exit(-1);
+        }
+
+        if (PrepareSkeleton(runtime, mounts, skeletonRoot) != 0) {
+            _exit(-1);
+        }
+
+        exit(Zygote(dir, key, runtime).Serve(ready[1]));
+    }
+
+    close(ready[1]);
+    waitpid(pid, nullptr, 0);
+
+    char buf{ 0 };
+    ssize_t len{ -1 };
+    while ((len = read(ready[0], &buf, 1)) == -1 && errno == EINTR) { }
+    close(ready[0]);
+
+    return len == 1 ? 0 : -1;
+}
+
+int connectZygote(const std::filesystem::path &dir,
+                  const std::string &key,
+                  const Runtime &runtime,
+                  const std::vector<std::size_t> &mounts)
+{
+    // the zygote might exit after the connection, in which case the container is started by
+    // ll-box directly
+    auto socketPath = dir / (key + ".sock");
+    if (auto fd = connectZygoteSocket(socketPath); fd != -1) {
+        return fd;
+    }
+
+    // the lock makes sure only one zygote is started for the key
+    int lock = open((dir / (key + ".lock")).c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (lock == -1 || flock(lock, LOCK_EX) == -1) {
+        logWan() << "lock zygote" << key << "failed:" << util::errnoString();
+        if (lock != -1) {
+            close(lock);
+        }
+        return -1;
+    }
+
+    auto fd = connectZygoteSocket(socketPath);
+    if (fd == -1) {
+        tracing::Span span("start zygote");
+        if (startZygote(dir, key, runtime, mounts, lock) == 0) {
+            fd = connectZygoteSocket(socketPath);
+        }
+    }
+
+    close(lock);
+    return fd;
+}
+
+} // namespace
+
+std::vector<std::size_t> skeletonMounts(const Runtime &runtime)
+{
+    if (!runtime.mounts || !runtime.annotations) {
+        return {};
+    }
+
+    std::vector<std::filesystem::path> layers;
+    for (const auto *key : { "org.deepin.linglong.baseDir", "org.deepin.linglong.runtimeDir" }) {
+        if (auto it = runtime.annotations->find(key); it != runtime.annotations->end()) {
+            layers.emplace_back(it->second);
+        }
+    }
+
+    std::vector<std::size_t> result;
+    // the destinations of the other mounts, the skeleton is mounted before them
+    std::vector<std::filesystem::path> others;
+    for (std::size_t i = 0; i < runtime.mounts->size(); ++i) {
+        const auto &mount = runtime.mounts->at(i);
+        auto destination = std::filesystem::path(mount.destination);
+        auto overlapped =
+          std::any_of(others.cbegin(), others.cend(), [&destination](const auto &other) {
+              return isUnder(destination, other) || isUnder(other, destination);
+          });
+        auto fromLayers = std::any_of(layers.cbegin(), layers.cend(), [&mount](const auto &layer) {
+            return isUnder(mount.source, layer);
+        });
+
+        if (!overlapped && fromLayers && destination.is_absolute() && mount.fsType == Mount::Bind
+            && (mount.flags & MS_RDONLY) != 0) {
+            result.push_back(i);
+        } else {
+            others.push_back(destination);
+        }
+    }
+
+    return result;
+}
+
+std::optional<int> runInZygote(const std::filesystem::path &stateRoot,
+                               const std::string &bundle,
+                               const std::string &config,
+                               const std::string &id,
+                               const Runtime &runtime)
+{
+    // the controlling terminal can't be passed to the container started by the zygote
+    if (isatty(STDIN_FILENO) != 0) {
+        logDbg() << "start container with a terminal directly";
+        return std::nullopt;
+    }
+
+    auto mounts = skeletonMounts(runtime);
+    if (mounts.empty()) {
+        logDbg() << "no skeleton mounts";
+        return std::nullopt;
+    }
+
+    auto dir = stateRoot / "zygote";
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+    if (ec) {
+        logWan() << "create" << dir << "failed:" << ec.message();
+        return std::nullopt;
+    }
+
+    // the filter is compiled and cached here, the container started by the zygote loads it from the
+    // cache, and the processes started by exec load the recorded one
+    std::optional<SeccompFilter> seccomp;
+    if (runtime.linux.seccomp) {
+        seccomp = PrepareSeccomp(*runtime.linux.seccomp, SeccompCacheDir(stateRoot));
+        if (!seccomp || !RecordSeccomp(*seccomp, stateRoot, id)) {
+            logErr() << "prepare seccomp failed";
+            return -1;
+        }
+    }
+
+    std::array<int, 2> notify{};
+    if (!createNotifySocket(notify)) {
+        return std::nullopt;
+    }
+
+    auto key = zygoteKey(runtime, mounts);
+    auto fd = connectZygote(dir, key, runtime, mounts);
+    if (fd == -1) {
+        close(notify[0]);
+        close(notify[1]);
+        return std::nullopt;
+    }
+
+    tracing::Span span("start from zygote");
+    nlohmann::json request{
+        { "bundle", bundle },
+        { "config", config },
+        { "id", id },
+        { "stateRoot", stateRoot.string() },
+    };
+    std::vector<int> fds;
+    auto sent = sendMessage(fd, request, { STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO, notify[1] });
+    close(notify[1]);
+    if (!sent) {
+        close(notify[0]);
+        close(fd);
+        return std::nullopt;
+    }
+
+    auto reply = receiveMessage(fd, fds);
+    auto pid = reply.is_object() ? reply.value("pid", -1) : -1;
+    if (pid == -1) {
+        logWan() << "zygote" << key << "failed to start container";
+        close(notify[0]);
+        close(fd);
+        return std::nullopt;
+    }
+    span.end();
+
+    auto seccompProgram = seccomp ? seccomp->file : std::filesystem::path{};
+    auto seccompFlags = seccomp ? seccomp->flags : 0;
+    writeContainerJson(stateRoot, bundle, id, pid, -1, seccompProgram, seccompFlags);
+    if (auto initPid = receiveContainerReady(notify[0]); initPid != -1) {
+        writeContainerJson(stateRoot, bundle, id, pid, initPid, seccompProgram, seccompFlags);
+    }
+    close(notify[0]);
+
+    reply = receiveMessage(fd, fds);
+    close(fd);
+
+    auto ret{ -1 };
+    if (!reply.is_object() || !reply.contains("wstatus")) {
+        logErr() << "lost connection to zygote" << key;
+    } else if (auto wstatus = reply.at("wstatus").get<int>();
+               WIFEXITED(wstatus) && WEXITSTATUS(wstatus) == 0) {
+        ret = 0;
+    } else {
+        logWan() << "container" << id << "exited with status" << wstatus;
+    }
+
+    if (auto stateFile = box::stateFile(stateRoot, id); !std::filesystem::remove(stateFile, ec)) {
+        logErr() << "remove" << stateFile << "failed";
+    }
+    RemoveSeccompRecord(stateRoot, id);
+
+    return ret;
+}
+
+} // namespace linglong
@@ -0,0 +1,33 @@
+/*
+ * SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#pragma once
+
+#include "util/oci_runtime.h"
+
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace linglong {
+
+// skeletonMounts returns the indices of the read-only binds from the base and the runtime layers,
+// which don't overlap with the other mounts before them. They're the same for all applications
+// using the same base and runtime, so they're mounted once by a zygote and moved into the
+// containers started from it.
+std::vector<std::size_t> skeletonMounts(const Runtime &runtime);
+
+// runInZygote runs the container in the spare entry process prepared by the zygote of its
+// skeleton, the zygote is started if it isn't running. It returns std::nullopt if the container
+// should be started by Container::Start instead.
+std::optional<int> runInZygote(const std::filesystem::path &stateRoot,
+                               const std::string &bundle,
+                               const std::string &config,
+                               const std::string &id,
+                               const Runtime &runtime);
+
+} // namespace linglong
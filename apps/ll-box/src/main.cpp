@@ -6,6 +6,11 @@
 
 #include "container/container.h"
 #include "container/helper.h"
+#include "container/seccomp.h"
+#include "container/zygote.h"
+#include "linglong/box/namespaces.h"
+#include "linglong/box/state.h"
+#include "linglong/tracing/tracing.h"
 #include "util/logger.h"
 #include "util/message_reader.h"
 #include "util/oci_runtime.h"
@@ -16,6 +21,7 @@
 #include <cstring>
 #include <filesystem>
 #include <iostream>
+#include <optional>
 #include <variant>
 
 #include <fcntl.h>
@@ -43,6 +49,7 @@ struct arg_run
     std::string container;
     std::string bundle{ std::filesystem::current_path() };
     std::string config{ "config.json" };
+    bool zygote{ false };
 };
 
 struct arg_exec
@@ -73,6 +80,8 @@ enum globalOption { OPTION_CGROUP_MANAGER = 1000, OPTION_ROOT };
 
 enum killOption { OPTION_KILL_CONTAINER = 1000, OPTION_KILL_SIGNAl };
 
+enum runOption { OPTION_ZYGOTE = 1000 };
+
 enum execOption { OPTION_CWD = 1000 };
 
 void containerJsonCleanUp(const std::filesystem::path &root)
@@ -88,7 +97,7 @@ void containerJsonCleanUp(const std::filesystem::path &root)
         }
 
         if (kill(boxPid, 0) != 0) {
-            auto jsonPath = root / (it->value("id", "unknown") + ".json");
+            auto jsonPath = linglong::box::stateFile(root, it->value("id", "unknown"));
             if (!std::filesystem::remove(jsonPath)) {
                 logErr() << "remove" << jsonPath << "failed";
             }
@@ -264,6 +273,74 @@ pid_t findLastBox(pid_t rootPid) noexcept
     return std::stoi(pidStr);
 }
 
+// enterContainer runs the command in the namespaces of the init process of the container like
+// nsenter, but without looking for the process in /proc. The command is filtered by the seccomp
+// filter of the container.
+int enterContainer(pid_t initPid,
+                   const arg_exec &arg,
+                   const std::optional<linglong::SeccompFilter> &seccomp) noexcept
+{
+    linglong::box::Namespaces namespaces;
+    if (!namespaces.open(initPid)) {
+        logErr() << "open namespaces of" << initPid << "failed:" << linglong::util::errnoString();
+        return -1;
+    }
+
+    if (namespaces.enter() == -1) {
+        logErr() << "enter namespaces of" << initPid
+                 << "failed:" << linglong::util::errnoString();
+        return -1;
+    }
+
+    if (::chdir(arg.cwd.c_str()) == -1) {
+        logErr() << "chdir to" << arg.cwd << "failed:" << linglong::util::errnoString();
+        return -1;
+    }
+
+    std::vector<const char *> argv;
+    for (const auto &str : arg.cmd) {
+        argv.push_back(str.c_str());
+    }
+
+    // run the shell like nsenter if no command is given
+    if (argv.empty()) {
+        const auto *shell = ::getenv("SHELL");
+        argv.push_back(shell != nullptr ? shell : "/bin/sh");
+    }
+    argv.push_back(nullptr);
+
+    // the pid namespace is entered by the children only
+    auto pid = ::fork();
+    if (pid == -1) {
+        logErr() << "fork failed:" << linglong::util::errnoString();
+        return -1;
+    }
+
+    if (pid == 0) {
+        if (seccomp && linglong::LoadSeccomp(*seccomp) != 0) {
+            ::_exit(127);
+        }
+        ::execvp(argv[0], const_cast<char **>(argv.data())); // NOLINT
+        logErr() << "execvp" << argv[0] << "failed:" << linglong::util::errnoString();
+        ::_exit(127);
+    }
+
+    int wstatus{ 0 };
+    while (::waitpid(pid, &wstatus, 0) == -1) {
+        if (errno != EINTR) {
+            logErr() << "waitpid failed:" << linglong::util::errnoString();
+            return -1;
+        }
+    }
+
+    if (WIFSIGNALED(wstatus)) {
+        ::signal(WTERMSIG(wstatus), SIG_DFL);
+        ::kill(::getpid(), WTERMSIG(wstatus));
+    }
+
+    return WIFEXITED(wstatus) ? WEXITSTATUS(wstatus) : -1;
+}
+
 int exec(const arg_exec &arg) noexcept
 {
     const auto &containerID = arg.container;
@@ -284,6 +361,28 @@ int exec(const arg_exec &arg) noexcept
         return -1;
     }
 
+    // the filter is read before the mount namespace is entered
+    std::optional<linglong::SeccompFilter> seccomp;
+    if (auto record = linglong::box::seccompRecord(*container); record) {
+        seccomp = linglong::ReadSeccomp(record->program, record->flags);
+        if (!seccomp) {
+            logErr() << "couldn't load seccomp filter of container" << containerID;
+            return -1;
+        }
+    }
+
+    // the init process isn't recorded by the old ll-box, or before the container is ready
+    if (auto initPid = container->value("initPid", -1);
+        initPid != -1 && ::kill(boxPid, 0) == 0 && ::kill(initPid, 0) == 0) {
+        return enterContainer(initPid, arg, seccomp);
+    }
+
+    // nsenter can't load the filter
+    if (seccomp) {
+        logErr() << "container" << containerID << "isn't ready";
+        return -1;
+    }
+
     auto lastBox = findLastBox(boxPid);
     if (lastBox == -1) {
         logErr() << "couldn't find pid of last ll-box";
@@ -307,6 +406,7 @@ int exec(const arg_exec &arg) noexcept
         logDbg() << "newArgv[" << i << "]:" << newArgv[i];
     }
 
+    linglong::util::Logger::Flush();
     return ::execvp("nsenter", const_cast<char **>(newArgv.data())); // NOLINT
 }
 
@@ -320,8 +420,19 @@ try {
         return -1;
     }
 
+    linglong::tracing::Span parseSpan("parse config");
     auto json = nlohmann::json::parse(configFileStream);
     auto runtime = json.get<linglong::Runtime>();
+    parseSpan.end();
+
+    const auto *zygoteEnv = ::getenv("LINGLONG_BOX_ZYGOTE");
+    if (arg.zygote || (zygoteEnv != nullptr && ::strcmp(zygoteEnv, "1") == 0)) {
+        auto ret =
+          linglong::runInZygote(arg.global->root, bundleDir, arg.config, arg.container, runtime);
+        if (ret) {
+            return *ret;
+        }
+    }
 
     linglong::Container container(bundleDir, arg.container, arg.global->root, runtime);
     return container.Start();
@@ -378,6 +489,9 @@ int parse_run(int key, char *arg, struct argp_state *state)
     case 'f': {
         input->config = arg;
     } break;
+    case OPTION_ZYGOTE: {
+        input->zygote = true;
+    } break;
     case 'b': {
         if (arg[0] != '/') {
             input->bundle = std::filesystem::current_path() / arg;
@@ -501,6 +615,15 @@ arg_run subCommand_run(struct argp_state *state)
             .doc = "override the config file name",
             .group = 0,
           },
+          {
+            .name = "zygote",
+            .key = OPTION_ZYGOTE,
+            .arg = nullptr,
+            .flags = 0,
+            .doc = "start the container from a zygote of the base and runtime, which is also "
+                   "enabled by LINGLONG_BOX_ZYGOTE=1",
+            .group = 0,
+          },
           { nullptr } // NOLINT
       };
 
@@ -681,15 +804,7 @@ int main(int argc, char **argv)
         return -1;
     }
 
-    std::string defaultRuntimeDir;
-    auto *XDGRuntimeDir = ::getenv("XDG_RUNTIME_DIR");
-    if (XDGRuntimeDir == nullptr) {
-        defaultRuntimeDir = "/run";
-    } else {
-        defaultRuntimeDir = XDGRuntimeDir;
-    }
-
-    auto defaultRootDir = std::filesystem::path{ defaultRuntimeDir } / "ll-box";
+    auto defaultRootDir = linglong::box::defaultStateRoot();
     auto rootDoc = std::string{ "root directory for storage of container state  (this should be "
                                 "located in tmpfs) (default: " }
       + defaultRootDir.string() + ")";
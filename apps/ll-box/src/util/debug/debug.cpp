@@ -16,8 +16,7 @@
 
 namespace linglong {
 
-#define DUMP_DBG(func, line) /*NOLINT*/ \
-    (linglong::util::Logger(linglong::util::Logger::Debug, func, line))
+#define DUMP_DBG(func, line) LINGLONG_BOX_LOG(Debug, func, line) /*NOLINT*/
 
 void DumpIDMap()
 {
@@ -7,6 +7,7 @@
 #include "filesystem.h"
 
 #include "logger.h"
+#include "mount_api.h"
 
 #include <sys/mount.h>
 
@@ -184,12 +185,10 @@ perms file_status::permissions() const noexcept
     return p;
 }
 
-int do_mount_with_fd(const char *root,
-                     const char *__special_file,
-                     const char *__dir,
-                     const char *__fstype,
-                     unsigned long int __rwflag,
-                     const void *__data) __THROW
+namespace {
+
+// open_target opens the target of a mount with O_PATH, and checks that it's in the container root
+int open_target(const char *root, const char *__dir)
 {
     // https://github.com/opencontainers/runc/blob/0ca91f44f1664da834bc61115a849b56d22f595f/libcontainer/utils/utils.go#L112
 
@@ -224,6 +223,20 @@ int do_mount_with_fd(const char *root,
           realpath.c_str());
     }
 
+    return fd;
+}
+
+} // namespace
+
+int do_mount_with_fd(const char *root,
+                     const char *__special_file,
+                     const char *__dir,
+                     const char *__fstype,
+                     unsigned long int __rwflag,
+                     const void *__data) __THROW
+{
+    int fd = open_target(root, __dir);
+    auto target = util::format("/proc/self/fd/%d", fd);
     auto ret = ::mount(__special_file, target.c_str(), __fstype, __rwflag, __data);
     auto olderrno = errno;
 
@@ -233,6 +246,18 @@ int do_mount_with_fd(const char *root,
     return ret;
 }
 
+int move_mount_with_fd(const char *root, int treeFd, const char *__dir) __THROW
+{
+    int fd = open_target(root, __dir);
+    auto ret = moveMount(treeFd, "", fd, "", MOVE_MOUNT_F_EMPTY_PATH | MOVE_MOUNT_T_EMPTY_PATH);
+    auto olderrno = errno;
+
+    close(fd);
+
+    errno = olderrno;
+    return ret;
+}
+
 } // namespace fs
 } // namespace util
 } // namespace linglong
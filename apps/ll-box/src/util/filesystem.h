@@ -185,6 +185,10 @@ int do_mount_with_fd(const char *root,
                      unsigned long int __rwflag,
                      const void *__data) __THROW;
 
+// move_mount_with_fd attaches the detached mount treeFd, e.g. cloned by open_tree, to __dir with
+// the same check as do_mount_with_fd
+int move_mount_with_fd(const char *root, int treeFd, const char *__dir) __THROW;
+
 } // namespace fs
 } // namespace util
 } // namespace linglong
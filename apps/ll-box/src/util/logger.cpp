@@ -6,7 +6,16 @@
 
 #include "logger.h"
 
+#include <sys/socket.h>
 #include <sys/syslog.h>
+#include <sys/un.h>
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include <endian.h>
+#include <pthread.h>
 
 namespace linglong {
 namespace util {
@@ -23,13 +32,180 @@ std::string RetErrString(int ret)
 
 std::string GetPidnsPid()
 {
+    // the pid namespace of the process is never changed, the cache is refreshed by the children
+    static pid_t cachedPid = -1;
+    static std::string cached;
+    if (cachedPid == getpid()) {
+        return cached;
+    }
+
     char buf[30];
     memset(buf, 0, sizeof(buf));
     if (readlink("/proc/self/ns/pid", buf, sizeof(buf) - 1) == -1) {
         return "";
     };
     std::string str = buf;
-    return str.substr(5, str.length() - 6) + ":" + std::to_string(getpid()); // 6 = strlen("pid:[]")
+    // 6 = strlen("pid:[]")
+    cached = str.substr(5, str.length() - 6) + ":" + std::to_string(getpid());
+    cachedPid = getpid();
+    return cached;
+}
+
+namespace {
+
+struct Record
+{
+    Logger::Level level;
+    std::string pidns;
+    const char *function;
+    int line;
+    std::string message;
+};
+
+struct Sink
+{
+    bool sync = false;
+    // the socket of journald, the records are written to syslog if it's unavailable
+    int journalFd = -1;
+    std::vector<Record> records;
+};
+
+// the sink is never destroyed, so the records can be flushed by atexit
+Sink &sink()
+{
+    static auto *instance = new Sink;
+    return *instance;
+}
+
+constexpr std::size_t maxBufferedRecords = 64;
+
+int syslogLevelOf(Logger::Level level)
+{
+    switch (level) {
+    case Logger::Debug:
+        return LOG_DEBUG;
+    case Logger::Info:
+        return LOG_INFO;
+    case Logger::Warning:
+        return LOG_WARNING;
+    case Logger::Error:
+    case Logger::Fatal:
+        return LOG_ERR;
+    }
+    return LOG_DEBUG;
+}
+
+void appendConsole(std::string &console, const Record &record)
+{
+    static const char *const prefixes[] = { "[DBG |", "[IFO |", "[WAN |", "[ERR |", "[FAL |" };
+    static const char *const colors[] = {
+        "", "\033[1;96m", "\033[1;93m", "\033[1;31m", "\033[1;91m",
+    };
+
+    console.append(colors[record.level]);
+    console.append(prefixes[record.level]);
+    console.append(" " + record.pidns + " | " + record.function + ":" + std::to_string(record.line)
+                   + " ] " + record.message);
+    if (record.level != Logger::Debug) {
+        console.append("\033[0m");
+    }
+    console.push_back('\n');
+}
+
+// appendField appends a field of the native protocol of journald, the values with newlines are
+// written in the binary form
+void appendField(std::string &entry, const char *key, const std::string &value)
+{
+    entry.append(key);
+    if (value.find('\n') == std::string::npos) {
+        entry.push_back('=');
+        entry.append(value);
+        entry.push_back('\n');
+        return;
+    }
+
+    entry.push_back('\n');
+    uint64_t size = htole64(value.size());
+    entry.append(reinterpret_cast<const char *>(&size), sizeof(size));
+    entry.append(value);
+    entry.push_back('\n');
+}
+
+void sendJournal(int fd, const Record &record)
+{
+    std::string entry;
+    appendField(entry, "MESSAGE", record.message);
+    appendField(entry, "PRIORITY", std::to_string(syslogLevelOf(record.level)));
+    appendField(entry, "SYSLOG_IDENTIFIER", "ll-box");
+    appendField(entry, "CODE_FUNC", record.function);
+    appendField(entry, "CODE_LINE", std::to_string(record.line));
+    appendField(entry, "LINGLONG_PIDNS", record.pidns);
+    send(fd, entry.data(), entry.size(), MSG_NOSIGNAL);
+}
+
+// connectJournal connects the socket of journald at the start, as it's unreachable after
+// pivot_root
+int connectJournal()
+{
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, "/run/systemd/journal/socket", sizeof(addr.sun_path) - 1);
+
+    int fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (fd == -1) {
+        return -1;
+    }
+
+    if (connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == -1) {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+} // namespace
+
+Logger::~Logger()
+{
+    auto &s = sink();
+    s.records.push_back({ level, GetPidnsPid(), function, line, ss.str() });
+    if (s.sync || level >= Warning || s.records.size() >= maxBufferedRecords) {
+        Flush();
+    }
+
+    if (level == Fatal) {
+        exit(-1);
+    }
+}
+
+void Logger::Flush() noexcept
+{
+    auto &s = sink();
+    if (s.records.empty()) {
+        return;
+    }
+
+    // swap out the records first, exit in a signal handler may flush again
+    std::vector<Record> records;
+    records.swap(s.records);
+
+    std::string console;
+    for (const auto &record : records) {
+        if (s.journalFd != -1) {
+            sendJournal(s.journalFd, record);
+        } else {
+            syslog(syslogLevelOf(record.level),
+                   "%s|%s:%d %s",
+                   record.pidns.c_str(),
+                   record.function,
+                   record.line,
+                   record.message.c_str());
+        }
+        appendConsole(console, record);
+    }
+
+    std::cout << console << std::flush;
 }
 
 static Logger::Level getLogLevelFromStr(std::string str)
@@ -52,6 +228,25 @@ static Logger::Level getLogLevelFromStr(std::string str)
 static Logger::Level initLogLevel()
 {
     openlog("ll-box", LOG_PID, LOG_USER);
+
+    auto &s = sink();
+    const auto *sync = getenv("LINGLONG_BOX_LOG_SYNC");
+    s.sync = sync != nullptr && std::string_view(sync) == "1";
+    // LINGLONG_BOX_LOG_JOURNAL=1 writes the records with the fields to journald instead of syslog
+    const auto *journal = getenv("LINGLONG_BOX_LOG_JOURNAL");
+    if (journal != nullptr && std::string_view(journal) == "1") {
+        s.journalFd = connectJournal();
+    }
+    atexit([]() {
+        Logger::Flush();
+    });
+    pthread_atfork(
+      []() {
+          Logger::Flush();
+      },
+      nullptr,
+      nullptr);
+
     auto env = getenv("LINGLONG_LOG_LEVEL");
     return getLogLevelFromStr(env ? env : "Error");
 }
@@ -8,8 +8,6 @@
 
 #include "util.h"
 
-#include <sys/syslog.h>
-
 #include <algorithm>
 #include <cstring>
 #include <iostream>
@@ -40,71 +38,8 @@ public:
         , function(fn)
         , line(line){};
 
-    ~Logger()
-    {
-        if (level < LOGLEVEL) {
-            return;
-        }
-
-        std::string prefix;
-        auto pid_ns = GetPidnsPid();
-        int syslogLevel = LOG_DEBUG;
-        switch (level) {
-        case Debug:
-            syslogLevel = LOG_DEBUG;
-            break;
-        case Info:
-            syslogLevel = LOG_INFO;
-            break;
-        case Warning:
-            syslogLevel = LOG_WARNING;
-            break;
-        case Error:
-            syslogLevel = LOG_ERR;
-            break;
-        case Fatal:
-            syslogLevel = LOG_ERR;
-            break;
-        }
-        syslog(syslogLevel, "%s|%s:%d %s", pid_ns.c_str(), function, line, ss.str().c_str());
-
-        switch (level) {
-        case Debug:
-            prefix = "[DBG |";
-            std::cout << prefix << " " << pid_ns << " | " << function << ":" << line << " ] "
-                      << ss.str() << std::endl;
-            break;
-        case Info:
-            prefix = "[IFO |";
-            std::cout << "\033[1;96m";
-            std::cout << prefix << " " << pid_ns << " | " << function << ":" << line << " ] "
-                      << ss.str();
-            std::cout << "\033[0m" << std::endl;
-            break;
-        case Warning:
-            prefix = "[WAN |";
-            std::cout << "\033[1;93m";
-            std::cout << prefix << " " << pid_ns << " | " << function << ":" << line << " ] "
-                      << ss.str();
-            std::cout << "\033[0m" << std::endl;
-            break;
-        case Error:
-            prefix = "[ERR |";
-            std::cout << "\033[1;31m";
-            std::cout << prefix << " " << pid_ns << " | " << function << ":" << line << " ] "
-                      << ss.str();
-            std::cout << "\033[0m" << std::endl;
-            break;
-        case Fatal:
-            prefix = "[FAL |";
-            std::cout << "\033[1;91m";
-            std::cout << prefix << " " << pid_ns << " | " << function << ":" << line << " ] "
-                      << ss.str();
-            std::cout << "\033[0m" << std::endl;
-            exit(-1);
-            break;
-        }
-    }
+    // the message is buffered, see Flush
+    ~Logger();
 
     template<class T>
     Logger &operator<<(const T &x)
@@ -113,6 +48,15 @@ public:
         return *this;
     }
 
+    // Enabled reports whether the messages of the level are written, the statements of the
+    // disabled levels don't format their arguments, see LINGLONG_BOX_LOG
+    static bool Enabled(Level l) noexcept { return l >= LOGLEVEL; }
+
+    // Flush writes the buffered messages. The messages below Warning are buffered in the process
+    // until the buffer is full or the process exits, and flushed before fork, clone and exec, as
+    // the buffer isn't shared with the children. LINGLONG_BOX_LOG_SYNC=1 disables the buffer.
+    static void Flush() noexcept;
+
 private:
     static Level LOGLEVEL;
     Level level = Debug;
@@ -120,11 +64,25 @@ private:
     int line;
     std::ostringstream ss;
 };
+
+// LogVoidify turns the log statement into a void expression for LINGLONG_BOX_LOG
+struct LogVoidify
+{
+    void operator&(const Logger & /*unused*/) { }
+};
+
 } // namespace util
 } // namespace linglong
 
-#define logDbg() (linglong::util::Logger(linglong::util::Logger::Debug, __FUNCTION__, __LINE__))
-#define logWan() (linglong::util::Logger(linglong::util::Logger::Warning, __FUNCTION__, __LINE__))
-#define logInf() (linglong::util::Logger(linglong::util::Logger::Info, __FUNCTION__, __LINE__))
-#define logErr() (linglong::util::Logger(linglong::util::Logger::Error, __FUNCTION__, __LINE__))
-#define logFal() (linglong::util::Logger(linglong::util::Logger::Fatal, __FUNCTION__, __LINE__))
+// the arguments are evaluated only if the level is enabled
+#define LINGLONG_BOX_LOG(level, function, line) /*NOLINT*/                      \
+    !linglong::util::Logger::Enabled(linglong::util::Logger::level)             \
+      ? (void)0                                                                 \
+      : linglong::util::LogVoidify()                                            \
+        & linglong::util::Logger(linglong::util::Logger::level, function, line)
+
+#define logDbg() LINGLONG_BOX_LOG(Debug, __FUNCTION__, __LINE__)
+#define logWan() LINGLONG_BOX_LOG(Warning, __FUNCTION__, __LINE__)
+#define logInf() LINGLONG_BOX_LOG(Info, __FUNCTION__, __LINE__)
+#define logErr() LINGLONG_BOX_LOG(Error, __FUNCTION__, __LINE__)
+#define logFal() LINGLONG_BOX_LOG(Fatal, __FUNCTION__, __LINE__)
@@ -0,0 +1,98 @@
+/*
+ * SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <sys/mount.h>
+#include <sys/syscall.h>
+
+#include <cerrno>
+#include <cstdint>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+// The new mount API is declared by glibc since 2.36, the constants are defined here for the older
+// ones. The wrappers return -1 with ENOSYS if the syscalls are unknown when building.
+#ifndef OPEN_TREE_CLONE
+#  define OPEN_TREE_CLONE 1
+#endif
+#ifndef OPEN_TREE_CLOEXEC
+#  define OPEN_TREE_CLOEXEC O_CLOEXEC
+#endif
+#ifndef MOVE_MOUNT_F_EMPTY_PATH
+#  define MOVE_MOUNT_F_EMPTY_PATH 0x00000004
+#endif
+#ifndef MOVE_MOUNT_T_EMPTY_PATH
+#  define MOVE_MOUNT_T_EMPTY_PATH 0x00000040
+#endif
+#ifndef AT_RECURSIVE
+#  define AT_RECURSIVE 0x8000
+#endif
+#ifndef MOUNT_ATTR_RDONLY
+#  define MOUNT_ATTR_RDONLY 0x00000001
+#  define MOUNT_ATTR_NOSUID 0x00000002
+#  define MOUNT_ATTR_NODEV 0x00000004
+#  define MOUNT_ATTR_NOEXEC 0x00000008
+#  define MOUNT_ATTR__ATIME 0x00000070
+#  define MOUNT_ATTR_RELATIME 0x00000000
+#  define MOUNT_ATTR_NOATIME 0x00000010
+#  define MOUNT_ATTR_STRICTATIME 0x00000020
+#  define MOUNT_ATTR_NODIRATIME 0x00000080
+#endif
+#ifndef MOUNT_ATTR_NOSYMFOLLOW
+#  define MOUNT_ATTR_NOSYMFOLLOW 0x00200000
+#endif
+
+namespace linglong {
+namespace util {
+
+// MountAttr is struct mount_attr of mount_setattr
+struct MountAttr
+{
+    uint64_t attrSet{ 0 };
+    uint64_t attrClr{ 0 };
+    uint64_t propagation{ 0 };
+    uint64_t usernsFd{ 0 };
+};
+
+inline int openTree(int dfd, const char *path, unsigned int flags)
+{
+#ifdef SYS_open_tree
+    return static_cast<int>(::syscall(SYS_open_tree, dfd, path, flags));
+#else
+    errno = ENOSYS;
+    return -1;
+#endif
+}
+
+inline int moveMount(int fromDfd,
+                     const char *fromPath,
+                     int toDfd,
+                     const char *toPath,
+                     unsigned int flags)
+{
+#ifdef SYS_move_mount
+    return static_cast<int>(::syscall(SYS_move_mount, fromDfd, fromPath, toDfd, toPath, flags));
+#else
+    errno = ENOSYS;
+    return -1;
+#endif
+}
+
+inline int mountSetattr(int dfd, const char *path, unsigned int flags, const MountAttr &attr)
+{
+#ifdef SYS_mount_setattr
+    return static_cast<int>(
+      ::syscall(SYS_mount_setattr, dfd, path, flags, &attr, sizeof(MountAttr)));
+#else
+    errno = ENOSYS;
+    return -1;
+#endif
+}
+
+} // namespace util
+} // namespace linglong
@@ -96,6 +96,10 @@ struct Mount
     uint32_t flags{ 0 };
     uint32_t propagationFlags{ 0 };
     uint32_t extensionFlags{ 0 };
+    // the flags set and cleared recursively on the bind mount and its submounts by the options like
+    // "rro", they need mount_setattr since linux 5.12
+    uint32_t recursiveFlags{ 0 };
+    uint32_t recursiveClearFlags{ 0 };
 };
 
 enum Extension { COPY_SYMLINK = 1 };
@@ -159,6 +163,27 @@ inline void from_json(const nlohmann::json &j, Mount &o)
         { "runbindable", MS_UNBINDABLE | MS_REC }, { "unbindable", MS_UNBINDABLE }
     };
 
+    const static std::map<std::string_view, mountFlag> recursiveFlags{
+        { "rro", { false, MS_RDONLY } },
+        { "rrw", { true, MS_RDONLY } },
+        { "rnosuid", { false, MS_NOSUID } },
+        { "rsuid", { true, MS_NOSUID } },
+        { "rnodev", { false, MS_NODEV } },
+        { "rdev", { true, MS_NODEV } },
+        { "rnoexec", { false, MS_NOEXEC } },
+        { "rexec", { true, MS_NOEXEC } },
+        { "rnodiratime", { false, MS_NODIRATIME } },
+        { "rdiratime", { true, MS_NODIRATIME } },
+        { "rrelatime", { false, MS_RELATIME } },
+        { "rnorelatime", { true, MS_RELATIME } },
+        { "rnoatime", { false, MS_NOATIME } },
+        { "ratime", { true, MS_NOATIME } },
+        { "rstrictatime", { false, MS_STRICTATIME } },
+        { "rnostrictatime", { true, MS_STRICTATIME } },
+        { "rnosymfollow", { false, LINGLONG_MS_NOSYMFOLLOW } },
+        { "rsymfollow", { true, LINGLONG_MS_NOSYMFOLLOW } },
+    };
+
     const static std::map<std::string_view, mountFlag> extensionFlags{
         { "copy-symlink", { false, Extension::COPY_SYMLINK } }
     };
@@ -173,7 +198,6 @@ inline void from_json(const nlohmann::json &j, Mount &o)
     o.data = {};
 
     // Parse options to data and flags.
-    // FIXME: support "recursive mount attrs" in the future
     // https://github.com/opencontainers/runc/blob/c83abc503de7e8b3017276e92e7510064eee02a8/libcontainer/specconv/spec_linux.go#L958
     auto options = j.value("options", util::str_vec());
     for (auto const &opt : options) {
@@ -185,6 +209,14 @@ inline void from_json(const nlohmann::json &j, Mount &o)
             }
         } else if (auto it = propagationFlags.find(opt); it != propagationFlags.cend()) {
             o.propagationFlags |= it->second;
+        } else if (auto it = recursiveFlags.find(opt); it != recursiveFlags.cend()) {
+            if (it->second.clear) {
+                o.recursiveFlags &= ~it->second.flag;
+                o.recursiveClearFlags |= it->second.flag;
+            } else {
+                o.recursiveFlags |= it->second.flag;
+                o.recursiveClearFlags &= ~it->second.flag;
+            }
         } else if (auto it = extensionFlags.find(opt); it != extensionFlags.cend()) {
             if (it->second.clear) {
                 o.extensionFlags &= ~it->second.flag;
@@ -284,6 +316,8 @@ struct Syscall
 {
     util::str_vec names;
     SeccompAction action;
+    // the errno returned by SCMP_ACT_ERRNO or the message of SCMP_ACT_TRACE, default EPERM
+    std::optional<u_int> errnoRet;
     std::vector<SyscallArg> args;
 };
 
@@ -291,6 +325,7 @@ inline void from_json(const nlohmann::json &j, Syscall &o)
 {
     o.names = j.at("names").get<util::str_vec>();
     o.action = j.at("action").get<SeccompAction>();
+    o.errnoRet = optional<decltype(o.errnoRet)::value_type>(j, "errnoRet");
     o.args = j.value("args", std::vector<SyscallArg>());
 }
 
@@ -298,27 +333,35 @@ inline void to_json(nlohmann::json &j, const Syscall &o)
 {
     j["names"] = o.names;
     j["action"] = o.action;
+    j["errnoRet"] = o.errnoRet;
     j["args"] = o.args;
 }
 
 struct Seccomp
 {
     SeccompAction defaultAction = "INVALID_ACTION";
+    std::optional<u_int> defaultErrnoRet;
     std::vector<SeccompArch> architectures;
+    // SECCOMP_FILTER_FLAG_* passed to seccomp(2)
+    std::vector<std::string> flags;
     std::vector<Syscall> syscalls;
 };
 
 inline void from_json(const nlohmann::json &j, Seccomp &o)
 {
     o.defaultAction = j.at("defaultAction").get<std::string>();
+    o.defaultErrnoRet = optional<decltype(o.defaultErrnoRet)::value_type>(j, "defaultErrnoRet");
     o.architectures = j.value("architectures", std::vector<SeccompArch>{});
+    o.flags = j.value("flags", std::vector<std::string>{});
     o.syscalls = j.value("syscalls", std::vector<Syscall>{});
 }
 
 inline void to_json(nlohmann::json &j, const Seccomp &o)
 {
     j["defaultAction"] = o.defaultAction;
+    j["defaultErrnoRet"] = o.defaultErrnoRet;
     j["architectures"] = o.architectures;
+    j["flags"] = o.flags;
     j["syscalls"] = o.syscalls;
 }
 
@@ -500,6 +543,7 @@ struct Runtime
     Linux linux;
     std::optional<std::vector<Mount>> mounts;
     std::optional<Hooks> hooks;
+    std::optional<std::map<std::string, std::string>> annotations;
 };
 
 inline void from_json(const nlohmann::json &j, Runtime &o)
@@ -512,6 +556,7 @@ inline void from_json(const nlohmann::json &j, Runtime &o)
     // maybe optional
     LLJS_FROM(root);
     o.hooks = optional<decltype(o.hooks)::value_type>(j, "hooks");
+    LLJS_FROM_OPT(annotations);
 }
 
 inline void to_json(nlohmann::json &j, const Runtime &o)
@@ -523,6 +568,7 @@ inline void to_json(nlohmann::json &j, const Runtime &o)
     j["linux"] = o.linux;
     j["root"] = o.root;
     j["hooks"] = o.hooks;
+    j["annotations"] = o.annotations;
 }
 
 inline static Runtime fromFile(const std::string &filepath)
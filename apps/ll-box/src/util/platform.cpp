@@ -22,6 +22,25 @@ const int kStackSize = (1024 * 1024);
 
 namespace util {
 
+namespace {
+
+struct CloneArgs
+{
+    int (*callback)(void *);
+    void *arg;
+};
+
+// cloneEntry flushes the logs of the child, which exits without atexit when the callback returns
+int cloneEntry(void *arg)
+{
+    auto &args = *static_cast<CloneArgs *>(arg);
+    auto ret = args.callback(args.arg);
+    Logger::Flush();
+    return ret;
+}
+
+} // namespace
+
 int PlatformClone(int (*callback)(void *), int flags, void *arg, ...)
 {
     char *stack;
@@ -39,7 +58,11 @@ int PlatformClone(int (*callback)(void *), int flags, void *arg, ...)
 
     stackTop = stack + kStackSize;
 
-    return clone(callback, stackTop, flags, arg);
+    // the buffered logs would be written twice by the child
+    Logger::Flush();
+    // the child has its own copy of the arguments
+    CloneArgs args{ callback, arg };
+    return clone(cloneEntry, stackTop, flags, &args);
 }
 
 int Exec(const util::str_vec &args, std::optional<std::vector<std::string>> env_list)
@@ -60,6 +83,7 @@ int Exec(const util::str_vec &args, std::optional<std::vector<std::string>> env_
     targetEnvv.push_back(nullptr);
 
     logDbg() << "execve" << targetArgv[0] << " in pid:" << getpid();
+    Logger::Flush();
 
     int ret = execvpe(targetArgv[0],
                       const_cast<char **>(targetArgv.data()),
@@ -88,6 +112,8 @@ static bool parse_wstatus(const int &wstatus, std::string &info)
 static int DoWait(const int pid, int target = 0)
 {
     logDbg() << util::format("DoWait called with pid=%d, target=%d", pid, target);
+    // the process may wait for a long time
+    Logger::Flush();
     int wstatus{ -1 };
     while (int child = waitpid(pid, &wstatus, 0)) {
         if (child > 0) {
@@ -18,10 +18,12 @@
 #include "linglong/utils/gettext.h"
 #include "linglong/utils/global/initialize.h"
 #include "ocppi/cli/crun/Crun.hpp"
+#include "ocppi/cli/llbox/LLBox.hpp"
 
 #include <CLI/CLI.hpp>
 #include <sys/file.h>
 
+#include <QFileInfo>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QtGlobal>
@@ -660,11 +662,24 @@ ll-cli list --upgradable
               QCoreApplication::exit(-1);
               return;
           }
-          auto ociRuntime = ocppi::cli::crun::Crun::New(path.toStdString());
-          if (!ociRuntime) {
-              std::rethrow_exception(ociRuntime.error());
+
+          // ll-box is driven in process for exec, kill and list unless it's disabled
+          std::unique_ptr<ocppi::cli::CLI> ociRuntime;
+          if (QFileInfo(path).fileName().startsWith("ll-box")
+              && qgetenv("LINGLONG_OCI_RUNTIME_IN_PROCESS") != "0") {
+              auto llBox = ocppi::cli::llbox::LLBox::New(path.toStdString());
+              if (!llBox) {
+                  std::rethrow_exception(llBox.error());
+              }
+              ociRuntime = std::move(*llBox);
+          } else {
+              auto crun = ocppi::cli::crun::Crun::New(path.toStdString());
+              if (!crun) {
+                  std::rethrow_exception(crun.error());
+              }
+              ociRuntime = std::move(*crun);
           }
-          auto *containerBuidler = new linglong::runtime::ContainerBuilder(**ociRuntime);
+          auto *containerBuidler = new linglong::runtime::ContainerBuilder(*ociRuntime);
           containerBuidler->setParent(QCoreApplication::instance());
 
           std::unique_ptr<InteractiveNotifier> notifier{ nullptr };
@@ -688,7 +703,7 @@ ll-cli list --upgradable
           }
 
           auto *cli = new linglong::cli::Cli(*printer,
-                                             **ociRuntime,
+                                             *ociRuntime,
                                              *containerBuidler,
                                              *pkgMan,
                                              *repo,
@@ -4,12 +4,14 @@
 
 #include "linglong/api/types/v1/Generators.hpp"
 #include "linglong/api/types/v1/UabMetaInfo.hpp"
-#include "sha256.h"
+#include "linglong/digest/sha256.h"
+#include "linglong/digest/verification_cache.h"
 
 #include <gelf.h>
 #include <getopt.h>
 #include <libelf.h>
 #include <linux/limits.h>
+#include <linux/loop.h>
 #include <nlohmann/json.hpp>
 #include <sys/mount.h>
 
@@ -18,11 +20,15 @@
 #include <atomic>
 #include <cstring>
 #include <filesystem>
-#include <iomanip>
 #include <iostream>
 #include <optional>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
 
 #include <fcntl.h>
+#include <sys/ioctl.h>
 #include <sys/stat.h>
 #include <sys/wait.h>
 #include <unistd.h>
@@ -265,6 +271,38 @@ std::optional<GElf_Shdr> getSectionHeader(int elfFd, std::string_view sectionNam
     return secHdr;
 }
 
+std::optional<std::array<std::byte, 32>> fromHex(std::string_view hex) noexcept
+{
+    std::array<std::byte, 32> digest{};
+    if (hex.size() != digest.size() * 2) {
+        return std::nullopt;
+    }
+
+    auto nibble = [](char c) -> int {
+        if (c >= '0' && c <= '9') {
+            return c - '0';
+        }
+        if (c >= 'a' && c <= 'f') {
+            return c - 'a' + 10;
+        }
+        if (c >= 'A' && c <= 'F') {
+            return c - 'A' + 10;
+        }
+        return -1;
+    };
+
+    for (std::size_t i = 0; i < digest.size(); ++i) {
+        auto high = nibble(hex[i * 2]);
+        auto low = nibble(hex[i * 2 + 1]);
+        if (high == -1 || low == -1) {
+            return std::nullopt;
+        }
+        digest[i] = static_cast<std::byte>((high << 4) | low);
+    }
+
+    return digest;
+}
+
 std::string calculateDigest(int fd, std::size_t bundleOffset, std::size_t bundleLength) noexcept
 {
     auto file = ::dup(fd);
@@ -282,9 +320,9 @@ std::string calculateDigest(int fd, std::size_t bundleOffset, std::size_t bundle
         return {};
     }
 
-    digest::SHA256 sha256;
+    linglong::digest::SHA256 sha256;
     std::array<std::byte, 4096> buf{};
-    std::array<std::byte, 32> md_value{};
+    std::string digest;
     auto expectedRead = buf.size();
     int readLength{ 0 };
 
@@ -302,21 +340,220 @@ std::string calculateDigest(int fd, std::size_t bundleOffset, std::size_t bundle
 
         bundleLength -= readLength;
         if (bundleLength == 0) {
-            sha256.final(md_value.data());
+            digest = sha256.hexDigest();
             break;
         }
 
         expectedRead = bundleLength > buf.size() ? buf.size() : bundleLength;
     }
 
-    std::stringstream stream;
-    stream << std::setfill('0') << std::hex;
+    return digest;
+}
+
+bool readAt(int fd, std::byte *buf, std::size_t size, std::size_t offset) noexcept
+{
+    while (size > 0) {
+        auto readLength = ::pread(fd, buf, size, offset);
+        if (readLength == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            std::cerr << "read bundle error:" << ::strerror(errno) << std::endl;
+            return false;
+        }
+        if (readLength == 0) {
+            std::cerr << "read bundle error: unexpected end of file" << std::endl;
+            return false;
+        }
+
+        buf += readLength;
+        size -= readLength;
+        offset += readLength;
+    }
+
+    return true;
+}
+
+// verifyDigestTree checks the tree against its root digest, then verifies the chunks of bundle
+// in parallel
+bool verifyDigestTree(int fd,
+                      std::size_t bundleOffset,
+                      std::size_t bundleLength,
+                      const linglong::api::types::v1::UabDigestTree &tree) noexcept
+{
+    if (tree.chunkSize <= 0) {
+        std::cerr << "invalid chunk size of digest tree: " << tree.chunkSize << std::endl;
+        return false;
+    }
 
-    for (auto v : md_value) {
-        stream << std::setw(2) << static_cast<unsigned int>(v);
+    const std::size_t chunkSize = tree.chunkSize;
+    const auto count = (bundleLength + chunkSize - 1) / chunkSize;
+    if (tree.chunks.size() != count) {
+        std::cerr << "expect " << count << " chunks in digest tree, but got " << tree.chunks.size()
+                  << std::endl;
+        return false;
     }
 
-    return stream.str();
+    linglong::digest::SHA256 root;
+    for (const auto &chunk : tree.chunks) {
+        auto raw = fromHex(chunk);
+        if (!raw) {
+            std::cerr << "invalid chunk digest: " << chunk << std::endl;
+            return false;
+        }
+        root.update(raw->data(), raw->size());
+    }
+    if (auto digest = root.hexDigest(); digest != tree.root) {
+        std::cerr << "root sha256 mismatched, expected: " << tree.root << " calculated: " << digest
+                  << std::endl;
+        return false;
+    }
+
+    std::atomic_size_t next{ 0 };
+    std::atomic_bool failed{ false };
+    auto worker = [&]() {
+        std::vector<std::byte> buf(std::min(chunkSize, bundleLength));
+        while (!failed.load(std::memory_order_relaxed)) {
+            auto index = next.fetch_add(1, std::memory_order_relaxed);
+            if (index >= count) {
+                return;
+            }
+
+            auto pos = index * chunkSize;
+            auto size = std::min(chunkSize, bundleLength - pos);
+            if (!readAt(fd, buf.data(), size, bundleOffset + pos)) {
+                failed.store(true, std::memory_order_relaxed);
+                return;
+            }
+
+            linglong::digest::SHA256 sha256;
+            sha256.update(buf.data(), size);
+            if (sha256.hexDigest() != tree.chunks[index]) {
+                std::cerr << "sha256 of chunk " << index << " mismatched" << std::endl;
+                failed.store(true, std::memory_order_relaxed);
+                return;
+            }
+        }
+    };
+
+    auto jobs = std::min<std::size_t>(std::max(1U, std::thread::hardware_concurrency()), count);
+    std::vector<std::thread> threads;
+    threads.reserve(jobs);
+    for (std::size_t i = 0; i < jobs; ++i) {
+        threads.emplace_back(worker);
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    return !failed.load();
+}
+
+// attachLoopDevice returns the fd of a read-only loop device backed by fd at offset, or -1 on
+// failure. The device is detached when its last reference is dropped, so keep the returned fd open
+// until the device is mounted.
+int attachLoopDevice(int fd, std::size_t offset, std::string &device) noexcept
+{
+    auto ctlFd = ::open("/dev/loop-control", O_RDWR | O_CLOEXEC);
+    if (ctlFd == -1) {
+        return -1;
+    }
+
+    auto closeCtl = defer([ctlFd] {
+        ::close(ctlFd);
+    });
+
+    loop_info64 info{};
+    info.lo_offset = offset;
+    info.lo_flags = LO_FLAGS_READ_ONLY | LO_FLAGS_AUTOCLEAR;
+
+    // retry if the free loop device is taken by others before we configure it
+    for (auto retry = 0; retry < 8; ++retry) {
+        auto nr = ::ioctl(ctlFd, LOOP_CTL_GET_FREE);
+        if (nr < 0) {
+            return -1;
+        }
+
+        device = "/dev/loop" + std::to_string(nr);
+        auto loopFd = ::open(device.c_str(), O_RDONLY | O_CLOEXEC);
+        if (loopFd == -1) {
+            return -1;
+        }
+
+        auto closeLoop = defer([&loopFd] {
+            if (loopFd != -1) {
+                ::close(loopFd);
+            }
+        });
+
+#ifdef LOOP_CONFIGURE
+        loop_config config{};
+        config.fd = fd;
+        config.info = info;
+        if (::ioctl(loopFd, LOOP_CONFIGURE, &config) == 0) {
+            return std::exchange(loopFd, -1);
+        }
+
+        if (errno == EBUSY) {
+            continue;
+        }
+
+        if (errno != EINVAL && errno != ENOTTY) {
+            return -1;
+        }
+#endif
+
+        if (::ioctl(loopFd, LOOP_SET_FD, fd) == -1) {
+            if (errno == EBUSY) {
+                continue;
+            }
+            return -1;
+        }
+
+        if (::ioctl(loopFd, LOOP_SET_STATUS64, &info) == -1) {
+            ::ioctl(loopFd, LOOP_CLR_FD, 0);
+            return -1;
+        }
+
+        return std::exchange(loopFd, -1);
+    }
+
+    return -1;
+}
+
+// mount bundle with the in-kernel erofs driver, it only works with CAP_SYS_ADMIN
+int mountBundleByKernel(int selfBinFd, std::size_t bundleOffset) noexcept
+{
+    std::string device;
+    auto loopFd = attachLoopDevice(selfBinFd, bundleOffset, device);
+    if (loopFd == -1) {
+        // unprivileged users fallback to erofsfuse silently
+        if (errno != EACCES && errno != EPERM) {
+            std::cerr << "couldn't attach loop device, fallback to erofsfuse: "
+                      << ::strerror(errno) << std::endl;
+        }
+        return -1;
+    }
+
+    // hold the loop device until it is mounted, then it will be detached automatically when the
+    // bundle is umounted, or immediately if the mount failed
+    auto closeLoop = defer([loopFd] {
+        ::close(loopFd);
+    });
+
+    if (::mount(device.c_str(),
+                mountPoint.c_str(),
+                "erofs",
+                MS_RDONLY | MS_NODEV | MS_NOSUID,
+                nullptr)
+        == -1) {
+        std::cerr << "couldn't mount " << device << ", fallback to erofsfuse: " << ::strerror(errno)
+                  << std::endl;
+        return -1;
+    }
+
+    return 0;
 }
 
 int mountSelfBundle(std::string_view selfBin,
@@ -339,11 +576,36 @@ int mountSelfBundle(std::string_view selfBin,
     }
 
     auto bundleOffset = bundleSh->sh_offset;
-    if (auto digest = calculateDigest(selfBinFd, bundleOffset, bundleSh->sh_size);
-        digest != meta.digest) {
-        std::cerr << "sha256 mismatched, expected: " << meta.digest << " calculated: " << digest
-                  << std::endl;
-        return -1;
+    // an unchanged bundle which has been verified before doesn't need to be hashed again
+    const auto &expectedDigest = meta.digestTree ? meta.digestTree->root : meta.digest;
+    std::optional<linglong::digest::VerificationCache> cache;
+    std::optional<linglong::digest::FileStamp> stamp;
+    if (auto cacheDir = linglong::digest::VerificationCache::defaultDirectory();
+        cacheDir && ::getenv("UAB_DISABLE_VERIFICATION_CACHE") == nullptr) {
+        cache.emplace(std::move(cacheDir).value());
+        stamp = linglong::digest::FileStamp::of(selfBinFd);
+    }
+
+    if (!cache || !stamp || !cache->verified(*stamp, expectedDigest)) {
+        if (meta.digestTree) {
+            if (!verifyDigestTree(selfBinFd, bundleOffset, bundleSh->sh_size, *meta.digestTree)) {
+                return -1;
+            }
+        } else if (auto digest = calculateDigest(selfBinFd, bundleOffset, bundleSh->sh_size);
+                   digest != meta.digest) {
+            std::cerr << "sha256 mismatched, expected: " << meta.digest
+                      << " calculated: " << digest << std::endl;
+            return -1;
+        }
+
+        if (cache && stamp) {
+            cache->remember(selfBinFd, *stamp, expectedDigest);
+        }
+    }
+
+    if (::getenv("UAB_EROFS_FORCE_FUSE") == nullptr
+        && mountBundleByKernel(selfBinFd, bundleOffset) == 0) {
+        return 0;
     }
 
     auto offsetStr = "--offset=" + std::to_string(bundleOffset);
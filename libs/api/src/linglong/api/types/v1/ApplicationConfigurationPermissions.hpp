@@ -19,6 +19,7 @@
 
 #include "linglong/api/types/v1/ApplicationConfigurationPermissionsBind.hpp"
 #include "linglong/api/types/v1/ApplicationConfigurationPermissionsInnerBind.hpp"
+#include "linglong/api/types/v1/ApplicationConfigurationPermissionsResources.hpp"
 
 namespace linglong {
 namespace api {
@@ -39,6 +40,12 @@ std::optional<std::vector<ApplicationConfigurationPermissionsBind>> binds;
 * inner binds of container
 */
 std::optional<std::vector<ApplicationConfigurationPermissionsInnerBind>> innerBinds;
+/**
+* resource limits of the container, which are applied to the systemd
+* user unit of the application. The values in the configuration of
+* the user override the ones of the package.
+*/
+std::optional<ApplicationConfigurationPermissionsResources> resources;
 };
 }
 }
@@ -0,0 +1,64 @@
+// This file is generated by tools/codegen.sh
+// DO NOT EDIT IT.
+
+// clang-format off
+
+//  To parse this JSON data, first install
+//
+//      json.hpp  https://github.com/nlohmann/json
+//
+//  Then include this file, and then do
+//
+//     ApplicationConfigurationPermissionsResources.hpp data = nlohmann::json::parse(jsonString);
+
+#pragma once
+
+#include <optional>
+#include <nlohmann/json.hpp>
+#include "linglong/api/types/v1/helper.hpp"
+
+namespace linglong {
+namespace api {
+namespace types {
+namespace v1 {
+/**
+* resource limits of the container, which are applied to the systemd
+* user unit of the application. The values in the configuration of
+* the user override the ones of the package.
+*/
+
+using nlohmann::json;
+
+/**
+* resource limits of the container, which are applied to the systemd
+* user unit of the application. The values in the configuration of
+* the user override the ones of the package.
+*/
+struct ApplicationConfigurationPermissionsResources {
+/**
+* CPU weight of the container, in range [1, 10000], default 100
+*/
+std::optional<int64_t> cpuWeight;
+/**
+* IO weight of the container, in range [1, 10000], default 100
+*/
+std::optional<int64_t> ioWeight;
+/**
+* memory usage in bytes over which the container is throttled
+*/
+std::optional<int64_t> memoryHigh;
+/**
+* memory usage in bytes over which the container is killed by OOM killer
+*/
+std::optional<int64_t> memoryMax;
+/**
+* maximum number of processes and threads in the container
+*/
+std::optional<int64_t> pidsMax;
+};
+}
+}
+}
+}
+
+// clang-format on
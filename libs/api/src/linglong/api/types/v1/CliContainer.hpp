@@ -32,10 +32,18 @@ using nlohmann::json;
 */
 struct CliContainer {
 /**
+* CPU time in microseconds used by the container
+*/
+std::optional<int64_t> cpuUsage;
+/**
 * id of container
 */
 std::string id;
 /**
+* memory in bytes used by the container
+*/
+std::optional<int64_t> memoryUsage;
+/**
 * package of container
 */
 std::string package;
@@ -43,6 +51,10 @@ std::string package;
 * pid of container
 */
 int64_t pid;
+/**
+* number of processes and threads in the container
+*/
+std::optional<int64_t> tasks;
 };
 }
 }
@@ -0,0 +1,403 @@
+// This file is generated by tools/codegen.sh
+// DO NOT EDIT IT.
+
+// clang-format off
+
+// The members and their keys, see linglong/utils/serialize/json_reader.h
+
+#pragma once
+
+#include <tuple>
+#include <utility>
+
+#include "linglong/api/types/v1/Generators.hpp"
+
+namespace linglong {
+namespace api {
+namespace types {
+namespace v1 {
+
+inline auto fields(const UserDirectories *) {
+return std::make_tuple(
+std::make_pair("allowed", &UserDirectories::allowed),
+std::make_pair("disallowed", &UserDirectories::disallowed));
+}
+
+inline auto fields(const ApplicationAccessPrivileges *) {
+return std::make_tuple(
+std::make_pair("userDirectories", &ApplicationAccessPrivileges::userDirectories));
+}
+
+inline auto fields(const ApplicationConfigurationPermissionsBind *) {
+return std::make_tuple(
+std::make_pair("destination", &ApplicationConfigurationPermissionsBind::destination),
+std::make_pair("source", &ApplicationConfigurationPermissionsBind::source));
+}
+
+inline auto fields(const ApplicationConfigurationPermissionsInnerBind *) {
+return std::make_tuple(
+std::make_pair("destination", &ApplicationConfigurationPermissionsInnerBind::destination),
+std::make_pair("source", &ApplicationConfigurationPermissionsInnerBind::source));
+}
+
+inline auto fields(const ApplicationConfigurationPermissionsResources *) {
+return std::make_tuple(
+std::make_pair("cpuWeight", &ApplicationConfigurationPermissionsResources::cpuWeight),
+std::make_pair("ioWeight", &ApplicationConfigurationPermissionsResources::ioWeight),
+std::make_pair("memoryHigh", &ApplicationConfigurationPermissionsResources::memoryHigh),
+std::make_pair("memoryMax", &ApplicationConfigurationPermissionsResources::memoryMax),
+std::make_pair("pidsMax", &ApplicationConfigurationPermissionsResources::pidsMax));
+}
+
+inline auto fields(const ApplicationConfigurationPermissions *) {
+return std::make_tuple(
+std::make_pair("binds", &ApplicationConfigurationPermissions::binds),
+std::make_pair("innerBinds", &ApplicationConfigurationPermissions::innerBinds),
+std::make_pair("resources", &ApplicationConfigurationPermissions::resources));
+}
+
+inline auto fields(const ApplicationConfiguration *) {
+return std::make_tuple(
+std::make_pair("permissions", &ApplicationConfiguration::permissions),
+std::make_pair("version", &ApplicationConfiguration::version));
+}
+
+inline auto fields(const BuilderConfig *) {
+return std::make_tuple(
+std::make_pair("arch", &BuilderConfig::arch),
+std::make_pair("cache", &BuilderConfig::cache),
+std::make_pair("offline", &BuilderConfig::offline),
+std::make_pair("repo", &BuilderConfig::repo),
+std::make_pair("version", &BuilderConfig::version));
+}
+
+inline auto fields(const BuilderProjectModules *) {
+return std::make_tuple(
+std::make_pair("files", &BuilderProjectModules::files),
+std::make_pair("name", &BuilderProjectModules::name));
+}
+
+inline auto fields(const BuilderProjectPackage *) {
+return std::make_tuple(
+std::make_pair("architecture", &BuilderProjectPackage::architecture),
+std::make_pair("channel", &BuilderProjectPackage::channel),
+std::make_pair("description", &BuilderProjectPackage::description),
+std::make_pair("id", &BuilderProjectPackage::id),
+std::make_pair("kind", &BuilderProjectPackage::kind),
+std::make_pair("name", &BuilderProjectPackage::name),
+std::make_pair("version", &BuilderProjectPackage::version));
+}
+
+inline auto fields(const BuilderProjectSource *) {
+return std::make_tuple(
+std::make_pair("commit", &BuilderProjectSource::commit),
+std::make_pair("digest", &BuilderProjectSource::digest),
+std::make_pair("kind", &BuilderProjectSource::kind),
+std::make_pair("name", &BuilderProjectSource::name),
+std::make_pair("url", &BuilderProjectSource::url),
+std::make_pair("version", &BuilderProjectSource::version));
+}
+
+inline auto fields(const BuilderProject *) {
+return std::make_tuple(
+std::make_pair("base", &BuilderProject::base),
+std::make_pair("build", &BuilderProject::build),
+std::make_pair("command", &BuilderProject::command),
+std::make_pair("exclude", &BuilderProject::exclude),
+std::make_pair("include", &BuilderProject::include),
+std::make_pair("modules", &BuilderProject::modules),
+std::make_pair("package", &BuilderProject::package),
+std::make_pair("permissions", &BuilderProject::permissions),
+std::make_pair("runtime", &BuilderProject::runtime),
+std::make_pair("sources", &BuilderProject::sources),
+std::make_pair("strip", &BuilderProject::strip),
+std::make_pair("version", &BuilderProject::version));
+}
+
+inline auto fields(const CliContainer *) {
+return std::make_tuple(
+std::make_pair("cpuUsage", &CliContainer::cpuUsage),
+std::make_pair("id", &CliContainer::id),
+std::make_pair("memoryUsage", &CliContainer::memoryUsage),
+std::make_pair("package", &CliContainer::package),
+std::make_pair("pid", &CliContainer::pid),
+std::make_pair("tasks", &CliContainer::tasks));
+}
+
+inline auto fields(const CommonOptions *) {
+return std::make_tuple(
+std::make_pair("force", &CommonOptions::force),
+std::make_pair("skipInteraction", &CommonOptions::skipInteraction));
+}
+
+inline auto fields(const CommonResult *) {
+return std::make_tuple(
+std::make_pair("code", &CommonResult::code),
+std::make_pair("message", &CommonResult::message),
+std::make_pair("type", &CommonResult::type));
+}
+
+inline auto fields(const ContainerProcessStateInfo *) {
+return std::make_tuple(
+std::make_pair("app", &ContainerProcessStateInfo::app),
+std::make_pair("base", &ContainerProcessStateInfo::base),
+std::make_pair("containerID", &ContainerProcessStateInfo::containerID),
+std::make_pair("runtime", &ContainerProcessStateInfo::runtime));
+}
+
+inline auto fields(const InteractionReply *) {
+return std::make_tuple(
+std::make_pair("action", &InteractionReply::action));
+}
+
+inline auto fields(const InteractionRequest *) {
+return std::make_tuple(
+std::make_pair("actions", &InteractionRequest::actions),
+std::make_pair("appName", &InteractionRequest::appName),
+std::make_pair("body", &InteractionRequest::body),
+std::make_pair("summary", &InteractionRequest::summary),
+std::make_pair("timeout", &InteractionRequest::timeout));
+}
+
+inline auto fields(const LayerInfo *) {
+return std::make_tuple(
+std::make_pair("info", &LayerInfo::info),
+std::make_pair("version", &LayerInfo::version));
+}
+
+inline auto fields(const OciConfigurationPatch *) {
+return std::make_tuple(
+std::make_pair("ociVersion", &OciConfigurationPatch::ociVersion),
+std::make_pair("patch", &OciConfigurationPatch::patch));
+}
+
+inline auto fields(const PackageInfo *) {
+return std::make_tuple(
+std::make_pair("appid", &PackageInfo::appid),
+std::make_pair("arch", &PackageInfo::arch),
+std::make_pair("base", &PackageInfo::base),
+std::make_pair("channel", &PackageInfo::channel),
+std::make_pair("command", &PackageInfo::command),
+std::make_pair("description", &PackageInfo::description),
+std::make_pair("kind", &PackageInfo::kind),
+std::make_pair("module", &PackageInfo::packageInfoModule),
+std::make_pair("name", &PackageInfo::name),
+std::make_pair("permissions", &PackageInfo::permissions),
+std::make_pair("runtime", &PackageInfo::runtime),
+std::make_pair("size", &PackageInfo::size),
+std::make_pair("version", &PackageInfo::version));
+}
+
+inline auto fields(const PackageInfoV2 *) {
+return std::make_tuple(
+std::make_pair("arch", &PackageInfoV2::arch),
+std::make_pair("base", &PackageInfoV2::base),
+std::make_pair("channel", &PackageInfoV2::channel),
+std::make_pair("command", &PackageInfoV2::command),
+std::make_pair("compatible_version", &PackageInfoV2::compatibleVersion),
+std::make_pair("description", &PackageInfoV2::description),
+std::make_pair("id", &PackageInfoV2::id),
+std::make_pair("kind", &PackageInfoV2::kind),
+std::make_pair("module", &PackageInfoV2::packageInfoV2Module),
+std::make_pair("name", &PackageInfoV2::name),
+std::make_pair("permissions", &PackageInfoV2::permissions),
+std::make_pair("runtime", &PackageInfoV2::runtime),
+std::make_pair("schema_version", &PackageInfoV2::schemaVersion),
+std::make_pair("size", &PackageInfoV2::size),
+std::make_pair("uuid", &PackageInfoV2::uuid),
+std::make_pair("version", &PackageInfoV2::version));
+}
+
+inline auto fields(const PackageManager1GetRepoInfoResultRepoInfo *) {
+return std::make_tuple(
+std::make_pair("defaultRepo", &PackageManager1GetRepoInfoResultRepoInfo::defaultRepo),
+std::make_pair("repos", &PackageManager1GetRepoInfoResultRepoInfo::repos));
+}
+
+inline auto fields(const PackageManager1GetRepoInfoResult *) {
+return std::make_tuple(
+std::make_pair("repoInfo", &PackageManager1GetRepoInfoResult::repoInfo),
+std::make_pair("code", &PackageManager1GetRepoInfoResult::code),
+std::make_pair("message", &PackageManager1GetRepoInfoResult::message),
+std::make_pair("type", &PackageManager1GetRepoInfoResult::type));
+}
+
+inline auto fields(const PackageManager1Package *) {
+return std::make_tuple(
+std::make_pair("channel", &PackageManager1Package::channel),
+std::make_pair("id", &PackageManager1Package::id),
+std::make_pair("module", &PackageManager1Package::packageManager1PackageModule),
+std::make_pair("version", &PackageManager1Package::version));
+}
+
+inline auto fields(const PackageManager1InstallParameters *) {
+return std::make_tuple(
+std::make_pair("options", &PackageManager1InstallParameters::options),
+std::make_pair("package", &PackageManager1InstallParameters::package));
+}
+
+inline auto fields(const PackageManager1JobInfo *) {
+return std::make_tuple(
+std::make_pair("id", &PackageManager1JobInfo::id),
+std::make_pair("code", &PackageManager1JobInfo::code),
+std::make_pair("message", &PackageManager1JobInfo::message),
+std::make_pair("type", &PackageManager1JobInfo::type));
+}
+
+inline auto fields(const PackageManager1ModifyRepoParameters *) {
+return std::make_tuple(
+std::make_pair("defaultRepo", &PackageManager1ModifyRepoParameters::defaultRepo),
+std::make_pair("repos", &PackageManager1ModifyRepoParameters::repos));
+}
+
+inline auto fields(const PackageManager1PackageTaskResult *) {
+return std::make_tuple(
+std::make_pair("taskObjectPath", &PackageManager1PackageTaskResult::taskObjectPath),
+std::make_pair("code", &PackageManager1PackageTaskResult::code),
+std::make_pair("message", &PackageManager1PackageTaskResult::message),
+std::make_pair("type", &PackageManager1PackageTaskResult::type));
+}
+
+inline auto fields(const PackageManager1RequestInteractionAdditionalMessage *) {
+return std::make_tuple(
+std::make_pair("LocalRef", &PackageManager1RequestInteractionAdditionalMessage::localRef),
+std::make_pair("RemoteRef", &PackageManager1RequestInteractionAdditionalMessage::remoteRef));
+}
+
+inline auto fields(const PackageManager1SearchParameters *) {
+return std::make_tuple(
+std::make_pair("id", &PackageManager1SearchParameters::id));
+}
+
+inline auto fields(const PackageManager1SearchResult *) {
+return std::make_tuple(
+std::make_pair("packages", &PackageManager1SearchResult::packages),
+std::make_pair("code", &PackageManager1SearchResult::code),
+std::make_pair("message", &PackageManager1SearchResult::message),
+std::make_pair("type", &PackageManager1SearchResult::type));
+}
+
+inline auto fields(const PackageManager1UninstallParameters *) {
+return std::make_tuple(
+std::make_pair("package", &PackageManager1UninstallParameters::package));
+}
+
+inline auto fields(const PackageManager1UpdateParameters *) {
+return std::make_tuple(
+std::make_pair("packages", &PackageManager1UpdateParameters::packages));
+}
+
+inline auto fields(const RepoConfig *) {
+return std::make_tuple(
+std::make_pair("defaultRepo", &RepoConfig::defaultRepo),
+std::make_pair("repos", &RepoConfig::repos),
+std::make_pair("version", &RepoConfig::version));
+}
+
+inline auto fields(const RepositoryCacheLayersItem *) {
+return std::make_tuple(
+std::make_pair("commit", &RepositoryCacheLayersItem::commit),
+std::make_pair("deleted", &RepositoryCacheLayersItem::deleted),
+std::make_pair("info", &RepositoryCacheLayersItem::info),
+std::make_pair("repo", &RepositoryCacheLayersItem::repo));
+}
+
+inline auto fields(const RepositoryCacheMergedItem *) {
+return std::make_tuple(
+std::make_pair("binaryCommit", &RepositoryCacheMergedItem::binaryCommit),
+std::make_pair("commits", &RepositoryCacheMergedItem::commits),
+std::make_pair("id", &RepositoryCacheMergedItem::id),
+std::make_pair("modules", &RepositoryCacheMergedItem::modules),
+std::make_pair("name", &RepositoryCacheMergedItem::name));
+}
+
+inline auto fields(const RepositoryCache *) {
+return std::make_tuple(
+std::make_pair("config", &RepositoryCache::config),
+std::make_pair("layers", &RepositoryCache::layers),
+std::make_pair("ll-version", &RepositoryCache::llVersion),
+std::make_pair("merged", &RepositoryCache::merged),
+std::make_pair("version", &RepositoryCache::version));
+}
+
+inline auto fields(const UabDigestTree *) {
+return std::make_tuple(
+std::make_pair("chunks", &UabDigestTree::chunks),
+std::make_pair("chunkSize", &UabDigestTree::chunkSize),
+std::make_pair("root", &UabDigestTree::root));
+}
+
+inline auto fields(const UabLayer *) {
+return std::make_tuple(
+std::make_pair("info", &UabLayer::info),
+std::make_pair("minified", &UabLayer::minified));
+}
+
+inline auto fields(const Sections *) {
+return std::make_tuple(
+std::make_pair("bundle", &Sections::bundle),
+std::make_pair("icon", &Sections::icon));
+}
+
+inline auto fields(const UabMetaInfo *) {
+return std::make_tuple(
+std::make_pair("digest", &UabMetaInfo::digest),
+std::make_pair("digestTree", &UabMetaInfo::digestTree),
+std::make_pair("layers", &UabMetaInfo::layers),
+std::make_pair("sections", &UabMetaInfo::sections),
+std::make_pair("uuid", &UabMetaInfo::uuid),
+std::make_pair("version", &UabMetaInfo::version));
+}
+
+inline auto fields(const UpgradeListResult *) {
+return std::make_tuple(
+std::make_pair("id", &UpgradeListResult::id),
+std::make_pair("new_version", &UpgradeListResult::newVersion),
+std::make_pair("old_version", &UpgradeListResult::oldVersion));
+}
+
+inline auto fields(const LinglongAPIV1 *) {
+return std::make_tuple(
+std::make_pair("ApplicationAccessPrivileges", &LinglongAPIV1::applicationAccessPrivileges),
+std::make_pair("ApplicationConfiguration", &LinglongAPIV1::applicationConfiguration),
+std::make_pair("ApplicationConfigurationPermissions", &LinglongAPIV1::applicationConfigurationPermissions),
+std::make_pair("BuilderConfig", &LinglongAPIV1::builderConfig),
+std::make_pair("BuilderProject", &LinglongAPIV1::builderProject),
+std::make_pair("CLIContainer", &LinglongAPIV1::cliContainer),
+std::make_pair("CommonOptions", &LinglongAPIV1::commonOptions),
+std::make_pair("CommonResult", &LinglongAPIV1::commonResult),
+std::make_pair("ContainerProcessStateInfo", &LinglongAPIV1::containerProcessStateInfo),
+std::make_pair("InteractionMessageType", &LinglongAPIV1::interactionMessageType),
+std::make_pair("InteractionReply", &LinglongAPIV1::interactionReply),
+std::make_pair("InteractionRequest", &LinglongAPIV1::interactionRequest),
+std::make_pair("LayerInfo", &LinglongAPIV1::layerInfo),
+std::make_pair("OCIConfigurationPatch", &LinglongAPIV1::ociConfigurationPatch),
+std::make_pair("PackageInfo", &LinglongAPIV1::packageInfo),
+std::make_pair("PackageInfoV2", &LinglongAPIV1::packageInfoV2),
+std::make_pair("PackageManager1GetRepoInfoResult", &LinglongAPIV1::packageManager1GetRepoInfoResult),
+std::make_pair("PackageManager1InstallLayerFDResult", &LinglongAPIV1::packageManager1InstallLayerFDResult),
+std::make_pair("PackageManager1InstallParameters", &LinglongAPIV1::packageManager1InstallParameters),
+std::make_pair("PackageManager1JobInfo", &LinglongAPIV1::packageManager1JobInfo),
+std::make_pair("PackageManager1ModifyRepoParameters", &LinglongAPIV1::packageManager1ModifyRepoParameters),
+std::make_pair("PackageManager1ModifyRepoResult", &LinglongAPIV1::packageManager1ModifyRepoResult),
+std::make_pair("PackageManager1Package", &LinglongAPIV1::packageManager1Package),
+std::make_pair("PackageManager1PackageTaskResult", &LinglongAPIV1::packageManager1PackageTaskResult),
+std::make_pair("PackageManager1RequestInteractionAdditionalMessage", &LinglongAPIV1::packageManager1RequestInteractionAdditionalMessage),
+std::make_pair("PackageManager1SearchParameters", &LinglongAPIV1::packageManager1SearchParameters),
+std::make_pair("PackageManager1SearchResult", &LinglongAPIV1::packageManager1SearchResult),
+std::make_pair("PackageManager1UninstallParameters", &LinglongAPIV1::packageManager1UninstallParameters),
+std::make_pair("PackageManager1UpdateParameters", &LinglongAPIV1::packageManager1UpdateParameters),
+std::make_pair("RepoConfig", &LinglongAPIV1::repoConfig),
+std::make_pair("RepositoryCache", &LinglongAPIV1::repositoryCache),
+std::make_pair("State", &LinglongAPIV1::state),
+std::make_pair("SubState", &LinglongAPIV1::subState),
+std::make_pair("UABMetaInfo", &LinglongAPIV1::uabMetaInfo),
+std::make_pair("UpgradeListResult", &LinglongAPIV1::upgradeListResult));
+}
+
+}
+}
+}
+}
+
+// clang-format on
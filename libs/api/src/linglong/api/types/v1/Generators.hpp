@@ -23,6 +23,7 @@
 #include "linglong/api/types/v1/Version.hpp"
 #include "linglong/api/types/v1/Sections.hpp"
 #include "linglong/api/types/v1/UabLayer.hpp"
+#include "linglong/api/types/v1/UabDigestTree.hpp"
 #include "linglong/api/types/v1/SubState.hpp"
 #include "linglong/api/types/v1/State.hpp"
 #include "linglong/api/types/v1/RepositoryCache.hpp"
@@ -59,6 +60,7 @@
 #include "linglong/api/types/v1/BuilderConfig.hpp"
 #include "linglong/api/types/v1/ApplicationConfiguration.hpp"
 #include "linglong/api/types/v1/ApplicationConfigurationPermissions.hpp"
+#include "linglong/api/types/v1/ApplicationConfigurationPermissionsResources.hpp"
 #include "linglong/api/types/v1/ApplicationConfigurationPermissionsInnerBind.hpp"
 #include "linglong/api/types/v1/ApplicationConfigurationPermissionsBind.hpp"
 #include "linglong/api/types/v1/ApplicationAccessPrivileges.hpp"
@@ -80,6 +82,9 @@ void to_json(json & j, const ApplicationConfigurationPermissionsBind & x);
 void from_json(const json & j, ApplicationConfigurationPermissionsInnerBind & x);
 void to_json(json & j, const ApplicationConfigurationPermissionsInnerBind & x);
 
+void from_json(const json & j, ApplicationConfigurationPermissionsResources & x);
+void to_json(json & j, const ApplicationConfigurationPermissionsResources & x);
+
 void from_json(const json & j, ApplicationConfigurationPermissions & x);
 void to_json(json & j, const ApplicationConfigurationPermissions & x);
 
@@ -179,6 +184,9 @@ void to_json(json & j, const RepositoryCacheMergedItem & x);
 void from_json(const json & j, RepositoryCache & x);
 void to_json(json & j, const RepositoryCache & x);
 
+void from_json(const json & j, UabDigestTree & x);
+void to_json(json & j, const UabDigestTree & x);
+
 void from_json(const json & j, UabLayer & x);
 void to_json(json & j, const UabLayer & x);
 
@@ -254,9 +262,37 @@ j["destination"] = x.destination;
 j["source"] = x.source;
 }
 
+inline void from_json(const json & j, ApplicationConfigurationPermissionsResources& x) {
+x.cpuWeight = get_stack_optional<int64_t>(j, "cpuWeight");
+x.ioWeight = get_stack_optional<int64_t>(j, "ioWeight");
+x.memoryHigh = get_stack_optional<int64_t>(j, "memoryHigh");
+x.memoryMax = get_stack_optional<int64_t>(j, "memoryMax");
+x.pidsMax = get_stack_optional<int64_t>(j, "pidsMax");
+}
+
+inline void to_json(json & j, const ApplicationConfigurationPermissionsResources & x) {
+j = json::object();
+if (x.cpuWeight) {
+j["cpuWeight"] = x.cpuWeight;
+}
+if (x.ioWeight) {
+j["ioWeight"] = x.ioWeight;
+}
+if (x.memoryHigh) {
+j["memoryHigh"] = x.memoryHigh;
+}
+if (x.memoryMax) {
+j["memoryMax"] = x.memoryMax;
+}
+if (x.pidsMax) {
+j["pidsMax"] = x.pidsMax;
+}
+}
+
 inline void from_json(const json & j, ApplicationConfigurationPermissions& x) {
 x.binds = get_stack_optional<std::vector<ApplicationConfigurationPermissionsBind>>(j, "binds");
 x.innerBinds = get_stack_optional<std::vector<ApplicationConfigurationPermissionsInnerBind>>(j, "innerBinds");
+x.resources = get_stack_optional<ApplicationConfigurationPermissionsResources>(j, "resources");
 }
 
 inline void to_json(json & j, const ApplicationConfigurationPermissions & x) {
@@ -267,6 +303,9 @@ j["binds"] = x.binds;
 if (x.innerBinds) {
 j["innerBinds"] = x.innerBinds;
 }
+if (x.resources) {
+j["resources"] = x.resources;
+}
 }
 
 inline void from_json(const json & j, ApplicationConfiguration& x) {
@@ -418,16 +457,28 @@ j["version"] = x.version;
 }
 
 inline void from_json(const json & j, CliContainer& x) {
+x.cpuUsage = get_stack_optional<int64_t>(j, "cpuUsage");
 x.id = j.at("id").get<std::string>();
+x.memoryUsage = get_stack_optional<int64_t>(j, "memoryUsage");
 x.package = j.at("package").get<std::string>();
 x.pid = j.at("pid").get<int64_t>();
+x.tasks = get_stack_optional<int64_t>(j, "tasks");
 }
 
 inline void to_json(json & j, const CliContainer & x) {
 j = json::object();
+if (x.cpuUsage) {
+j["cpuUsage"] = x.cpuUsage;
+}
 j["id"] = x.id;
+if (x.memoryUsage) {
+j["memoryUsage"] = x.memoryUsage;
+}
 j["package"] = x.package;
 j["pid"] = x.pid;
+if (x.tasks) {
+j["tasks"] = x.tasks;
+}
 }
 
 inline void from_json(const json & j, CommonOptions& x) {
@@ -847,6 +898,19 @@ j["merged"] = x.merged;
 j["version"] = x.version;
 }
 
+inline void from_json(const json & j, UabDigestTree& x) {
+x.chunks = j.at("chunks").get<std::vector<std::string>>();
+x.chunkSize = j.at("chunkSize").get<int64_t>();
+x.root = j.at("root").get<std::string>();
+}
+
+inline void to_json(json & j, const UabDigestTree & x) {
+j = json::object();
+j["chunks"] = x.chunks;
+j["chunkSize"] = x.chunkSize;
+j["root"] = x.root;
+}
+
 inline void from_json(const json & j, UabLayer& x) {
 x.info = j.at("info").get<PackageInfoV2>();
 x.minified = j.at("minified").get<bool>();
@@ -873,6 +937,7 @@ j["icon"] = x.icon;
 
 inline void from_json(const json & j, UabMetaInfo& x) {
 x.digest = j.at("digest").get<std::string>();
+x.digestTree = get_stack_optional<UabDigestTree>(j, "digestTree");
 x.layers = j.at("layers").get<std::vector<UabLayer>>();
 x.sections = j.at("sections").get<Sections>();
 x.uuid = j.at("uuid").get<std::string>();
@@ -882,6 +947,9 @@ x.version = j.at("version").get<Version>();
 inline void to_json(json & j, const UabMetaInfo & x) {
 j = json::object();
 j["digest"] = x.digest;
+if (x.digestTree) {
+j["digestTree"] = x.digestTree;
+}
 j["layers"] = x.layers;
 j["sections"] = x.sections;
 j["uuid"] = x.uuid;
@@ -0,0 +1,50 @@
+// This file is generated by tools/codegen.sh
+// DO NOT EDIT IT.
+
+// clang-format off
+
+//  To parse this JSON data, first install
+//
+//      json.hpp  https://github.com/nlohmann/json
+//
+//  Then include this file, and then do
+//
+//     UabDigestTree.hpp data = nlohmann::json::parse(jsonString);
+
+#pragma once
+
+#include <optional>
+#include <nlohmann/json.hpp>
+#include "linglong/api/types/v1/helper.hpp"
+
+namespace linglong {
+namespace api {
+namespace types {
+namespace v1 {
+using nlohmann::json;
+
+/**
+* The digests of fixed size chunks of the bundle section, chunks can be verified in
+* parallel or lazily when they are read. The digest field is still required by the
+* installers which don't support this.
+*/
+struct UabDigestTree {
+/**
+* The sha256 digests in hex of all chunks in order.
+*/
+std::vector<std::string> chunks;
+/**
+* Size in bytes of every chunk except the last one.
+*/
+int64_t chunkSize;
+/**
+* The sha256 digest in hex of the concatenated binary digests of all chunks.
+*/
+std::string root;
+};
+}
+}
+}
+}
+
+// clang-format on
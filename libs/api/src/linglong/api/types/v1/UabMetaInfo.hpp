@@ -17,6 +17,7 @@
 #include <nlohmann/json.hpp>
 #include "linglong/api/types/v1/helper.hpp"
 
+#include "linglong/api/types/v1/UabDigestTree.hpp"
 #include "linglong/api/types/v1/UabLayer.hpp"
 #include "linglong/api/types/v1/Sections.hpp"
 
@@ -41,6 +42,12 @@ struct UabMetaInfo {
 * The digest of the bundle section.
 */
 std::string digest;
+/**
+* The digests of fixed size chunks of the bundle section, chunks can be verified in
+* parallel or lazily when they are read. The digest field is still required by the
+* installers which don't support this.
+*/
+std::optional<UabDigestTree> digestTree;
 std::vector<UabLayer> layers;
 Sections sections;
 /**
@@ -0,0 +1,87 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "linglong/box/namespaces.h"
+
+#include <sys/syscall.h>
+
+#include <cerrno>
+#include <filesystem>
+#include <string>
+
+#include <fcntl.h>
+#include <sched.h>
+#include <unistd.h>
+
+namespace linglong::box {
+
+namespace {
+
+constexpr std::array<const char *, 3> namespaceNames{ "user", "mnt", "pid" };
+
+} // namespace
+
+Namespaces::~Namespaces()
+{
+    if (this->pidfd != -1) {
+        ::close(this->pidfd);
+    }
+    for (auto fd : this->fds) {
+        if (fd != -1) {
+            ::close(fd);
+        }
+    }
+}
+
+bool Namespaces::open(pid_t pid) noexcept
+{
+#ifdef SYS_pidfd_open
+    this->pidfd = static_cast<int>(::syscall(SYS_pidfd_open, pid, 0));
+#endif
+
+    // the namespace files are opened even with a pidfd, setns doesn't accept pidfds before 5.8
+    auto proc = std::filesystem::path("/proc") / std::to_string(pid) / "ns";
+    auto openErrno = 0;
+    for (std::size_t i = 0; i < namespaceNames.size(); ++i) {
+        this->fds[i] = ::open((proc / namespaceNames[i]).c_str(), O_RDONLY | O_CLOEXEC);
+        if (this->fds[i] == -1 && openErrno == 0) {
+            openErrno = errno;
+        }
+    }
+
+    if (this->pidfd == -1 && openErrno != 0) {
+        errno = openErrno;
+        return false;
+    }
+
+    return true;
+}
+
+int Namespaces::enter() const noexcept
+{
+    auto savedErrno = EBADF;
+    if (this->pidfd != -1) {
+        if (::setns(this->pidfd, CLONE_NEWUSER | CLONE_NEWNS | CLONE_NEWPID) == 0) {
+            return 0;
+        }
+        savedErrno = errno;
+    }
+
+    for (auto fd : this->fds) {
+        if (fd == -1) {
+            errno = savedErrno;
+            return -1;
+        }
+    }
+
+    for (auto fd : this->fds) {
+        if (::setns(fd, 0) == -1) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+} // namespace linglong::box
@@ -0,0 +1,38 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include <array>
+
+#include <sys/types.h>
+
+namespace linglong::box {
+
+// Namespaces holds the user, mount and pid namespaces of the init process of a container, which are
+// entered by exec.
+class Namespaces
+{
+public:
+    Namespaces() = default;
+    Namespaces(const Namespaces &) = delete;
+    Namespaces &operator=(const Namespaces &) = delete;
+    ~Namespaces();
+
+    // open opens a pidfd of pid and its namespace files. All of them are opened before any is
+    // entered: the /proc of the container replaces the host's once the mount namespace is entered,
+    // and the process may exit in between. It returns false with errno set if neither works.
+    bool open(pid_t pid) noexcept;
+
+    // enter enters the namespaces, atomically with the pidfd since linux 5.8, or one by one with
+    // the namespace files. It returns -1 with errno set on failure. It's async-signal-safe, so it
+    // can be called after fork. The pid namespace is only entered by the children created later.
+    int enter() const noexcept;
+
+private:
+    int pidfd{ -1 };
+    std::array<int, 3> fds{ -1, -1, -1 };
+};
+
+} // namespace linglong::box
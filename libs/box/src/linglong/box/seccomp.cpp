@@ -0,0 +1,105 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "linglong/box/seccomp.h"
+
+#include <linux/seccomp.h>
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+
+#include <cerrno>
+#include <fstream>
+#include <string>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace linglong::box {
+
+std::optional<std::vector<sock_filter>> readProgram(int fd) noexcept
+{
+    auto size = ::lseek(fd, 0, SEEK_END);
+    if (size <= 0 || size % sizeof(sock_filter) != 0) {
+        return std::nullopt;
+    }
+
+    auto count = static_cast<std::size_t>(size) / sizeof(sock_filter);
+    if (count > BPF_MAXINSNS) {
+        return std::nullopt;
+    }
+
+    std::vector<sock_filter> program(count);
+    auto bytes = count * sizeof(sock_filter);
+    if (::pread(fd, program.data(), bytes, 0) != static_cast<ssize_t>(bytes)) {
+        return std::nullopt;
+    }
+
+    return program;
+}
+
+std::optional<std::vector<sock_filter>> readProgram(const std::filesystem::path &file) noexcept
+{
+    auto fd = ::open(file.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        return std::nullopt;
+    }
+
+    auto program = readProgram(fd);
+    ::close(fd);
+    return program;
+}
+
+bool writeProgram(const std::filesystem::path &file,
+                  const std::vector<sock_filter> &program) noexcept
+{
+    std::error_code ec;
+    std::filesystem::create_directories(file.parent_path(), ec);
+
+    auto temp = file;
+    temp += "." + std::to_string(::getpid());
+    {
+        std::ofstream stream(temp, std::ios::binary | std::ios::trunc);
+        stream.write(reinterpret_cast<const char *>(program.data()),
+                     static_cast<std::streamsize>(program.size() * sizeof(sock_filter)));
+        if (!stream.flush()) {
+            std::filesystem::remove(temp, ec);
+            return false;
+        }
+    }
+
+    std::filesystem::rename(temp, file, ec);
+    if (ec) {
+        std::filesystem::remove(temp, ec);
+        return false;
+    }
+
+    return true;
+}
+
+int loadProgram(const std::vector<sock_filter> &program, unsigned int flags) noexcept
+{
+    sock_fprog prog{
+        .len = static_cast<unsigned short>(program.size()),
+        .filter = const_cast<sock_filter *>(program.data()),
+    };
+
+    if (::prctl(PR_SET_NO_NEW_PRIVS, 1, 0, 0, 0) == -1) {
+        return -1;
+    }
+
+#ifdef SYS_seccomp
+    if (::syscall(SYS_seccomp, SECCOMP_SET_MODE_FILTER, flags, &prog) == 0) {
+        return 0;
+    }
+
+    // the flags are only available with seccomp(2)
+    if (errno != ENOSYS || flags != 0) {
+        return -1;
+    }
+#endif
+
+    return ::prctl(PR_SET_SECCOMP, SECCOMP_MODE_FILTER, &prog) == -1 ? -1 : 0;
+}
+
+} // namespace linglong::box
@@ -0,0 +1,29 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include <linux/filter.h>
+
+#include <filesystem>
+#include <optional>
+#include <vector>
+
+namespace linglong::box {
+
+// readProgram reads the BPF program from the start of fd, std::nullopt is returned if it's empty,
+// longer than BPF_MAXINSNS or not made of whole instructions.
+std::optional<std::vector<sock_filter>> readProgram(int fd) noexcept;
+std::optional<std::vector<sock_filter>> readProgram(const std::filesystem::path &file) noexcept;
+
+// writeProgram writes the program to a temporary file and renames it to file, so the containers
+// started concurrently never read a partial program. The errors are left to the caller to report.
+bool writeProgram(const std::filesystem::path &file,
+                  const std::vector<sock_filter> &program) noexcept;
+
+// loadProgram installs the program to the current process with no_new_privs set. It returns -1
+// with errno set on failure. It's async-signal-safe, so it can be called between fork and exec.
+int loadProgram(const std::vector<sock_filter> &program, unsigned int flags) noexcept;
+
+} // namespace linglong::box
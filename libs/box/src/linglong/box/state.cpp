@@ -0,0 +1,95 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "linglong/box/state.h"
+
+#include <cstdlib>
+#include <fstream>
+
+#include <signal.h>
+
+namespace linglong::box {
+
+std::filesystem::path defaultStateRoot()
+{
+    const auto *runtimeDir = ::getenv("XDG_RUNTIME_DIR");
+    return std::filesystem::path{ runtimeDir != nullptr ? runtimeDir : "/run" } / "ll-box";
+}
+
+std::filesystem::path stateFile(const std::filesystem::path &root, const std::string &id)
+{
+    return root / (id + ".json");
+}
+
+bool alive(const nlohmann::json &state) noexcept
+{
+    auto pid = state.value("pid", -1);
+    return pid == -1 || ::kill(pid, 0) == 0;
+}
+
+std::optional<nlohmann::json> readState(const std::filesystem::path &file) noexcept
+{
+    std::ifstream stream(file);
+    if (!stream.is_open()) {
+        return std::nullopt;
+    }
+
+    auto state = nlohmann::json::parse(stream, nullptr, false);
+    if (state.is_discarded() || !state.is_object()) {
+        return std::nullopt;
+    }
+
+    if (!alive(state)) {
+        std::error_code ec;
+        std::filesystem::remove(file, ec);
+        return std::nullopt;
+    }
+
+    return state;
+}
+
+std::optional<nlohmann::json> findState(const std::filesystem::path &root,
+                                        const std::string &id) noexcept
+{
+    if (id.empty() || id.find('/') != std::string::npos) {
+        return std::nullopt;
+    }
+
+    auto state = readState(stateFile(root, id));
+    if (!state || state->value("id", "") != id) {
+        return std::nullopt;
+    }
+
+    return state;
+}
+
+std::optional<SeccompRecord> seccompRecord(const nlohmann::json &state) noexcept
+{
+    auto it = state.find("seccomp");
+    if (it == state.end() || !it->is_object()) {
+        return std::nullopt;
+    }
+
+    return SeccompRecord{
+        .program = it->value("program", ""),
+        .flags = it->value("flags", 0U),
+    };
+}
+
+void setSeccompRecord(nlohmann::json &state, const SeccompRecord &record)
+{
+    state["seccomp"] = { { "program", record.program.string() }, { "flags", record.flags } };
+}
+
+std::filesystem::path seccompCacheDir(const std::filesystem::path &root)
+{
+    return root / "seccomp";
+}
+
+std::filesystem::path seccompExecFile(const std::filesystem::path &root, const std::string &id)
+{
+    return seccompCacheDir(root) / "exec" / (id + ".bpf");
+}
+
+} // namespace linglong::box
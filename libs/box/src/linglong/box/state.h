@@ -0,0 +1,72 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include <nlohmann/json.hpp>
+
+#include <filesystem>
+#include <optional>
+#include <string>
+
+// The state of the containers started by ll-box is kept in files under the state root, they are
+// written by ll-box and read by ll-box and the ll-box backend of ocppi, which runs exec, kill, list
+// and state in process.
+//
+// <root>/<id>.json is the state of a running container, an ocppi::types::ContainerListItem with
+// the extra fields used by exec:
+//
+//   {
+//     "bundle": "<bundle directory>",
+//     "id": "<id>",
+//     "pid": <pid of ll-box>,
+//     "status": "running",
+//     "initPid": <pid of the init process, whose namespaces are entered by exec>,
+//     "seccomp": { "program": "<BPF program file>", "flags": <SECCOMP_FILTER_FLAG_*> }
+//   }
+//
+// initPid is absent until the container is ready and in the files of the old ll-box, seccomp is
+// absent if the container isn't filtered. The file is stale once ll-box exits, the readers remove
+// it.
+//
+// <root>/seccomp/<digest>.bpf are the programs compiled from the seccomp sections, cached by the
+// digest of the section. <root>/seccomp/exec/<id>.bpf is the program of a container whose program
+// isn't cached. A program file is the array of struct sock_filter loaded by seccomp(2).
+//
+// <root>/zygote is the directory of the zygotes, see apps/ll-box/src/container/zygote.h.
+namespace linglong::box {
+
+// defaultStateRoot returns ${XDG_RUNTIME_DIR}/ll-box, or /run/ll-box without XDG_RUNTIME_DIR
+std::filesystem::path defaultStateRoot();
+
+std::filesystem::path stateFile(const std::filesystem::path &root, const std::string &id);
+
+// alive reports whether the ll-box process of the container is still running, the states without
+// a pid are kept
+bool alive(const nlohmann::json &state) noexcept;
+
+// readState returns the state in file, or std::nullopt if it's unreadable or stale. The stale file
+// is removed.
+std::optional<nlohmann::json> readState(const std::filesystem::path &file) noexcept;
+
+// findState returns the state of the container id in root
+std::optional<nlohmann::json> findState(const std::filesystem::path &root,
+                                        const std::string &id) noexcept;
+
+struct SeccompRecord
+{
+    std::filesystem::path program;
+    unsigned int flags{ 0 };
+};
+
+// seccompRecord returns the seccomp filter recorded in the state, if the container is filtered
+std::optional<SeccompRecord> seccompRecord(const nlohmann::json &state) noexcept;
+
+void setSeccompRecord(nlohmann::json &state, const SeccompRecord &record);
+
+std::filesystem::path seccompCacheDir(const std::filesystem::path &root);
+
+std::filesystem::path seccompExecFile(const std::filesystem::path &root, const std::string &id);
+
+} // namespace linglong::box
@@ -0,0 +1,262 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+// refer: https://zh.wikipedia.org/wiki/SHA-2
+
+#include "linglong/digest/sha256.h"
+
+#include "linglong/digest/details/sha256_transform.h"
+
+#include <algorithm>
+
+namespace linglong::digest {
+
+namespace details {
+
+namespace {
+
+constexpr std::uint32_t rotateRight(std::uint32_t x, unsigned n) noexcept
+{
+    return (x >> n) | (x << (32 - n));
+}
+
+constexpr std::uint32_t loadBigEndian(const std::byte *p) noexcept
+{
+    return (static_cast<std::uint32_t>(p[0]) << 24) | (static_cast<std::uint32_t>(p[1]) << 16)
+      | (static_cast<std::uint32_t>(p[2]) << 8) | static_cast<std::uint32_t>(p[3]);
+}
+
+constexpr std::uint32_t sum0(std::uint32_t x) noexcept
+{
+    return rotateRight(x, 2) ^ rotateRight(x, 13) ^ rotateRight(x, 22);
+}
+
+constexpr std::uint32_t sum1(std::uint32_t x) noexcept
+{
+    return rotateRight(x, 6) ^ rotateRight(x, 11) ^ rotateRight(x, 25);
+}
+
+constexpr std::uint32_t sigma0(std::uint32_t x) noexcept
+{
+    return rotateRight(x, 7) ^ rotateRight(x, 18) ^ (x >> 3);
+}
+
+constexpr std::uint32_t sigma1(std::uint32_t x) noexcept
+{
+    return rotateRight(x, 17) ^ rotateRight(x, 19) ^ (x >> 10);
+}
+
+constexpr std::uint32_t Ch(std::uint32_t x, std::uint32_t y, std::uint32_t z) noexcept
+{
+    return (x & y) ^ ((~x) & z);
+}
+
+constexpr std::uint32_t Maj(std::uint32_t x, std::uint32_t y, std::uint32_t z) noexcept
+{
+    return (x & y) ^ (x & z) ^ (y & z);
+}
+
+} // namespace
+
+void sha256Portable(std::uint32_t *state, const std::byte *data, std::size_t blocks)
+{
+    for (std::size_t i = 0; i < blocks; ++i, data += SHA256::blockSize) {
+        std::array<std::uint32_t, 64> W{};
+        for (std::size_t t = 0; t < 16; ++t) {
+            W[t] = loadBigEndian(data + t * 4);
+        }
+        for (std::size_t t = 16; t < 64; ++t) {
+            W[t] = sigma1(W[t - 2]) + W[t - 7] + sigma0(W[t - 15]) + W[t - 16];
+        }
+
+        auto a = state[0];
+        auto b = state[1];
+        auto c = state[2];
+        auto d = state[3];
+        auto e = state[4];
+        auto f = state[5];
+        auto g = state[6];
+        auto h = state[7];
+
+        for (std::size_t t = 0; t < 64; ++t) {
+            auto T1 = h + sum1(e) + Ch(e, f, g) + sha256K[t] + W[t];
+            auto T2 = sum0(a) + Maj(a, b, c);
+            h = g;
+            g = f;
+            f = e;
+            e = d + T1;
+            d = c;
+            c = b;
+            b = a;
+            a = T1 + T2;
+        }
+
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+        state[5] += f;
+        state[6] += g;
+        state[7] += h;
+    }
+}
+
+} // namespace details
+
+namespace {
+
+SHA256::Implementation detectImplementation() noexcept
+{
+    if (details::x86SHASupported()) {
+        return SHA256::Implementation::X86SHA;
+    }
+    if (details::armv8CryptoSupported()) {
+        return SHA256::Implementation::ARMv8Crypto;
+    }
+    return SHA256::Implementation::Portable;
+}
+
+SHA256::Implementation defaultImplementation() noexcept
+{
+    static const auto impl = detectImplementation();
+    return impl;
+}
+
+} // namespace
+
+SHA256::SHA256() noexcept
+    : SHA256(defaultImplementation())
+{
+}
+
+SHA256::SHA256(Implementation implementation) noexcept
+    : impl(implementation)
+{
+    switch (implementation) {
+    case Implementation::X86SHA:
+        this->transform = details::sha256X86SHA;
+        break;
+    case Implementation::ARMv8Crypto:
+        this->transform = details::sha256ARMv8Crypto;
+        break;
+    case Implementation::Portable:
+    default:
+        this->impl = Implementation::Portable;
+        this->transform = details::sha256Portable;
+        break;
+    }
+}
+
+void SHA256::update(const std::byte *data, std::size_t len) noexcept
+{
+    this->total += static_cast<std::uint64_t>(len) * 8;
+
+    // if the current block is not completed, consuming input data to fill the rest of block and
+    // transforming data block
+    if (this->pos != 0) {
+        auto size = std::min(len, blockSize - this->pos);
+        std::copy_n(data, size, &this->m[this->pos]);
+        this->pos += size;
+        data += size;
+        len -= size;
+        if (this->pos < blockSize) {
+            return;
+        }
+
+        this->transform(this->H.data(), this->m.data(), 1);
+        this->pos = 0;
+    }
+
+    // transform the complete blocks in place
+    if (len >= blockSize) {
+        auto blocks = len / blockSize;
+        this->transform(this->H.data(), data, blocks);
+        data += blocks * blockSize;
+        len -= blocks * blockSize;
+    }
+
+    // copy the rest of input data to the current block and wait for more data
+    std::copy_n(data, len, this->m.data());
+    this->pos = len;
+}
+
+void SHA256::update(const char *data, std::size_t len) noexcept
+{
+    this->update(reinterpret_cast<const std::byte *>(data), len);
+}
+
+void SHA256::final(std::byte *digest) noexcept
+{
+    // complete the last block
+    this->m[this->pos++] = std::byte(0x80);
+
+    // reserve space to fill the length of the last block
+    if (this->pos > blockSize - sizeof(std::uint64_t)) {
+        std::fill(this->m.begin() + this->pos, this->m.end(), std::byte(0));
+        this->transform(this->H.data(), this->m.data(), 1);
+        this->pos = 0;
+    }
+
+    std::fill(this->m.begin() + this->pos, this->m.end() - sizeof(std::uint64_t), std::byte(0));
+    for (std::size_t i = 0; i < sizeof(std::uint64_t); ++i) {
+        this->m[blockSize - 1 - i] = static_cast<std::byte>(this->total >> (i * 8));
+    }
+    this->transform(this->H.data(), this->m.data(), 1);
+
+    for (std::size_t i = 0; i < this->H.size(); ++i) {
+        digest[i * 4] = static_cast<std::byte>(this->H[i] >> 24);
+        digest[i * 4 + 1] = static_cast<std::byte>(this->H[i] >> 16);
+        digest[i * 4 + 2] = static_cast<std::byte>(this->H[i] >> 8);
+        digest[i * 4 + 3] = static_cast<std::byte>(this->H[i]);
+    }
+}
+
+std::string SHA256::hexDigest() noexcept
+{
+    constexpr auto hex = "0123456789abcdef";
+
+    std::array<std::byte, digestSize> digest{};
+    this->final(digest.data());
+
+    std::string result;
+    result.reserve(digestSize * 2);
+    for (auto byte : digest) {
+        result.push_back(hex[static_cast<unsigned int>(byte) >> 4]);
+        result.push_back(hex[static_cast<unsigned int>(byte) & 0xf]);
+    }
+    return result;
+}
+
+SHA256::Implementation SHA256::implementation() const noexcept
+{
+    return this->impl;
+}
+
+std::vector<SHA256::Implementation> SHA256::supportedImplementations() noexcept
+{
+    std::vector<Implementation> result{ Implementation::Portable };
+    if (details::x86SHASupported()) {
+        result.push_back(Implementation::X86SHA);
+    }
+    if (details::armv8CryptoSupported()) {
+        result.push_back(Implementation::ARMv8Crypto);
+    }
+    return result;
+}
+
+const char *SHA256::implementationName(Implementation implementation) noexcept
+{
+    switch (implementation) {
+    case Implementation::X86SHA:
+        return "x86-sha";
+    case Implementation::ARMv8Crypto:
+        return "armv8-crypto";
+    case Implementation::Portable:
+    default:
+        return "portable";
+    }
+}
+
+} // namespace linglong::digest
@@ -0,0 +1,66 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace linglong::digest {
+
+// SHA256 calculates sha256 with the fastest implementation supported by the current CPU, which is
+// detected once at runtime.
+class SHA256
+{
+public:
+    enum class Implementation {
+        Portable,
+        // SHA extensions of x86-64, a.k.a. SHA-NI
+        X86SHA,
+        // cryptographic extension of ARMv8
+        ARMv8Crypto,
+    };
+
+    static constexpr std::size_t digestSize = 32;
+    static constexpr std::size_t blockSize = 64;
+
+    SHA256() noexcept;
+    // the implementation must be one of supportedImplementations()
+    explicit SHA256(Implementation implementation) noexcept;
+    SHA256(const SHA256 &) = delete;
+    SHA256(SHA256 &&) = delete;
+    SHA256 &operator=(const SHA256 &) = delete;
+    SHA256 &operator=(SHA256 &&) = delete;
+    ~SHA256() = default;
+
+    void update(const std::byte *data, std::size_t len) noexcept;
+    void update(const char *data, std::size_t len) noexcept;
+    // final writes digestSize bytes to digest, the object can't be updated anymore
+    void final(std::byte *digest) noexcept;
+    // hexDigest is the same as final but returns the digest in lowercase hex
+    std::string hexDigest() noexcept;
+
+    [[nodiscard]] Implementation implementation() const noexcept;
+
+    // supportedImplementations returns the implementations supported by the current CPU, the
+    // first one is the portable implementation and the last one is the default implementation
+    static std::vector<Implementation> supportedImplementations() noexcept;
+    static const char *implementationName(Implementation implementation) noexcept;
+
+private:
+    using Transform = void (*)(std::uint32_t *state, const std::byte *data, std::size_t blocks);
+
+    Implementation impl;
+    Transform transform;
+    std::uint64_t total{ 0 };
+    std::size_t pos{ 0 };
+    std::array<std::uint32_t, 8> H{ 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                                    0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 };
+    std::array<std::byte, blockSize> m{};
+};
+
+} // namespace linglong::digest
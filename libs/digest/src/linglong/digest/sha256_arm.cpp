@@ -0,0 +1,84 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+// refer: Arm Architecture Reference Manual, SHA256H, SHA256H2, SHA256SU0 and SHA256SU1
+
+#include "linglong/digest/details/sha256_transform.h"
+
+#if defined(__aarch64__)
+#  include <arm_neon.h>
+#  include <asm/hwcap.h>
+#  include <sys/auxv.h>
+
+#  if defined(__clang__)
+#    define LINGLONG_TARGET_CRYPTO __attribute__((target("crypto")))
+#  else
+#    define LINGLONG_TARGET_CRYPTO __attribute__((target("+crypto")))
+#  endif
+#endif
+
+namespace linglong::digest::details {
+
+#if defined(__aarch64__)
+
+bool armv8CryptoSupported() noexcept
+{
+    return (::getauxval(AT_HWCAP) & HWCAP_SHA2) != 0;
+}
+
+LINGLONG_TARGET_CRYPTO void
+sha256ARMv8Crypto(std::uint32_t *state, const std::byte *data, std::size_t blocks)
+{
+    auto abcd = vld1q_u32(&state[0]);
+    auto efgh = vld1q_u32(&state[4]);
+
+    for (std::size_t block = 0; block < blocks; ++block, data += 64) {
+        const auto abcdSave = abcd;
+        const auto efghSave = efgh;
+
+        uint32x4_t msgs[4];
+        for (int i = 0; i < 4; ++i) {
+            auto bytes = vld1q_u8(reinterpret_cast<const uint8_t *>(data + i * 16));
+            msgs[i] = vreinterpretq_u32_u8(vrev32q_u8(bytes));
+        }
+
+        // every iteration does 4 rounds, and calculates the message schedule of 4 rounds later
+#  pragma GCC unroll 16
+        for (int i = 0; i < 16; ++i) {
+            auto &cur = msgs[i % 4];
+            const auto wk = vaddq_u32(cur, vld1q_u32(&sha256K[i * 4]));
+            if (i < 12) {
+                cur = vsha256su0q_u32(cur, msgs[(i + 1) % 4]);
+            }
+            const auto abcdPrev = abcd;
+            abcd = vsha256hq_u32(abcd, efgh, wk);
+            efgh = vsha256h2q_u32(efgh, abcdPrev, wk);
+            if (i < 12) {
+                cur = vsha256su1q_u32(cur, msgs[(i + 2) % 4], msgs[(i + 3) % 4]);
+            }
+        }
+
+        abcd = vaddq_u32(abcd, abcdSave);
+        efgh = vaddq_u32(efgh, efghSave);
+    }
+
+    vst1q_u32(&state[0], abcd);
+    vst1q_u32(&state[4], efgh);
+}
+
+#else
+
+bool armv8CryptoSupported() noexcept
+{
+    return false;
+}
+
+void sha256ARMv8Crypto(std::uint32_t *state, const std::byte *data, std::size_t blocks)
+{
+    sha256Portable(state, data, blocks);
+}
+
+#endif
+
+} // namespace linglong::digest::details
@@ -0,0 +1,110 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+// refer: Intel SHA Extensions, New Instructions Supporting the Secure Hash Algorithm on Intel
+// Architecture Processors
+
+#include "linglong/digest/details/sha256_transform.h"
+
+#if defined(__x86_64__)
+#  include <cpuid.h>
+#  include <immintrin.h>
+#endif
+
+namespace linglong::digest::details {
+
+#if defined(__x86_64__)
+
+bool x86SHASupported() noexcept
+{
+    unsigned int eax{ 0 };
+    unsigned int ebx{ 0 };
+    unsigned int ecx{ 0 };
+    unsigned int edx{ 0 };
+    if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) == 0) {
+        return false;
+    }
+    const bool ssse3 = (ecx & bit_SSSE3) != 0;
+    const bool sse41 = (ecx & bit_SSE4_1) != 0;
+
+    if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) == 0) {
+        return false;
+    }
+    const bool sha = (ebx & (1U << 29)) != 0;
+
+    return ssse3 && sse41 && sha;
+}
+
+__attribute__((target("sha,sse4.1,ssse3"))) void
+sha256X86SHA(std::uint32_t *state, const std::byte *data, std::size_t blocks)
+{
+    const __m128i byteSwap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+    // the instructions use the state as ABEF and CDGH
+    auto tmp = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&state[0]));
+    auto state1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&state[4]));
+    tmp = _mm_shuffle_epi32(tmp, 0xB1);
+    state1 = _mm_shuffle_epi32(state1, 0x1B);
+    auto state0 = _mm_alignr_epi8(tmp, state1, 8);
+    state1 = _mm_blend_epi16(state1, tmp, 0xF0);
+
+    for (std::size_t block = 0; block < blocks; ++block, data += 64) {
+        const auto abefSave = state0;
+        const auto cdghSave = state1;
+
+        __m128i msgs[4];
+        for (int i = 0; i < 4; ++i) {
+            msgs[i] = _mm_shuffle_epi8(
+              _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i * 16)),
+              byteSwap);
+        }
+
+        // every iteration does 4 rounds, the message schedule of the later rounds is calculated
+        // by sha256msg1 and sha256msg2 in advance
+#  pragma GCC unroll 16
+        for (int i = 0; i < 16; ++i) {
+            auto &cur = msgs[i % 4];
+            auto msg = _mm_add_epi32(
+              cur,
+              _mm_loadu_si128(reinterpret_cast<const __m128i *>(&sha256K[i * 4])));
+            state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+            if (i >= 3 && i <= 14) {
+                auto &next = msgs[(i + 1) % 4];
+                next = _mm_add_epi32(next, _mm_alignr_epi8(cur, msgs[(i + 3) % 4], 4));
+                next = _mm_sha256msg2_epu32(next, cur);
+            }
+            msg = _mm_shuffle_epi32(msg, 0x0E);
+            state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+            if (i >= 1 && i <= 12) {
+                msgs[(i + 3) % 4] = _mm_sha256msg1_epu32(msgs[(i + 3) % 4], cur);
+            }
+        }
+
+        state0 = _mm_add_epi32(state0, abefSave);
+        state1 = _mm_add_epi32(state1, cdghSave);
+    }
+
+    tmp = _mm_shuffle_epi32(state0, 0x1B);
+    state1 = _mm_shuffle_epi32(state1, 0xB1);
+    state0 = _mm_blend_epi16(tmp, state1, 0xF0);
+    state1 = _mm_alignr_epi8(state1, tmp, 8);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(&state[0]), state0);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(&state[4]), state1);
+}
+
+#else
+
+bool x86SHASupported() noexcept
+{
+    return false;
+}
+
+void sha256X86SHA(std::uint32_t *state, const std::byte *data, std::size_t blocks)
+{
+    sha256Portable(state, data, blocks);
+}
+
+#endif
+
+} // namespace linglong::digest::details
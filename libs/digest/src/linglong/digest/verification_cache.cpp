@@ -0,0 +1,249 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "linglong/digest/verification_cache.h"
+
+#include "linglong/digest/sha256.h"
+
+#include <array>
+#include <cerrno>
+#include <cstdlib>
+#include <sstream>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if __has_include(<linux/fsverity.h>)
+#  include <linux/fsverity.h>
+#endif
+
+namespace linglong::digest {
+
+namespace {
+
+// an entry is much smaller than this, anything larger is not an entry written by us
+constexpr std::size_t maxEntrySize = 4096;
+
+#ifdef FS_IOC_MEASURE_VERITY
+std::string toHex(const unsigned char *data, std::size_t size) noexcept
+{
+    constexpr auto hex = "0123456789abcdef";
+
+    std::string result;
+    result.reserve(size * 2);
+    for (std::size_t i = 0; i < size; ++i) {
+        result.push_back(hex[data[i] >> 4]);
+        result.push_back(hex[data[i] & 0xf]);
+    }
+    return result;
+}
+#endif
+
+std::string measureVerity([[maybe_unused]] int fd) noexcept
+{
+#ifdef FS_IOC_MEASURE_VERITY
+    // the digest of SHA-512, the largest algorithm supported by fs-verity
+    constexpr std::size_t maxVerityDigestSize = 64;
+    // fsverity_digest ends with a flexible array member
+    alignas(fsverity_digest) std::array<unsigned char,
+                                        sizeof(fsverity_digest) + maxVerityDigestSize>
+      buf{};
+    auto *measurement = reinterpret_cast<fsverity_digest *>(buf.data());
+
+    measurement->digest_size = maxVerityDigestSize;
+    // fails with ENODATA if fs-verity isn't enabled on the file, or ENOTTY/EOPNOTSUPP if the
+    // filesystem doesn't support it
+    if (::ioctl(fd, FS_IOC_MEASURE_VERITY, measurement) != 0
+        || measurement->digest_size > maxVerityDigestSize) {
+        return {};
+    }
+
+    return std::to_string(measurement->digest_algorithm) + ":"
+      + toHex(measurement->digest, measurement->digest_size);
+#else
+    return {};
+#endif
+}
+
+// serialize returns the exact content of the entry for the stamp and digest, a cached entry is
+// valid only if it's byte-identical to this, so any modification of the entry invalidates it
+std::string serialize(const FileStamp &stamp, std::string_view digest) noexcept
+{
+    std::ostringstream stream;
+    stream << "version=1\n";
+    if (!stamp.verity.empty()) {
+        // the measurement covers the whole content, the inode and timestamps are irrelevant
+        stream << "verity=" << stamp.verity << "\n";
+    } else {
+        stream << "dev=" << stamp.dev << "\n"
+               << "ino=" << stamp.ino << "\n"
+               << "size=" << stamp.size << "\n"
+               << "mtime=" << stamp.mtime.tv_sec << "." << stamp.mtime.tv_nsec << "\n"
+               << "ctime=" << stamp.ctime.tv_sec << "." << stamp.ctime.tv_nsec << "\n";
+    }
+    stream << "digest=" << digest << "\n";
+    return stream.str();
+}
+
+} // namespace
+
+std::optional<FileStamp> FileStamp::of(int fd) noexcept
+{
+    struct stat st{};
+    if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        return std::nullopt;
+    }
+
+    FileStamp stamp;
+    stamp.dev = st.st_dev;
+    stamp.ino = st.st_ino;
+    stamp.size = st.st_size;
+    stamp.mtime = st.st_mtim;
+    stamp.ctime = st.st_ctim;
+    stamp.verity = measureVerity(fd);
+    return stamp;
+}
+
+bool operator==(const FileStamp &lhs, const FileStamp &rhs) noexcept
+{
+    return lhs.dev == rhs.dev && lhs.ino == rhs.ino && lhs.size == rhs.size
+      && lhs.mtime.tv_sec == rhs.mtime.tv_sec && lhs.mtime.tv_nsec == rhs.mtime.tv_nsec
+      && lhs.ctime.tv_sec == rhs.ctime.tv_sec && lhs.ctime.tv_nsec == rhs.ctime.tv_nsec
+      && lhs.verity == rhs.verity;
+}
+
+bool operator!=(const FileStamp &lhs, const FileStamp &rhs) noexcept
+{
+    return !(lhs == rhs);
+}
+
+VerificationCache::VerificationCache(std::filesystem::path dir,
+                                     std::chrono::nanoseconds racyWindow) noexcept
+    : dir(std::move(dir))
+    , racyWindow(racyWindow)
+{
+}
+
+std::optional<std::filesystem::path> VerificationCache::defaultDirectory() noexcept
+{
+    std::filesystem::path cacheHome;
+    if (auto *xdgCacheHome = ::getenv("XDG_CACHE_HOME");
+        xdgCacheHome != nullptr && xdgCacheHome[0] == '/') {
+        cacheHome = xdgCacheHome;
+    } else if (auto *home = ::getenv("HOME"); home != nullptr && home[0] == '/') {
+        cacheHome = std::filesystem::path{ home } / ".cache";
+    } else {
+        return std::nullopt;
+    }
+
+    return cacheHome / "linglong" / "uab-verification";
+}
+
+std::filesystem::path VerificationCache::entryPath(const FileStamp &stamp) const noexcept
+{
+    // one entry per file, a new verification of the same file replaces the stale entry
+    auto key = stamp.verity.empty()
+      ? "inode:" + std::to_string(stamp.dev) + ":" + std::to_string(stamp.ino)
+      : "verity:" + stamp.verity;
+
+    SHA256 sha256;
+    sha256.update(key.data(), key.size());
+    return this->dir / sha256.hexDigest();
+}
+
+bool VerificationCache::verified(const FileStamp &stamp, std::string_view digest) const noexcept
+{
+    if (digest.empty()) {
+        return false;
+    }
+
+    auto fd = ::open(this->entryPath(stamp).c_str(), O_RDONLY | O_CLOEXEC | O_NOFOLLOW);
+    if (fd == -1) {
+        return false;
+    }
+
+    std::array<char, maxEntrySize> buf{};
+    std::size_t size{ 0 };
+    bool trusted{ false };
+    struct stat st{};
+    if (::fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_uid == ::geteuid()
+        && (st.st_mode & (S_IWGRP | S_IWOTH)) == 0) {
+        trusted = true;
+        while (size < buf.size()) {
+            auto ret = ::read(fd, buf.data() + size, buf.size() - size);
+            if (ret == -1 && errno == EINTR) {
+                continue;
+            }
+            if (ret <= 0) {
+                trusted = ret == 0;
+                break;
+            }
+            size += static_cast<std::size_t>(ret);
+        }
+    }
+    ::close(fd);
+
+    return trusted && std::string_view{ buf.data(), size } == serialize(stamp, digest);
+}
+
+bool VerificationCache::remember(int fd,
+                                 const FileStamp &stamp,
+                                 std::string_view digest) const noexcept
+{
+    // the file may be modified while it was being verified
+    auto current = FileStamp::of(fd);
+    if (digest.empty() || !current || *current != stamp) {
+        return false;
+    }
+
+    timespec now{};
+    ::clock_gettime(CLOCK_REALTIME, &now);
+    auto changed = std::chrono::seconds(stamp.ctime.tv_sec)
+      + std::chrono::nanoseconds(stamp.ctime.tv_nsec);
+    if (std::chrono::seconds(now.tv_sec) + std::chrono::nanoseconds(now.tv_nsec) - changed
+        < this->racyWindow) {
+        return false;
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(this->dir, ec);
+    if (ec) {
+        return false;
+    }
+    std::filesystem::permissions(this->dir, std::filesystem::perms::owner_all, ec);
+
+    auto tmpPath = (this->dir / ".entry-XXXXXX").string();
+    auto tmpFd = ::mkostemp(tmpPath.data(), O_CLOEXEC);
+    if (tmpFd == -1) {
+        return false;
+    }
+
+    auto content = serialize(stamp, digest);
+    std::size_t written{ 0 };
+    while (written < content.size()) {
+        auto ret = ::write(tmpFd, content.data() + written, content.size() - written);
+        if (ret == -1 && errno == EINTR) {
+            continue;
+        }
+        if (ret <= 0) {
+            break;
+        }
+        written += static_cast<std::size_t>(ret);
+    }
+    ::close(tmpFd);
+
+    // rename atomically, so a concurrent lookup never sees a partial entry
+    if (written != content.size()
+        || ::rename(tmpPath.c_str(), this->entryPath(stamp).c_str()) != 0) {
+        ::unlink(tmpPath.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace linglong::digest
@@ -0,0 +1,63 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include <sys/types.h>
+
+#include <chrono>
+#include <ctime>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace linglong::digest {
+
+// FileStamp identifies the content of a file without reading it. The fs-verity measurement is
+// used if the file has fs-verity enabled, otherwise any change of the file changes its ctime.
+struct FileStamp
+{
+    dev_t dev{ 0 };
+    ino_t ino{ 0 };
+    off_t size{ 0 };
+    timespec mtime{};
+    timespec ctime{};
+    // "<algorithm>:<hex digest>" of fs-verity, empty if it's not enabled
+    std::string verity;
+
+    static std::optional<FileStamp> of(int fd) noexcept;
+};
+
+bool operator==(const FileStamp &lhs, const FileStamp &rhs) noexcept;
+bool operator!=(const FileStamp &lhs, const FileStamp &rhs) noexcept;
+
+// VerificationCache remembers the files which have been verified against their expected digests,
+// so an unchanged file doesn't need to be hashed again. It's a per-user cache, entries are
+// trusted only if they are owned by the current user and not writable by others.
+class VerificationCache
+{
+public:
+    // the timestamps of files are usually coarse-grained, a file changed within racyWindow after
+    // it was stamped may keep the same stamp, so the recently changed files are not remembered
+    explicit VerificationCache(
+      std::filesystem::path dir,
+      std::chrono::nanoseconds racyWindow = std::chrono::seconds(2)) noexcept;
+
+    // defaultDirectory is $XDG_CACHE_HOME/linglong/uab-verification
+    static std::optional<std::filesystem::path> defaultDirectory() noexcept;
+
+    [[nodiscard]] bool verified(const FileStamp &stamp, std::string_view digest) const noexcept;
+    // remember records that the file of fd, which had the stamp before it was verified, matches
+    // digest. Nothing is recorded if the file has been changed since then.
+    bool remember(int fd, const FileStamp &stamp, std::string_view digest) const noexcept;
+
+    [[nodiscard]] std::filesystem::path entryPath(const FileStamp &stamp) const noexcept;
+
+private:
+    std::filesystem::path dir;
+    std::chrono::nanoseconds racyWindow;
+};
+
+} // namespace linglong::digest
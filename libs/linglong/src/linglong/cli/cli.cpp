@@ -21,6 +21,9 @@
 #include "linglong/cli/printer.h"
 #include "linglong/package/layer_file.h"
 #include "linglong/runtime/container_builder.h"
+#include "linglong/runtime/readahead.h"
+#include "linglong/runtime/resource_policy.h"
+#include "linglong/tracing/tracing.h"
 #include "linglong/utils/configure.h"
 #include "linglong/utils/error/error.h"
 #include "linglong/utils/serialize/json.h"
@@ -270,6 +273,7 @@ Cli::Cli(Printer &printer,
 int Cli::run()
 {
     LINGLONG_TRACE("command run");
+    tracing::Span runSpan("ll-cli run");
     // NOTE: ll-box is not support running as root for now.
     if (getuid() == 0) {
         qInfo() << "'ll-cli run' currently does not support running as root.";
@@ -279,6 +283,7 @@ int Cli::run()
     auto userContainerDir = std::filesystem::path{ "/run/linglong" } / std::to_string(::getuid());
     auto mode = S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH;
     auto pidFile = userContainerDir / std::to_string(::getpid());
+    tracing::Span pidFileSpan("create pid file");
     auto fd = ::open(pidFile.c_str(), O_WRONLY | O_CREAT | O_EXCL, mode);
     if (fd == -1) {
         qCritical() << QString{ "create file " } + pidFile.c_str() + " error:" + ::strerror(errno);
@@ -286,6 +291,7 @@ int Cli::run()
         return -1;
     }
     ::close(fd);
+    pidFileSpan.end();
 
     QObject::connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, [pidFile] {
         std::error_code ec;
@@ -304,16 +310,20 @@ int Cli::run()
         return -1;
     }
 
+    tracing::Span appRefSpan("clearReference app");
     auto curAppRef = this->repository.clearReference(*fuzzyRef,
                                                      {
                                                        .forceRemote = false,
                                                        .fallbackToRemote = false,
                                                      });
+    appRefSpan.end();
     if (!curAppRef) {
         this->printer.printErr(curAppRef.error());
         return -1;
     }
+    tracing::Span appLayerSpan("getMergedModuleDir app");
     auto appLayerDir = this->repository.getMergedModuleDir(*curAppRef);
+    appLayerSpan.end();
     if (!appLayerDir) {
         this->printer.printErr(appLayerDir.error());
         return -1;
@@ -335,17 +345,20 @@ int Cli::run()
             return -1;
         }
 
+        tracing::Span runtimeRefSpan("clearReference runtime");
         auto runtimeRefRet = this->repository.clearReference(*runtimeFuzzyRef,
                                                              {
                                                                .forceRemote = false,
                                                                .fallbackToRemote = false,
                                                              });
+        runtimeRefSpan.end();
         if (!runtimeRefRet) {
             this->printer.printErr(runtimeRefRet.error());
             return -1;
         }
         auto &runtimeRef = *runtimeRefRet;
 
+        tracing::Span runtimeLayerSpan("getMergedModuleDir runtime");
         if (!info->uuid.has_value()) {
             auto runtimeLayerDirRet = this->repository.getMergedModuleDir(runtimeRef);
             if (!runtimeLayerDirRet) {
@@ -363,6 +376,7 @@ int Cli::run()
             runtimeLayerRef = runtimeRefRet->toString().toStdString();
             runtimeLayerDir = std::move(runtimeLayerDirRet).value();
         }
+        runtimeLayerSpan.end();
     }
 
     auto baseFuzzyRef = package::FuzzyReference::parse(QString::fromStdString(info->base));
@@ -371,16 +385,19 @@ int Cli::run()
         return -1;
     }
 
+    tracing::Span baseRefSpan("clearReference base");
     auto baseRef = this->repository.clearReference(*baseFuzzyRef,
                                                    {
                                                      .forceRemote = false,
                                                      .fallbackToRemote = false,
                                                    });
+    baseRefSpan.end();
     if (!baseRef) {
         this->printer.printErr(LINGLONG_ERRV(baseRef));
         return -1;
     }
     utils::error::Result<package::LayerDir> baseLayerDir;
+    tracing::Span baseLayerSpan("getMergedModuleDir base");
     if (!info->uuid.has_value()) {
         qDebug() << "getMergedModuleDir base";
         baseLayerDir = this->repository.getMergedModuleDir(*baseRef);
@@ -388,6 +405,7 @@ int Cli::run()
         qDebug() << "getLayerDir base" << info->uuid.value().c_str();
         baseLayerDir = this->repository.getLayerDir(*baseRef, std::string{ "binary" }, info->uuid);
     }
+    baseLayerSpan.end();
     if (!baseLayerDir) {
         this->printer.printErr(LINGLONG_ERRV(baseLayerDir));
         return -1;
@@ -451,7 +469,9 @@ int Cli::run()
         return true;
     };
 
+    tracing::Span containersSpan("getCurrentContainers");
     auto containers = getCurrentContainers().value_or(std::vector<api::types::v1::CliContainer>{});
+    containersSpan.end();
     for (const auto &container : containers) {
         if (container.package != curAppRef->toString().toStdString()) {
             qDebug() << "mismatch:" << container.package.c_str() << " -- " << curAppRef->toString();
@@ -484,6 +504,7 @@ int Cli::run()
         opt.uid = ::getuid();
         opt.gid = ::getgid();
 
+        tracing::Span execSpan("exec in running container");
         auto result = this->ociCLI.exec(container.id,
                                         execArgs[0],
                                         { execArgs.cbegin() + 1, execArgs.cend() },
@@ -539,6 +560,25 @@ int Cli::run()
         }
     }
 
+    // the files read by the first seconds of the last launch are read ahead while the container is
+    // starting, the session lasts until the application exits
+    std::unique_ptr<runtime::ReadaheadSession> readahead;
+    if (qgetenv("LINGLONG_READAHEAD") == "1") {
+        tracing::Span readaheadSpan("start readahead");
+        std::vector<std::filesystem::path> layers;
+        layers.emplace_back(appLayerDir->absoluteFilePath("files").toStdString());
+        if (runtimeLayerDir) {
+            layers.emplace_back(runtimeLayerDir->absoluteFilePath("files").toStdString());
+        }
+        layers.emplace_back(baseLayerDir->absoluteFilePath("files").toStdString());
+        readahead =
+          std::make_unique<runtime::ReadaheadSession>(runtime::Readahead::defaultDirectory(),
+                                                      curAppRef->id,
+                                                      layers,
+                                                      std::chrono::seconds(10));
+    }
+
+    tracing::Span createSpan("ContainerBuilder::create");
     auto container = this->containerBuilder.create({
       .appID = curAppRef->id,
       .containerID = newContainerID,
@@ -548,7 +588,12 @@ int Cli::run()
       .patches = {},
       .mounts = std::move(applicationMounts),
       .masks = {},
+      .cacheConfig = true,
+      // the environment of the login shell is captured at the first launch
+      .cacheLoginEnvironment = qgetenv("LINGLONG_NO_LOGIN_SHELL") == "1",
+      .cacheStackCaches = true,
     });
+    createSpan.end();
     if (!container) {
         this->printer.printErr(container.error());
         return -1;
@@ -561,7 +606,22 @@ int Cli::run()
         return -1;
     }
 
+    // the resources are limited by the systemd unit of this process, which contains ll-box and the
+    // container, the application runs without the limits if the unit isn't available
+    auto resources =
+      runtime::mergeResources(info->permissions ? info->permissions->resources : std::nullopt,
+                              runtime::userResources(curAppRef->id));
+    if (resources) {
+        tracing::Span resourcesSpan("apply resources");
+        auto ret = runtime::applyResources(curAppRef->id, newContainerID, *resources);
+        if (!ret) {
+            qWarning() << "run without resource limits:" << ret.error().message();
+        }
+    }
+
+    tracing::Span containerRunSpan("Container::run");
     auto result = (*container)->run(process);
+    containerRunSpan.end();
     if (!result) {
         this->printer.printErr(result.error());
         return -1;
@@ -671,11 +731,22 @@ Cli::getCurrentContainers() const noexcept
             continue;
         }
 
-        myContainers.emplace_back(api::types::v1::CliContainer{
+        auto &item = myContainers.emplace_back(api::types::v1::CliContainer{
           .id = std::move(info->containerID),
           .package = std::move(info->app),
           .pid = container->pid,
         });
+
+        // the usage is only reported for the unit of the application, other units may contain
+        // the processes outside the container, e.g. the terminal which starts it
+        auto ref = package::FuzzyReference::parse(QString::fromStdString(item.package));
+        auto cgroup = runtime::cgroupOf(static_cast<pid_t>(container->pid));
+        if (ref && cgroup && runtime::appUnitOf(*cgroup, ref->id)) {
+            auto usage = runtime::resourceUsage("/sys/fs/cgroup" + *cgroup);
+            item.cpuUsage = usage.cpuUsage;
+            item.memoryUsage = usage.memoryUsage;
+            item.tasks = usage.tasks;
+        }
     }
 
     return myContainers;
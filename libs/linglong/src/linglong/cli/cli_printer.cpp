@@ -94,35 +94,64 @@ void CLIPrinter::printContainers(const std::vector<api::types::v1::CliContainer>
     const std::string packageSection = qUtf8Printable("App");
     const std::string idSection = qUtf8Printable("ContainerID");
     const std::string pidSection = qUtf8Printable("Pid");
+    const std::string cpuSection = qUtf8Printable("CPU");
+    const std::string memorySection = qUtf8Printable("Memory");
+
+    // the usage is missing if the container isn't in the unit of the application
+    auto cpu = [](const api::types::v1::CliContainer &con) -> std::string {
+        if (!con.cpuUsage) {
+            return "-";
+        }
+        return QString("%1s")
+          .arg(static_cast<double>(*con.cpuUsage) / 1e6, 0, 'f', 1)
+          .toStdString();
+    };
+    auto memory = [](const api::types::v1::CliContainer &con) -> std::string {
+        if (!con.memoryUsage) {
+            return "-";
+        }
+        return QString("%1MiB")
+          .arg(static_cast<double>(*con.memoryUsage) / (1024 * 1024), 0, 'f', 1)
+          .toStdString();
+    };
 
     std::size_t packageLen = 0;
     std::size_t idLen = 0;
     std::size_t pidLen = 0;
+    std::size_t cpuLen = 0;
 
     std::for_each(list.cbegin(),
                   list.cend(),
-                  [&packageLen, &idLen, &pidLen](const api::types::v1::CliContainer &con) {
+                  [&packageLen, &idLen, &pidLen, &cpuLen, &cpu](
+                    const api::types::v1::CliContainer &con) {
                       packageLen = std::max(packageLen, con.package.size());
                       idLen = std::max(idLen, con.id.size());
                       pidLen = std::max(pidLen, std::to_string(con.pid).size());
+                      cpuLen = std::max(cpuLen, cpu(con).size());
                   });
 
     packageLen = std::max(packageSection.size(), packageLen);
     idLen = std::max(idSection.size(), idLen);
     pidLen = std::max(pidSection.size(), pidLen);
+    cpuLen = std::max(cpuSection.size(), cpuLen);
 
     packageLen += padding;
     idLen += padding;
     pidLen += padding;
+    cpuLen += padding;
 
     std::cout << "\033[38;5;214m" << std::left << std::setw(static_cast<int>(packageLen))
               << packageSection << std::setw(static_cast<int>(idLen)) << idSection
-              << std::setw(static_cast<int>(pidLen)) << pidSection << "\033[0m" << std::endl;
+              << std::setw(static_cast<int>(pidLen)) << pidSection
+              << std::setw(static_cast<int>(cpuLen)) << cpuSection << memorySection << "\033[0m"
+              << std::endl;
 
     for (auto const &container : list) {
         std::cout << std::setw(static_cast<int>(packageLen)) << container.package
                   << std::setw(static_cast<int>(idLen)) << container.id
-                  << std::setw(static_cast<int>(pidLen)) << container.pid << std::endl;
+                  << std::setw(static_cast<int>(pidLen)) << container.pid
+                  << std::setw(static_cast<int>(cpuLen)) << cpu(container) << memory(container)
+                  << std::endl;
     }
 }
 
@@ -0,0 +1,637 @@
+/*
+ * SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#include "linglong/package/erofs_image.h"
+
+#include <lz4.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <optional>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace linglong::package {
+
+namespace {
+
+// the on-disk format is described in linux/fs/erofs/erofs_fs.h
+constexpr quint64 superBlockOffset = 1024;
+constexpr quint32 superBlockMagic = 0xE0F5E1E2;
+constexpr std::size_t superBlockSize = 128;
+constexpr std::size_t compactInodeSize = 32;
+constexpr std::size_t extendedInodeSize = 64;
+constexpr std::size_t mapHeaderSize = 8;
+constexpr std::size_t fullIndexSize = 8;
+constexpr std::size_t dirEntrySize = 12;
+
+constexpr quint32 featureZeroPadding = 0x00000001;
+constexpr quint32 featureDeviceTable = 0x00000008;
+
+enum DataLayout : quint8 {
+    FlatPlain = 0,
+    CompressedFull = 1,
+    FlatInline = 2,
+    CompressedCompact = 3,
+    ChunkBased = 4,
+};
+
+enum LClusterType : quint8 {
+    Plain = 0,
+    Head1 = 1,
+    NonHead = 2,
+    Head2 = 3,
+};
+
+constexpr quint16 adviseCompacted2B = 0x0001;
+constexpr quint16 adviseBigPCluster1 = 0x0002;
+constexpr quint16 adviseBigPCluster2 = 0x0004;
+constexpr quint16 adviseInlinePCluster = 0x0008;
+constexpr quint16 adviseInterlacedPCluster = 0x0010;
+constexpr quint16 adviseFragmentPCluster = 0x0020;
+
+constexpr quint8 compressionLZ4 = 0;
+
+quint16 le16(const unsigned char *p) noexcept
+{
+    return static_cast<quint16>(p[0] | (p[1] << 8));
+}
+
+quint32 le32(const unsigned char *p) noexcept
+{
+    return static_cast<quint32>(p[0]) | (static_cast<quint32>(p[1]) << 8)
+      | (static_cast<quint32>(p[2]) << 16) | (static_cast<quint32>(p[3]) << 24);
+}
+
+quint64 le64(const unsigned char *p) noexcept
+{
+    return static_cast<quint64>(le32(p)) | (static_cast<quint64>(le32(p + 4)) << 32);
+}
+
+quint64 alignUp(quint64 value, quint64 align) noexcept
+{
+    return (value + align - 1) / align * align;
+}
+
+} // namespace
+
+ErofsImage::ErofsImage(int fd, quint64 offset) noexcept
+    : fd(fd)
+    , offset(offset)
+{
+}
+
+ErofsImage::~ErofsImage()
+{
+    if (this->fd != -1) {
+        ::close(this->fd);
+    }
+}
+
+utils::error::Result<std::unique_ptr<ErofsImage>>
+ErofsImage::New(const QString &path, quint64 offset, Verifier verifier) noexcept
+{
+    LINGLONG_TRACE(QString{ "open erofs image %1 at offset %2" }.arg(path).arg(offset));
+
+    auto fd = ::open(path.toLocal8Bit().constData(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        return LINGLONG_ERR(QString{ "open: %1" }.arg(::strerror(errno)), errno);
+    }
+    std::unique_ptr<ErofsImage> image(new ErofsImage(fd, offset));
+    image->verifier = std::move(verifier);
+
+    unsigned char sb[superBlockSize];
+    auto ret = image->read(superBlockOffset, sb, sizeof(sb));
+    if (!ret) {
+        return LINGLONG_ERR(ret);
+    }
+
+    if (le32(sb) != superBlockMagic) {
+        return LINGLONG_ERR("bad superblock magic");
+    }
+
+    image->blkSizeBits = sb[12];
+    image->rootNid = le16(sb + 14);
+    image->metaBlkAddr = le32(sb + 40);
+    image->featureIncompat = le32(sb + 80);
+    const auto dirBlkBits = sb[90];
+
+    if (image->blkSizeBits < 9 || image->blkSizeBits > 16) {
+        return LINGLONG_ERR(QString{ "unsupported block size bits %1" }.arg(image->blkSizeBits),
+                            ENOTSUP);
+    }
+    if ((image->featureIncompat & featureDeviceTable) != 0 || dirBlkBits != 0) {
+        return LINGLONG_ERR("multiple devices and large directory blocks are not supported",
+                            ENOTSUP);
+    }
+
+    return image;
+}
+
+utils::error::Result<void> ErofsImage::read(quint64 pos, void *buf, std::size_t size) const noexcept
+{
+    LINGLONG_TRACE(QString{ "read %1 bytes at %2" }.arg(size).arg(pos));
+
+    if (this->verifier) {
+        auto ret = this->verifier(pos, size);
+        if (!ret) {
+            return LINGLONG_ERR(ret);
+        }
+    }
+
+    auto *out = static_cast<char *>(buf);
+    std::size_t done{ 0 };
+    while (done < size) {
+        auto n = ::pread(this->fd,
+                         out + done,
+                         size - done,
+                         static_cast<off_t>(this->offset + pos + done));
+        if (n == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return LINGLONG_ERR(::strerror(errno), errno);
+        }
+        if (n == 0) {
+            return LINGLONG_ERR("unexpected end of file");
+        }
+        done += n;
+    }
+
+    return LINGLONG_OK;
+}
+
+utils::error::Result<ErofsImage::Inode> ErofsImage::root() const noexcept
+{
+    return this->inode(this->rootNid);
+}
+
+utils::error::Result<ErofsImage::Inode> ErofsImage::inode(quint64 nid) const noexcept
+{
+    LINGLONG_TRACE(QString{ "read inode %1" }.arg(nid));
+
+    const quint64 pos = (static_cast<quint64>(this->metaBlkAddr) << this->blkSizeBits) + nid * 32;
+    unsigned char raw[extendedInodeSize];
+    auto ret = this->read(pos, raw, compactInodeSize);
+    if (!ret) {
+        return LINGLONG_ERR(ret);
+    }
+
+    Inode inode;
+    inode.nid = nid;
+    const auto format = le16(raw);
+    const auto xattrCount = le16(raw + 2);
+    const auto extended = (format & 1) != 0;
+    inode.layout = (format >> 1) & 0x7;
+    inode.mode = le16(raw + 4);
+    inode.rawBlkAddr = le32(raw + 16);
+
+    std::size_t inodeSize = compactInodeSize;
+    if (extended) {
+        ret = this->read(pos + compactInodeSize,
+                         raw + compactInodeSize,
+                         extendedInodeSize - compactInodeSize);
+        if (!ret) {
+            return LINGLONG_ERR(ret);
+        }
+        inodeSize = extendedInodeSize;
+        inode.size = le64(raw + 8);
+        inode.uid = le32(raw + 24);
+        inode.gid = le32(raw + 28);
+        inode.nlink = le32(raw + 44);
+    } else {
+        inode.nlink = le16(raw + 6);
+        inode.size = le32(raw + 8);
+        inode.uid = le16(raw + 24);
+        inode.gid = le16(raw + 26);
+    }
+
+    // the inline xattrs are skipped, they are not stored in a bare-user-only ostree repository
+    const std::size_t xattrSize = xattrCount == 0 ? 0 : 12 + (xattrCount - 1) * 4;
+    inode.metaEnd = pos + inodeSize + xattrSize;
+
+    return inode;
+}
+
+utils::error::Result<ErofsImage::Inode>
+ErofsImage::lookup(const std::string &path) const noexcept
+{
+    LINGLONG_TRACE(QString{ "lookup %1" }.arg(path.c_str()));
+
+    auto current = this->root();
+    if (!current) {
+        return LINGLONG_ERR(current);
+    }
+
+    std::size_t begin = 0;
+    while (begin < path.size()) {
+        auto end = path.find('/', begin);
+        if (end == std::string::npos) {
+            end = path.size();
+        }
+        auto name = path.substr(begin, end - begin);
+        begin = end + 1;
+        if (name.empty() || name == ".") {
+            continue;
+        }
+
+        if (!S_ISDIR(current->mode)) {
+            return LINGLONG_ERR("not a directory", ENOTDIR);
+        }
+        auto entries = this->readDir(*current);
+        if (!entries) {
+            return LINGLONG_ERR(entries);
+        }
+        auto entry = std::find_if(entries->begin(), entries->end(), [&name](const DirEntry &e) {
+            return e.name == name;
+        });
+        if (entry == entries->end()) {
+            return LINGLONG_ERR(QString{ "%1 not found" }.arg(name.c_str()), ENOENT);
+        }
+        current = this->inode(entry->nid);
+        if (!current) {
+            return LINGLONG_ERR(current);
+        }
+    }
+
+    return current;
+}
+
+utils::error::Result<std::vector<ErofsImage::DirEntry>>
+ErofsImage::readDir(const Inode &dir) const noexcept
+{
+    LINGLONG_TRACE(QString{ "read directory %1" }.arg(dir.nid));
+
+    if (!S_ISDIR(dir.mode)) {
+        return LINGLONG_ERR("not a directory", ENOTDIR);
+    }
+
+    auto data = this->readAll(dir);
+    if (!data) {
+        return LINGLONG_ERR(data);
+    }
+
+    // every block starts with an array of dirents, followed by the names without terminator
+    std::vector<DirEntry> entries;
+    const auto blockSize = static_cast<qsizetype>(1) << this->blkSizeBits;
+    for (qsizetype blockStart = 0; blockStart < data->size(); blockStart += blockSize) {
+        const auto blockLen = std::min(blockSize, data->size() - blockStart);
+        const auto *block = reinterpret_cast<const unsigned char *>(data->constData()) + blockStart;
+        if (blockLen < static_cast<qsizetype>(dirEntrySize)) {
+            return LINGLONG_ERR("corrupted directory block");
+        }
+
+        const auto count = le16(block + 8) / dirEntrySize;
+        if (count == 0 || count * dirEntrySize > static_cast<std::size_t>(blockLen)) {
+            return LINGLONG_ERR("corrupted directory block");
+        }
+
+        for (std::size_t i = 0; i < count; ++i) {
+            const auto *dirent = block + i * dirEntrySize;
+            const qsizetype nameOff = le16(dirent + 8);
+            qsizetype nameEnd = blockLen;
+            if (i + 1 < count) {
+                nameEnd = le16(dirent + dirEntrySize + 8);
+            }
+            if (nameOff >= nameEnd || nameEnd > blockLen) {
+                return LINGLONG_ERR("corrupted directory entry");
+            }
+
+            const auto *name = reinterpret_cast<const char *>(block + nameOff);
+            // the last name of a block may be padded with zeros
+            auto nameLen = ::strnlen(name, nameEnd - nameOff);
+            std::string entryName(name, nameLen);
+            if (entryName == "." || entryName == "..") {
+                continue;
+            }
+            entries.push_back({ std::move(entryName), le64(dirent) });
+        }
+    }
+
+    return entries;
+}
+
+utils::error::Result<QByteArray> ErofsImage::readAll(const Inode &inode) const noexcept
+{
+    LINGLONG_TRACE(QString{ "read all data of inode %1" }.arg(inode.nid));
+
+    QByteArray data;
+    data.reserve(static_cast<int>(inode.size));
+    auto ret = this->readData(inode, [&data](const char *buf, std::size_t size) {
+        data.append(buf, static_cast<int>(size));
+        return utils::error::Result<void>{};
+    });
+    if (!ret) {
+        return LINGLONG_ERR(ret);
+    }
+
+    return data;
+}
+
+utils::error::Result<void> ErofsImage::readData(const Inode &inode,
+                                                const Sink &sink) const noexcept
+{
+    LINGLONG_TRACE(QString{ "read data of inode %1" }.arg(inode.nid));
+
+    if (inode.size == 0) {
+        return LINGLONG_OK;
+    }
+
+    utils::error::Result<void> ret;
+    switch (inode.layout) {
+    case FlatPlain:
+    case FlatInline:
+        ret = this->readFlat(inode, sink);
+        break;
+    case CompressedFull:
+    case CompressedCompact:
+        ret = this->readCompressed(inode, sink);
+        break;
+    default:
+        return LINGLONG_ERR(QString{ "unsupported data layout %1" }.arg(inode.layout), ENOTSUP);
+    }
+    if (!ret) {
+        return LINGLONG_ERR(ret);
+    }
+
+    return LINGLONG_OK;
+}
+
+utils::error::Result<void> ErofsImage::readFlat(const Inode &inode,
+                                                const Sink &sink) const noexcept
+{
+    LINGLONG_TRACE("read flat data");
+
+    const quint64 blockSize = 1ULL << this->blkSizeBits;
+    const quint64 blocks = (inode.size + blockSize - 1) / blockSize;
+    // the last block of an inline inode is stored right after the inode
+    const quint64 plainBlocks = inode.layout == FlatInline ? blocks - 1 : blocks;
+    const quint64 plainSize = std::min(inode.size, plainBlocks * blockSize);
+
+    std::vector<char> buf(std::min<quint64>(plainSize, 128 * 1024));
+    quint64 pos = static_cast<quint64>(inode.rawBlkAddr) << this->blkSizeBits;
+    for (quint64 done = 0; done < plainSize;) {
+        const auto len = std::min<quint64>(buf.size(), plainSize - done);
+        auto ret = this->read(pos + done, buf.data(), len);
+        if (!ret) {
+            return LINGLONG_ERR(ret);
+        }
+        ret = sink(buf.data(), len);
+        if (!ret) {
+            return LINGLONG_ERR(ret);
+        }
+        done += len;
+    }
+
+    if (plainSize == inode.size) {
+        return LINGLONG_OK;
+    }
+
+    const auto tailSize = inode.size - plainSize;
+    if (tailSize > blockSize) {
+        return LINGLONG_ERR("corrupted inline data");
+    }
+    buf.resize(tailSize);
+    auto ret = this->read(inode.metaEnd, buf.data(), tailSize);
+    if (!ret) {
+        return LINGLONG_ERR(ret);
+    }
+    ret = sink(buf.data(), tailSize);
+    if (!ret) {
+        return LINGLONG_ERR(ret);
+    }
+
+    return LINGLONG_OK;
+}
+
+utils::error::Result<ErofsImage::LCluster> ErofsImage::fullIndex(const Inode &inode,
+                                                                 quint64 lcn) const noexcept
+{
+    LINGLONG_TRACE(QString{ "read full index %1" }.arg(lcn));
+
+    const auto pos =
+      alignUp(inode.metaEnd, 8) + mapHeaderSize + fullIndexSize + lcn * fullIndexSize;
+    unsigned char raw[fullIndexSize];
+    auto ret = this->read(pos, raw, sizeof(raw));
+    if (!ret) {
+        return LINGLONG_ERR(ret);
+    }
+
+    LCluster cluster;
+    cluster.type = le16(raw) & 0x3;
+    cluster.clusterOffset = le16(raw + 2);
+    cluster.blkAddr = le32(raw + 4);
+    return cluster;
+}
+
+// compactIndex follows z_erofs_load_compact_lcluster and unpack_compacted_index of the kernel
+utils::error::Result<ErofsImage::LCluster>
+ErofsImage::compactIndex(const Inode &inode, quint16 advise, quint64 lcn) const noexcept
+{
+    LINGLONG_TRACE(QString{ "read compact index %1" }.arg(lcn));
+
+    const auto blockSize = 1ULL << this->blkSizeBits;
+    const auto totalIdx = (inode.size + blockSize - 1) / blockSize;
+    const auto base = alignUp(inode.metaEnd, 8) + mapHeaderSize;
+
+    // the indexes start with 4-byte packs to align the following 2-byte packs to 32 bytes
+    const quint64 compacted4BInitial = ((32 - base % 32) / 4) & 7;
+    quint64 compacted2B = 0;
+    if ((advise & adviseCompacted2B) != 0 && compacted4BInitial < totalIdx) {
+        compacted2B = (totalIdx - compacted4BInitial) / 16 * 16;
+    }
+
+    auto pos = base;
+    auto index = lcn;
+    auto amortizedShift = 2U;
+    if (index >= compacted4BInitial) {
+        pos += compacted4BInitial * 4;
+        index -= compacted4BInitial;
+        if (index < compacted2B) {
+            amortizedShift = 1;
+        } else {
+            pos += compacted2B * 2;
+            index -= compacted2B;
+        }
+    }
+    pos += index << amortizedShift;
+
+    if (amortizedShift == 1 && this->blkSizeBits > 12) {
+        return LINGLONG_ERR("2-byte compacted indexes require 4k logical clusters", ENOTSUP);
+    }
+    const quint64 vcnt = amortizedShift == 2 ? 2 : 16;
+    const quint64 packSize = vcnt << amortizedShift;
+    const auto packBase = pos / packSize * packSize;
+
+    unsigned char pack[32 + 4]{};
+    auto ret = this->read(packBase, pack, packSize);
+    if (!ret) {
+        return LINGLONG_ERR(ret);
+    }
+
+    const auto loBits = std::max<unsigned>(this->blkSizeBits, 12);
+    const auto encodeBits = (packSize - 4) * 8 / vcnt;
+    auto decode = [&pack, loBits](quint64 bitPos, quint8 &type) {
+        const auto v = le32(pack + bitPos / 8) >> (bitPos & 7);
+        type = (v >> loBits) & 3;
+        return v & ((1U << loBits) - 1);
+    };
+
+    auto i = static_cast<int>((pos - packBase) >> amortizedShift);
+    LCluster cluster;
+    const auto lo = decode(encodeBits * i, cluster.type);
+    if (cluster.type == NonHead) {
+        return cluster;
+    }
+    cluster.clusterOffset = lo;
+
+    // every head or plain lcluster before this one in the pack takes one physical block
+    quint32 nblk = 1;
+    while (i > 0) {
+        --i;
+        quint8 type{ 0 };
+        const auto delta = decode(encodeBits * i, type);
+        if (type == NonHead) {
+            i -= static_cast<int>(delta);
+        }
+        if (i >= 0) {
+            ++nblk;
+        }
+    }
+    cluster.blkAddr = le32(pack + packSize - 4) + nblk;
+    return cluster;
+}
+
+utils::error::Result<void> ErofsImage::readCompressed(const Inode &inode,
+                                                      const Sink &sink) const noexcept
+{
+    LINGLONG_TRACE("read compressed data");
+
+    unsigned char header[mapHeaderSize];
+    auto ret = this->read(alignUp(inode.metaEnd, 8), header, sizeof(header));
+    if (!ret) {
+        return LINGLONG_ERR(ret);
+    }
+    const auto advise = le16(header + 4);
+    const auto algorithmType = header[6];
+    const auto clusterBits = header[7];
+
+    constexpr auto unsupportedAdvise = adviseBigPCluster1 | adviseBigPCluster2
+      | adviseInlinePCluster | adviseFragmentPCluster;
+    if ((advise & unsupportedAdvise) != 0 || clusterBits != 0) {
+        return LINGLONG_ERR(QString{ "unsupported compression advise %1 with cluster bits %2" }
+                              .arg(advise)
+                              .arg(clusterBits),
+                            ENOTSUP);
+    }
+
+    const auto blockSize = 1ULL << this->blkSizeBits;
+    const auto totalIdx = (inode.size + blockSize - 1) / blockSize;
+    std::vector<char> block(blockSize);
+    std::vector<char> out;
+
+    // decode one extent, which starts at a head or plain lcluster and ends at the next one
+    auto emit = [&](const LCluster &head,
+                    quint64 start,
+                    quint64 end) -> utils::error::Result<void> {
+        LINGLONG_TRACE(QString{ "decode extent %1-%2" }.arg(start).arg(end));
+
+        auto ret = this->read(static_cast<quint64>(head.blkAddr) << this->blkSizeBits,
+                              block.data(),
+                              blockSize);
+        if (!ret) {
+            return LINGLONG_ERR(ret);
+        }
+
+        const auto length = end - start;
+        if (head.type == Plain) {
+            if (length > blockSize) {
+                return LINGLONG_ERR("corrupted plain extent");
+            }
+            // interlaced extents are rotated by the offset of the extent in a block
+            const auto shift = (advise & adviseInterlacedPCluster) != 0 ? start % blockSize : 0;
+            out.resize(length);
+            for (quint64 i = 0; i < length; ++i) {
+                out[i] = block[(shift + i) % blockSize];
+            }
+            return sink(out.data(), length);
+        }
+
+        const auto algorithm = head.type == Head1 ? algorithmType & 0xF : algorithmType >> 4;
+        if (algorithm != compressionLZ4) {
+            return LINGLONG_ERR(QString{ "unsupported compression algorithm %1" }.arg(algorithm),
+                                ENOTSUP);
+        }
+
+        // with zero padding, the compressed data is placed at the end of the block
+        const char *src = block.data();
+        auto srcSize = static_cast<int>(blockSize);
+        if ((this->featureIncompat & featureZeroPadding) != 0) {
+            while (srcSize > 0 && *src == 0) {
+                ++src;
+                --srcSize;
+            }
+        }
+
+        out.resize(length);
+        auto decoded = LZ4_decompress_safe_partial(src,
+                                                   out.data(),
+                                                   srcSize,
+                                                   static_cast<int>(length),
+                                                   static_cast<int>(length));
+        if (decoded < 0 || static_cast<quint64>(decoded) != length) {
+            return LINGLONG_ERR(QString{ "lz4 decompress: got %1 bytes" }.arg(decoded));
+        }
+        return sink(out.data(), length);
+    };
+
+    std::optional<LCluster> head;
+    quint64 headStart = 0;
+    for (quint64 lcn = 0; lcn < totalIdx; ++lcn) {
+        auto cluster = inode.layout == CompressedFull
+          ? this->fullIndex(inode, lcn)
+          : this->compactIndex(inode, advise, lcn);
+        if (!cluster) {
+            return LINGLONG_ERR(cluster);
+        }
+        if (cluster->type == NonHead) {
+            if (!head) {
+                return LINGLONG_ERR("the first logical cluster is not a head");
+            }
+            continue;
+        }
+
+        const auto start = lcn * blockSize + cluster->clusterOffset;
+        if (head) {
+            if (start <= headStart || start > inode.size) {
+                return LINGLONG_ERR("corrupted logical cluster index");
+            }
+            ret = emit(*head, headStart, start);
+            if (!ret) {
+                return LINGLONG_ERR(ret);
+            }
+        } else if (start != 0) {
+            return LINGLONG_ERR("the first extent doesn't start at 0");
+        }
+        head = *cluster;
+        headStart = start;
+    }
+
+    if (!head) {
+        return LINGLONG_ERR("no extent found");
+    }
+    ret = emit(*head, headStart, inode.size);
+    if (!ret) {
+        return LINGLONG_ERR(ret);
+    }
+
+    return LINGLONG_OK;
+}
+
+} // namespace linglong::package
@@ -0,0 +1,103 @@
+/*
+ * SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#pragma once
+
+#include "linglong/utils/error/error.h"
+
+#include <QByteArray>
+#include <QString>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace linglong::package {
+
+// ErofsImage reads an erofs image which is embedded in a layer or uab file at the given offset,
+// without mounting it. It supports the images created by mkfs.erofs with the options used by
+// LayerPackager and UABPackager: uncompressed or lz4 compressed files with 1-block physical
+// clusters. Other features are reported as errors, callers should fallback to mount the image.
+class ErofsImage
+{
+public:
+    struct Inode
+    {
+        quint64 nid{ 0 };
+        quint32 mode{ 0 };
+        quint32 uid{ 0 };
+        quint32 gid{ 0 };
+        quint32 nlink{ 0 };
+        quint64 size{ 0 };
+        quint8 layout{ 0 };
+        quint32 rawBlkAddr{ 0 };
+        // the end offset of the inode and its inline xattrs in the image
+        quint64 metaEnd{ 0 };
+    };
+
+    struct DirEntry
+    {
+        std::string name;
+        quint64 nid{ 0 };
+    };
+
+    using Sink = std::function<utils::error::Result<void>(const char *data, std::size_t size)>;
+    // Verifier checks [pos, pos + size) of the image before the data read from there is used
+    using Verifier = std::function<utils::error::Result<void>(quint64 pos, std::size_t size)>;
+
+    ErofsImage(const ErofsImage &) = delete;
+    ErofsImage(ErofsImage &&) = delete;
+    ErofsImage &operator=(const ErofsImage &) = delete;
+    ErofsImage &operator=(ErofsImage &&) = delete;
+    ~ErofsImage();
+
+    static utils::error::Result<std::unique_ptr<ErofsImage>>
+    New(const QString &path, quint64 offset = 0, Verifier verifier = {}) noexcept;
+
+    [[nodiscard]] utils::error::Result<Inode> root() const noexcept;
+    [[nodiscard]] utils::error::Result<Inode> inode(quint64 nid) const noexcept;
+    // lookup resolves a relative path from the root directory, symlinks are not followed
+    [[nodiscard]] utils::error::Result<Inode> lookup(const std::string &path) const noexcept;
+    // readDir returns the entries of a directory without "." and ".."
+    [[nodiscard]] utils::error::Result<std::vector<DirEntry>>
+    readDir(const Inode &dir) const noexcept;
+    // readData passes the content of a regular file or symlink to sink in order
+    [[nodiscard]] utils::error::Result<void> readData(const Inode &inode,
+                                                      const Sink &sink) const noexcept;
+    [[nodiscard]] utils::error::Result<QByteArray> readAll(const Inode &inode) const noexcept;
+
+private:
+    struct LCluster
+    {
+        quint8 type{ 0 };
+        quint16 clusterOffset{ 0 };
+        quint32 blkAddr{ 0 };
+    };
+
+    ErofsImage(int fd, quint64 offset) noexcept;
+
+    [[nodiscard]] utils::error::Result<void>
+    read(quint64 pos, void *buf, std::size_t size) const noexcept;
+    [[nodiscard]] utils::error::Result<void> readFlat(const Inode &inode,
+                                                      const Sink &sink) const noexcept;
+    [[nodiscard]] utils::error::Result<void> readCompressed(const Inode &inode,
+                                                            const Sink &sink) const noexcept;
+    [[nodiscard]] utils::error::Result<LCluster>
+    fullIndex(const Inode &inode, quint64 lcn) const noexcept;
+    [[nodiscard]] utils::error::Result<LCluster>
+    compactIndex(const Inode &inode, quint16 advise, quint64 lcn) const noexcept;
+
+    int fd{ -1 };
+    quint64 offset{ 0 };
+    Verifier verifier;
+    quint8 blkSizeBits{ 0 };
+    quint16 rootNid{ 0 };
+    quint32 metaBlkAddr{ 0 };
+    quint32 featureIncompat{ 0 };
+};
+
+} // namespace linglong::package
@@ -9,6 +9,7 @@
 #include "linglong/api/types/v1/Generators.hpp"
 #include "linglong/api/types/v1/LayerInfo.hpp"
 #include "linglong/utils/command/env.h"
+#include "linglong/utils/erofs/mount.h"
 
 #include <QDataStream>
 #include <QSysInfo>
@@ -137,10 +138,8 @@ utils::error::Result<LayerDir> LayerPackager::unpack(LayerFile &file)
         return LINGLONG_ERR(offset);
     }
 
-    auto ret = utils::command::Exec("erofsfuse",
-                                    { QString("--offset=%1").arg(*offset),
-                                      fileInfo.absoluteFilePath(),
-                                      unpackDir.absolutePath() });
+    auto ret =
+      utils::erofs::mount(fileInfo.absoluteFilePath(), *offset, unpackDir.absolutePath());
     if (!ret) {
         return LINGLONG_ERR(ret);
     }
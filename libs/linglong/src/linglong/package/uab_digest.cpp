@@ -0,0 +1,250 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "linglong/package/uab_digest.h"
+
+#include "linglong/digest/sha256.h"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <functional>
+#include <thread>
+
+#include <unistd.h>
+
+namespace linglong::package {
+
+namespace {
+
+utils::error::Result<void> readAt(int fd, quint64 pos, char *buf, std::size_t size) noexcept
+{
+    LINGLONG_TRACE(QString{ "read %1 bytes at %2" }.arg(size).arg(pos));
+
+    std::size_t done{ 0 };
+    while (done < size) {
+        auto n = ::pread(fd, buf + done, size - done, static_cast<off_t>(pos + done));
+        if (n == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return LINGLONG_ERR(::strerror(errno), errno);
+        }
+        if (n == 0) {
+            return LINGLONG_ERR("unexpected end of file");
+        }
+        done += n;
+    }
+
+    return LINGLONG_OK;
+}
+
+} // namespace
+
+utils::error::Result<BundleDigest>
+calculateBundleDigest(int fd, quint64 offset, quint64 length, qint64 chunkSize) noexcept
+{
+    LINGLONG_TRACE("calculate digests of uab bundle")
+
+    if (chunkSize <= 0) {
+        return LINGLONG_ERR(QString{ "invalid chunk size %1" }.arg(chunkSize), EINVAL);
+    }
+
+    digest::SHA256 whole;
+    digest::SHA256 root;
+    BundleDigest result;
+    result.tree.chunkSize = chunkSize;
+
+    QByteArray buf(static_cast<int>(chunkSize), Qt::Uninitialized);
+    std::array<std::byte, digest::SHA256::digestSize> chunkDigest{};
+    for (quint64 pos = 0; pos < length; pos += chunkSize) {
+        auto size = std::min<quint64>(chunkSize, length - pos);
+        auto ret = readAt(fd, offset + pos, buf.data(), size);
+        if (!ret) {
+            return LINGLONG_ERR(ret);
+        }
+
+        whole.update(buf.constData(), size);
+        digest::SHA256 chunk;
+        chunk.update(buf.constData(), size);
+        chunk.final(chunkDigest.data());
+        root.update(chunkDigest.data(), chunkDigest.size());
+        result.tree.chunks.emplace_back(
+          QByteArray::fromRawData(reinterpret_cast<const char *>(chunkDigest.data()),
+                                  chunkDigest.size())
+            .toHex()
+            .toStdString());
+    }
+
+    result.digest = whole.hexDigest();
+    result.tree.root = root.hexDigest();
+    return result;
+}
+
+ChunkVerifier::ChunkVerifier(int fd, quint64 offset, quint64 length, quint64 chunkSize) noexcept
+    : fd(fd)
+    , offset(offset)
+    , length(length)
+    , chunkSize(chunkSize)
+{
+}
+
+ChunkVerifier::~ChunkVerifier()
+{
+    if (this->fd != -1) {
+        ::close(this->fd);
+    }
+}
+
+utils::error::Result<std::unique_ptr<ChunkVerifier>>
+ChunkVerifier::New(int fd,
+                   quint64 offset,
+                   quint64 length,
+                   const api::types::v1::UabDigestTree &tree) noexcept
+{
+    LINGLONG_TRACE("check digest tree of uab bundle")
+
+    if (tree.chunkSize <= 0) {
+        return LINGLONG_ERR(QString{ "invalid chunk size %1" }.arg(tree.chunkSize), EBADMSG);
+    }
+
+    const quint64 chunkSize = tree.chunkSize;
+    const auto count = (length + chunkSize - 1) / chunkSize;
+    if (tree.chunks.size() != count) {
+        return LINGLONG_ERR(QString{ "expect %1 chunks for %2 bytes, but got %3" }
+                              .arg(count)
+                              .arg(length)
+                              .arg(tree.chunks.size()),
+                            EBADMSG);
+    }
+
+    digest::SHA256 root;
+    std::vector<QByteArray> digests;
+    digests.reserve(count);
+    for (const auto &chunk : tree.chunks) {
+        auto raw = QByteArray::fromHex(QByteArray::fromStdString(chunk));
+        if (static_cast<std::size_t>(raw.size()) != digest::SHA256::digestSize) {
+            return LINGLONG_ERR(QString{ "invalid chunk digest %1" }.arg(chunk.c_str()), EBADMSG);
+        }
+        root.update(raw.constData(), raw.size());
+        digests.emplace_back(std::move(raw));
+    }
+
+    auto rootDigest = root.hexDigest();
+    if (rootDigest != tree.root) {
+        return LINGLONG_ERR(QString{ "root digest mismatched, expected: %1 calculated: %2" }.arg(
+                              tree.root.c_str(),
+                              rootDigest.c_str()),
+                            EBADMSG);
+    }
+
+    auto dupFd = ::dup(fd);
+    if (dupFd == -1) {
+        return LINGLONG_ERR(QString{ "dup: %1" }.arg(::strerror(errno)), errno);
+    }
+
+    std::unique_ptr<ChunkVerifier> verifier(new ChunkVerifier(dupFd, offset, length, chunkSize));
+    verifier->digests = std::move(digests);
+    verifier->verified = std::make_unique<std::atomic_bool[]>(count);
+    return verifier;
+}
+
+utils::error::Result<void> ChunkVerifier::verifyChunk(std::size_t index) noexcept
+{
+    LINGLONG_TRACE(QString{ "verify chunk %1 of uab bundle" }.arg(index));
+
+    if (this->verified[index].load(std::memory_order_acquire)) {
+        return LINGLONG_OK;
+    }
+
+    const auto pos = index * this->chunkSize;
+    const auto size = std::min(this->chunkSize, this->length - pos);
+    QByteArray buf(static_cast<int>(size), Qt::Uninitialized);
+    auto ret = readAt(this->fd, this->offset + pos, buf.data(), size);
+    if (!ret) {
+        return LINGLONG_ERR(ret);
+    }
+
+    std::array<std::byte, digest::SHA256::digestSize> chunkDigest{};
+    digest::SHA256 sha256;
+    sha256.update(buf.constData(), buf.size());
+    sha256.final(chunkDigest.data());
+    if (std::memcmp(chunkDigest.data(), this->digests[index].constData(), chunkDigest.size())
+        != 0) {
+        return LINGLONG_ERR("digest mismatched", EBADMSG);
+    }
+
+    this->verified[index].store(true, std::memory_order_release);
+    return LINGLONG_OK;
+}
+
+utils::error::Result<void> ChunkVerifier::verifyRange(quint64 pos, quint64 size) noexcept
+{
+    LINGLONG_TRACE(QString{ "verify %1 bytes at %2 of uab bundle" }.arg(size).arg(pos));
+
+    if (size == 0) {
+        return LINGLONG_OK;
+    }
+    if (pos >= this->length || size > this->length - pos) {
+        return LINGLONG_ERR("out of the bundle section", EBADMSG);
+    }
+
+    for (auto index = pos / this->chunkSize; index <= (pos + size - 1) / this->chunkSize;
+         ++index) {
+        auto ret = this->verifyChunk(index);
+        if (!ret) {
+            return LINGLONG_ERR(ret);
+        }
+    }
+
+    return LINGLONG_OK;
+}
+
+utils::error::Result<void> ChunkVerifier::verifyAll(unsigned int jobs) noexcept
+{
+    LINGLONG_TRACE("verify all chunks of uab bundle")
+
+    const auto count = this->digests.size();
+    if (jobs == 0) {
+        jobs = std::max(1U, std::thread::hardware_concurrency());
+    }
+    jobs = static_cast<unsigned int>(std::min<std::size_t>(jobs, count));
+
+    std::atomic_size_t next{ 0 };
+    std::atomic_bool failed{ false };
+    std::vector<utils::error::Result<void>> results(jobs);
+    auto worker = [this, count, &next, &failed](utils::error::Result<void> &result) {
+        while (!failed.load(std::memory_order_relaxed)) {
+            auto index = next.fetch_add(1, std::memory_order_relaxed);
+            if (index >= count) {
+                return;
+            }
+            result = this->verifyChunk(index);
+            if (!result) {
+                failed.store(true, std::memory_order_relaxed);
+                return;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(jobs);
+    for (auto &result : results) {
+        threads.emplace_back(worker, std::ref(result));
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    for (auto &result : results) {
+        if (!result) {
+            return LINGLONG_ERR(result);
+        }
+    }
+
+    return LINGLONG_OK;
+}
+
+} // namespace linglong::package
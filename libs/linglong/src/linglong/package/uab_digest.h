@@ -0,0 +1,68 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include "linglong/api/types/v1/UabDigestTree.hpp"
+#include "linglong/utils/error/error.h"
+
+#include <QByteArray>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace linglong::package {
+
+// the size of chunks in the digest tree of the bundle section created by UABPackager
+constexpr qint64 defaultDigestChunkSize = 1024 * 1024;
+
+struct BundleDigest
+{
+    // the sha256 of the whole section, it's the only digest known by the old installers
+    std::string digest;
+    api::types::v1::UabDigestTree tree;
+};
+
+// calculateBundleDigest calculates both digests of length bytes at offset of fd in one pass
+utils::error::Result<BundleDigest> calculateBundleDigest(
+  int fd, quint64 offset, quint64 length, qint64 chunkSize = defaultDigestChunkSize) noexcept;
+
+// ChunkVerifier verifies the bundle section of an uab file against its digest tree. Chunks can be
+// verified all in parallel, or lazily when a range of the section is going to be read, every chunk
+// is verified only once. A digest mismatch is reported as an error with code EBADMSG. It's safe to
+// use a verifier from multiple threads.
+class ChunkVerifier
+{
+public:
+    ChunkVerifier(const ChunkVerifier &) = delete;
+    ChunkVerifier(ChunkVerifier &&) = delete;
+    ChunkVerifier &operator=(const ChunkVerifier &) = delete;
+    ChunkVerifier &operator=(ChunkVerifier &&) = delete;
+    ~ChunkVerifier();
+
+    // New checks the tree itself against its root digest, the section is not read
+    static utils::error::Result<std::unique_ptr<ChunkVerifier>>
+    New(int fd, quint64 offset, quint64 length, const api::types::v1::UabDigestTree &tree) noexcept;
+
+    // verifyAll verifies the remaining chunks with jobs threads, 0 means the number of CPUs
+    utils::error::Result<void> verifyAll(unsigned int jobs = 0) noexcept;
+    // verifyRange verifies the chunks overlapping [pos, pos + size) of the section
+    utils::error::Result<void> verifyRange(quint64 pos, quint64 size) noexcept;
+
+private:
+    ChunkVerifier(int fd, quint64 offset, quint64 length, quint64 chunkSize) noexcept;
+
+    utils::error::Result<void> verifyChunk(std::size_t index) noexcept;
+
+    int fd{ -1 };
+    quint64 offset{ 0 };
+    quint64 length{ 0 };
+    quint64 chunkSize{ 0 };
+    std::vector<QByteArray> digests;
+    std::unique_ptr<std::atomic_bool[]> verified;
+};
+
+} // namespace linglong::package
@@ -5,16 +5,19 @@
 #include "linglong/package/uab_file.h"
 
 #include "linglong/api/types/v1/Generators.hpp"
+#include "linglong/digest/sha256.h"
 #include "linglong/utils/command/env.h"
+#include "linglong/utils/erofs/mount.h"
 #include "linglong/utils/finally/finally.h"
 
 #include <nlohmann/json.hpp>
 
-#include <QCryptographicHash>
 #include <QDir>
 #include <QFileInfo>
 #include <QStandardPaths>
 
+#include <algorithm>
+#include <cerrno>
 #include <random>
 #include <string_view>
 
@@ -157,9 +160,33 @@ utils::error::Result<bool> UABFile::verify() noexcept
           QString{ "couldn't find bundle section which named %1" }.arg(bundleSection));
     }
 
+    if (metaInfo.digestTree) {
+        auto verifier = ChunkVerifier::New(handle(),
+                                           bundleSh->sh_offset,
+                                           bundleSh->sh_size,
+                                           *metaInfo.digestTree);
+        if (!verifier) {
+            if (verifier.error().code() == EBADMSG) {
+                qWarning() << verifier.error();
+                return false;
+            }
+            return LINGLONG_ERR(verifier);
+        }
+
+        auto ret = (*verifier)->verifyAll();
+        if (!ret) {
+            if (ret.error().code() == EBADMSG) {
+                qWarning() << ret.error();
+                return false;
+            }
+            return LINGLONG_ERR(ret);
+        }
+        return true;
+    }
+
+    digest::SHA256 cryptor;
     std::array<char, 4096> buf{};
     std::string digest;
-    QCryptographicHash cryptor{ QCryptographicHash::Sha256 };
 
     seek(bundleSh->sh_offset);
     auto backToHead = utils::finally::finally([this] {
@@ -167,24 +194,70 @@ utils::error::Result<bool> UABFile::verify() noexcept
     });
 
     auto bundleLength = bundleSh->sh_size;
-    auto readBytes = buf.size();
-    int bytesRead{ 0 };
+    auto readBytes = std::min<quint64>(buf.size(), bundleLength);
+    qint64 bytesRead{ 0 };
     while ((bytesRead = read(buf.data(), readBytes)) != 0) {
         if (bytesRead == -1) {
             return LINGLONG_ERR(QString{ "read error: %1" }.arg(errorString()));
         }
 
-        cryptor.addData(buf.data(), bytesRead);
+        cryptor.update(buf.data(), bytesRead);
         bundleLength -= bytesRead;
-        if (bundleLength <= 0) {
-            digest = cryptor.result().toHex().toStdString();
+        if (bundleLength == 0) {
+            digest = cryptor.hexDigest();
             break;
         }
+        readBytes = std::min<quint64>(buf.size(), bundleLength);
     }
 
     return (expectedDigest == digest);
 }
 
+utils::error::Result<std::shared_ptr<ChunkVerifier>> UABFile::chunkVerifier() noexcept
+{
+    LINGLONG_TRACE("get chunk verifier of uab")
+
+    auto metaInfoRet = getMetaInfo();
+    if (!metaInfoRet) {
+        return LINGLONG_ERR(metaInfoRet.error());
+    }
+
+    const auto &metaInfo = metaInfoRet->get();
+    if (!metaInfo.digestTree) {
+        return nullptr;
+    }
+
+    auto bundleSh = getSectionHeader(QString::fromStdString(metaInfo.sections.bundle));
+    if (!bundleSh) {
+        return LINGLONG_ERR(bundleSh.error());
+    }
+
+    auto verifier =
+      ChunkVerifier::New(handle(), bundleSh->sh_offset, bundleSh->sh_size, *metaInfo.digestTree);
+    if (!verifier) {
+        return LINGLONG_ERR(verifier);
+    }
+
+    return std::shared_ptr<ChunkVerifier>{ std::move(verifier).value() };
+}
+
+utils::error::Result<quint64> UABFile::bundleOffset() noexcept
+{
+    LINGLONG_TRACE("get offset of uab bundle")
+
+    auto metaInfoRet = getMetaInfo();
+    if (!metaInfoRet) {
+        return LINGLONG_ERR(metaInfoRet.error());
+    }
+
+    auto bundleSh = getSectionHeader(QString::fromStdString(metaInfoRet->get().sections.bundle));
+    if (!bundleSh) {
+        return LINGLONG_ERR(bundleSh.error());
+    }
+
+    return bundleSh->sh_offset;
+}
+
 utils::error::Result<std::filesystem::path> UABFile::mountUab() noexcept
 {
     LINGLONG_TRACE("mount uab bundle")
@@ -213,15 +286,12 @@ utils::error::Result<std::filesystem::path> UABFile::mountUab() noexcept
                             % ec.message().c_str());
     }
 
-    auto ret = utils::command::Exec(
-      "erofsfuse",
-      QStringList{ QString{ "--offset=%1" }.arg(bundleOffset), fileName(), uabDir.c_str() });
+    auto ret = utils::erofs::mount(fileName(), bundleOffset, uabDir.c_str());
     if (!ret) {
         return LINGLONG_ERR(ret.error());
     }
 
     this->mountPoint = uabDir;
-    qDebug() << "erofsfuse output:" << *ret;
 
     return mountPoint;
 }
@@ -229,9 +299,6 @@ utils::error::Result<std::filesystem::path> UABFile::mountUab() noexcept
 utils::error::Result<std::filesystem::path> UABFile::extractSignData() noexcept
 {
     LINGLONG_TRACE("extract sign data from uab")
-    if (mountPoint.empty()) {
-        return LINGLONG_ERR("uab is not mounted");
-    }
 
     auto signSection = getSectionHeader("linglong.bundle.sign");
     if (!signSection) {
@@ -5,6 +5,7 @@
 #pragma once
 
 #include "linglong/api/types/v1/UabMetaInfo.hpp"
+#include "linglong/package/uab_digest.h"
 #include "linglong/utils/error/error.h"
 
 #include <gelf.h>
@@ -25,8 +26,15 @@ public:
     UABFile &operator=(UABFile &&) = delete;
     ~UABFile() override;
 
+    // verify checks the whole bundle section, the chunks are verified in parallel if there is a
+    // digest tree in the metadata
     utils::error::Result<bool> verify() noexcept;
+    // chunkVerifier returns a verifier to check the bundle section lazily while reading it, it's
+    // null if the metadata only has the digest of the whole section
+    utils::error::Result<std::shared_ptr<ChunkVerifier>> chunkVerifier() noexcept;
     utils::error::Result<std::filesystem::path> mountUab() noexcept;
+    // the offset of the erofs image of bundle section in this file
+    utils::error::Result<quint64> bundleOffset() noexcept;
 
     // this method will extract sign data to a temporary directory, caller should remove it
     utils::error::Result<std::filesystem::path> extractSignData() noexcept;
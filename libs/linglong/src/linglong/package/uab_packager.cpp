@@ -7,13 +7,13 @@
 #include "linglong/api/types/v1/Generators.hpp"
 #include "linglong/api/types/v1/Version.hpp"
 #include "linglong/package/architecture.h"
+#include "linglong/package/uab_digest.h"
 #include "linglong/utils/command/env.h"
 #include "linglong/utils/configure.h"
 #include "linglong/utils/serialize/json.h"
 
 #include <yaml-cpp/yaml.h>
 
-#include <QCryptographicHash>
 #include <QStandardPaths>
 
 #include <fstream>
@@ -592,17 +592,19 @@ utils::error::Result<void> UABPackager::packBundle() noexcept
         }
     }
 
-    // calculate digest
+    // calculate the digest of the whole bundle for old installers and the digest tree
     QFile bundle{ bundleFile };
     if (!bundle.open(QIODevice::ReadOnly | QIODevice::ExistingOnly)) {
         return LINGLONG_ERR(bundle);
     }
 
-    QCryptographicHash cryptor{ QCryptographicHash::Sha256 };
-    if (!cryptor.addData(&bundle)) {
-        return LINGLONG_ERR(QString{ "failed to calculate digest from %1: %2" }.arg(bundleFile));
+    auto digest = calculateBundleDigest(bundle.handle(), 0, bundle.size());
+    if (!digest) {
+        return LINGLONG_ERR(QString{ "failed to calculate digest from %1" }.arg(bundleFile),
+                            digest);
     }
-    this->meta.digest = cryptor.result().toHex().toStdString();
+    this->meta.digest = std::move(digest->digest);
+    this->meta.digestTree = std::move(digest->tree);
     const auto *bundleSection = "linglong.bundle";
     if (auto ret = this->uab.addNewSection(bundleSection, QFileInfo{ bundleFile }); !ret) {
         return LINGLONG_ERR(ret);
@@ -30,6 +30,7 @@
 #include <QUuid>
 
 #include <algorithm>
+#include <cerrno>
 #include <utility>
 
 #include <fcntl.h>
@@ -116,9 +117,16 @@ PackageManager::PackageManager(linglong::repo::OSTreeRepo &repo, QObject *parent
           }
           // start next task
           this->runningTaskObjectPath = taskObjectPath;
-          if (this->taskList.empty()) {
+          // the shared info is updated once all queued tasks are done, so the clients see the
+          // exported entries without waiting for the debounce
+          auto queued = std::any_of(taskList.cbegin(), taskList.cend(), [](auto *task) {
+              return task->getJob().has_value()
+                && task->state() == linglong::api::types::v1::State::Queued;
+          });
+          if (!queued) {
+              this->repo.flushSharedInfo();
               return;
-          };
+          }
           for (auto it = taskList.begin(); it != taskList.end(); ++it) {
               auto *task = *it;
               if (!task->getJob().has_value()
@@ -637,6 +645,7 @@ QVariantMap PackageManager::installFromLayer(const QDBusUnixFileDescriptor &fd,
        &taskRef,
        packageRef,
        layerFile = *layerFileRet,
+       info = packageInfo,
        module = packageInfo.packageInfoV2Module,
        options,
        msgType,
@@ -673,35 +682,42 @@ QVariantMap PackageManager::installFromLayer(const QDBusUnixFileDescriptor &fd,
           taskRef.updateSubState(linglong::api::types::v1::SubState::PreAction,
                                  "preparing environment");
 
-          package::LayerPackager layerPackager;
-          auto layerDir = layerPackager.unpack(*layerFile);
-          if (!layerDir) {
-              taskRef.reportError(std::move(layerDir).error());
+          auto offset = layerFile->binaryDataOffset();
+          if (!offset) {
+              taskRef.reportError(std::move(offset).error());
               return;
           }
 
-          auto unmountLayer = utils::finally::finally([mountPoint = layerDir->absolutePath()] {
-              if (QFileInfo::exists(mountPoint)) {
-                  auto ret = utils::command::Exec("umount", { mountPoint });
-                  if (!ret) {
-                      qCritical() << "failed to umount " << mountPoint
-                                  << ", please umount it manually";
-                  }
-              }
-          });
-
-          auto info = (*layerDir).info();
-          if (!info) {
-              taskRef.reportError(std::move(info).error());
-              return;
-          }
-
-          pullDependency(taskRef, *info, module);
+          pullDependency(taskRef, info, module);
           if (isTaskDone(taskRef.subState())) {
               return;
           }
 
-          auto result = this->repo.importLayerDir(*layerDir);
+          // import the erofs image directly, mount it if the image uses the features which the
+          // importer doesn't support, the other errors aren't hidden by the fallback
+          auto result = this->repo.importErofsLayer(layerFile->fileName(), *offset);
+          if (!result && result.error().code() == ENOTSUP) {
+              qInfo() << "fallback to import the mounted layer:" << result.error().message();
+
+              package::LayerPackager layerPackager;
+              auto layerDir = layerPackager.unpack(*layerFile);
+              if (!layerDir) {
+                  taskRef.reportError(std::move(layerDir).error());
+                  return;
+              }
+
+              auto unmountLayer = utils::finally::finally([mountPoint = layerDir->absolutePath()] {
+                  if (QFileInfo::exists(mountPoint)) {
+                      auto ret = utils::command::Exec("umount", { mountPoint });
+                      if (!ret) {
+                          qCritical() << "failed to umount " << mountPoint
+                                      << ", please umount it manually";
+                      }
+                  }
+              });
+
+              result = this->repo.importLayerDir(*layerDir);
+          }
           if (!result) {
               taskRef.reportError(std::move(result).error());
               return;
@@ -717,12 +733,12 @@ QVariantMap PackageManager::installFromLayer(const QDBusUnixFileDescriptor &fd,
           taskRef.updateState(linglong::api::types::v1::State::Succeed,
                               "install layer successfully");
 
-          if (info->kind != "app") {
+          if (info.kind != "app") {
               return;
           }
 
           if (!localRef) {
-              auto newRef = package::Reference::fromPackageInfo(*info);
+              auto newRef = package::Reference::fromPackageInfo(info);
               if (!newRef) {
                   taskRef.reportError(std::move(newRef).error());
                   return;
@@ -737,7 +753,7 @@ QVariantMap PackageManager::installFromLayer(const QDBusUnixFileDescriptor &fd,
               return;
           }
 
-          auto newRef = package::Reference::fromPackageInfo(*info);
+          auto newRef = package::Reference::fromPackageInfo(info);
           if (!newRef) {
               taskRef.reportError(std::move(newRef).error());
               return;
@@ -772,12 +788,19 @@ QVariantMap PackageManager::installFromUAB(const QDBusUnixFileDescriptor &fd,
     }
 
     const auto &uab = *uabRet;
-    auto verifyRet = uab->verify();
-    if (!verifyRet) {
-        return toDBusReply(verifyRet);
+    // the bundle with a digest tree is verified lazily while importing its layers
+    auto verifierRet = uab->chunkVerifier();
+    if (!verifierRet) {
+        return toDBusReply(verifierRet);
     }
-    if (!*verifyRet) {
-        return toDBusReply(-1, "couldn't pass uab verification");
+    if (!*verifierRet) {
+        auto verifyRet = uab->verify();
+        if (!verifyRet) {
+            return toDBusReply(verifyRet);
+        }
+        if (!*verifyRet) {
+            return toDBusReply(-1, "couldn't pass uab verification");
+        }
     }
 
     auto realFile = uab->symLinkTarget();
@@ -896,6 +919,7 @@ QVariantMap PackageManager::installFromUAB(const QDBusUnixFileDescriptor &fd,
                       fdDup = fd, // keep file descriptor don't close by the destructor of
                                   // QDBusUnixFileDescriptor
                       uab = std::move(uabRet).value(),
+                      verifier = std::move(verifierRet).value(),
                       layerInfos = std::move(layerInfos),
                       metaInfo = std::move(metaInfoRet).value(),
                       options,
@@ -935,59 +959,96 @@ QVariantMap PackageManager::installFromUAB(const QDBusUnixFileDescriptor &fd,
         taskRef.updateSubState(linglong::api::types::v1::SubState::PreAction,
                                "prepare environment");
 
-        auto mountPoint = uab->mountUab();
-        if (!mountPoint) {
-            taskRef.reportError(std::move(mountPoint).error());
-            return;
-        }
-
-        if (isTaskDone(taskRef.subState())) {
+        auto bundleOffset = uab->bundleOffset();
+        if (!bundleOffset) {
+            taskRef.reportError(std::move(bundleOffset).error());
             return;
         }
 
-        auto uabLayersDir = *mountPoint / "layers";
-        const auto &uabLayersDirInfo = QFileInfo{ uabLayersDir.c_str() };
-        if (!uabLayersDirInfo.exists() || !uabLayersDirInfo.isDir()) {
-            taskRef.updateState(linglong::api::types::v1::State::Failed,
-                                "the contents of this uab file are invalid");
-            return;
-        }
-
-        utils::Transaction transaction;
-        for (const auto &layer : layerInfos) {
-            if (isTaskDone(taskRef.subState())) {
-                return;
+        // layers are imported from the erofs image of bundle directly, the bundle is mounted only
+        // if the image can't be read by the importer
+        std::optional<std::filesystem::path> mountPoint;
+        package::ErofsImage::Verifier verifyRange;
+        if (verifier) {
+            verifyRange = [&verifier](quint64 pos, std::size_t size) {
+                return verifier->verifyRange(pos, size);
+            };
+        }
+        auto importLayer = [this, &uab, &verifier, &verifyRange, &bundleOffset, &mountPoint](
+                             const api::types::v1::UabLayer &layer,
+                             const std::vector<std::filesystem::path> &overlays,
+                             const std::optional<std::string> &subRef)
+          -> utils::error::Result<package::LayerDir> {
+            LINGLONG_TRACE(QString{ "import layer %1" }.arg(layer.info.id.c_str()));
+
+            auto layerPath =
+              std::filesystem::path{ "layers" } / layer.info.id / layer.info.packageInfoV2Module;
+            auto ret = this->repo.importErofsLayer(uab->fileName(),
+                                                   *bundleOffset,
+                                                   layerPath.string(),
+                                                   overlays,
+                                                   subRef,
+                                                   verifyRange);
+            if (ret) {
+                return ret;
+            }
+            if (ret.error().code() == EBADMSG) {
+                return LINGLONG_ERR("couldn't pass uab verification", ret);
+            }
+            // only the features which the importer doesn't support are left to the kernel
+            if (ret.error().code() != ENOTSUP) {
+                return LINGLONG_ERR(ret);
+            }
+            qInfo() << "fallback to import the mounted layer:" << ret.error().message();
+
+            if (!mountPoint) {
+                // the mounted bundle can't be verified lazily
+                if (verifier) {
+                    auto verified = verifier->verifyAll();
+                    if (!verified) {
+                        return LINGLONG_ERR("couldn't pass uab verification", verified);
+                    }
+                }
+                auto mounted = uab->mountUab();
+                if (!mounted) {
+                    return LINGLONG_ERR(mounted);
+                }
+                mountPoint = *mounted;
             }
 
             std::error_code ec;
-            auto layerDirPath = uabLayersDir / layer.info.id / layer.info.packageInfoV2Module;
+            auto layerDirPath = *mountPoint / layerPath;
             if (!std::filesystem::exists(layerDirPath, ec)) {
                 if (ec) {
-                    taskRef.updateState(linglong::api::types::v1::State::Failed,
-                                        QString{ "get status of" } % layerDirPath.c_str()
-                                          % "failed:" % ec.message().c_str());
-                    return;
+                    return LINGLONG_ERR(QString{ "get status of %1 failed: %2" }.arg(
+                      layerDirPath.c_str(),
+                      ec.message().c_str()));
                 }
+                return LINGLONG_ERR(
+                  QString{ "layer directory %1 doesn't exist" }.arg(layerDirPath.c_str()));
+            }
+
+            ret = this->repo.importLayerDir(package::LayerDir{ layerDirPath.c_str() },
+                                            overlays,
+                                            subRef);
+            if (!ret) {
+                return LINGLONG_ERR(ret);
+            }
+            return ret;
+        };
 
-                taskRef.updateState(linglong::api::types::v1::State::Failed,
-                                    QString{ "layer directory " } % layerDirPath.c_str()
-                                      % " doesn't exist");
+        utils::Transaction transaction;
+        for (const auto &layer : layerInfos) {
+            if (isTaskDone(taskRef.subState())) {
                 return;
             }
 
-            const auto &layerDir = package::LayerDir{ layerDirPath.c_str() };
             std::optional<std::string> subRef{ std::nullopt };
             if (layer.minified) {
                 subRef = metaInfo.get().uuid;
             }
 
-            auto infoRet = layerDir.info();
-            if (!infoRet) {
-                taskRef.reportError(std::move(infoRet).error());
-                return;
-            }
-            auto &info = *infoRet;
-
+            auto info = layer.info;
             auto refRet = package::Reference::fromPackageInfo(info);
             if (!refRet) {
                 taskRef.reportError(std::move(refRet).error());
@@ -1025,7 +1086,7 @@ QVariantMap PackageManager::installFromUAB(const QDBusUnixFileDescriptor &fd,
                 }
             }
 
-            auto ret = this->repo.importLayerDir(layerDir, overlays, subRef);
+            auto ret = importLayer(layer, overlays, subRef);
             if (!ret) {
                 taskRef.reportError(std::move(ret).error());
                 return;
@@ -0,0 +1,246 @@
+/*
+ * SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#include "linglong/repo/erofs_importer.h"
+
+#include <gio/gunixinputstream.h>
+#include <sys/stat.h>
+
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace linglong::repo {
+
+namespace {
+
+// files larger than this are decoded to an unnamed temporary file instead of memory
+constexpr quint64 maxInMemorySize = 4 * 1024 * 1024;
+
+struct ImportContext
+{
+    OstreeRepo *repo;
+    const package::ErofsImage &image;
+    // hard links share the same inode, only write them once
+    std::unordered_map<quint64, std::string> written;
+};
+
+utils::error::Result<GInputStream *> openContent(const ImportContext &ctx,
+                                                 const package::ErofsImage::Inode &inode) noexcept
+{
+    LINGLONG_TRACE(QString{ "open content of inode %1" }.arg(inode.nid));
+
+    if (inode.size <= maxInMemorySize) {
+        auto data = ctx.image.readAll(inode);
+        if (!data) {
+            return LINGLONG_ERR(data);
+        }
+        g_autoptr(GBytes) bytes = g_bytes_new(data->constData(), data->size());
+        return g_memory_input_stream_new_from_bytes(bytes);
+    }
+
+    auto fd = ::openat(ostree_repo_get_dfd(ctx.repo), "tmp", O_TMPFILE | O_RDWR | O_CLOEXEC, 0600);
+    if (fd == -1) {
+        return LINGLONG_ERR(QString{ "open temporary file: %1" }.arg(::strerror(errno)), errno);
+    }
+    // the stream takes the ownership of fd
+    g_autoptr(GInputStream) stream = g_unix_input_stream_new(fd, TRUE);
+
+    auto ret = ctx.image.readData(inode, [fd](const char *data,
+                                              std::size_t size) -> utils::error::Result<void> {
+        LINGLONG_TRACE("write temporary file");
+        while (size > 0) {
+            auto n = ::write(fd, data, size);
+            if (n == -1) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return LINGLONG_ERR(::strerror(errno), errno);
+            }
+            data += n;
+            size -= n;
+        }
+        return LINGLONG_OK;
+    });
+    if (!ret) {
+        return LINGLONG_ERR(ret);
+    }
+
+    if (::lseek(fd, 0, SEEK_SET) == -1) {
+        return LINGLONG_ERR(QString{ "lseek: %1" }.arg(::strerror(errno)), errno);
+    }
+
+    return static_cast<GInputStream *>(g_steal_pointer(&stream));
+}
+
+utils::error::Result<std::string> writeContent(ImportContext &ctx,
+                                               const package::ErofsImage::Inode &inode) noexcept
+{
+    LINGLONG_TRACE(QString{ "write content of inode %1" }.arg(inode.nid));
+
+    if (inode.nlink > 1) {
+        auto it = ctx.written.find(inode.nid);
+        if (it != ctx.written.end()) {
+            return it->second;
+        }
+    }
+
+    g_autoptr(GFileInfo) info = g_file_info_new();
+    g_file_info_set_attribute_uint32(info, "unix::uid", 0);
+    g_file_info_set_attribute_uint32(info, "unix::gid", 0);
+
+    g_autoptr(GInputStream) input = nullptr;
+    if (S_ISREG(inode.mode)) {
+        g_file_info_set_file_type(info, G_FILE_TYPE_REGULAR);
+        // squash the s{ug}id and sticky bits like the canonical permissions modifier
+        g_file_info_set_attribute_uint32(info, "unix::mode", inode.mode & (S_IFREG | 0755));
+        g_file_info_set_size(info, static_cast<goffset>(inode.size));
+
+        auto stream = openContent(ctx, inode);
+        if (!stream) {
+            return LINGLONG_ERR(stream);
+        }
+        input = *stream;
+    } else if (S_ISLNK(inode.mode)) {
+        auto target = ctx.image.readAll(inode);
+        if (!target) {
+            return LINGLONG_ERR(target);
+        }
+        g_file_info_set_file_type(info, G_FILE_TYPE_SYMBOLIC_LINK);
+        g_file_info_set_attribute_uint32(info, "unix::mode", inode.mode);
+        g_file_info_set_is_symlink(info, TRUE);
+        g_file_info_set_symlink_target(info, target->constData());
+        g_file_info_set_size(info, 0);
+    } else {
+        return LINGLONG_ERR(QString{ "unsupported file type of mode %1" }.arg(inode.mode, 0, 8),
+                            ENOTSUP);
+    }
+
+    g_autoptr(GError) gErr = nullptr;
+    g_autoptr(GInputStream) content = nullptr;
+    guint64 length = 0;
+    if (ostree_raw_file_to_content_stream(input, info, nullptr, &content, &length, nullptr, &gErr)
+        == FALSE) {
+        return LINGLONG_ERR("ostree_raw_file_to_content_stream", gErr);
+    }
+
+    g_autofree guchar *csum = nullptr;
+    if (ostree_repo_write_content(ctx.repo, nullptr, content, length, &csum, nullptr, &gErr)
+        == FALSE) {
+        return LINGLONG_ERR("ostree_repo_write_content", gErr);
+    }
+
+    g_autofree char *hex = ostree_checksum_from_bytes(csum);
+    std::string checksum = hex;
+    if (inode.nlink > 1) {
+        ctx.written.emplace(inode.nid, checksum);
+    }
+    return checksum;
+}
+
+utils::error::Result<void> writeDirMeta(ImportContext &ctx,
+                                        const package::ErofsImage::Inode &dir,
+                                        OstreeMutableTree *mtree) noexcept
+{
+    LINGLONG_TRACE(QString{ "write metadata of directory %1" }.arg(dir.nid));
+
+    g_autoptr(GFileInfo) info = g_file_info_new();
+    g_file_info_set_file_type(info, G_FILE_TYPE_DIRECTORY);
+    g_file_info_set_attribute_uint32(info, "unix::uid", 0);
+    g_file_info_set_attribute_uint32(info, "unix::gid", 0);
+    g_file_info_set_attribute_uint32(info, "unix::mode", dir.mode & (S_IFDIR | 0755));
+
+    g_autoptr(GVariant) dirmeta = ostree_create_directory_metadata(info, nullptr);
+    g_autoptr(GError) gErr = nullptr;
+    g_autofree guchar *csum = nullptr;
+    if (ostree_repo_write_metadata(ctx.repo,
+                                   OSTREE_OBJECT_TYPE_DIR_META,
+                                   nullptr,
+                                   dirmeta,
+                                   &csum,
+                                   nullptr,
+                                   &gErr)
+        == FALSE) {
+        return LINGLONG_ERR("ostree_repo_write_metadata", gErr);
+    }
+
+    g_autofree char *checksum = ostree_checksum_from_bytes(csum);
+    ostree_mutable_tree_set_metadata_checksum(mtree, checksum);
+    return LINGLONG_OK;
+}
+
+utils::error::Result<void> writeDir(ImportContext &ctx,
+                                    const package::ErofsImage::Inode &dir,
+                                    OstreeMutableTree *mtree) noexcept
+{
+    LINGLONG_TRACE(QString{ "write directory %1" }.arg(dir.nid));
+
+    auto ret = writeDirMeta(ctx, dir, mtree);
+    if (!ret) {
+        return LINGLONG_ERR(ret);
+    }
+
+    auto entries = ctx.image.readDir(dir);
+    if (!entries) {
+        return LINGLONG_ERR(entries);
+    }
+
+    g_autoptr(GError) gErr = nullptr;
+    for (const auto &entry : *entries) {
+        auto inode = ctx.image.inode(entry.nid);
+        if (!inode) {
+            return LINGLONG_ERR(inode);
+        }
+
+        if (S_ISDIR(inode->mode)) {
+            g_autoptr(OstreeMutableTree) subtree = nullptr;
+            if (ostree_mutable_tree_ensure_dir(mtree, entry.name.c_str(), &subtree, &gErr)
+                == FALSE) {
+                return LINGLONG_ERR("ostree_mutable_tree_ensure_dir", gErr);
+            }
+            ret = writeDir(ctx, *inode, subtree);
+            if (!ret) {
+                return LINGLONG_ERR(QString::fromStdString(entry.name), ret);
+            }
+            continue;
+        }
+
+        auto checksum = writeContent(ctx, *inode);
+        if (!checksum) {
+            return LINGLONG_ERR(QString::fromStdString(entry.name), checksum);
+        }
+        if (ostree_mutable_tree_replace_file(mtree, entry.name.c_str(), checksum->c_str(), &gErr)
+            == FALSE) {
+            return LINGLONG_ERR("ostree_mutable_tree_replace_file", gErr);
+        }
+    }
+
+    return LINGLONG_OK;
+}
+
+} // namespace
+
+utils::error::Result<void> writeErofsToMtree(OstreeRepo *repo,
+                                             const package::ErofsImage &image,
+                                             const package::ErofsImage::Inode &dir,
+                                             OstreeMutableTree *mtree) noexcept
+{
+    LINGLONG_TRACE("write erofs image to ostree mutable tree");
+
+    ImportContext ctx{ repo, image, {} };
+    auto ret = writeDir(ctx, dir, mtree);
+    if (!ret) {
+        return LINGLONG_ERR(ret);
+    }
+
+    return LINGLONG_OK;
+}
+
+} // namespace linglong::repo
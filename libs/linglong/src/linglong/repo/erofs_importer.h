@@ -0,0 +1,24 @@
+/*
+ * SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#pragma once
+
+#include "linglong/package/erofs_image.h"
+#include "linglong/utils/error/error.h"
+
+#include <ostree.h>
+
+namespace linglong::repo {
+
+// writeErofsToMtree writes the directory dir of an erofs image to mtree, the result is the same as
+// ostree_repo_write_directory_to_mtree with OSTREE_REPO_COMMIT_MODIFIER_FLAGS_CANONICAL_PERMISSIONS
+// on the mounted directory. It must be called in a transaction of repo.
+utils::error::Result<void> writeErofsToMtree(OstreeRepo *repo,
+                                             const package::ErofsImage &image,
+                                             const package::ErofsImage::Inode &dir,
+                                             OstreeMutableTree *mtree) noexcept;
+
+} // namespace linglong::repo
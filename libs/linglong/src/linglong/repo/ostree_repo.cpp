@@ -11,11 +11,13 @@
 #include "linglong/api/types/v1/PackageInfoV2.hpp"
 #include "linglong/api/types/v1/RepositoryCacheLayersItem.hpp"
 #include "linglong/api/types/v1/RepositoryCacheMergedItem.hpp"
+#include "linglong/package/erofs_image.h"
 #include "linglong/package/fuzzy_reference.h"
 #include "linglong/package/layer_dir.h"
 #include "linglong/package/reference.h"
 #include "linglong/package_manager/package_task.h"
 #include "linglong/repo/config.h"
+#include "linglong/repo/erofs_importer.h"
 #include "linglong/utils/command/env.h"
 #include "linglong/utils/error/error.h"
 #include "linglong/utils/finally/finally.h"
@@ -24,9 +26,10 @@
 
 #include <gio/gio.h>
 #include <glib.h>
-#include <nlohmann/json_fwd.hpp>
+#include <nlohmann/json.hpp>
 #include <ostree-repo.h>
 
+#include <QCoreApplication>
 #include <QCryptographicHash>
 #include <QDebug>
 #include <QDir>
@@ -42,6 +45,7 @@
 #include <cstdlib>
 #include <cstring>
 #include <filesystem>
+#include <functional>
 #include <future>
 #include <iostream>
 #include <map>
@@ -282,11 +286,12 @@ ostreeSpecFromReferenceV2(const package::Reference &ref,
     return ret + "_" + subRef.value();
 }
 
-utils::error::Result<QString> commitDirToRepo(std::vector<GFile *> dirs,
-                                              OstreeRepo *repo,
-                                              const char *refspec) noexcept
+// commitToRepo commits the mutable tree filled by fill to the refspec of repo
+utils::error::Result<QString>
+commitToRepo(OstreeRepo *repo,
+             const char *refspec,
+             const std::function<utils::error::Result<void>(OstreeMutableTree *)> &fill) noexcept
 {
-    Q_ASSERT(dirs.size() >= 1);
     Q_ASSERT(repo != nullptr);
 
     LINGLONG_TRACE("commit to ostree linglong repo");
@@ -305,22 +310,9 @@ utils::error::Result<QString> commitDirToRepo(std::vector<GFile *> dirs,
     });
 
     g_autoptr(OstreeMutableTree) mtree = ostree_mutable_tree_new();
-    g_autoptr(OstreeRepoCommitModifier) modifier = nullptr;
-    modifier =
-      ostree_repo_commit_modifier_new(OSTREE_REPO_COMMIT_MODIFIER_FLAGS_CANONICAL_PERMISSIONS,
-                                      nullptr,
-                                      nullptr,
-                                      nullptr);
-    Q_ASSERT(modifier != nullptr);
-    if (modifier == nullptr) {
-        return LINGLONG_ERR("ostree_repo_commit_modifier_new return a nullptr");
-    }
-
-    for (auto *dir : dirs) {
-        if (ostree_repo_write_directory_to_mtree(repo, dir, mtree, modifier, nullptr, &gErr)
-            == FALSE) {
-            return LINGLONG_ERR("ostree_repo_write_directory_to_mtree", gErr);
-        }
+    auto ret = fill(mtree);
+    if (!ret) {
+        return LINGLONG_ERR(ret);
     }
 
     g_autoptr(GFile) file = nullptr;
@@ -353,6 +345,47 @@ utils::error::Result<QString> commitDirToRepo(std::vector<GFile *> dirs,
     return commit;
 }
 
+// writeDirsToMtree writes dirs to mtree in order, files in the later directories overwrite the
+// files with the same path in the former ones
+utils::error::Result<void> writeDirsToMtree(OstreeRepo *repo,
+                                            const std::vector<GFile *> &dirs,
+                                            OstreeMutableTree *mtree) noexcept
+{
+    LINGLONG_TRACE("write directories to ostree mutable tree");
+
+    g_autoptr(GError) gErr = nullptr;
+    g_autoptr(OstreeRepoCommitModifier) modifier = nullptr;
+    modifier =
+      ostree_repo_commit_modifier_new(OSTREE_REPO_COMMIT_MODIFIER_FLAGS_CANONICAL_PERMISSIONS,
+                                      nullptr,
+                                      nullptr,
+                                      nullptr);
+    Q_ASSERT(modifier != nullptr);
+    if (modifier == nullptr) {
+        return LINGLONG_ERR("ostree_repo_commit_modifier_new return a nullptr");
+    }
+
+    for (auto *dir : dirs) {
+        if (ostree_repo_write_directory_to_mtree(repo, dir, mtree, modifier, nullptr, &gErr)
+            == FALSE) {
+            return LINGLONG_ERR("ostree_repo_write_directory_to_mtree", gErr);
+        }
+    }
+
+    return LINGLONG_OK;
+}
+
+utils::error::Result<QString> commitDirToRepo(std::vector<GFile *> dirs,
+                                              OstreeRepo *repo,
+                                              const char *refspec) noexcept
+{
+    Q_ASSERT(dirs.size() >= 1);
+
+    return commitToRepo(repo, refspec, [repo, &dirs](OstreeMutableTree *mtree) {
+        return writeDirsToMtree(repo, dirs, mtree);
+    });
+}
+
 utils::error::Result<void> updateOstreeRepoConfig(OstreeRepo *repo,
                                                   const QString &remoteName,
                                                   const QString &url,
@@ -669,6 +702,8 @@ OSTreeRepo::OSTreeRepo(const QDir &path,
                        const api::types::v1::RepoConfig &cfg,
                        ClientFactory &clientFactory) noexcept
     : cfg(cfg)
+    , sharedInfoUpdater(
+        std::make_unique<SharedInfoUpdater>(QDir(path.absoluteFilePath("entries/share"))))
     , m_clientFactory(clientFactory)
 {
     if (!path.exists()) {
@@ -682,6 +717,11 @@ OSTreeRepo::OSTreeRepo(const QDir &path,
         qFatal("%s", msg.c_str());
     }
 
+    // the pending regeneration is run before the event loop exits, the repository might outlive it
+    if (auto *app = QCoreApplication::instance(); app != nullptr) {
+        QObject::connect(app, &QCoreApplication::aboutToQuit, this, &OSTreeRepo::flushSharedInfo);
+    }
+
     g_autoptr(GError) gErr = nullptr;
     g_autoptr(GFile) repoPath = nullptr;
     g_autoptr(OstreeRepo) ostreeRepo = nullptr;
@@ -848,8 +888,6 @@ OSTreeRepo::importLayerDir(const package::LayerDir &dir,
         return LINGLONG_ERR(QString("layer directory %1 not exists").arg(dir.absolutePath()));
     }
 
-    utils::Transaction transaction;
-
     auto info = dir.info();
     if (!info) {
         return LINGLONG_ERR(info);
@@ -889,13 +927,128 @@ OSTreeRepo::importLayerDir(const package::LayerDir &dir,
         return LINGLONG_ERR(commitID);
     }
 
+    auto layerDir = this->checkoutImportedLayer(*commitID, *info);
+    if (!layerDir) {
+        return LINGLONG_ERR(layerDir);
+    }
+
+    return layerDir;
+}
+
+utils::error::Result<package::LayerDir>
+OSTreeRepo::importErofsLayer(const QString &file,
+                             quint64 offset,
+                             const std::string &subDir,
+                             const std::vector<std::filesystem::path> &overlays,
+                             const std::optional<std::string> &subRef,
+                             const package::ErofsImage::Verifier &verifier) noexcept
+{
+    LINGLONG_TRACE(QString{ "import erofs image %1 at offset %2" }.arg(file).arg(offset));
+
+    auto image = package::ErofsImage::New(file, offset, verifier);
+    if (!image) {
+        return LINGLONG_ERR(image);
+    }
+
+    auto dir = (*image)->lookup(subDir);
+    if (!dir) {
+        return LINGLONG_ERR(dir);
+    }
+
+    auto infoInode = (*image)->lookup(subDir + "/info.json");
+    if (!infoInode) {
+        return LINGLONG_ERR(infoInode);
+    }
+
+    auto content = (*image)->readAll(*infoInode);
+    if (!content) {
+        return LINGLONG_ERR(content);
+    }
+
+    nlohmann::json json;
+    try {
+        json = nlohmann::json::parse(content->toStdString());
+    } catch (...) {
+        return LINGLONG_ERR("parse info.json", std::current_exception());
+    }
+
+    auto info = utils::parsePackageInfo(json);
+    if (!info) {
+        return LINGLONG_ERR(info);
+    }
+
+    auto reference = package::Reference::fromPackageInfo(*info);
+    if (!reference) {
+        return LINGLONG_ERR(reference);
+    }
+
+    if (this->getLayerDir(*reference, info->packageInfoV2Module, subRef)) {
+        return LINGLONG_ERR(reference->toString() + " exists.", 0);
+    }
+
+    std::vector<GFile *> dirs;
+    auto cleanRes = utils::finally::finally([&dirs] {
+        std::for_each(dirs.begin(), dirs.end(), [](GFile *file) {
+            g_object_unref(file);
+        });
+    });
+
+    for (const auto &overlay : overlays) {
+        auto *gFile = g_file_new_for_path(overlay.c_str());
+        if (gFile == nullptr) {
+            qFatal("g_file_new_for_path");
+        }
+        dirs.push_back(gFile);
+    }
+
+    auto refspec =
+      ostreeSpecFromReferenceV2(*reference, std::nullopt, info->packageInfoV2Module, subRef);
+    auto *repo = this->ostreeRepo.get();
+    auto commitID = commitToRepo(
+      repo,
+      refspec.c_str(),
+      [repo, &image, &dir, &dirs](OstreeMutableTree *mtree) -> utils::error::Result<void> {
+          LINGLONG_TRACE("write layer to ostree mutable tree");
+
+          auto ret = writeErofsToMtree(repo, **image, *dir, mtree);
+          if (!ret) {
+              return LINGLONG_ERR(ret);
+          }
+
+          ret = writeDirsToMtree(repo, dirs, mtree);
+          if (!ret) {
+              return LINGLONG_ERR(ret);
+          }
+
+          return LINGLONG_OK;
+      });
+    if (!commitID) {
+        return LINGLONG_ERR(commitID);
+    }
+
+    auto layerDir = this->checkoutImportedLayer(*commitID, *info);
+    if (!layerDir) {
+        return LINGLONG_ERR(layerDir);
+    }
+
+    return layerDir;
+}
+
+utils::error::Result<package::LayerDir>
+OSTreeRepo::checkoutImportedLayer(const QString &commitID,
+                                  const api::types::v1::PackageInfoV2 &info) noexcept
+{
+    LINGLONG_TRACE("checkout imported layer " + commitID);
+
+    utils::Transaction transaction;
+
     api::types::v1::RepositoryCacheLayersItem item;
 
-    item.commit = (*commitID).toStdString();
-    item.info = *info;
+    item.commit = commitID.toStdString();
+    item.info = info;
     item.repo = "local";
 
-    auto layerDir = this->ensureEmptyLayerDir((*commitID).toStdString());
+    auto layerDir = this->ensureEmptyLayerDir(item.commit);
     if (!layerDir) {
         return LINGLONG_ERR(layerDir);
     }
@@ -1112,7 +1265,7 @@ void OSTreeRepo::pull(service::PackageTask &taskContext,
 {
     // Note: if module is runtime, refString will be channel:id/version/binary.
     // because we need considering update channel:id/version/runtime to channel:id/version/binary.
-    auto refString = ostreeSpecFromReferenceV2(reference, std::nullopt, module);
+    const auto refString = ostreeSpecFromReferenceV2(reference, std::nullopt, module);
     LINGLONG_TRACE("pull " + QString::fromStdString(refString));
 
     utils::Transaction transaction;
@@ -1157,14 +1310,16 @@ void OSTreeRepo::pull(service::PackageTask &taskContext,
         shouldFallback = true;
     }
     // Note: this fallback is only for binary to runtime
+    std::string fallbackRefString;
     if (shouldFallback && (module == "binary" || module == "runtime")) {
         auto *progress = ostree_async_progress_new_and_connect(progress_changed, (void *)&data);
         Q_ASSERT(progress != nullptr);
         // fallback to old ref
-        refString = ostreeSpecFromReference(reference, std::nullopt, module);
-        qWarning() << "fallback to module runtime, pull " << QString::fromStdString(refString);
+        fallbackRefString = ostreeSpecFromReference(reference, std::nullopt, module);
+        qWarning() << "fallback to module runtime, pull "
+                   << QString::fromStdString(fallbackRefString);
 
-        refs[0] = refString.c_str();
+        refs[0] = fallbackRefString.c_str();
         g_clear_error(&gErr);
 
         GVariantBuilder builder;
@@ -1723,38 +1878,12 @@ utils::error::Result<void> OSTreeRepo::exportAllEntries() noexcept
 
 void OSTreeRepo::updateSharedInfo() noexcept
 {
-    LINGLONG_TRACE("update shared info");
-
-    auto applicationDir = QDir(this->repoDir.absoluteFilePath("entries/share/applications"));
-    auto mimeDataDir = QDir(this->repoDir.absoluteFilePath("entries/share/mime"));
-    auto glibSchemasDir = QDir(this->repoDir.absoluteFilePath("entries/share/glib-2.0/schemas"));
-    // 更新 desktop database
-    if (applicationDir.exists()) {
-        auto ret =
-          utils::command::Exec("update-desktop-database", { applicationDir.absolutePath() });
-        if (!ret) {
-            qWarning() << "warning: failed to update desktop database in "
-                + applicationDir.absolutePath() + ": " + ret.error().message();
-        }
-    }
-
-    // 更新 mime type database
-    if (mimeDataDir.exists()) {
-        auto ret = utils::command::Exec("update-mime-database", { mimeDataDir.absolutePath() });
-        if (!ret) {
-            qWarning() << "warning: failed to update mime type database in "
-                + mimeDataDir.absolutePath() + ": " + ret.error().message();
-        }
-    }
+    this->sharedInfoUpdater->schedule();
+}
 
-    // 更新 glib-2.0/schemas
-    if (glibSchemasDir.exists()) {
-        auto ret = utils::command::Exec("glib-compile-schemas", { glibSchemasDir.absolutePath() });
-        if (!ret) {
-            qWarning() << "warning: failed to update schemas in " + glibSchemasDir.absolutePath()
-                + ": " + ret.error().message();
-        }
-    }
+void OSTreeRepo::flushSharedInfo() noexcept
+{
+    this->sharedInfoUpdater->flush();
 }
 
 utils::error::Result<void>
@@ -7,12 +7,14 @@
 #pragma once
 
 #include "linglong/api/types/v1/RepoConfig.hpp"
+#include "linglong/package/erofs_image.h"
 #include "linglong/package/fuzzy_reference.h"
 #include "linglong/package/layer_dir.h"
 #include "linglong/package/reference.h"
 #include "linglong/package_manager/package_task.h"
 #include "linglong/repo/client_factory.h"
 #include "linglong/repo/repo_cache.h"
+#include "linglong/repo/shared_info_updater.h"
 #include "linglong/utils/error/error.h"
 
 #include <ostree.h>
@@ -50,6 +52,16 @@ public:
     importLayerDir(const package::LayerDir &dir,
                    std::vector<std::filesystem::path> overlays = {},
                    const std::optional<std::string> &subRef = std::nullopt) noexcept;
+    // importErofsLayer imports the directory subDir of the erofs image in file at offset without
+    // mounting it, the overlays are written on top of it like importLayerDir. The data read from
+    // the image is checked by verifier if it's set.
+    utils::error::Result<package::LayerDir>
+    importErofsLayer(const QString &file,
+                     quint64 offset,
+                     const std::string &subDir = "",
+                     const std::vector<std::filesystem::path> &overlays = {},
+                     const std::optional<std::string> &subRef = std::nullopt,
+                     const package::ErofsImage::Verifier &verifier = {}) noexcept;
 
     [[nodiscard]] utils::error::Result<package::LayerDir>
     getLayerDir(const package::Reference &ref,
@@ -95,7 +107,11 @@ public:
     void exportReference(const package::Reference &ref) noexcept;
     // unexportReference should be called when LayerDir of ref is existed in local repo
     void unexportReference(const package::Reference &ref) noexcept;
+    // updateSharedInfo schedules a debounced regeneration of the desktop, mime and schemas caches
     void updateSharedInfo() noexcept;
+    // flushSharedInfo runs the pending regeneration immediately, it's called when the event loop
+    // exits and by the package manager once its task queue is drained
+    void flushSharedInfo() noexcept;
     utils::error::Result<void>
     markDeleted(const package::Reference &ref,
                 bool deleted,
@@ -133,12 +149,16 @@ private:
     std::unique_ptr<OstreeRepo, OstreeRepoDeleter> ostreeRepo = nullptr;
     QDir repoDir;
     std::unique_ptr<linglong::repo::RepoCache> cache{ nullptr };
+    std::unique_ptr<SharedInfoUpdater> sharedInfoUpdater{ nullptr };
     ClientFactory &m_clientFactory;
 
     utils::error::Result<void> updateConfig(const api::types::v1::RepoConfig &newCfg) noexcept;
     QDir ostreeRepoDir() const noexcept;
     [[nodiscard]] utils::error::Result<QDir>
     ensureEmptyLayerDir(const std::string &commit) const noexcept;
+    utils::error::Result<package::LayerDir>
+    checkoutImportedLayer(const QString &commitID,
+                          const api::types::v1::PackageInfoV2 &info) noexcept;
     utils::error::Result<void> handleRepositoryUpdate(
       QDir layerDir, const api::types::v1::RepositoryCacheLayersItem &layer) noexcept;
     utils::error::Result<void>
@@ -0,0 +1,144 @@
+/*
+ * SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#include "shared_info_updater.h"
+
+#include "linglong/utils/command/env.h"
+
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QDirIterator>
+
+#include <algorithm>
+
+namespace linglong::repo {
+
+SharedInfoUpdater::SharedInfoUpdater(QDir shareDir, QObject *parent) noexcept
+    : QObject(parent)
+    , shareDir(std::move(shareDir))
+    , runner(utils::command::Exec)
+{
+    using namespace std::chrono_literals;
+    this->timer.setSingleShot(true);
+    this->timer.setInterval(1s);
+    this->timer.callOnTimeout(this, &SharedInfoUpdater::flush);
+}
+
+SharedInfoUpdater::~SharedInfoUpdater()
+{
+    this->flush();
+}
+
+void SharedInfoUpdater::setRunner(Runner runner) noexcept
+{
+    this->runner = std::move(runner);
+}
+
+void SharedInfoUpdater::setDelay(std::chrono::milliseconds delay) noexcept
+{
+    this->timer.setInterval(delay);
+}
+
+void SharedInfoUpdater::schedule() noexcept
+{
+    this->isPending = true;
+    // without an event loop, the pending update will be run by flush or on destruction
+    if (QCoreApplication::instance() == nullptr) {
+        return;
+    }
+    this->timer.start();
+}
+
+void SharedInfoUpdater::flush() noexcept
+{
+    this->timer.stop();
+    if (!this->isPending) {
+        return;
+    }
+    this->isPending = false;
+    this->update();
+}
+
+const std::vector<SharedInfoUpdater::Cache> &SharedInfoUpdater::caches() noexcept
+{
+    static const std::vector<Cache> caches{
+        { "update-desktop-database", "applications", ".", { "*.desktop" }, "mimeinfo.cache", true },
+        { "update-mime-database", "mime", "packages", { "*.xml" }, "mime.cache", false },
+        { "glib-compile-schemas",
+          "glib-2.0/schemas",
+          ".",
+          { "*.gschema.xml", "*.gschema.override" },
+          "gschemas.compiled",
+          false },
+    };
+    return caches;
+}
+
+QByteArray SharedInfoUpdater::fingerprint(const Cache &cache) const noexcept
+{
+    QDir dir(this->shareDir.absoluteFilePath(cache.dir));
+    QDir sourceDir(dir.absoluteFilePath(cache.sourceDir));
+    if (!sourceDir.exists()) {
+        return {};
+    }
+
+    // files in entries are symlinks to the layers, the link target changes when a layer changes
+    QStringList entries;
+    QDirIterator it(sourceDir.absolutePath(),
+                    cache.nameFilters,
+                    QDir::Files | QDir::System | QDir::Hidden,
+                    cache.recursive ? QDirIterator::Subdirectories : QDirIterator::NoIteratorFlags);
+    while (it.hasNext()) {
+        it.next();
+        const auto info = it.fileInfo();
+        entries.append(QString("%1\n%2\n%3\n%4")
+                         .arg(sourceDir.relativeFilePath(info.absoluteFilePath()),
+                              info.symLinkTarget(),
+                              QString::number(info.size()),
+                              QString::number(info.lastModified().toMSecsSinceEpoch())));
+    }
+    std::sort(entries.begin(), entries.end());
+
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    for (const auto &entry : entries) {
+        hash.addData(entry.toUtf8());
+        hash.addData("\0", 1);
+    }
+    return hash.result();
+}
+
+void SharedInfoUpdater::update() noexcept
+{
+    for (const auto &cache : caches()) {
+        QDir dir(this->shareDir.absoluteFilePath(cache.dir));
+        if (!dir.exists()) {
+            this->fingerprints.remove(cache.program);
+            continue;
+        }
+
+        auto current = this->fingerprint(cache);
+        auto last = this->fingerprints.constFind(cache.program);
+        auto unchanged = last != this->fingerprints.constEnd() && *last == current;
+        if (unchanged && dir.exists(cache.output)) {
+            qDebug() << "skip" << cache.program << "for" << dir.absolutePath()
+                     << ": nothing changed";
+            continue;
+        }
+
+        auto ret = this->runner(cache.program, { dir.absolutePath() });
+        if (!ret) {
+            qWarning() << "warning: failed to run" << cache.program << "in" << dir.absolutePath()
+                       << ":" << ret.error().message();
+            this->fingerprints.remove(cache.program);
+            continue;
+        }
+        this->fingerprints.insert(cache.program, current);
+    }
+}
+
+} // namespace linglong::repo
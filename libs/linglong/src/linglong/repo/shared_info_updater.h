@@ -0,0 +1,78 @@
+/*
+ * SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#pragma once
+
+#include "linglong/utils/error/error.h"
+
+#include <QDir>
+#include <QHash>
+#include <QObject>
+#include <QStringList>
+#include <QTimer>
+
+#include <chrono>
+#include <functional>
+#include <vector>
+
+namespace linglong::repo {
+
+// SharedInfoUpdater regenerates the desktop, mime and glib schemas caches under entries/share.
+// Requests are debounced, so a batch of install/uninstall/export operations only triggers a
+// single run, and each cache is only rebuilt when its source files have changed.
+//
+// The generators run on the thread of the event loop and block it. The tasks of the package
+// manager export and unexport entries on the same thread, so a run never sees entries/share
+// changing under it and never records the fingerprint of a half-updated directory. Since the
+// unchanged caches are skipped, a run is usually short compared to the tasks.
+class SharedInfoUpdater : public QObject
+{
+    Q_OBJECT
+public:
+    using Runner =
+      std::function<utils::error::Result<QString>(const QString &program, const QStringList &args)>;
+
+    explicit SharedInfoUpdater(QDir shareDir, QObject *parent = nullptr) noexcept;
+    SharedInfoUpdater(const SharedInfoUpdater &) = delete;
+    SharedInfoUpdater(SharedInfoUpdater &&) = delete;
+    SharedInfoUpdater &operator=(const SharedInfoUpdater &) = delete;
+    SharedInfoUpdater &operator=(SharedInfoUpdater &&) = delete;
+    ~SharedInfoUpdater() override;
+
+    // the runner is used to execute the cache generators, tests can replace it
+    void setRunner(Runner runner) noexcept;
+    void setDelay(std::chrono::milliseconds delay) noexcept;
+
+    // schedule a regeneration, requests within the delay are merged into one run
+    void schedule() noexcept;
+    // run a pending regeneration immediately
+    void flush() noexcept;
+
+    [[nodiscard]] bool pending() const noexcept { return this->isPending; }
+
+private:
+    struct Cache
+    {
+        QString program;
+        QString dir;       // relative to share dir, passed to program
+        QString sourceDir; // relative to dir, where the source files are
+        QStringList nameFilters;
+        QString output; // relative to dir, generated by program
+        bool recursive;
+    };
+
+    static const std::vector<Cache> &caches() noexcept;
+    [[nodiscard]] QByteArray fingerprint(const Cache &cache) const noexcept;
+    void update() noexcept;
+
+    QDir shareDir;
+    Runner runner;
+    QTimer timer;
+    bool isPending{ false };
+    QHash<QString, QByteArray> fingerprints;
+};
+
+} // namespace linglong::repo
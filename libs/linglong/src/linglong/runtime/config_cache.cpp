@@ -0,0 +1,242 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "linglong/runtime/config_cache.h"
+
+#include "linglong/digest/sha256.h"
+#include "linglong/runtime/container_builder.h"
+#include "linglong/runtime/file_stamp.h"
+#include "linglong/utils/configure.h"
+#include "linglong/utils/serialize/json.h"
+
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <filesystem>
+#include <sstream>
+#include <vector>
+
+namespace linglong::runtime {
+
+namespace {
+
+constexpr auto bundleDirAnnotation = "org.deepin.linglong.bundleDir";
+
+} // namespace
+
+ConfigCache::ConfigCache(QDir dir) noexcept
+    : dir(std::move(dir))
+{
+}
+
+QDir ConfigCache::defaultDirectory() noexcept
+{
+    return QDir(QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation))
+      .filePath("linglong/oci-config");
+}
+
+std::optional<ConfigCache::Entry> ConfigCache::load(const QString &appID,
+                                                    const std::string &key) const noexcept
+{
+    QFile file(this->dir.filePath(appID + ".json"));
+    if (!file.open(QFile::ReadOnly)) {
+        return std::nullopt;
+    }
+
+    try {
+        auto content = nlohmann::json::parse(file.readAll().toStdString());
+        if (content.at("key") != key) {
+            return std::nullopt;
+        }
+
+        auto entry = Entry{
+            .key = key,
+            .bundleDir = content.at("bundleDir"),
+            .links = content.at("links"),
+            .config = content.at("config"),
+            .environment = std::nullopt,
+        };
+        if (content.contains("environment")) {
+            entry.environment = content.at("environment").get<std::vector<std::string>>();
+        }
+
+        return entry;
+    } catch (const std::exception &e) {
+        qWarning() << "ignore invalid cached OCI configuration" << file.fileName() << e.what();
+        return std::nullopt;
+    }
+}
+
+utils::error::Result<void>
+ConfigCache::store(const QString &appID,
+                   const std::string &key,
+                   const QDir &bundleDir,
+                   const ocppi::runtime::config::types::Config &config) noexcept
+{
+    LINGLONG_TRACE("cache OCI configuration of " + appID);
+
+    std::map<std::string, std::string> links;
+    std::error_code ec;
+    for (const auto &entry :
+         std::filesystem::directory_iterator{ bundleDir.absolutePath().toStdString(), ec }) {
+        if (entry.is_symlink(ec)) {
+            links.emplace(entry.path().filename(), std::filesystem::read_symlink(entry.path(), ec));
+        }
+    }
+    if (ec) {
+        return LINGLONG_ERR("list bundle directory", ec);
+    }
+
+    // the configuration contains the environment variables of the user
+    if (!this->dir.mkpath(".")
+        || !QFile::setPermissions(this->dir.absolutePath(),
+                                  QFile::ReadOwner | QFile::WriteOwner | QFile::ExeOwner)) {
+        return LINGLONG_ERR("create " + this->dir.absolutePath());
+    }
+
+    QSaveFile file(this->dir.filePath(appID + ".json"));
+    if (!file.open(QFile::WriteOnly)) {
+        return LINGLONG_ERR(file.fileName() + ": " + file.errorString());
+    }
+
+    auto content = nlohmann::json{
+        { "key", key },
+        { "bundleDir", bundleDir.absolutePath().toStdString() },
+        { "links", links },
+        { "config", config },
+    };
+    file.write(QByteArray::fromStdString(content.dump()));
+    if (!file.commit()) {
+        return LINGLONG_ERR(file.fileName() + ": " + file.errorString());
+    }
+
+    return LINGLONG_OK;
+}
+
+utils::error::Result<void>
+ConfigCache::storeEnvironment(const QString &appID,
+                              const std::string &key,
+                              const std::vector<std::string> &environment) noexcept
+{
+    LINGLONG_TRACE("cache login environment of " + appID);
+
+    QFile file(this->dir.filePath(appID + ".json"));
+    if (!file.open(QFile::ReadOnly)) {
+        return LINGLONG_ERR(file);
+    }
+
+    auto content = nlohmann::json::parse(file.readAll().toStdString(), nullptr, false);
+    file.close();
+    // the configuration is regenerated by another launch
+    if (!content.is_object() || content.value("key", "") != key) {
+        return LINGLONG_ERR("cached configuration is changed");
+    }
+
+    content["environment"] = environment;
+    QSaveFile saveFile(file.fileName());
+    if (!saveFile.open(QFile::WriteOnly)) {
+        return LINGLONG_ERR(saveFile.fileName() + ": " + saveFile.errorString());
+    }
+    saveFile.write(QByteArray::fromStdString(content.dump()));
+    if (!saveFile.commit()) {
+        return LINGLONG_ERR(saveFile.fileName() + ": " + saveFile.errorString());
+    }
+
+    return LINGLONG_OK;
+}
+
+auto ConfigCache::rebase(const Entry &entry, const QDir &bundleDir) noexcept
+  -> utils::error::Result<ocppi::runtime::config::types::Config>
+{
+    LINGLONG_TRACE("rebase cached OCI configuration to " + bundleDir.absolutePath());
+
+    auto config = entry.config;
+    if (!config.mounts) {
+        return LINGLONG_ERR("no mounts in cached configuration");
+    }
+
+    auto newBundleDir = bundleDir.absolutePath().toStdString();
+    std::vector<std::filesystem::path> created;
+    for (const auto &[name, target] : entry.links) {
+        std::error_code ec;
+        auto link = std::filesystem::path{ newBundleDir } / name;
+        std::filesystem::create_symlink(target, link, ec);
+        if (ec) {
+            // the configuration will be generated in this bundle directory
+            for (const auto &path : created) {
+                std::filesystem::remove(path, ec);
+            }
+            return LINGLONG_ERR("create symlink " + QString::fromStdString(name), ec);
+        }
+        created.push_back(std::move(link));
+    }
+
+    auto oldPrefix = entry.bundleDir + "/";
+    for (auto &mount : *config.mounts) {
+        if (mount.source && mount.source->rfind(oldPrefix, 0) == 0) {
+            mount.source = newBundleDir + "/" + mount.source->substr(oldPrefix.size());
+        }
+    }
+    if (config.annotations) {
+        (*config.annotations)[bundleDirAnnotation] = newBundleDir;
+    }
+
+    return config;
+}
+
+auto configKey(const ContainerOptions &opts, const QString &containerConfigFilePath) noexcept
+  -> std::optional<std::string>
+{
+    std::ostringstream stream;
+    stream << "version " << LINGLONG_VERSION << "\n";
+
+    // the layers are checked out to the directories named after their commits
+    stream << "app " << opts.appID.toStdString() << "\n";
+    stream << "appDir " << (opts.appDir ? opts.appDir->absolutePath().toStdString() : "") << "\n";
+    stream << "runtimeDir "
+           << (opts.runtimeDir ? opts.runtimeDir->absolutePath().toStdString() : "") << "\n";
+    stream << "baseDir " << opts.baseDir.absolutePath().toStdString() << "\n";
+    stream << "patches " << nlohmann::json(opts.patches).dump() << "\n";
+    stream << "mounts " << nlohmann::json(opts.mounts).dump() << "\n";
+    stream << "masks " << nlohmann::json(opts.masks).dump() << "\n";
+
+    writeFileStamp(stream, containerConfigFilePath);
+    auto appConfig = QStandardPaths::locate(QStandardPaths::ConfigLocation,
+                                            "linglong/" + opts.appID + "/config.yaml");
+    if (!appConfig.isEmpty()) {
+        writeFileStamp(stream, appConfig);
+    }
+
+    auto config = nlohmann::json{
+        { "annotations", { { "org.deepin.linglong.appID", opts.appID.toStdString() } } },
+    };
+    QDir configDotDDir = QFileInfo(containerConfigFilePath).dir().filePath("config.d");
+    for (const auto &info : configDotDDir.entryInfoList(QDir::Files)) {
+        // the executables of the builtin generators are followed, so upgrades are noticed
+        writeFileStamp(stream, info.absoluteFilePath());
+        if (!info.isExecutable()) {
+            continue;
+        }
+
+        const auto *generator = getBuiltinGenerator(info);
+        if (generator == nullptr) {
+            qDebug() << "OCI configuration isn't cached because of generator"
+                     << info.absoluteFilePath();
+            return std::nullopt;
+        }
+
+        auto state = generator->hostState(config);
+        if (!state) {
+            return std::nullopt;
+        }
+        stream << *state;
+    }
+
+    auto content = stream.str();
+    digest::SHA256 sha256;
+    sha256.update(content.data(), content.size());
+    return sha256.hexDigest();
+}
+
+} // namespace linglong::runtime
@@ -0,0 +1,71 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include "linglong/utils/error/error.h"
+#include "ocppi/runtime/config/types/Config.hpp"
+
+#include <QDir>
+
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace linglong::runtime {
+
+struct ContainerOptions;
+
+// ConfigCache keeps the OCI configuration generated for the last launch of every application,
+// the later launches reuse it as long as the key of the configuration is unchanged.
+class ConfigCache
+{
+public:
+    struct Entry
+    {
+        std::string key;
+        // the bundle directory of the container which the configuration was generated for
+        std::string bundleDir;
+        // the symlinks created in the bundle directory by the generators
+        std::map<std::string, std::string> links;
+        ocppi::runtime::config::types::Config config;
+        // the environment set up by the login shell for the configuration, see LoginEnvironment
+        std::optional<std::vector<std::string>> environment;
+    };
+
+    explicit ConfigCache(QDir dir) noexcept;
+
+    // defaultDirectory returns ${XDG_CACHE_HOME}/linglong/oci-config
+    static QDir defaultDirectory() noexcept;
+
+    [[nodiscard]] std::optional<Entry> load(const QString &appID,
+                                            const std::string &key) const noexcept;
+    utils::error::Result<void> store(const QString &appID,
+                                     const std::string &key,
+                                     const QDir &bundleDir,
+                                     const ocppi::runtime::config::types::Config &config) noexcept;
+    // storeEnvironment adds the environment to the cached configuration with the key
+    utils::error::Result<void>
+    storeEnvironment(const QString &appID,
+                     const std::string &key,
+                     const std::vector<std::string> &environment) noexcept;
+
+    // rebase moves the cached configuration to the bundle directory of a new container, and
+    // recreates the symlinks in it
+    static auto rebase(const Entry &entry, const QDir &bundleDir) noexcept
+      -> utils::error::Result<ocppi::runtime::config::types::Config>;
+
+private:
+    QDir dir;
+};
+
+// configKey digests everything the generated configuration depends on: the application, runtime
+// and base layers, the container configuration and its patches, the options and the host state
+// reported by the builtin generators. nullopt is returned if the configuration can't be cached,
+// e.g. it's modified by third party generators.
+auto configKey(const ContainerOptions &opts, const QString &containerConfigFilePath) noexcept
+  -> std::optional<std::string>;
+
+} // namespace linglong::runtime
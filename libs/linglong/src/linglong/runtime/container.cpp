@@ -7,6 +7,7 @@
 #include "linglong/runtime/container.h"
 
 #include "linglong/package/architecture.h"
+#include "linglong/tracing/tracing.h"
 #include "linglong/utils/finally/finally.h"
 #include "ocppi/runtime/RunOption.hpp"
 #include "ocppi/runtime/config/types/Generators.hpp"
@@ -14,22 +15,61 @@
 #include <QDir>
 #include <QStandardPaths>
 
+#include <algorithm>
 #include <filesystem>
 #include <fstream>
+#include <iterator>
 
 #include <sys/stat.h>
 #include <unistd.h>
 
 namespace linglong::runtime {
 
+namespace {
+
+// the file in the container where the login shell saves its environment
+constexpr auto loginEnvironmentFile = "/run/linglong/login-environment";
+
+} // namespace
+
+std::vector<std::string> parseEnvironment(const std::string &content) noexcept
+{
+    std::vector<std::string> environment;
+    std::size_t begin = 0;
+    while (begin < content.size()) {
+        auto end = content.find('\0', begin);
+        if (end == std::string::npos) {
+            end = content.size();
+        }
+
+        auto env = content.substr(begin, end - begin);
+        begin = end + 1;
+        if (env.find('=') == std::string::npos) {
+            continue;
+        }
+
+        // `_` is the path of the command executed by the shell, the others depend on the directory
+        // and the shell the application is launched from
+        auto key = env.substr(0, env.find('='));
+        if (key == "_" || key == "PWD" || key == "OLDPWD" || key == "SHLVL") {
+            continue;
+        }
+        environment.push_back(std::move(env));
+    }
+
+    return environment;
+}
+
 Container::Container(const ocppi::runtime::config::types::Config &cfg,
                      const QString &appID,
                      const QString &conatinerID,
-                     ocppi::cli::CLI &cli)
+                     ocppi::cli::CLI &cli,
+                     std::optional<LoginEnvironment> loginEnvironment)
     : cfg(cfg)
     , id(conatinerID)
     , appID(appID)
     , cli(cli)
+    , loginEnvironment(std::move(loginEnvironment))
 {
     Q_ASSERT(cfg.process.has_value());
 }
@@ -78,7 +118,24 @@ Container::run(const ocppi::runtime::config::types::Process &process) noexcept
         return LINGLONG_ERR("process.env is not set");
     }
 
-    auto originEnvs = this->cfg.process->env.value();
+    // the environment captured from the login shell replaces the one it's set up from
+    auto direct = this->loginEnvironment && this->loginEnvironment->environment;
+    auto originEnvs = direct ? *this->loginEnvironment->environment : *this->cfg.process->env;
+    if (direct) {
+        // the variables added to the configuration after the environment is captured, e.g. the
+        // ones pointing to the stack caches
+        for (const auto &env : *this->cfg.process->env) {
+            auto key = env.substr(0, env.find('=') + 1);
+            auto captured = std::any_of(originEnvs.cbegin(),
+                                        originEnvs.cend(),
+                                        [&key](const std::string &item) {
+                                            return item.rfind(key, 0) == 0;
+                                        });
+            if (!captured) {
+                originEnvs.push_back(env);
+            }
+        }
+    }
     this->cfg.process = process;
 
     if (this->cfg.process->user) {
@@ -95,6 +152,17 @@ Container::run(const ocppi::runtime::config::types::Process &process) noexcept
         this->cfg.process->cwd = ("/run/host/rootfs" + QDir::currentPath()).toStdString();
     }
 
+    // bash sets PWD to the working directory, which isn't part of the captured environment
+    if (direct) {
+        originEnvs.erase(std::remove_if(originEnvs.begin(),
+                                        originEnvs.end(),
+                                        [](const std::string &env) {
+                                            return env.rfind("PWD=", 0) == 0;
+                                        }),
+                         originEnvs.end());
+        originEnvs.push_back("PWD=" + this->cfg.process->cwd);
+    }
+
     this->cfg.process->user = ocppi::runtime::config::types::User{};
     this->cfg.process->user->gid = getgid();
     this->cfg.process->user->uid = getuid();
@@ -103,8 +171,12 @@ Container::run(const ocppi::runtime::config::types::Process &process) noexcept
         this->cfg.process->terminal = true;
     }
     // 在原始args前面添加bash --login -c，这样可以使用/etc/profile配置的环境变量
-    if (process.args.has_value()) {
+    if (process.args.has_value() && !direct) {
         QStringList bashArgs;
+        if (this->loginEnvironment) {
+            // the failure is ignored, the environment is captured again at the next launch
+            bashArgs.push_back(QString("env -0 > %1 || true;").arg(loginEnvironmentFile));
+        }
         // 为避免原始args包含空格，每个arg都使用单引号包裹，并对arg内部的单引号进行转义替换
         for (const auto &arg : *process.args) {
             bashArgs.push_back(
@@ -165,6 +237,24 @@ Container::run(const ocppi::runtime::config::types::Process &process) noexcept
       .uidMappings = {},
     });
 
+    auto loginEnvironmentPath = bundle.absoluteFilePath("login-environment").toStdString();
+    if (this->loginEnvironment && !direct) {
+        std::ofstream ofs(loginEnvironmentPath);
+        if (!ofs.is_open()) {
+            return LINGLONG_ERR("create login-environment in bundle directory");
+        }
+
+        this->cfg.mounts->push_back(ocppi::runtime::config::types::Mount{
+          .destination = loginEnvironmentFile,
+          .gidMappings = {},
+          .options = { { "rbind" } },
+          .source = loginEnvironmentPath,
+          .type = "bind",
+          .uidMappings = {},
+        });
+    }
+
+    tracing::Span configSpan("write config.json");
     nlohmann::json json = this->cfg;
 
     {
@@ -177,10 +267,14 @@ Container::run(const ocppi::runtime::config::types::Process &process) noexcept
         ofs << json.dump();
         ofs.close();
     }
+    configSpan.end();
+
     qDebug() << "run container in " << bundle.path();
     ocppi::runtime::RunOption opt;
     // 禁用crun自己创建cgroup，便于AM识别和管理玲珑应用
     opt.GlobalOption::extra.emplace_back("--cgroup-manager=disabled");
+    // the span lasts until the application exits, ll-box records the launch phases inside it
+    tracing::Span runSpan("oci runtime run");
     auto result = this->cli.run(ocppi::runtime::ContainerID(this->id.toStdString()),
                                 std::filesystem::path(bundle.absolutePath().toStdString()),
                                 opt);
@@ -189,6 +283,16 @@ Container::run(const ocppi::runtime::config::types::Process &process) noexcept
         return LINGLONG_ERR("cli run", result);
     }
 
+    if (this->loginEnvironment && !direct) {
+        std::ifstream ifs(loginEnvironmentPath);
+        std::string content{ std::istreambuf_iterator<char>(ifs),
+                             std::istreambuf_iterator<char>() };
+        auto environment = parseEnvironment(content);
+        if (!environment.empty()) {
+            this->loginEnvironment->store(environment);
+        }
+    }
+
     return LINGLONG_OK;
 }
 
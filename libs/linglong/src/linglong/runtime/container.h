@@ -11,15 +11,35 @@
 #include "ocppi/runtime/config/types/Config.hpp"
 #include "ocppi/runtime/config/types/Process.hpp"
 
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
 namespace linglong::runtime {
 
+// LoginEnvironment lets the application start without the login shell, the environment set up by
+// /etc/profile is captured when the application is started by the login shell, and applied to the
+// process directly afterwards.
+struct LoginEnvironment
+{
+    // the environment captured for the configuration of the container, if any
+    std::optional<std::vector<std::string>> environment;
+    std::function<void(const std::vector<std::string> &)> store;
+};
+
+// parseEnvironment parses the output of `env -0`, the variables set by the shell for the command
+// and the ones depending on the working directory, i.e. `_`, PWD, OLDPWD and SHLVL, are dropped.
+std::vector<std::string> parseEnvironment(const std::string &content) noexcept;
+
 class Container
 {
 public:
     Container(const ocppi::runtime::config::types::Config &cfg,
               const QString &appID,
               const QString &conatinerID,
-              ocppi::cli::CLI &cli);
+              ocppi::cli::CLI &cli,
+              std::optional<LoginEnvironment> loginEnvironment = std::nullopt);
 
     utils::error::Result<void> run(const ocppi::runtime::config::types::Process &process) noexcept;
 
@@ -28,6 +48,7 @@ private:
     QString id;
     QString appID;
     ocppi::cli::CLI &cli;
+    std::optional<LoginEnvironment> loginEnvironment;
 };
 
 }; // namespace linglong::runtime
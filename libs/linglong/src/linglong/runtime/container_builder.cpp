@@ -7,6 +7,11 @@
 #include "linglong/runtime/container_builder.h"
 
 #include "linglong/api/types/v1/ApplicationConfiguration.hpp"
+#include "linglong/oci-cfg-generators/builtins.h"
+#include "linglong/runtime/config_cache.h"
+#include "linglong/runtime/mount_planner.h"
+#include "linglong/runtime/stack_cache.h"
+#include "linglong/tracing/tracing.h"
 #include "linglong/utils/configure.h"
 #include "linglong/utils/error/error.h"
 #include "linglong/utils/serialize/json.h"
@@ -19,7 +24,9 @@
 #include <QTemporaryDir>
 
 #include <fstream>
-#include <unordered_set>
+#include <filesystem>
+#include <sstream>
+#include <utility>
 
 namespace linglong::runtime {
 
@@ -87,22 +94,20 @@ utils::error::Result<QDir> getBundleDir(QString containerID)
     return bundle;
 }
 
-void applyJSONPatch(ocppi::runtime::config::types::Config &cfg,
+void applyJSONPatch(nlohmann::json &cfg,
                     const api::types::v1::OciConfigurationPatch &patch) noexcept
 {
     LINGLONG_TRACE(QString("apply oci runtime config patch %1")
                      .arg(QString::fromStdString(nlohmann::json(patch).dump(-1, ' ', true))));
 
-    if (patch.ociVersion != cfg.ociVersion) {
+    if (patch.ociVersion != cfg.value("ociVersion", "")) {
         qWarning() << LINGLONG_ERRV("ociVersion mismatched");
         Q_ASSERT(false);
         return;
     }
 
-    auto raw = nlohmann::json(cfg);
     try {
-        raw = raw.patch(patch.patch);
-        cfg = raw.get<ocppi::runtime::config::types::Config>();
+        cfg = cfg.patch(patch.patch);
     } catch (...) {
         qCritical() << LINGLONG_ERRV("apply patch", std::current_exception());
         Q_ASSERT(false);
@@ -110,7 +115,7 @@ void applyJSONPatch(ocppi::runtime::config::types::Config &cfg,
     }
 }
 
-void applyJSONFilePatch(ocppi::runtime::config::types::Config &cfg, const QFileInfo &info) noexcept
+void applyJSONFilePatch(nlohmann::json &cfg, const QFileInfo &info) noexcept
 {
     if (!info.isFile()) {
         return;
@@ -135,17 +140,16 @@ void applyJSONFilePatch(ocppi::runtime::config::types::Config &cfg, const QFileI
     applyJSONPatch(cfg, *patch);
 }
 
-void applyExecutablePatch(QString workdir,
-                          ocppi::runtime::config::types::Config &cfg,
-                          const QFileInfo &info) noexcept
+void applyExecutablePatch(QString workdir, nlohmann::json &cfg, const QFileInfo &info) noexcept
 {
     LINGLONG_TRACE(QString("process oci configuration generator %1").arg(info.absoluteFilePath()));
+    tracing::Span span("generator " + info.fileName().toStdString());
 
     QProcess generatorProcess;
     generatorProcess.setProgram(info.absoluteFilePath());
     generatorProcess.setWorkingDirectory(workdir);
     generatorProcess.start();
-    generatorProcess.write(QByteArray::fromStdString(nlohmann::json(cfg).dump()));
+    generatorProcess.write(QByteArray::fromStdString(cfg.dump()));
     generatorProcess.closeWriteChannel();
 
     constexpr auto timeout = 200;
@@ -159,7 +163,7 @@ void applyExecutablePatch(QString workdir,
     if (generatorProcess.exitCode() != 0) {
         qCritical() << "generator" << info.absoluteFilePath() << "return"
                     << generatorProcess.exitCode() << "\ninput:\n"
-                    << nlohmann::json(cfg).dump().c_str() << "\n\nstderr:\n"
+                    << cfg.dump().c_str() << "\n\nstderr:\n"
                     << qPrintable(error);
         Q_ASSERT(false);
         return;
@@ -168,6 +172,7 @@ void applyExecutablePatch(QString workdir,
         qDebug() << "generator" << info.absoluteFilePath() << "stderr:" << error;
     }
 
+    // the output of third party generators is validated before it's applied
     auto result = generatorProcess.readAllStandardOutput();
     auto modified = utils::serialize::LoadJSON<ocppi::runtime::config::types::Config>(result);
     if (!modified) {
@@ -179,27 +184,54 @@ void applyExecutablePatch(QString workdir,
     cfg = *modified;
 }
 
-void applyPatches(const ContainerOptions &opts,
-                  ocppi::runtime::config::types::Config &cfg,
-                  const QFileInfoList &patches) noexcept
+void applyBuiltinGenerator(const generator::Generator &generator, nlohmann::json &cfg) noexcept
 {
-    auto bundleDir = getBundleDir(opts.containerID);
+    auto name = std::string{ generator.name() };
+    LINGLONG_TRACE(QString("apply builtin oci configuration generator %1")
+                     .arg(QString::fromStdString(name)));
+    tracing::Span span("generator " + name);
+
+    std::ostringstream log;
+    if (!generator.apply(cfg, log)) {
+        qCritical() << LINGLONG_ERRV(QString::fromStdString(log.str()));
+        Q_ASSERT(false);
+        return;
+    }
 
-    for (const auto &info : patches) {
-        if (!info.isFile()) {
-            continue;
-        }
+    if (auto output = log.str(); !output.empty()) {
+        qDebug() << "generator" << name.c_str() << "stderr:" << output.c_str();
+    }
+}
 
-        if (info.isExecutable()) {
-            applyExecutablePatch(bundleDir->path(), cfg, info);
-            continue;
-        }
+void applyPatch(const QString &bundleDir, nlohmann::json &cfg, const QFileInfo &info) noexcept
+{
+    if (!info.isFile()) {
+        return;
+    }
 
+    if (!info.isExecutable()) {
         applyJSONFilePatch(cfg, info);
+        return;
     }
+
+    if (const auto *generator = getBuiltinGenerator(info); generator != nullptr) {
+        applyBuiltinGenerator(*generator, cfg);
+        return;
+    }
+
+    applyExecutablePatch(bundleDir, cfg, info);
 }
 
-void applyPatches(ocppi::runtime::config::types::Config &cfg,
+void applyPatches(const QString &bundleDir,
+                  nlohmann::json &cfg,
+                  const QFileInfoList &patches) noexcept
+{
+    for (const auto &info : patches) {
+        applyPatch(bundleDir, cfg, info);
+    }
+}
+
+void applyPatches(nlohmann::json &cfg,
                   const std::vector<api::types::v1::OciConfigurationPatch> &patches) noexcept
 {
     for (const auto &patch : patches) {
@@ -207,13 +239,30 @@ void applyPatches(ocppi::runtime::config::types::Config &cfg,
     }
 }
 
-auto getOCIConfig(const ContainerOptions &opts) noexcept
-  -> utils::error::Result<ocppi::runtime::config::types::Config>
+// applyValidatedPatch applies the patch to a copy of cfg, the result replaces cfg only if it's
+// still a valid OCI configuration, otherwise the patch is skipped
+template<typename Patch>
+void applyValidatedPatch(nlohmann::json &cfg, const QString &name, const Patch &patch) noexcept
 {
-    LINGLONG_TRACE("get origin OCI configuration file");
+    LINGLONG_TRACE(QString("apply oci runtime config patch %1").arg(name));
+
+    auto patched = cfg;
+    patch(patched);
+
+    auto config = utils::serialize::LoadJSON<ocppi::runtime::config::types::Config>(
+      std::as_const(patched));
+    if (!config) {
+        qWarning() << LINGLONG_ERRV("skip the patch which breaks the configuration", config);
+        return;
+    }
+
+    cfg = std::move(patched);
+}
+
+auto getContainerConfigFilePath() noexcept -> utils::error::Result<QString>
+{
+    LINGLONG_TRACE("get container configuration file path");
 
-    QTemporaryDir dir;
-    dir.setAutoRemove(false);
     QString containerConfigFilePath = qgetenv("LINGLONG_CONTAINER_CONFIG");
     if (containerConfigFilePath.isEmpty()) {
         containerConfigFilePath = LINGLONG_INSTALL_PREFIX "/lib/linglong/container/config.json";
@@ -225,6 +274,17 @@ auto getOCIConfig(const ContainerOptions &opts) noexcept
         }
     }
 
+    return containerConfigFilePath;
+}
+
+auto getOCIConfig(const ContainerOptions &opts, const QString &containerConfigFilePath) noexcept
+  -> utils::error::Result<ocppi::runtime::config::types::Config>
+{
+    LINGLONG_TRACE("get origin OCI configuration file");
+
+    QTemporaryDir dir;
+    dir.setAutoRemove(false);
+
     auto config = utils::serialize::LoadJSONFile<ocppi::runtime::config::types::Config>(
       containerConfigFilePath);
     if (!config) {
@@ -248,18 +308,63 @@ auto getOCIConfig(const ContainerOptions &opts) noexcept
     if (opts.appDir) {
         annotations["org.deepin.linglong.appDir"] = opts.appDir->absolutePath().toStdString();
     }
+
+    auto bundleDir = getBundleDir(opts.containerID);
+    if (!bundleDir) {
+        return LINGLONG_ERR(bundleDir);
+    }
+    annotations["org.deepin.linglong.bundleDir"] = bundleDir->absolutePath().toStdString();
     config->annotations = std::move(annotations);
 
     QDir configDotDDir = QFileInfo(containerConfigFilePath).dir().filePath("config.d");
     Q_ASSERT(configDotDDir.exists());
 
-    applyPatches(opts, *config, configDotDDir.entryInfoList(QDir::Files));
+    // all patches and generators are applied on the same json document, it's converted from and to
+    // the OCI configuration only once
+    const auto original = nlohmann::json(*config);
+    auto raw = original;
+
+    auto patchFiles = configDotDDir.entryInfoList(QDir::Files);
+    applyPatches(bundleDir->absolutePath(), raw, patchFiles);
 
     auto appPatches = getPatchesForApplication(opts.appID);
 
-    applyPatches(*config, appPatches);
+    applyPatches(raw, appPatches);
 
-    applyPatches(*config, opts.patches);
+    applyPatches(raw, opts.patches);
+
+    config = utils::serialize::LoadJSON<ocppi::runtime::config::types::Config>(std::as_const(raw));
+    if (!config) {
+        // some patch broke the configuration, apply the patches again and validate the result of
+        // every one to skip the broken ones, it's slow but only happens with broken patches
+        qWarning() << LINGLONG_ERRV("apply patches", config)
+                   << "\nretry with validating the result of every patch";
+
+        raw = original;
+        for (const auto &info : patchFiles) {
+            applyValidatedPatch(raw, info.absoluteFilePath(), [&](nlohmann::json &cfg) {
+                applyPatch(bundleDir->absolutePath(), cfg, info);
+            });
+        }
+        for (const auto &patch : appPatches) {
+            applyValidatedPatch(raw, QString::fromStdString(nlohmann::json(patch).dump()),
+                                [&patch](nlohmann::json &cfg) {
+                                    applyJSONPatch(cfg, patch);
+                                });
+        }
+        for (const auto &patch : opts.patches) {
+            applyValidatedPatch(raw, QString::fromStdString(nlohmann::json(patch).dump()),
+                                [&patch](nlohmann::json &cfg) {
+                                    applyJSONPatch(cfg, patch);
+                                });
+        }
+
+        config =
+          utils::serialize::LoadJSON<ocppi::runtime::config::types::Config>(std::as_const(raw));
+        if (!config) {
+            return LINGLONG_ERR("apply patches", config);
+        }
+    }
 
     Q_ASSERT(config->mounts.has_value());
     auto &mounts = *config->mounts;
@@ -281,141 +386,148 @@ auto fixMount(ocppi::runtime::config::types::Config config) noexcept
         return config;
     }
 
-    auto originalRoot = QDir{ QString::fromStdString(config.root.value().path) };
+    auto originalRoot = std::filesystem::path{ config.root.value().path };
+    std::error_code ec;
+    if (!std::filesystem::is_directory(originalRoot, ec)) {
+        return LINGLONG_ERR("invalid root directory "
+                            + QString::fromStdString(originalRoot.string()));
+    }
+
     config.root = { { .path = "rootfs", .readonly = false } };
+    config.mounts = planMounts(originalRoot, *config.mounts);
 
-    auto &mounts = config.mounts.value();
-    auto commonParent = [](const QString &path1, const QString &path2) {
-        QString ret = path2;
-        while (!path1.startsWith(ret)) {
-            ret.chop(1);
-        }
-        if (ret.isEmpty()) {
-            return ret;
-        }
-        while (!ret.endsWith('/')) {
-            ret.chop(1);
-        }
-        return QDir::cleanPath(ret);
-    };
+    return config;
+};
 
-    QStringList tmpfsPath;
-    for (const auto &mount : mounts) {
-        if (mount.destination.empty() || mount.destination.at(0) != '/') {
-            continue;
-        }
+// writeEnvFile saves the environment variables to 00env.sh in the bundle directory, which is
+// mounted to /etc/profile.d/00env.sh
+auto writeEnvFile(const QDir &bundle, const ocppi::runtime::config::types::Config &config) noexcept
+  -> utils::error::Result<std::string>
+{
+    LINGLONG_TRACE("write 00env.sh");
 
-        auto hostSource = QDir::cleanPath(
-          originalRoot.filePath(QString::fromStdString(mount.destination.substr(1))));
-        if (QFileInfo::exists(hostSource)) {
-            continue;
-        }
+    std::string envShFile = bundle.absoluteFilePath("00env.sh").toStdString();
+    std::ofstream ofs(envShFile);
+    Q_ASSERT(ofs.is_open());
+    if (!ofs.is_open()) {
+        return LINGLONG_ERR("create 00env.sh failed in bundle directory");
+    }
 
-        auto elem = hostSource.split(QDir::separator());
-        while (!elem.isEmpty() && !QFile::exists(elem.join(QDir::separator()))) {
-            elem.removeLast();
-        }
+    for (const auto &env : config.process->env.value()) {
+        const QString envStr = QString::fromStdString(env);
+        auto pos = envStr.indexOf("=");
+        auto value = envStr.mid(pos + 1, envStr.length());
+        // here we process environment variables with single quotes.
+        // A=a'b ===> A='a'\''b'
+        value.replace("'", R"('\'')");
+
+        // We need to quote the values environment variables
+        // avoid loading errors when some environment variables have multiple values, such as
+        // (a;b).
+        const auto fixEnv = QString(R"(%1='%2')").arg(envStr.mid(0, pos)).arg(value);
+        ofs << "export " << fixEnv.toStdString() << std::endl;
+    }
+    ofs.close();
 
-        if (elem.isEmpty()) {
-            qWarning() << "invalid host source:" << hostSource;
-            continue;
-        }
+    return envShFile;
+}
 
-        bool newTmp{ true };
-        auto existsPath = elem.join(QDir::separator());
-        auto originalRootPath = QDir::cleanPath(originalRoot.absolutePath());
-        if (existsPath <= originalRootPath) {
-            continue;
-        }
+// loadCachedConfig returns the cached entry with the configuration rebased for the new container,
+// or nullopt if the configuration has to be generated
+auto loadCachedConfig(const ConfigCache &cache,
+                      const ContainerOptions &opts,
+                      const std::string &key,
+                      const QDir &bundle) noexcept -> std::optional<ConfigCache::Entry>
+{
+    LINGLONG_TRACE("load cached OCI configuration");
+    tracing::Span span("load cached OCI config");
 
-        for (auto it = tmpfsPath.cbegin(); it != tmpfsPath.cend(); ++it) {
-            if (existsPath == *it) {
-                newTmp = false;
-                continue;
-            }
-
-            if (auto common = commonParent(existsPath, *it); common > originalRootPath) {
-                newTmp = false;
-                tmpfsPath.replace(it - tmpfsPath.cbegin(), common);
-                break;
-            }
-        }
+    auto entry = cache.load(opts.appID, key);
+    if (!entry) {
+        return std::nullopt;
+    }
 
-        if (newTmp) {
-            tmpfsPath.push_back(existsPath);
-        }
+    auto config = ConfigCache::rebase(*entry, bundle);
+    if (!config) {
+        qWarning() << LINGLONG_ERRV(config);
+        return std::nullopt;
     }
 
-    using MountType = std::remove_reference_t<decltype(mounts)>::value_type;
-    auto rootBinds =
-      originalRoot.entryInfoList(QDir::Dirs | QDir::Files | QDir::System | QDir::NoDotAndDotDot);
-    auto pos = mounts.begin();
-    for (const auto &bind : rootBinds) {
-        auto mountPoint = MountType{
-            .destination = ("/" + bind.fileName()).toStdString(),
-            .gidMappings = {},
-            .options = { { "rbind", "ro" } },
-            .source = bind.absoluteFilePath().toStdString(),
-            .type = "bind",
-            .uidMappings = {},
-        };
-        if (bind.isSymLink()) {
-            mountPoint.options->emplace_back("copy-symlink");
-        }
-        pos = mounts.insert(pos, std::move(mountPoint));
-        ++pos;
-    }
-
-    for (const auto &tmpfs : tmpfsPath) {
-        pos = mounts.insert(
-          pos,
-          MountType{
-            .destination = tmpfs.mid(originalRoot.absolutePath().size()).toStdString(),
-            .gidMappings = {},
-            .options = { { "nodev", "nosuid", "mode=755" } },
-            .source = "tmpfs",
-            .type = "tmpfs",
-            .uidMappings = {},
-          });
-        ++pos;
-
-        auto dir = QDir{ tmpfs };
-        for (const auto &rootDest :
-             dir.entryInfoList(QDir::Dirs | QDir::Files | QDir::System | QDir::NoDotAndDotDot)) {
-            auto rootDestPath = rootDest.absoluteFilePath();
-            auto destination = rootDestPath.mid(originalRoot.absolutePath().size());
-            auto mountPoint = MountType{
-                .destination = destination.toStdString(),
-                .gidMappings = {},
-                .options = { { "rbind", "ro" } },
-                .source = rootDestPath.toStdString(),
-                .type = "bind",
-                .uidMappings = {},
-            };
-            if (rootDest.isSymLink()) {
-                mountPoint.options->emplace_back("copy-symlink");
-            }
-            pos = mounts.insert(pos, std::move(mountPoint));
-            ++pos;
-        }
+    // the environment variables are the same, but the file is in the old bundle directory
+    auto envShFile = writeEnvFile(bundle, *config);
+    if (!envShFile) {
+        qWarning() << LINGLONG_ERRV(envShFile);
+        return std::nullopt;
     }
 
-    // remove extra mount points
-    std::unordered_set<std::string> dups;
-    for (auto it = mounts.crbegin(); it != mounts.crend(); ++it) {
-        if (dups.find(it->destination) != dups.end()) {
-            mounts.erase(std::next(it).base());
-            continue;
-        }
+    entry->config = std::move(*config);
+    return entry;
+}
 
-        dups.insert(it->destination);
+// loginEnvironment stores the environment captured from the login shell to the cached
+// configuration with the key
+auto loginEnvironment(const ContainerOptions &opts,
+                      const ConfigCache &cache,
+                      const std::string &key,
+                      std::optional<std::vector<std::string>> environment) noexcept
+  -> std::optional<LoginEnvironment>
+{
+    if (!opts.cacheLoginEnvironment) {
+        return std::nullopt;
     }
 
-    return config;
-};
+    return LoginEnvironment{
+        .environment = std::move(environment),
+        .store =
+          [cache, appID = opts.appID, key](const std::vector<std::string> &environment) mutable {
+              auto ret = cache.storeEnvironment(appID, key, environment);
+              if (!ret) {
+                  qWarning() << ret.error().message();
+              }
+          },
+    };
+}
+
+// applyStackCaches mounts the caches generated for the layers, the configuration is left unchanged
+// on failure, so the caches are still generated in the container
+void applyStackCaches(const ContainerOptions &opts,
+                      const QDir &bundle,
+                      ocppi::runtime::config::types::Config &config) noexcept
+{
+    if (!opts.cacheStackCaches) {
+        return;
+    }
+
+    LINGLONG_TRACE("apply stack caches");
+    tracing::Span span("apply stack caches");
+
+    auto ret = StackCache(StackCache::defaultDirectory()).apply(opts, bundle, config);
+    if (!ret) {
+        qWarning() << LINGLONG_ERRV(ret);
+    }
+}
 
 } // namespace
 
+auto getBuiltinGenerator(const QFileInfo &info) noexcept -> const generator::Generator *
+{
+    if (!info.isSymLink()) {
+        return nullptr;
+    }
+
+    const auto &generators = generator::builtinGenerators();
+    auto it = generators.find(info.fileName().toStdString());
+    if (it == generators.end()) {
+        return nullptr;
+    }
+
+    if (QFileInfo(info.symLinkTarget()).fileName() != info.fileName() + "-static") {
+        return nullptr;
+    }
+
+    return it->second.get();
+}
+
 ContainerBuilder::ContainerBuilder(ocppi::cli::CLI &cli)
     : cli(cli)
 {
@@ -430,51 +542,83 @@ auto ContainerBuilder::create(const ContainerOptions &opts) noexcept
     if (!bundle.has_value()) {
         return LINGLONG_ERR(bundle);
     }
-    auto originalConfig = getOCIConfig(opts);
+
+    auto containerConfigFilePath = getContainerConfigFilePath();
+    if (!containerConfigFilePath) {
+        return LINGLONG_ERR(containerConfigFilePath);
+    }
+
+    // the key is calculated before the generators run, since they read the host state which the
+    // key is digested from
+    std::optional<ConfigCache> cache;
+    std::optional<std::string> key;
+    if (opts.cacheConfig) {
+        key = configKey(opts, *containerConfigFilePath);
+    }
+    if (key) {
+        cache.emplace(ConfigCache::defaultDirectory());
+        auto entry = loadCachedConfig(*cache, opts, *key, *bundle);
+        if (entry) {
+            applyStackCaches(opts, *bundle, entry->config);
+            return QSharedPointer<Container>::create(
+              entry->config,
+              opts.appID,
+              opts.containerID,
+              this->cli,
+              loginEnvironment(opts, *cache, entry->key, std::move(entry->environment)));
+        }
+    }
+
+    tracing::Span configSpan("getOCIConfig");
+    auto originalConfig = getOCIConfig(opts, *containerConfigFilePath);
+    configSpan.end();
     if (!originalConfig) {
         return LINGLONG_ERR(originalConfig);
     }
-    // save env to /run/user/1000/linglong/xxx/00env.sh, mount it to /etc/profile.d/00env.sh
-    std::string envShFile = bundle->absoluteFilePath("00env.sh").toStdString();
-    {
-        std::ofstream ofs(envShFile);
-        Q_ASSERT(ofs.is_open());
-        if (!ofs.is_open()) {
-            return LINGLONG_ERR("create 00env.sh failed in bundle directory");
-        }
 
-        for (const auto &env : originalConfig->process->env.value()) {
-            const QString envStr = QString::fromStdString(env);
-            auto pos = envStr.indexOf("=");
-            auto value = envStr.mid(pos + 1, envStr.length());
-            // here we process environment variables with single quotes.
-            // A=a'b ===> A='a'\''b'
-            value.replace("'", R"('\'')");
-
-            // We need to quote the values environment variables
-            // avoid loading errors when some environment variables have multiple values, such as
-            // (a;b).
-            const auto fixEnv = QString(R"(%1='%2')").arg(envStr.mid(0, pos)).arg(value);
-            ofs << "export " << fixEnv.toStdString() << std::endl;
-        }
-        ofs.close();
+    // save env to /run/user/1000/linglong/xxx/00env.sh, mount it to /etc/profile.d/00env.sh
+    auto envShFile = writeEnvFile(*bundle, *originalConfig);
+    if (!envShFile) {
+        return LINGLONG_ERR(envShFile);
     }
 
     originalConfig->mounts->push_back(ocppi::runtime::config::types::Mount{
       .destination = "/etc/profile.d/00env.sh",
       .gidMappings = {},
       .options = { { "ro", "rbind" } },
-      .source = envShFile,
+      .source = *envShFile,
       .type = "bind",
       .uidMappings = {},
     });
 
+    tracing::Span fixMountSpan("fixMount");
     auto config = fixMount(*originalConfig);
+    fixMountSpan.end();
     if (!config) {
         return LINGLONG_ERR(config);
     }
 
-    return QSharedPointer<Container>::create(*config, opts.appID, opts.containerID, this->cli);
+    // the configuration isn't stored if the host state is changed while it's generated, e.g. the
+    // generators create the directories to mount, since it might not match the key. The next
+    // launch generates and stores it with the new state.
+    std::optional<LoginEnvironment> environment;
+    if (key && configKey(opts, *containerConfigFilePath) == key) {
+        auto ret = cache->store(opts.appID, *key, *bundle, *config);
+        if (!ret) {
+            qWarning() << LINGLONG_ERRV(ret);
+        } else {
+            environment = loginEnvironment(opts, *cache, *key, std::nullopt);
+        }
+    }
+
+    // the cached configuration is independent of the stack caches
+    applyStackCaches(opts, *bundle, *config);
+
+    return QSharedPointer<Container>::create(*config,
+                                             opts.appID,
+                                             opts.containerID,
+                                             this->cli,
+                                             std::move(environment));
 }
 
 } // namespace linglong::runtime
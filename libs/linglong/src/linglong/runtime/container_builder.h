@@ -7,12 +7,14 @@
 #pragma once
 
 #include "linglong/api/types/v1/OciConfigurationPatch.hpp"
+#include "linglong/oci-cfg-generators/generator.h"
 #include "linglong/runtime/container.h"
 #include "linglong/utils/error/error.h"
 #include "ocppi/cli/CLI.hpp"
 #include "ocppi/runtime/config/types/Mount.hpp"
 
 #include <QDir>
+#include <QFileInfo>
 
 namespace linglong::runtime {
 
@@ -28,8 +30,21 @@ struct ContainerOptions
     std::vector<api::types::v1::OciConfigurationPatch> patches;
     std::vector<ocppi::runtime::config::types::Mount> mounts; // extra mounts
     std::vector<std::string> masks;
+
+    // reuse the configuration generated for the last launch of the application, see ConfigCache
+    bool cacheConfig{ false };
+    // start the application without the login shell once its environment is cached along with the
+    // configuration, see LoginEnvironment
+    bool cacheLoginEnvironment{ false };
+    // reuse the caches generated in the container for the same layers, e.g. ld.so.cache, instead of
+    // generating them at every launch, see StackCache
+    bool cacheStackCaches{ false };
 };
 
+// getBuiltinGenerator returns the builtin generator if the file in config.d is the symlink to its
+// executable installed by linglong.
+auto getBuiltinGenerator(const QFileInfo &info) noexcept -> const generator::Generator *;
+
 class ContainerBuilder : public QObject
 {
     Q_OBJECT
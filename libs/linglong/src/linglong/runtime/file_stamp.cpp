@@ -0,0 +1,29 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "linglong/runtime/file_stamp.h"
+
+#include <QFile>
+
+#include <cerrno>
+
+#include <sys/stat.h>
+
+namespace linglong::runtime {
+
+void writeFileStamp(std::ostream &stream, const QString &path)
+{
+    stream << path.toStdString();
+
+    struct stat st{};
+    if (::stat(QFile::encodeName(path).constData(), &st) == -1) {
+        stream << " " << errno << "\n";
+        return;
+    }
+
+    stream << " " << st.st_dev << " " << st.st_ino << " " << st.st_size << " "
+           << st.st_mtim.tv_sec << "." << st.st_mtim.tv_nsec << "\n";
+}
+
+} // namespace linglong::runtime
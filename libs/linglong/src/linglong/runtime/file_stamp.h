@@ -0,0 +1,19 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include <QString>
+
+#include <ostream>
+
+namespace linglong::runtime {
+
+// writeFileStamp writes a line identifying the current state of the file at path to stream: the
+// path followed by its device, inode, size and modification time, or by the errno of stat if it
+// can't be accessed. The caches keyed by the digests of these lines are invalidated when the file
+// is replaced, modified, created or removed.
+void writeFileStamp(std::ostream &stream, const QString &path);
+
+} // namespace linglong::runtime
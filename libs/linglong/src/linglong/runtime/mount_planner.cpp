@@ -0,0 +1,205 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "linglong/runtime/mount_planner.h"
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+
+namespace linglong::runtime {
+
+namespace {
+
+using Mount = ocppi::runtime::config::types::Mount;
+
+struct Node
+{
+    std::map<std::string, std::unique_ptr<Node>> children;
+    // the index of the last mount to this path
+    std::optional<std::size_t> mount;
+    // the mount isn't hidden by a later mount to any parent of this path
+    bool visible{ false };
+    // the directory of the root is replaced by tmpfs
+    bool tmpfs{ false };
+};
+
+class Planner
+{
+public:
+    Planner(const std::filesystem::path &rootDir, const std::vector<Mount> &mounts)
+        : rootDir(rootDir)
+        , mounts(mounts)
+        , nodes(mounts.size(), nullptr)
+    {
+    }
+
+    std::vector<Mount> plan()
+    {
+        for (std::size_t i = 0; i < this->mounts.size(); ++i) {
+            this->insert(i);
+        }
+
+        this->root.visible = this->root.mount.has_value();
+        this->walk(this->root, "/", this->root.mount, this->root.mount.has_value(), &this->root);
+
+        std::vector<Mount> result;
+        result.reserve(this->mounts.size());
+        this->bindEntries(this->root, "/", result);
+        this->replaceWithTmpfs(this->root, "/", result);
+
+        for (std::size_t i = 0; i < this->mounts.size(); ++i) {
+            const auto *node = this->nodes[i];
+            if (node == nullptr || (node->mount == i && node->visible)) {
+                result.push_back(this->mounts[i]);
+            }
+        }
+
+        return result;
+    }
+
+private:
+    void insert(std::size_t index)
+    {
+        const auto &destination = this->mounts[index].destination;
+        if (destination.empty() || destination.front() != '/') {
+            return;
+        }
+
+        auto *node = &this->root;
+        for (const auto &part :
+             std::filesystem::path{ destination }.lexically_normal().relative_path()) {
+            // "/a/b/" ends with an empty component
+            if (part.empty()) {
+                continue;
+            }
+
+            auto &child = node->children[part.string()];
+            if (!child) {
+                child = std::make_unique<Node>();
+            }
+            node = child.get();
+        }
+
+        node->mount = index;
+        this->nodes[index] = node;
+    }
+
+    // walk resolves the nodes below the node at path: parentMount is the last mount to the node
+    // and its parents, covered tells whether the root is hidden by a visible mount there, and
+    // existing is the deepest directory existing in the root.
+    void walk(Node &node,
+              const std::filesystem::path &path,
+              std::optional<std::size_t> parentMount,
+              bool covered,
+              Node *existing)
+    {
+        for (auto &[name, child] : node.children) {
+            auto childPath = path / name;
+            child->visible = child->mount && (!parentMount || *child->mount > *parentMount);
+
+            auto exists{ false };
+            auto *childExisting = existing;
+            if (!covered && existing == &node) {
+                std::error_code ec;
+                auto status =
+                  std::filesystem::status(this->rootDir / childPath.relative_path(), ec);
+                exists = std::filesystem::exists(status);
+                if (std::filesystem::is_directory(status)) {
+                    childExisting = child.get();
+                }
+            }
+
+            // the missing mount point can't be created in the read-only root, except in the top
+            // level of the container
+            if (!covered && child->visible && !exists && existing != &this->root) {
+                existing->tmpfs = true;
+            }
+
+            this->walk(*child,
+                       childPath,
+                       std::max(parentMount, child->mount),
+                       covered || child->visible,
+                       childExisting);
+        }
+    }
+
+    // bindEntries binds the entries of the directory at path in the root, except the ones replaced
+    // by other mounts
+    void bindEntries(const Node &node,
+                     const std::filesystem::path &path,
+                     std::vector<Mount> &result)
+    {
+        std::vector<std::filesystem::directory_entry> entries;
+        std::error_code ec;
+        auto dir = this->rootDir / path.relative_path();
+        for (auto it = std::filesystem::directory_iterator{ dir, ec };
+             !ec && it != std::filesystem::directory_iterator{};
+             it.increment(ec)) {
+            entries.push_back(*it);
+        }
+        std::sort(entries.begin(), entries.end());
+
+        for (const auto &entry : entries) {
+            auto name = entry.path().filename();
+            if (auto it = node.children.find(name.string());
+                it != node.children.end() && (it->second->visible || it->second->tmpfs)) {
+                continue;
+            }
+
+            auto mount = Mount{
+                .destination = (path / name).string(),
+                .gidMappings = {},
+                .options = { { "rbind", "ro" } },
+                .source = entry.path().string(),
+                .type = "bind",
+                .uidMappings = {},
+            };
+            if (entry.is_symlink(ec)) {
+                mount.options->emplace_back("copy-symlink");
+            }
+            result.push_back(std::move(mount));
+        }
+    }
+
+    void replaceWithTmpfs(const Node &node,
+                          const std::filesystem::path &path,
+                          std::vector<Mount> &result)
+    {
+        for (const auto &[name, child] : node.children) {
+            auto childPath = path / name;
+            if (child->tmpfs) {
+                result.push_back(Mount{
+                  .destination = childPath.string(),
+                  .gidMappings = {},
+                  .options = { { "nodev", "nosuid", "mode=755" } },
+                  .source = "tmpfs",
+                  .type = "tmpfs",
+                  .uidMappings = {},
+                });
+                this->bindEntries(*child, childPath, result);
+            }
+
+            this->replaceWithTmpfs(*child, childPath, result);
+        }
+    }
+
+    const std::filesystem::path &rootDir;
+    const std::vector<Mount> &mounts;
+    // the node of each absolute mount
+    std::vector<const Node *> nodes;
+    Node root;
+};
+
+} // namespace
+
+auto planMounts(const std::filesystem::path &rootDir, const std::vector<Mount> &mounts) noexcept
+  -> std::vector<Mount>
+{
+    return Planner{ rootDir, mounts }.plan();
+}
+
+} // namespace linglong::runtime
@@ -0,0 +1,29 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include "ocppi/runtime/config/types/Mount.hpp"
+
+#include <filesystem>
+#include <vector>
+
+namespace linglong::runtime {
+
+// planMounts returns the mounts that make an empty writable root directory look like rootDir with
+// the mounts applied on it, which is how ll-box sets up the root of linglong containers:
+//
+// - the entries of rootDir are bound read-only into the container;
+// - the missing mount points can't be created in read-only binds, so the deepest existing
+//   directories containing them are replaced by tmpfs, with their entries bound again;
+// - mounts to the same destination and mounts hidden by later mounts to their parents are dropped.
+//
+// The destinations of the mounts are organized as a trie, every node of it is checked at most
+// once, and only the root directory and the directories replaced by tmpfs are listed. The mounts
+// are returned in the order that parents are mounted before their children.
+auto planMounts(const std::filesystem::path &rootDir,
+                const std::vector<ocppi::runtime::config::types::Mount> &mounts) noexcept
+  -> std::vector<ocppi::runtime::config::types::Mount>;
+
+} // namespace linglong::runtime
@@ -0,0 +1,435 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "linglong/runtime/readahead.h"
+
+#include "linglong/digest/sha256.h"
+#include "linglong/utils/serialize/json.h"
+
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/fanotify.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/statfs.h>
+#include <unistd.h>
+
+namespace linglong::runtime {
+
+namespace {
+
+// the key of the directory in the events, the file handles are unique in a filesystem
+auto handleKey(const void *fsid, const file_handle &handle) -> std::string
+{
+    std::string key(static_cast<const char *>(fsid), sizeof(fsid_t));
+    key.append(reinterpret_cast<const char *>(&handle.handle_type), sizeof(handle.handle_type));
+    key.append(reinterpret_cast<const char *>(handle.f_handle), handle.handle_bytes);
+    return key;
+}
+
+} // namespace
+
+Readahead::Readahead(QDir dir) noexcept
+    : dir(std::move(dir))
+{
+}
+
+QDir Readahead::defaultDirectory() noexcept
+{
+    return QDir(QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation))
+      .filePath("linglong/readahead");
+}
+
+auto Readahead::load(const QString &appID, const std::string &key) const noexcept
+  -> std::optional<std::vector<ReadaheadRange>>
+{
+    QFile file(this->dir.filePath(appID + ".json"));
+    if (!file.open(QFile::ReadOnly)) {
+        return std::nullopt;
+    }
+
+    try {
+        auto content = nlohmann::json::parse(file.readAll().toStdString());
+        if (content.at("key") != key) {
+            return std::nullopt;
+        }
+
+        std::vector<ReadaheadRange> ranges;
+        for (const auto &range : content.at("ranges")) {
+            ranges.push_back({
+              .path = range.at("path"),
+              .offset = range.at("offset"),
+              .length = range.at("length"),
+            });
+        }
+        return ranges;
+    } catch (const std::exception &e) {
+        qWarning() << "ignore invalid readahead profile" << file.fileName() << e.what();
+        return std::nullopt;
+    }
+}
+
+utils::error::Result<void> Readahead::store(const QString &appID,
+                                            const std::string &key,
+                                            const std::vector<ReadaheadRange> &ranges) noexcept
+{
+    LINGLONG_TRACE("store readahead profile of " + appID);
+
+    if (!this->dir.mkpath(".")) {
+        return LINGLONG_ERR("create " + this->dir.absolutePath());
+    }
+
+    QSaveFile file(this->dir.filePath(appID + ".json"));
+    if (!file.open(QFile::WriteOnly)) {
+        return LINGLONG_ERR(file.fileName() + ": " + file.errorString());
+    }
+
+    auto content = nlohmann::json{
+        { "key", key },
+        { "ranges", nlohmann::json::array() },
+    };
+    for (const auto &range : ranges) {
+        content["ranges"].push_back({
+          { "path", range.path },
+          { "offset", range.offset },
+          { "length", range.length },
+        });
+    }
+    file.write(QByteArray::fromStdString(content.dump()));
+    if (!file.commit()) {
+        return LINGLONG_ERR(file.fileName() + ": " + file.errorString());
+    }
+
+    return LINGLONG_OK;
+}
+
+auto readaheadKey(const std::vector<std::filesystem::path> &layers) noexcept -> std::string
+{
+    std::string content;
+    for (const auto &layer : layers) {
+        content += layer.string() + "\n";
+    }
+
+    digest::SHA256 sha256;
+    sha256.update(content.data(), content.size());
+    return sha256.hexDigest();
+}
+
+auto residentRanges(const std::filesystem::path &path) noexcept
+  -> utils::error::Result<std::vector<ReadaheadRange>>
+{
+    LINGLONG_TRACE(QString("get resident ranges of %1").arg(path.c_str()));
+
+    auto fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        return LINGLONG_ERR(QString{ "open: %1" }.arg(::strerror(errno)), errno);
+    }
+
+    struct stat st{};
+    if (::fstat(fd, &st) == -1 || !S_ISREG(st.st_mode) || st.st_size == 0) {
+        ::close(fd);
+        return std::vector<ReadaheadRange>{};
+    }
+
+    auto size = static_cast<std::size_t>(st.st_size);
+    auto *addr = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+        return LINGLONG_ERR(QString{ "mmap: %1" }.arg(::strerror(errno)), errno);
+    }
+
+    auto pageSize = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    std::vector<unsigned char> pages((size + pageSize - 1) / pageSize);
+    auto ret = ::mincore(addr, size, pages.data());
+    auto savedErrno = errno;
+    ::munmap(addr, size);
+    if (ret == -1) {
+        return LINGLONG_ERR(QString{ "mincore: %1" }.arg(::strerror(savedErrno)), savedErrno);
+    }
+
+    // the adjacent resident pages are merged into one range
+    std::vector<ReadaheadRange> ranges;
+    for (std::size_t i = 0; i < pages.size(); ++i) {
+        if ((pages[i] & 1) == 0) {
+            continue;
+        }
+
+        auto offset = i * pageSize;
+        if (!ranges.empty() && ranges.back().offset + ranges.back().length == offset) {
+            ranges.back().length += pageSize;
+            continue;
+        }
+        ranges.push_back({ .path = path.string(), .offset = offset, .length = pageSize });
+    }
+    if (!ranges.empty() && ranges.back().offset + ranges.back().length > size) {
+        ranges.back().length = size - ranges.back().offset;
+    }
+
+    return ranges;
+}
+
+void readahead(const std::vector<ReadaheadRange> &ranges, const std::atomic_bool &stopped) noexcept
+{
+    int fd = -1;
+    std::string opened;
+    for (const auto &range : ranges) {
+        if (stopped) {
+            break;
+        }
+
+        if (range.path != opened) {
+            if (fd != -1) {
+                ::close(fd);
+            }
+            opened = range.path;
+            fd = ::open(range.path.c_str(), O_RDONLY | O_CLOEXEC);
+        }
+        if (fd == -1) {
+            continue;
+        }
+
+        // readahead only starts the reads, they're waited by the application if it's faster
+        ::readahead(fd, static_cast<off64_t>(range.offset), range.length);
+    }
+
+    if (fd != -1) {
+        ::close(fd);
+    }
+}
+
+ReadaheadRecorder::~ReadaheadRecorder()
+{
+    if (this->fanotifyFd != -1) {
+        ::close(this->fanotifyFd);
+    }
+    if (this->stopFd != -1) {
+        ::close(this->stopFd);
+    }
+}
+
+auto ReadaheadRecorder::start(const std::vector<std::filesystem::path> &dirs) noexcept
+  -> utils::error::Result<std::unique_ptr<ReadaheadRecorder>>
+{
+    LINGLONG_TRACE("start recording opened files");
+
+    std::unique_ptr<ReadaheadRecorder> recorder(new ReadaheadRecorder);
+    recorder->fanotifyFd = ::fanotify_init(FAN_CLASS_NOTIF | FAN_REPORT_DFID_NAME | FAN_CLOEXEC
+                                             | FAN_NONBLOCK,
+                                           O_RDONLY | O_CLOEXEC);
+    if (recorder->fanotifyFd == -1) {
+        return LINGLONG_ERR(QString{ "fanotify_init: %1" }.arg(::strerror(errno)), errno);
+    }
+
+    recorder->stopFd = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (recorder->stopFd == -1) {
+        return LINGLONG_ERR(QString{ "eventfd: %1" }.arg(::strerror(errno)), errno);
+    }
+
+    std::vector<char> buffer(sizeof(file_handle) + MAX_HANDLE_SZ);
+    auto *handle = reinterpret_cast<file_handle *>(buffer.data());
+    auto mark = [&recorder,
+                 handle](const std::filesystem::path &dir) -> utils::error::Result<void> {
+        LINGLONG_TRACE(QString("mark %1").arg(dir.c_str()));
+
+        if (::fanotify_mark(recorder->fanotifyFd,
+                            FAN_MARK_ADD | FAN_MARK_ONLYDIR,
+                            FAN_OPEN | FAN_EVENT_ON_CHILD,
+                            AT_FDCWD,
+                            dir.c_str())
+            == -1) {
+            return LINGLONG_ERR(QString{ "fanotify_mark: %1" }.arg(::strerror(errno)), errno);
+        }
+
+        struct statfs st{};
+        int mountID{ 0 };
+        handle->handle_bytes = MAX_HANDLE_SZ;
+        if (::statfs(dir.c_str(), &st) == -1
+            || ::name_to_handle_at(AT_FDCWD, dir.c_str(), handle, &mountID, 0) == -1) {
+            return LINGLONG_ERR(QString{ "get file handle: %1" }.arg(::strerror(errno)), errno);
+        }
+        recorder->dirs.emplace(handleKey(&st.f_fsid, *handle), dir);
+        return LINGLONG_OK;
+    };
+
+    for (const auto &dir : dirs) {
+        std::error_code ec;
+        if (!std::filesystem::is_directory(dir, ec)) {
+            continue;
+        }
+
+        auto ret = mark(dir);
+        if (!ret) {
+            return LINGLONG_ERR(ret);
+        }
+
+        std::filesystem::recursive_directory_iterator it{
+            dir,
+            std::filesystem::directory_options::skip_permission_denied,
+            ec
+        };
+        for (; !ec && it != std::filesystem::recursive_directory_iterator{}; it.increment(ec)) {
+            if (it->is_symlink(ec) || !it->is_directory(ec)) {
+                continue;
+            }
+
+            ret = mark(it->path());
+            if (!ret) {
+                return LINGLONG_ERR(ret);
+            }
+        }
+        if (ec) {
+            return LINGLONG_ERR("walk " + QString::fromStdString(dir.string()), ec);
+        }
+    }
+
+    return recorder;
+}
+
+auto ReadaheadRecorder::record(std::chrono::milliseconds timeout) noexcept
+  -> utils::error::Result<std::set<std::filesystem::path>>
+{
+    LINGLONG_TRACE("record opened files");
+
+    std::set<std::filesystem::path> files;
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    alignas(fanotify_event_metadata) char buffer[64 * 1024];
+    while (true) {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+          deadline - std::chrono::steady_clock::now());
+        if (remaining.count() <= 0) {
+            break;
+        }
+
+        pollfd fds[] = {
+            { .fd = this->fanotifyFd, .events = POLLIN, .revents = 0 },
+            { .fd = this->stopFd, .events = POLLIN, .revents = 0 },
+        };
+        auto ret = ::poll(fds, 2, static_cast<int>(remaining.count()));
+        if (ret == -1 && errno == EINTR) {
+            continue;
+        }
+        if (ret == -1) {
+            return LINGLONG_ERR(QString{ "poll: %1" }.arg(::strerror(errno)), errno);
+        }
+
+        // the events queued before stopping are still read
+        while (true) {
+            auto len = ::read(this->fanotifyFd, buffer, sizeof(buffer));
+            if (len == -1 && errno == EINTR) {
+                continue;
+            }
+            if (len == -1 && errno == EAGAIN) {
+                break;
+            }
+            if (len == -1) {
+                return LINGLONG_ERR(QString{ "read: %1" }.arg(::strerror(errno)), errno);
+            }
+
+            auto *event = reinterpret_cast<fanotify_event_metadata *>(buffer);
+            for (; FAN_EVENT_OK(event, len); event = FAN_EVENT_NEXT(event, len)) {
+                if ((event->mask & FAN_Q_OVERFLOW) != 0) {
+                    qWarning() << "fanotify event queue overflowed, some opened files are lost";
+                    continue;
+                }
+
+                auto *info = reinterpret_cast<fanotify_event_info_fid *>(event + 1);
+                if (info->hdr.info_type != FAN_EVENT_INFO_TYPE_DFID_NAME) {
+                    continue;
+                }
+
+                auto *handle = reinterpret_cast<file_handle *>(info->handle);
+                auto it = this->dirs.find(handleKey(&info->fsid, *handle));
+                if (it == this->dirs.end()) {
+                    continue;
+                }
+
+                const auto *name = reinterpret_cast<const char *>(handle->f_handle)
+                  + handle->handle_bytes;
+                files.insert(it->second / name);
+            }
+        }
+
+        if ((fds[1].revents & POLLIN) != 0) {
+            break;
+        }
+    }
+
+    return files;
+}
+
+void ReadaheadRecorder::stop() noexcept
+{
+    std::uint64_t value{ 1 };
+    if (::write(this->stopFd, &value, sizeof(value)) == -1) {
+        qWarning() << "failed to stop recording opened files:" << ::strerror(errno);
+    }
+}
+
+ReadaheadSession::ReadaheadSession(Readahead readahead,
+                                   const QString &appID,
+                                   const std::vector<std::filesystem::path> &layers,
+                                   std::chrono::milliseconds recordDuration) noexcept
+{
+    auto key = readaheadKey(layers);
+    auto ranges = readahead.load(appID, key);
+    if (ranges) {
+        this->thread = std::thread([this, ranges = std::move(*ranges)]() {
+            runtime::readahead(ranges, this->stopped);
+        });
+        return;
+    }
+
+    auto started = ReadaheadRecorder::start(layers);
+    if (!started) {
+        qWarning() << "failed to record readahead profile:" << started.error().message();
+        return;
+    }
+    this->recorder = std::move(*started);
+
+    this->thread = std::thread([this,
+                                readahead = std::move(readahead),
+                                appID,
+                                key = std::move(key),
+                                recordDuration]() mutable {
+        auto files = this->recorder->record(recordDuration);
+        if (!files) {
+            qWarning() << "failed to record readahead profile:" << files.error().message();
+            return;
+        }
+
+        std::vector<ReadaheadRange> profile;
+        for (const auto &file : *files) {
+            auto fileRanges = residentRanges(file);
+            if (!fileRanges) {
+                continue;
+            }
+            profile.insert(profile.end(), fileRanges->begin(), fileRanges->end());
+        }
+
+        auto ret = readahead.store(appID, key, profile);
+        if (!ret) {
+            qWarning() << ret.error().message();
+        }
+    });
+}
+
+ReadaheadSession::~ReadaheadSession()
+{
+    this->stopped = true;
+    if (this->recorder) {
+        this->recorder->stop();
+    }
+    if (this->thread.joinable()) {
+        this->thread.join();
+    }
+}
+
+} // namespace linglong::runtime
@@ -0,0 +1,119 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include "linglong/utils/error/error.h"
+
+#include <QDir>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <optional>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace linglong::runtime {
+
+struct ReadaheadRange
+{
+    std::string path;
+    std::uint64_t offset{ 0 };
+    std::uint64_t length{ 0 };
+};
+
+// Readahead keeps the profile of the file ranges read by every application during its startup,
+// the later launches read them into the page cache before the application asks for them, so the
+// startup after boot or page cache eviction doesn't wait for the random reads across the layers.
+class Readahead
+{
+public:
+    explicit Readahead(QDir dir) noexcept;
+
+    // defaultDirectory returns ${XDG_CACHE_HOME}/linglong/readahead
+    static QDir defaultDirectory() noexcept;
+
+    [[nodiscard]] auto load(const QString &appID, const std::string &key) const noexcept
+      -> std::optional<std::vector<ReadaheadRange>>;
+    utils::error::Result<void> store(const QString &appID,
+                                     const std::string &key,
+                                     const std::vector<ReadaheadRange> &ranges) noexcept;
+
+private:
+    QDir dir;
+};
+
+// readaheadKey digests the layer directories, which contain the commits of the layers
+auto readaheadKey(const std::vector<std::filesystem::path> &layers) noexcept -> std::string;
+
+// residentRanges returns the ranges of the file in the page cache
+auto residentRanges(const std::filesystem::path &path) noexcept
+  -> utils::error::Result<std::vector<ReadaheadRange>>;
+
+// readahead reads the ranges into the page cache until it's stopped, the missing files are skipped
+void readahead(const std::vector<ReadaheadRange> &ranges, const std::atomic_bool &stopped) noexcept;
+
+// ReadaheadRecorder watches the files opened in the directories with fanotify. The directories are
+// marked one by one with FAN_EVENT_ON_CHILD and the events report the names in them, which works
+// without privileges since Linux 5.13.
+class ReadaheadRecorder
+{
+public:
+    ReadaheadRecorder(const ReadaheadRecorder &) = delete;
+    ReadaheadRecorder(ReadaheadRecorder &&) = delete;
+    ReadaheadRecorder &operator=(const ReadaheadRecorder &) = delete;
+    ReadaheadRecorder &operator=(ReadaheadRecorder &&) = delete;
+    ~ReadaheadRecorder();
+
+    // start marks the directories and their subdirectories, the files opened after it returns are
+    // recorded
+    static auto start(const std::vector<std::filesystem::path> &dirs) noexcept
+      -> utils::error::Result<std::unique_ptr<ReadaheadRecorder>>;
+
+    // record returns the files opened until the timeout or stop is called
+    auto record(std::chrono::milliseconds timeout) noexcept
+      -> utils::error::Result<std::set<std::filesystem::path>>;
+    // stop makes record return, it can be called from other threads
+    void stop() noexcept;
+
+private:
+    ReadaheadRecorder() = default;
+
+    int fanotifyFd{ -1 };
+    int stopFd{ -1 };
+    // the paths of the marked directories indexed by their filesystem IDs and file handles
+    std::map<std::string, std::filesystem::path> dirs;
+};
+
+// ReadaheadSession reads ahead the ranges in the profile of the layers in the background if it's
+// recorded, otherwise records the files opened in the layers for a while and stores the ranges of
+// them in the page cache as the profile. Recording after dropping the page cache gives the exact
+// ranges read by the application.
+class ReadaheadSession
+{
+public:
+    ReadaheadSession(Readahead readahead,
+                     const QString &appID,
+                     const std::vector<std::filesystem::path> &layers,
+                     std::chrono::milliseconds recordDuration) noexcept;
+    ReadaheadSession(const ReadaheadSession &) = delete;
+    ReadaheadSession(ReadaheadSession &&) = delete;
+    ReadaheadSession &operator=(const ReadaheadSession &) = delete;
+    ReadaheadSession &operator=(ReadaheadSession &&) = delete;
+    // the destructor stops reading ahead or recording, the recorded profile is stored
+    ~ReadaheadSession();
+
+private:
+    std::atomic_bool stopped{ false };
+    std::unique_ptr<ReadaheadRecorder> recorder;
+    std::thread thread;
+};
+
+} // namespace linglong::runtime
@@ -0,0 +1,382 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "linglong/runtime/resource_policy.h"
+
+#include "linglong/api/types/v1/ApplicationConfiguration.hpp"
+#include "linglong/api/types/v1/Generators.hpp"
+#include "linglong/utils/serialize/yaml.h"
+
+#include <QDBusArgument>
+#include <QDBusConnection>
+#include <QDBusMessage>
+#include <QDBusMetaType>
+#include <QDBusVariant>
+#include <QStandardPaths>
+
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <fstream>
+#include <thread>
+
+#include <unistd.h>
+
+namespace linglong::runtime {
+
+namespace {
+
+// UnitProperty is the `(sv)` of the properties of systemd units
+struct UnitProperty
+{
+    QString name;
+    QDBusVariant value;
+};
+
+// UnitAuxiliary is the `(sa(sv))` of the auxiliary units of StartTransientUnit
+struct UnitAuxiliary
+{
+    QString name;
+    QList<UnitProperty> properties;
+};
+
+} // namespace
+
+} // namespace linglong::runtime
+
+Q_DECLARE_METATYPE(linglong::runtime::UnitProperty)
+Q_DECLARE_METATYPE(linglong::runtime::UnitAuxiliary)
+
+namespace linglong::runtime {
+
+namespace {
+
+QDBusArgument &operator<<(QDBusArgument &argument, const UnitProperty &property)
+{
+    argument.beginStructure();
+    argument << property.name << property.value;
+    argument.endStructure();
+    return argument;
+}
+
+const QDBusArgument &operator>>(const QDBusArgument &argument, UnitProperty &property)
+{
+    argument.beginStructure();
+    argument >> property.name >> property.value;
+    argument.endStructure();
+    return argument;
+}
+
+QDBusArgument &operator<<(QDBusArgument &argument, const UnitAuxiliary &auxiliary)
+{
+    argument.beginStructure();
+    argument << auxiliary.name << auxiliary.properties;
+    argument.endStructure();
+    return argument;
+}
+
+const QDBusArgument &operator>>(const QDBusArgument &argument, UnitAuxiliary &auxiliary)
+{
+    argument.beginStructure();
+    argument >> auxiliary.name >> auxiliary.properties;
+    argument.endStructure();
+    return argument;
+}
+
+constexpr auto systemdService = "org.freedesktop.systemd1";
+constexpr auto systemdPath = "/org/freedesktop/systemd1";
+constexpr auto systemdManager = "org.freedesktop.systemd1.Manager";
+
+auto readValue(const std::filesystem::path &file) noexcept -> std::optional<std::int64_t>
+{
+    std::ifstream stream(file);
+    std::string content;
+    if (!std::getline(stream, content)) {
+        return std::nullopt;
+    }
+
+    std::int64_t value{ 0 };
+    auto [end, ec] = std::from_chars(content.data(), content.data() + content.size(), value);
+    if (ec != std::errc{}) {
+        return std::nullopt;
+    }
+
+    return value;
+}
+
+} // namespace
+
+auto mergeResources(const std::optional<Resources> &package,
+                    const std::optional<Resources> &user) noexcept -> std::optional<Resources>
+{
+    if (!package || !user) {
+        return package ? package : user;
+    }
+
+    auto merged = *package;
+    auto override = [](std::optional<std::int64_t> &value,
+                       const std::optional<std::int64_t> &userValue) {
+        if (userValue) {
+            value = userValue;
+        }
+    };
+    override(merged.cpuWeight, user->cpuWeight);
+    override(merged.ioWeight, user->ioWeight);
+    override(merged.memoryHigh, user->memoryHigh);
+    override(merged.memoryMax, user->memoryMax);
+    override(merged.pidsMax, user->pidsMax);
+
+    return merged;
+}
+
+auto userResources(const QString &appID) noexcept -> std::optional<Resources>
+{
+    auto filePath =
+      QStandardPaths::locate(QStandardPaths::ConfigLocation, "linglong/" + appID + "/config.yaml");
+    if (filePath.isEmpty()) {
+        return std::nullopt;
+    }
+
+    LINGLONG_TRACE(QString("get resources of application %1").arg(appID));
+
+    auto config =
+      utils::serialize::LoadYAMLFile<api::types::v1::ApplicationConfiguration>(filePath);
+    if (!config) {
+        qWarning() << LINGLONG_ERRV(config);
+        return std::nullopt;
+    }
+
+    if (!config->permissions) {
+        return std::nullopt;
+    }
+
+    return config->permissions->resources;
+}
+
+auto unitProperties(const Resources &resources) noexcept
+  -> std::vector<std::pair<std::string, std::uint64_t>>
+{
+    std::vector<std::pair<std::string, std::uint64_t>> properties;
+
+    auto weight = [&properties](const char *name, const std::optional<std::int64_t> &value) {
+        if (!value) {
+            return;
+        }
+
+        if (*value < 1 || *value > 10000) {
+            qWarning() << "ignore" << name << *value << "out of range [1, 10000]";
+            return;
+        }
+
+        properties.emplace_back(name, *value);
+    };
+    auto limit = [&properties](const char *name, const std::optional<std::int64_t> &value) {
+        if (!value) {
+            return;
+        }
+
+        if (*value <= 0) {
+            qWarning() << "ignore" << name << *value << "which isn't positive";
+            return;
+        }
+
+        properties.emplace_back(name, *value);
+    };
+
+    weight("CPUWeight", resources.cpuWeight);
+    weight("IOWeight", resources.ioWeight);
+    limit("MemoryHigh", resources.memoryHigh);
+    limit("MemoryMax", resources.memoryMax);
+    limit("TasksMax", resources.pidsMax);
+
+    return properties;
+}
+
+auto escapeUnitName(const std::string &name) noexcept -> std::string
+{
+    constexpr auto hex = "0123456789abcdef";
+
+    std::string escaped;
+    for (std::size_t i = 0; i < name.size(); ++i) {
+        auto c = static_cast<unsigned char>(name[i]);
+        if (c == '/') {
+            escaped.push_back('-');
+            continue;
+        }
+
+        if (std::isalnum(c) != 0 || c == ':' || c == '_' || (c == '.' && i != 0)) {
+            escaped.push_back(static_cast<char>(c));
+            continue;
+        }
+
+        escaped.append("\\x");
+        escaped.push_back(hex[c >> 4]);
+        escaped.push_back(hex[c & 0xf]);
+    }
+
+    return escaped;
+}
+
+auto appUnitOf(const std::string &cgroup, const QString &appID) noexcept
+  -> std::optional<std::string>
+{
+    auto unit = std::filesystem::path(cgroup).filename().string();
+    if (unit.rfind("app-", 0) != 0) {
+        return std::nullopt;
+    }
+
+    auto name = unit;
+    for (const std::string suffix : { ".service", ".scope" }) {
+        if (name.size() > suffix.size()
+            && name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0) {
+            name.resize(name.size() - suffix.size());
+            break;
+        }
+    }
+    if (name.size() == unit.size()) {
+        return std::nullopt;
+    }
+
+    // the application ID is followed by the random part or nothing
+    auto id = "-" + escapeUnitName(appID.toStdString());
+    for (auto pos = name.find(id); pos != std::string::npos; pos = name.find(id, pos + 1)) {
+        auto end = pos + id.size();
+        if (end == name.size() || name[end] == '@' || name[end] == '-') {
+            return unit;
+        }
+    }
+
+    return std::nullopt;
+}
+
+auto cgroupOf(pid_t pid) noexcept -> std::optional<std::string>
+{
+    std::ifstream cgroups("/proc/" + std::to_string(pid) + "/cgroup");
+    std::string line;
+    while (std::getline(cgroups, line)) {
+        if (line.rfind("0::", 0) == 0) {
+            return line.substr(3);
+        }
+    }
+
+    return std::nullopt;
+}
+
+auto resourceUsage(const std::filesystem::path &cgroupDir) noexcept -> ResourceUsage
+{
+    ResourceUsage usage;
+
+    // cpu.stat is always available, the CPU time is counted without the cpu controller
+    std::ifstream cpuStat(cgroupDir / "cpu.stat");
+    std::string key;
+    std::int64_t value{ 0 };
+    while (cpuStat >> key >> value) {
+        if (key == "usage_usec") {
+            usage.cpuUsage = value;
+            break;
+        }
+    }
+
+    usage.memoryUsage = readValue(cgroupDir / "memory.current");
+    usage.tasks = readValue(cgroupDir / "pids.current");
+
+    return usage;
+}
+
+auto applyResources(const QString &appID,
+                    const QString &containerID,
+                    const Resources &resources) noexcept -> utils::error::Result<void>
+{
+    LINGLONG_TRACE(QString("apply resources of %1").arg(appID));
+
+    auto properties = unitProperties(resources);
+    if (properties.empty()) {
+        return LINGLONG_OK;
+    }
+
+    auto cgroup = cgroupOf(::getpid());
+    if (!cgroup || !std::filesystem::exists("/sys/fs/cgroup/cgroup.controllers")) {
+        return LINGLONG_ERR("cgroup v2 is unavailable");
+    }
+
+    auto bus = QDBusConnection::sessionBus();
+    if (!bus.isConnected()) {
+        return LINGLONG_ERR("session bus is unavailable");
+    }
+
+    static const auto registered = []() {
+        qDBusRegisterMetaType<UnitProperty>();
+        qDBusRegisterMetaType<QList<UnitProperty>>();
+        qDBusRegisterMetaType<UnitAuxiliary>();
+        qDBusRegisterMetaType<QList<UnitAuxiliary>>();
+        return true;
+    }();
+    Q_UNUSED(registered);
+
+    QList<UnitProperty> unitProperties;
+    for (const auto &[name, value] : properties) {
+        unitProperties.push_back({
+          .name = QString::fromStdString(name),
+          .value = QDBusVariant(QVariant::fromValue<qulonglong>(value)),
+        });
+    }
+
+    // the unit started by desktop environment is kept, so that it still manages the application
+    if (auto unit = appUnitOf(*cgroup, appID); unit) {
+        auto message = QDBusMessage::createMethodCall(systemdService,
+                                                      systemdPath,
+                                                      systemdManager,
+                                                      "SetUnitProperties");
+        message << QString::fromStdString(*unit) << true << QVariant::fromValue(unitProperties);
+        auto reply = bus.call(message);
+        if (reply.type() == QDBusMessage::ErrorMessage) {
+            return LINGLONG_ERR(QString("set properties of %1: %2")
+                                  .arg(QString::fromStdString(*unit), reply.errorMessage()));
+        }
+
+        return LINGLONG_OK;
+    }
+
+    auto unit = QString("app-linglong-%1-%2.scope")
+                  .arg(QString::fromStdString(escapeUnitName(appID.toStdString())),
+                       containerID.left(12));
+    unitProperties.push_back({
+      .name = "Description",
+      .value = QDBusVariant(QString("Linglong application %1").arg(appID)),
+    });
+    unitProperties.push_back({
+      .name = "CollectMode",
+      .value = QDBusVariant(QString("inactive-or-failed")),
+    });
+    unitProperties.push_back({
+      .name = "PIDs",
+      .value = QDBusVariant(QVariant::fromValue(QList<uint>{ static_cast<uint>(::getpid()) })),
+    });
+
+    auto message = QDBusMessage::createMethodCall(systemdService,
+                                                  systemdPath,
+                                                  systemdManager,
+                                                  "StartTransientUnit");
+    message << unit << QString("fail") << QVariant::fromValue(unitProperties)
+            << QVariant::fromValue(QList<UnitAuxiliary>{});
+    auto reply = bus.call(message);
+    if (reply.type() == QDBusMessage::ErrorMessage) {
+        return LINGLONG_ERR(QString("start %1: %2").arg(unit, reply.errorMessage()));
+    }
+
+    // the process is moved by the start job, which runs after the reply
+    constexpr auto timeout = std::chrono::seconds(1);
+    constexpr auto interval = std::chrono::milliseconds(5);
+    for (auto waited = std::chrono::milliseconds(0); waited < timeout; waited += interval) {
+        cgroup = cgroupOf(::getpid());
+        if (cgroup && std::filesystem::path(*cgroup).filename() == unit.toStdString()) {
+            return LINGLONG_OK;
+        }
+        std::this_thread::sleep_for(interval);
+    }
+
+    return LINGLONG_ERR(QString("process isn't moved to %1").arg(unit));
+}
+
+} // namespace linglong::runtime
@@ -0,0 +1,68 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include "linglong/api/types/v1/ApplicationConfigurationPermissionsResources.hpp"
+#include "linglong/utils/error/error.h"
+
+#include <QString>
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <sys/types.h>
+
+namespace linglong::runtime {
+
+using Resources = api::types::v1::ApplicationConfigurationPermissionsResources;
+
+struct ResourceUsage
+{
+    std::optional<std::int64_t> cpuUsage;
+    std::optional<std::int64_t> memoryUsage;
+    std::optional<std::int64_t> tasks;
+};
+
+// mergeResources returns the resources of the package, each of them can be overridden by the user
+auto mergeResources(const std::optional<Resources> &package,
+                    const std::optional<Resources> &user) noexcept -> std::optional<Resources>;
+
+// userResources returns the resources in ${XDG_CONFIG_HOME}/linglong/<appID>/config.yaml
+auto userResources(const QString &appID) noexcept -> std::optional<Resources>;
+
+// unitProperties converts the resources to the properties of systemd units, the invalid ones are
+// skipped
+auto unitProperties(const Resources &resources) noexcept
+  -> std::vector<std::pair<std::string, std::uint64_t>>;
+
+// escapeUnitName escapes the string to a part of systemd unit name like systemd-escape
+auto escapeUnitName(const std::string &name) noexcept -> std::string;
+
+// appUnitOf returns the name of the unit of the cgroup if it's started for the application, the
+// units of applications are named `app[-<launcher>]-<appID>[@<random>].service` or
+// `app[-<launcher>]-<appID>-<random>.scope` by desktop environments.
+auto appUnitOf(const std::string &cgroup, const QString &appID) noexcept
+  -> std::optional<std::string>;
+
+// cgroupOf returns the cgroup v2 of the process relative to /sys/fs/cgroup
+auto cgroupOf(pid_t pid) noexcept -> std::optional<std::string>;
+
+// resourceUsage reads the usage from the cgroup directory, the values of the disabled controllers
+// are missing
+auto resourceUsage(const std::filesystem::path &cgroupDir) noexcept -> ResourceUsage;
+
+// applyResources limits the resources of the current process and its children by the systemd user
+// instance. If the process is in the unit started for the application by desktop environment,
+// the properties of the unit are changed, otherwise the process is moved to a new scope
+// app-linglong-<appID>-<containerID>.scope, so the application is still recognized.
+auto applyResources(const QString &appID,
+                    const QString &containerID,
+                    const Resources &resources) noexcept -> utils::error::Result<void>;
+
+} // namespace linglong::runtime
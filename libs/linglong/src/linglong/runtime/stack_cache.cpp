@@ -0,0 +1,418 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "linglong/runtime/stack_cache.h"
+
+#include "linglong/digest/sha256.h"
+#include "linglong/package/architecture.h"
+#include "linglong/runtime/container_builder.h"
+#include "linglong/runtime/file_stamp.h"
+#include "ocppi/runtime/config/types/Generators.hpp"
+
+#include <QStandardPaths>
+
+#include <algorithm>
+#include <filesystem>
+#include <sstream>
+
+#include <unistd.h>
+
+namespace linglong::runtime {
+
+namespace {
+
+constexpr auto stagingDirName = "staging";
+// the parent directory of the caches generated by the builtin hooks in the container
+constexpr auto cacheDestination = "/run/linglong/cache/";
+
+// ldconfigCacheFile returns the cache file written by the ldconfig hook, which is passed with -C
+auto ldconfigCacheFile(const ocppi::runtime::config::types::Hook &hook) noexcept
+  -> std::optional<std::filesystem::path>
+{
+    if (std::filesystem::path{ hook.path }.filename() != "ldconfig" || !hook.args) {
+        return std::nullopt;
+    }
+
+    const auto &args = *hook.args;
+    auto it = std::find(args.cbegin(), args.cend(), "-C");
+    if (it == args.cend() || ++it == args.cend()) {
+        return std::nullopt;
+    }
+
+    return std::filesystem::path{ *it };
+}
+
+// shellGenerator returns the generator running the script in the destination directory, the done
+// file is created after the script whether it succeeds or not, so a failed generation isn't
+// retried until the inputs are changed
+auto shellGenerator(const std::string &name,
+                    std::vector<std::string> inputs,
+                    const std::string &script,
+                    std::map<std::string, std::string> env) -> StackCache::Generator
+{
+    auto destination = cacheDestination + name;
+    return {
+        .name = name,
+        .destination = destination,
+        .done = ".done",
+        .inputs = std::move(inputs),
+        .hook = {
+          .args = { { "/bin/sh",
+                      "-c",
+                      "cd " + destination + " || exit 1\n" + script + "touch .done\n" } },
+          .env = { { "PATH=/runtime/bin:/usr/bin:/bin" } },
+          .path = "/bin/sh",
+          .timeout = std::nullopt,
+        },
+        .env = std::move(env),
+    };
+}
+
+// hostPath returns the path of the file in the layers which is mounted to the path in the container
+auto hostPath(const ContainerOptions &opts, const std::string &path) noexcept
+  -> std::optional<QString>
+{
+    auto relative = [&path](const std::string &prefix) -> std::optional<std::string> {
+        if (path == prefix) {
+            return "";
+        }
+        if (path.rfind(prefix + "/", 0) == 0) {
+            return path.substr(prefix.size() + 1);
+        }
+        return std::nullopt;
+    };
+
+    if (auto rest = relative("/runtime"); rest) {
+        if (!opts.runtimeDir) {
+            return std::nullopt;
+        }
+        return QDir(opts.runtimeDir->filePath("files")).filePath(QString::fromStdString(*rest));
+    }
+
+    if (auto rest = relative("/opt/apps/" + opts.appID.toStdString() + "/files"); rest) {
+        if (!opts.appDir) {
+            return std::nullopt;
+        }
+        return QDir(opts.appDir->filePath("files")).filePath(QString::fromStdString(*rest));
+    }
+
+    return opts.baseDir.filePath("files" + QString::fromStdString(path));
+}
+
+// copyCache copies the generated cache to a temporary directory and renames it, so the cache is
+// complete once the directory exists
+auto copyCache(const QString &source, const QString &destination) noexcept
+  -> utils::error::Result<void>
+{
+    LINGLONG_TRACE("copy " + source + " to " + destination);
+
+    auto target = std::filesystem::path{ destination.toStdString() };
+    auto temporary = target;
+    temporary += ".tmp-" + std::to_string(::getpid());
+
+    std::error_code ec;
+    std::filesystem::remove_all(temporary, ec);
+    auto parent = temporary.parent_path();
+    std::filesystem::create_directories(parent, ec);
+    if (ec) {
+        return LINGLONG_ERR("create " + QString::fromStdString(parent.string()), ec);
+    }
+
+    // the symlinks to the files in the container are kept
+    std::filesystem::copy(source.toStdString(),
+                          temporary,
+                          std::filesystem::copy_options::recursive
+                            | std::filesystem::copy_options::copy_symlinks,
+                          ec);
+    if (ec) {
+        std::error_code ignored;
+        std::filesystem::remove_all(temporary, ignored);
+        return LINGLONG_ERR("copy", ec);
+    }
+
+    std::filesystem::rename(temporary, target, ec);
+    if (ec) {
+        std::error_code ignored;
+        std::filesystem::remove_all(temporary, ignored);
+        // the cache is collected by another launch
+        if (std::filesystem::exists(target, ignored)) {
+            return LINGLONG_OK;
+        }
+        return LINGLONG_ERR("rename", ec);
+    }
+
+    return LINGLONG_OK;
+}
+
+} // namespace
+
+StackCache::StackCache(QDir dir) noexcept
+    : dir(std::move(dir))
+{
+}
+
+QDir StackCache::defaultDirectory() noexcept
+{
+    return QDir(QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation))
+      .filePath("linglong/stack-cache");
+}
+
+auto StackCache::generators(const ocppi::runtime::config::types::Config &config,
+                            const QString &appID,
+                            const QString &triplet) noexcept -> std::vector<Generator>
+{
+    auto t = triplet.toStdString();
+    auto appFiles = "/opt/apps/" + appID.toStdString() + "/files";
+    std::vector<Generator> generators;
+
+    // ldconfig writes the cache to a temporary file in the same directory and renames it, so the
+    // whole directory is mounted
+    if (config.hooks && config.hooks->startContainer) {
+        for (const auto &hook : *config.hooks->startContainer) {
+            auto cacheFile = ldconfigCacheFile(hook);
+            if (!cacheFile) {
+                continue;
+            }
+
+            generators.push_back({
+              .name = "ld.so.cache",
+              .destination = cacheFile->parent_path().string(),
+              .done = cacheFile->filename().string(),
+              .inputs = { "/etc/ld.so.conf",
+                          "/etc/ld.so.conf.d",
+                          "/lib",
+                          "/lib/" + t,
+                          "/lib64",
+                          "/usr/lib",
+                          "/usr/lib/" + t,
+                          "/usr/lib64",
+                          "/usr/local/lib",
+                          "/runtime/lib",
+                          "/runtime/lib/" + t,
+                          appFiles + "/lib",
+                          appFiles + "/lib/" + t },
+              .hook = hook,
+              .env = {},
+            });
+            break;
+        }
+    }
+
+    // the cache directory is listed before the ones of the base, so fc-cache writes to it
+    generators.push_back(shellGenerator(
+      "fontconfig",
+      { "/etc/fonts",
+        "/etc/fonts/conf.d",
+        "/usr/share/fonts",
+        "/usr/local/share/fonts",
+        "/runtime/share/fonts",
+        appFiles + "/share/fonts" },
+      std::string{ R"(printf '<?xml version="1.0"?>\n<fontconfig>\n)" }
+        + R"(  <cachedir>)" + cacheDestination + R"(fontconfig</cachedir>\n)"
+        + R"(  <include ignore_missing="yes">/etc/fonts/fonts.conf</include>\n</fontconfig>\n')"
+        + " >fonts.conf.tmp\n"
+        + "FONTCONFIG_FILE=$PWD/fonts.conf.tmp fc-cache && mv fonts.conf.tmp fonts.conf\n",
+      { { "FONTCONFIG_FILE", "fonts.conf" } }));
+
+    // the tools of the runtime are preferred, since they scan the modules of the runtime
+    auto query = [&t](const std::string &tool, const std::string &command) {
+        return "for query in /runtime/lib/" + t + "/" + tool + " /usr/lib/" + t + "/" + tool
+          + "; do\n  if [ -x \"$query\" ]; then\n    " + command + "\n    break\n  fi\ndone\n";
+    };
+    generators.push_back(shellGenerator(
+      "gdk-pixbuf",
+      { "/usr/lib/" + t + "/gdk-pixbuf-2.0/2.10.0/loaders",
+        "/runtime/lib/" + t + "/gdk-pixbuf-2.0/2.10.0/loaders" },
+      query("gdk-pixbuf-2.0/gdk-pixbuf-query-loaders",
+            R"("$query" >loaders.cache.tmp && mv loaders.cache.tmp loaders.cache)"),
+      { { "GDK_PIXBUF_MODULE_FILE", "loaders.cache" } }));
+    generators.push_back(shellGenerator(
+      "gtk-3.0",
+      { "/usr/lib/" + t + "/gtk-3.0/3.0.0/immodules",
+        "/runtime/lib/" + t + "/gtk-3.0/3.0.0/immodules" },
+      query("libgtk-3-0/gtk-query-immodules-3.0",
+            R"("$query" >immodules.cache.tmp && mv immodules.cache.tmp immodules.cache)"),
+      { { "GTK_IM_MODULE_FILE", "immodules.cache" } }));
+
+    // giomodule.cache is read from the directory of the modules, which is read-only in the layers,
+    // so the modules of the base and runtime are linked to a directory with the cache
+    generators.push_back(shellGenerator(
+      "gio",
+      { "/usr/lib/" + t + "/gio/modules", "/runtime/lib/" + t + "/gio/modules" },
+      "mkdir -p modules\nfor module in /usr/lib/" + t + "/gio/modules/*.so /runtime/lib/" + t
+        + "/gio/modules/*.so; do\n  [ -e \"$module\" ] && ln -sf \"$module\" modules/\ndone\n"
+        + query("glib-2.0/gio-querymodules", R"("$query" modules)"),
+      { { "GIO_MODULE_DIR", "modules" } }));
+
+    return generators;
+}
+
+utils::error::Result<void> StackCache::apply(const ContainerOptions &opts,
+                                             const QDir &bundleDir,
+                                             ocppi::runtime::config::types::Config &config) const
+  noexcept
+{
+    LINGLONG_TRACE("apply stack caches");
+
+    auto arch = package::Architecture::currentCPUArchitecture();
+    if (!arch) {
+        return LINGLONG_ERR(arch);
+    }
+
+    auto generators = StackCache::generators(config, opts.appID, arch->getTriplet());
+    auto result = config;
+    if (!result.hooks) {
+        result.hooks = ocppi::runtime::config::types::Hooks{};
+    }
+    if (!result.hooks->startContainer) {
+        result.hooks->startContainer = std::vector<ocppi::runtime::config::types::Hook>{};
+    }
+    if (!result.mounts) {
+        result.mounts = std::vector<ocppi::runtime::config::types::Mount>{};
+    }
+    auto &hooks = *result.hooks->startContainer;
+    auto &mounts = *result.mounts;
+
+    auto collected = false;
+    for (const auto &generator : generators) {
+        // the hooks of the caches which the layers have no inputs for are skipped
+        auto hasInputs =
+          std::any_of(generator.inputs.cbegin(), generator.inputs.cend(), [&opts](const auto &in) {
+              auto path = hostPath(opts, in);
+              return path && QFileInfo::exists(*path);
+          });
+        if (!hasInputs) {
+            continue;
+        }
+
+        auto key = QString::fromStdString(stackCacheKey(opts, generator));
+        auto name = QString::fromStdString(generator.name);
+        auto done = QString::fromStdString(generator.done);
+        QDir cacheDir = this->dir.filePath(name + "/" + key);
+        if (!cacheDir.exists(done) && !collected) {
+            this->collect(generators, bundleDir);
+            collected = true;
+        }
+
+        auto hookJSON = nlohmann::json(generator.hook);
+        auto hook = std::find_if(hooks.begin(), hooks.end(), [&hookJSON](const auto &item) {
+            return nlohmann::json(item) == hookJSON;
+        });
+        ocppi::runtime::config::types::Mount mount{
+            .destination = generator.destination,
+            .gidMappings = {},
+            .options = { { "rbind", "ro", "nosuid", "nodev" } },
+            .source = cacheDir.absolutePath().toStdString(),
+            .type = "bind",
+            .uidMappings = {},
+        };
+
+        if (cacheDir.exists(done)) {
+            if (hook != hooks.end()) {
+                hooks.erase(hook);
+            }
+            for (const auto &[env, file] : generator.env) {
+                if (result.process && result.process->env
+                    && cacheDir.exists(QString::fromStdString(file))) {
+                    result.process->env->push_back(env + "=" + generator.destination + "/" + file);
+                }
+            }
+        } else {
+            // the staging directory is named after the container, it's removed after the bundle
+            // directory
+            QDir staging = this->dir.filePath(
+              QString("%1/%2/%3/%4").arg(QString(stagingDirName), name, key, bundleDir.dirName()));
+            if (!staging.mkpath(".")) {
+                return LINGLONG_ERR("create " + staging.absolutePath());
+            }
+            mount.options = { { "rbind", "nosuid", "nodev" } };
+            mount.source = staging.absolutePath().toStdString();
+            if (hook == hooks.end()) {
+                hooks.push_back(generator.hook);
+            }
+        }
+
+        auto existing = std::find_if(mounts.begin(), mounts.end(), [&generator](const auto &item) {
+            return item.destination == generator.destination;
+        });
+        if (existing != mounts.end()) {
+            *existing = std::move(mount);
+        } else {
+            mounts.push_back(std::move(mount));
+        }
+    }
+
+    config = std::move(result);
+    return LINGLONG_OK;
+}
+
+void StackCache::collect(const std::vector<Generator> &generators,
+                         const QDir &bundleDir) const noexcept
+{
+    LINGLONG_TRACE("collect stack caches");
+
+    // the bundle directories of all containers are in the same directory
+    auto bundlesDir = QFileInfo(bundleDir.absolutePath()).dir();
+    QDir staging = this->dir.filePath(stagingDirName);
+    for (const auto &name : staging.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+        auto generator =
+          std::find_if(generators.cbegin(), generators.cend(), [&name](const auto &item) {
+              return QString::fromStdString(item.name) == name.fileName();
+          });
+
+        QDir nameDir(name.absoluteFilePath());
+        for (const auto &key : nameDir.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+            QDir cacheDir = this->dir.filePath(name.fileName() + "/" + key.fileName());
+            QDir keyDir(key.absoluteFilePath());
+            for (const auto &container : keyDir.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+                QDir containerDir(container.absoluteFilePath());
+                // the done file is created after the cache is written
+                if (generator != generators.cend() && !cacheDir.exists()
+                    && containerDir.exists(QString::fromStdString(generator->done))) {
+                    auto ret = copyCache(containerDir.absolutePath(), cacheDir.absolutePath());
+                    if (!ret) {
+                        qWarning() << LINGLONG_ERRV(ret);
+                    }
+                }
+
+                if (!bundlesDir.exists(container.fileName())) {
+                    containerDir.removeRecursively();
+                }
+            }
+
+            // they're only removed if all containers of the stack have exited
+            nameDir.rmdir(key.fileName());
+        }
+        staging.rmdir(name.fileName());
+    }
+}
+
+auto stackCacheKey(const ContainerOptions &opts, const StackCache::Generator &generator) noexcept
+  -> std::string
+{
+    std::ostringstream stream;
+    stream << "generator " << generator.name << " " << nlohmann::json(generator.hook).dump()
+           << "\n";
+
+    // the layers are checked out to the directories named after their commits, the inputs are
+    // checked as well, since the layers of ll-builder are changed in place
+    stream << "app " << opts.appID.toStdString() << "\n";
+    stream << "appDir " << (opts.appDir ? opts.appDir->absolutePath().toStdString() : "") << "\n";
+    stream << "runtimeDir "
+           << (opts.runtimeDir ? opts.runtimeDir->absolutePath().toStdString() : "") << "\n";
+    stream << "baseDir " << opts.baseDir.absolutePath().toStdString() << "\n";
+    for (const auto &input : generator.inputs) {
+        auto path = hostPath(opts, input);
+        if (path) {
+            writeFileStamp(stream, *path);
+        }
+    }
+
+    auto content = stream.str();
+    digest::SHA256 sha256;
+    sha256.update(content.data(), content.size());
+    return sha256.hexDigest();
+}
+
+} // namespace linglong::runtime
@@ -0,0 +1,74 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include "linglong/utils/error/error.h"
+#include "ocppi/runtime/config/types/Config.hpp"
+#include "ocppi/runtime/config/types/Hook.hpp"
+
+#include <QDir>
+
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace linglong::runtime {
+
+struct ContainerOptions;
+
+// StackCache keeps the caches generated by the startContainer hooks for every stack of base,
+// runtime and application layers, e.g. ld.so.cache and the caches of fontconfig, gdk-pixbuf
+// loaders, GIO modules and GTK input method modules. The first launch of a stack runs the hooks
+// with their output directories bound to staging directories, the later launches bind the
+// collected caches read-only and skip the hooks.
+class StackCache
+{
+public:
+    struct Generator
+    {
+        std::string name;
+        // the directory in the container where the hook writes the cache
+        std::string destination;
+        // the file created in the destination when the hook finishes
+        std::string done;
+        // the paths in the container which the cache is generated from
+        std::vector<std::string> inputs;
+        ocppi::runtime::config::types::Hook hook;
+        // the environment variables pointing to the files in the destination, they're only set if
+        // the files are generated
+        std::map<std::string, std::string> env;
+    };
+
+    explicit StackCache(QDir dir) noexcept;
+
+    // defaultDirectory returns ${XDG_CACHE_HOME}/linglong/stack-cache
+    static QDir defaultDirectory() noexcept;
+
+    // generators returns the generators of the caches, the one of ld.so.cache is the ldconfig hook
+    // of the configuration if there is one
+    static auto generators(const ocppi::runtime::config::types::Config &config,
+                           const QString &appID,
+                           const QString &triplet) noexcept -> std::vector<Generator>;
+
+    // apply rewrites the mounts and hooks of the configuration for the caches, the configuration is
+    // unchanged on failure
+    utils::error::Result<void> apply(const ContainerOptions &opts,
+                                     const QDir &bundleDir,
+                                     ocppi::runtime::config::types::Config &config) const noexcept;
+
+private:
+    // collect saves the caches generated by the previous launches, and removes the staging
+    // directories of the containers which have exited
+    void collect(const std::vector<Generator> &generators, const QDir &bundleDir) const noexcept;
+
+    QDir dir;
+};
+
+// stackCacheKey digests the layers, the inputs of the generator in them and its hook
+auto stackCacheKey(const ContainerOptions &opts, const StackCache::Generator &generator) noexcept
+  -> std::string;
+
+} // namespace linglong::runtime
@@ -0,0 +1,104 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <gtest/gtest.h>
+
+#include "linglong/box/seccomp.h"
+#include "linglong/box/state.h"
+
+#include <linux/seccomp.h>
+
+#include <cstdlib>
+#include <fstream>
+
+#include <unistd.h>
+
+namespace box = linglong::box;
+
+namespace {
+
+class BoxStateTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        char dir[] = "/tmp/ll-box-state-test-XXXXXX";
+        ASSERT_NE(::mkdtemp(dir), nullptr);
+        this->root = dir;
+    }
+
+    void TearDown() override
+    {
+        std::error_code ec;
+        std::filesystem::remove_all(this->root, ec);
+    }
+
+    void write(const std::string &id, const nlohmann::json &state)
+    {
+        std::ofstream(box::stateFile(this->root, id)) << state.dump();
+    }
+
+    std::filesystem::path root;
+};
+
+} // namespace
+
+TEST_F(BoxStateTest, FindState)
+{
+    write("running", { { "id", "running" }, { "pid", ::getpid() }, { "initPid", 1 } });
+    auto state = box::findState(this->root, "running");
+    ASSERT_TRUE(state.has_value());
+    EXPECT_EQ(state->value("initPid", -1), 1);
+    EXPECT_FALSE(box::seccompRecord(*state).has_value());
+
+    // the id must match the file name
+    write("other", { { "id", "running" } });
+    EXPECT_FALSE(box::findState(this->root, "other").has_value());
+    EXPECT_FALSE(box::findState(this->root, "../running").has_value());
+    EXPECT_FALSE(box::findState(this->root, "missing").has_value());
+
+    // the state of an exited ll-box is removed
+    write("stale", { { "id", "stale" }, { "pid", 2147483647 } });
+    EXPECT_FALSE(box::findState(this->root, "stale").has_value());
+    EXPECT_FALSE(std::filesystem::exists(box::stateFile(this->root, "stale")));
+}
+
+TEST_F(BoxStateTest, SeccompRecord)
+{
+    nlohmann::json state = { { "id", "test" } };
+    box::setSeccompRecord(state, { .program = "/run/ll-box/seccomp/test.bpf", .flags = 2U });
+    write("test", state);
+
+    auto loaded = box::findState(this->root, "test");
+    ASSERT_TRUE(loaded.has_value());
+    auto record = box::seccompRecord(*loaded);
+    ASSERT_TRUE(record.has_value());
+    EXPECT_EQ(record->program, "/run/ll-box/seccomp/test.bpf");
+    EXPECT_EQ(record->flags, 2U);
+
+    EXPECT_EQ(box::seccompExecFile(this->root, "test"),
+              box::seccompCacheDir(this->root) / "exec" / "test.bpf");
+}
+
+TEST_F(BoxStateTest, Program)
+{
+    const std::vector<sock_filter> program{
+        BPF_STMT(BPF_LD | BPF_W | BPF_ABS, 0),
+        BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
+    };
+    auto file = box::seccompExecFile(this->root, "test");
+    ASSERT_TRUE(box::writeProgram(file, program));
+
+    auto loaded = box::readProgram(file);
+    ASSERT_TRUE(loaded.has_value());
+    ASSERT_EQ(loaded->size(), program.size());
+    EXPECT_EQ(loaded->at(1).k, static_cast<__u32>(SECCOMP_RET_ALLOW));
+
+    // the files which aren't made of whole instructions are refused
+    std::ofstream(file, std::ios::trunc) << "bad";
+    EXPECT_FALSE(box::readProgram(file).has_value());
+    std::ofstream(file, std::ios::trunc).close();
+    EXPECT_FALSE(box::readProgram(file).has_value());
+    EXPECT_FALSE(box::readProgram(this->root / "missing.bpf").has_value());
+}
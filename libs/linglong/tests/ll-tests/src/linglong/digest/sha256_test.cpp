@@ -0,0 +1,134 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <gtest/gtest.h>
+
+#include "linglong/digest/sha256.h"
+
+#include <openssl/evp.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <limits>
+#include <random>
+#include <string>
+
+namespace digest = linglong::digest;
+
+namespace {
+
+std::string hexDigest(digest::SHA256::Implementation impl, const std::string &data)
+{
+    digest::SHA256 sha256(impl);
+    sha256.update(data.data(), data.size());
+    return sha256.hexDigest();
+}
+
+} // namespace
+
+// test vectors from FIPS 180-2 and https://www.di-mgt.com.au/sha_testvectors.html
+TEST(SHA256, KnownAnswer)
+{
+    const std::vector<std::pair<std::string, std::string>> vectors{
+        { "", "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855" },
+        { "abc", "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad" },
+        { "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq",
+          "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1" },
+        { "abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmnoijklmnopjklmnopqklmnopqr"
+          "lmnopqrsmnopqrstnopqrstu",
+          "cf5b16a778af8380036ce59e7b0492370b249b11e8f07a51afac45037afee9d1" },
+        { std::string(1000000, 'a'),
+          "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0" },
+    };
+
+    for (auto impl : digest::SHA256::supportedImplementations()) {
+        SCOPED_TRACE(digest::SHA256::implementationName(impl));
+        for (const auto &[data, expected] : vectors) {
+            EXPECT_EQ(hexDigest(impl, data), expected) << data.substr(0, 64);
+        }
+    }
+}
+
+TEST(SHA256, DefaultImplementation)
+{
+    digest::SHA256 sha256;
+    EXPECT_EQ(sha256.implementation(), digest::SHA256::supportedImplementations().back());
+    EXPECT_EQ(digest::SHA256::supportedImplementations().front(),
+              digest::SHA256::Implementation::Portable);
+}
+
+TEST(SHA256, SameAsOpenSSL)
+{
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<> dist(std::numeric_limits<unsigned char>::min(),
+                                         std::numeric_limits<unsigned char>::max());
+
+    std::array<std::byte, 16384> data{};
+    std::generate(data.begin(), data.end(), [&gen, &dist]() {
+        return static_cast<std::byte>(dist(gen));
+    });
+
+    // cover the lengths around the block boundary and the updates of random sizes
+    std::uniform_int_distribution<std::size_t> lengthDist(0, data.size());
+    std::vector<std::size_t> lengths{ 0, 1, 55, 56, 63, 64, 65, 119, 120, 128, data.size() };
+    for (int i = 0; i < 32; ++i) {
+        lengths.push_back(lengthDist(gen));
+    }
+
+    for (auto impl : digest::SHA256::supportedImplementations()) {
+        SCOPED_TRACE(digest::SHA256::implementationName(impl));
+        for (auto length : lengths) {
+            std::array<std::byte, 32> digest1{};
+            digest::SHA256 sha256_1(impl);
+            std::size_t pos = 0;
+            while (pos < length) {
+                auto size = std::min(std::uniform_int_distribution<std::size_t>(1, 200)(gen),
+                                     length - pos);
+                sha256_1.update(data.data() + pos, size);
+                pos += size;
+            }
+            sha256_1.final(digest1.data());
+
+            std::array<std::byte, 32> digest2{};
+            unsigned int len{ 0 };
+            auto ret = EVP_Digest(data.data(),
+                                  length,
+                                  reinterpret_cast<unsigned char *>(digest2.data()),
+                                  &len,
+                                  EVP_sha256(),
+                                  nullptr);
+            ASSERT_NE(ret, 0);
+            EXPECT_EQ(digest1, digest2) << "length " << length;
+        }
+    }
+}
+
+// run with --gtest_also_run_disabled_tests --gtest_filter='SHA256.DISABLED_Throughput'
+TEST(SHA256, DISABLED_Throughput)
+{
+    std::string data(256 * 1024 * 1024, '\0');
+    std::mt19937 gen(42);
+    std::generate(data.begin(), data.end(), [&gen]() {
+        return static_cast<char>(gen());
+    });
+
+    std::string expected;
+    for (auto impl : digest::SHA256::supportedImplementations()) {
+        auto begin = std::chrono::steady_clock::now();
+        auto result = hexDigest(impl, data);
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+
+        auto throughput = static_cast<double>(data.size()) / 1024 / 1024 / elapsed.count();
+        std::cout << digest::SHA256::implementationName(impl) << ": " << throughput << " MiB/s"
+                  << std::endl;
+        RecordProperty(digest::SHA256::implementationName(impl), std::to_string(throughput));
+
+        if (expected.empty()) {
+            expected = result;
+        }
+        EXPECT_EQ(result, expected);
+    }
+}
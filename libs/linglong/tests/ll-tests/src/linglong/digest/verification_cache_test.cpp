@@ -0,0 +1,179 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <gtest/gtest.h>
+
+#include "linglong/digest/verification_cache.h"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace digest = linglong::digest;
+
+namespace {
+
+constexpr auto expectedDigest = "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad";
+// the files in tests are always just created
+constexpr std::chrono::nanoseconds noRacyWindow{ 0 };
+
+class VerificationCacheTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        auto tmpl = (std::filesystem::temp_directory_path() / "verification-cache-XXXXXX").string();
+        ASSERT_NE(::mkdtemp(tmpl.data()), nullptr);
+        dir = tmpl;
+
+        bundle = dir / "app.uab";
+        std::ofstream{ bundle } << "abc";
+        fd = ::open(bundle.c_str(), O_RDONLY | O_CLOEXEC);
+        ASSERT_NE(fd, -1);
+    }
+
+    void TearDown() override
+    {
+        if (fd != -1) {
+            ::close(fd);
+        }
+        std::error_code ec;
+        std::filesystem::remove_all(dir, ec);
+    }
+
+    std::filesystem::path dir;
+    std::filesystem::path bundle;
+    int fd{ -1 };
+};
+
+} // namespace
+
+TEST_F(VerificationCacheTest, Hit)
+{
+    digest::VerificationCache cache(dir / "cache", noRacyWindow);
+    auto stamp = digest::FileStamp::of(fd);
+    ASSERT_TRUE(stamp);
+
+    EXPECT_FALSE(cache.verified(*stamp, expectedDigest));
+    ASSERT_TRUE(cache.remember(fd, *stamp, expectedDigest));
+    EXPECT_TRUE(cache.verified(*stamp, expectedDigest));
+
+    // a later launch stats the file again
+    auto again = digest::FileStamp::of(fd);
+    ASSERT_TRUE(again);
+    EXPECT_TRUE(cache.verified(*again, expectedDigest));
+
+    // the metadata of the bundle changed, the entry belongs to the old digest
+    EXPECT_FALSE(cache.verified(*again, std::string(64, '0')));
+    EXPECT_FALSE(cache.verified(*again, ""));
+
+    struct stat st{};
+    ASSERT_EQ(::stat(cache.entryPath(*stamp).c_str(), &st), 0);
+    EXPECT_EQ(st.st_mode & 0777, 0600U);
+    ASSERT_EQ(::stat((dir / "cache").c_str(), &st), 0);
+    EXPECT_EQ(st.st_mode & 0777, 0700U);
+}
+
+TEST_F(VerificationCacheTest, FileModified)
+{
+    digest::VerificationCache cache(dir / "cache", noRacyWindow);
+    auto stamp = digest::FileStamp::of(fd);
+    ASSERT_TRUE(stamp);
+    ASSERT_TRUE(cache.remember(fd, *stamp, expectedDigest));
+
+    // the ctime may be unchanged since there is no racy window, but the size is changed
+    std::ofstream{ bundle, std::ios::app } << "d";
+    auto modified = digest::FileStamp::of(fd);
+    ASSERT_TRUE(modified);
+    EXPECT_NE(*modified, *stamp);
+    EXPECT_FALSE(cache.verified(*modified, expectedDigest));
+
+    // the file was modified during the verification, nothing should be remembered
+    EXPECT_FALSE(cache.remember(fd, *stamp, expectedDigest));
+    EXPECT_FALSE(cache.verified(*modified, expectedDigest));
+}
+
+TEST_F(VerificationCacheTest, RecentlyChanged)
+{
+    digest::VerificationCache cache(dir / "cache");
+    auto stamp = digest::FileStamp::of(fd);
+    ASSERT_TRUE(stamp);
+    EXPECT_FALSE(cache.remember(fd, *stamp, expectedDigest));
+    EXPECT_FALSE(cache.verified(*stamp, expectedDigest));
+}
+
+TEST_F(VerificationCacheTest, FileReplaced)
+{
+    digest::VerificationCache cache(dir / "cache", noRacyWindow);
+    auto stamp = digest::FileStamp::of(fd);
+    ASSERT_TRUE(stamp);
+    ASSERT_TRUE(cache.remember(fd, *stamp, expectedDigest));
+
+    auto replacement = dir / "replacement.uab";
+    std::ofstream{ replacement } << "abc";
+    std::filesystem::rename(replacement, bundle);
+
+    auto newFd = ::open(bundle.c_str(), O_RDONLY | O_CLOEXEC);
+    ASSERT_NE(newFd, -1);
+    auto newStamp = digest::FileStamp::of(newFd);
+    ::close(newFd);
+    ASSERT_TRUE(newStamp);
+    EXPECT_FALSE(cache.verified(*newStamp, expectedDigest));
+}
+
+TEST_F(VerificationCacheTest, EntryTampered)
+{
+    digest::VerificationCache cache(dir / "cache", noRacyWindow);
+    auto stamp = digest::FileStamp::of(fd);
+    ASSERT_TRUE(stamp);
+    ASSERT_TRUE(cache.remember(fd, *stamp, expectedDigest));
+
+    auto entry = cache.entryPath(*stamp);
+    std::string content;
+    {
+        std::ifstream in{ entry };
+        content.assign(std::istreambuf_iterator<char>{ in }, std::istreambuf_iterator<char>{});
+    }
+    ASSERT_FALSE(content.empty());
+
+    auto rewrite = [&entry](const std::string &data) {
+        std::ofstream{ entry, std::ios::trunc } << data;
+        std::filesystem::permissions(entry,
+                                     std::filesystem::perms::owner_read
+                                       | std::filesystem::perms::owner_write);
+    };
+
+    // claim the entry is for another digest
+    auto pos = content.find(expectedDigest);
+    ASSERT_NE(pos, std::string::npos);
+    auto forged = content;
+    forged.replace(pos, 64, std::string(64, 'f'));
+    rewrite(forged);
+    EXPECT_FALSE(cache.verified(*stamp, expectedDigest));
+
+    rewrite(content.substr(0, content.size() / 2));
+    EXPECT_FALSE(cache.verified(*stamp, expectedDigest));
+
+    rewrite(content + "digest=" + std::string(64, 'f') + "\n");
+    EXPECT_FALSE(cache.verified(*stamp, expectedDigest));
+
+    // the original content is accepted only if nobody else could have written it
+    rewrite(content);
+    EXPECT_TRUE(cache.verified(*stamp, expectedDigest));
+    std::filesystem::permissions(entry,
+                                 std::filesystem::perms::others_write,
+                                 std::filesystem::perm_options::add);
+    EXPECT_FALSE(cache.verified(*stamp, expectedDigest));
+
+    // symlinks are not followed
+    std::filesystem::remove(entry);
+    auto target = dir / "target";
+    std::ofstream{ target } << content;
+    std::filesystem::create_symlink(target, entry);
+    EXPECT_FALSE(cache.verified(*stamp, expectedDigest));
+}
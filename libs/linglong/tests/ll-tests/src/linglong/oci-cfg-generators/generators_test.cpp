@@ -0,0 +1,289 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <gtest/gtest.h>
+
+#include "linglong/oci-cfg-generators/builtins.h"
+#include "linglong/oci-cfg-generators/host_ipc.h"
+#include "linglong/oci-cfg-generators/user_home.h"
+
+#include <nlohmann/json.hpp>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace generator = linglong::generator;
+
+namespace {
+
+const std::filesystem::path dataDir = "data/oci-cfg-generators";
+
+std::string readFile(const std::filesystem::path &path)
+{
+    std::ifstream stream{ path };
+    return { std::istreambuf_iterator<char>{ stream }, std::istreambuf_iterator<char>{} };
+}
+
+void replaceAll(std::string &str, std::string_view from, std::string_view to)
+{
+    for (auto pos = str.find(from); pos != std::string::npos; pos = str.find(from, pos)) {
+        str.replace(pos, from.size(), to);
+        pos += to.size();
+    }
+}
+
+// the generators read the environment of the process, it's replaced by the one used to record the
+// golden outputs during the tests
+class ScopedEnvironment
+{
+public:
+    explicit ScopedEnvironment(const std::map<std::string, std::string> &env)
+    {
+        for (auto **entry = environ; *entry != nullptr; ++entry) {
+            this->saved.emplace_back(*entry);
+        }
+
+        ::clearenv();
+        for (const auto &[key, value] : env) {
+            ::setenv(key.c_str(), value.c_str(), 1);
+        }
+    }
+
+    ScopedEnvironment(const ScopedEnvironment &) = delete;
+    ScopedEnvironment &operator=(const ScopedEnvironment &) = delete;
+
+    ~ScopedEnvironment()
+    {
+        ::clearenv();
+        for (const auto &entry : this->saved) {
+            auto pos = entry.find('=');
+            ::setenv(entry.substr(0, pos).c_str(), entry.substr(pos + 1).c_str(), 1);
+        }
+    }
+
+private:
+    std::vector<std::string> saved;
+};
+
+class GeneratorsTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        auto tmpl = (std::filesystem::temp_directory_path() / "generators-XXXXXX").string();
+        ASSERT_NE(::mkdtemp(tmpl.data()), nullptr);
+        dir = tmpl;
+        home = dir / "home";
+        std::filesystem::create_directories(home);
+
+        if (auto *ptr = ::getenv("LINGLONG_GENERATORS_DIR"); ptr != nullptr) {
+            generatorsDir = ptr;
+        }
+
+        input = nlohmann::json::parse(readFile(dataDir / "input.json"));
+        env = std::make_unique<ScopedEnvironment>(std::map<std::string, std::string>{
+          { "HOME", home.string() },
+          { "USER", "tester" },
+          { "DISPLAY", ":0" },
+          { "LANG", "C.UTF-8" },
+          { "LANGUAGE", "" },
+          { "XDG_SESSION_TYPE", "x11" },
+        });
+    }
+
+    void TearDown() override
+    {
+        env.reset();
+        std::error_code ec;
+        std::filesystem::remove_all(dir, ec);
+    }
+
+    [[nodiscard]] nlohmann::json golden(std::string_view name) const
+    {
+        auto content = readFile(dataDir / (std::string{ name } + ".json"));
+        replaceAll(content, "@UID@", std::to_string(::getuid()));
+        replaceAll(content, "@GID@", std::to_string(::getgid()));
+        replaceAll(content, "@HOME@", home.string());
+        return nlohmann::json::parse(content);
+    }
+
+    void expectGolden(std::string_view name)
+    {
+        const auto &generators = generator::builtinGenerators();
+        auto it = generators.find(name);
+        ASSERT_NE(it, generators.end()) << name;
+
+        auto config = input;
+        std::ostringstream log;
+        ASSERT_TRUE(it->second->apply(config, log)) << log.str();
+        EXPECT_EQ(config, golden(name)) << config.dump(4);
+    }
+
+    std::filesystem::path dir;
+    std::filesystem::path home;
+    std::filesystem::path generatorsDir;
+    nlohmann::json input;
+    std::unique_ptr<ScopedEnvironment> env;
+};
+
+} // namespace
+
+TEST_F(GeneratorsTest, Builtins)
+{
+    std::vector<std::string_view> names;
+    for (const auto &[name, generator] : generator::builtinGenerators()) {
+        EXPECT_EQ(name, generator->name());
+        names.push_back(name);
+    }
+
+    EXPECT_EQ(names,
+              (std::vector<std::string_view>{ "00-id-mapping", "05-initialize", "20-devices",
+                                              "25-host-env", "30-user-home", "40-host-ipc",
+                                              "90-legacy" }));
+}
+
+// the golden outputs were recorded by the generator executables before they were moved into the
+// library, the generators depending on the devices and sockets of the host are not compared
+TEST_F(GeneratorsTest, IDMapping)
+{
+    expectGolden("00-id-mapping");
+}
+
+TEST_F(GeneratorsTest, Initialize)
+{
+    expectGolden("05-initialize");
+}
+
+TEST_F(GeneratorsTest, HostEnv)
+{
+    expectGolden("25-host-env");
+}
+
+TEST_F(GeneratorsTest, UserHome)
+{
+    if (!std::filesystem::exists("/etc/skel/.bashrc")) {
+        GTEST_SKIP() << "the golden output masks ~/.bashrc with /etc/skel/.bashrc";
+    }
+
+    expectGolden("30-user-home");
+}
+
+TEST_F(GeneratorsTest, FailedGeneratorLeavesConfigUntouched)
+{
+    ::unsetenv("HOME");
+
+    auto config = input;
+    std::ostringstream log;
+    EXPECT_FALSE(generator::UserHome{}.apply(config, log));
+    EXPECT_FALSE(log.str().empty());
+    EXPECT_EQ(config, input);
+
+    config["ociVersion"] = "1.0.0";
+    auto mismatched = config;
+    EXPECT_FALSE(generator::builtinGenerators().at("00-id-mapping")->apply(config, log));
+    EXPECT_EQ(config, mismatched);
+}
+
+TEST_F(GeneratorsTest, HostIPCLinksInBundleDir)
+{
+    auto bundleDir = dir / "bundle";
+    std::filesystem::create_directories(bundleDir);
+    input["annotations"]["org.deepin.linglong.bundleDir"] = bundleDir.string();
+
+    auto config = input;
+    std::ostringstream log;
+    ASSERT_TRUE(generator::HostIPC{}.apply(config, log)) << log.str();
+
+    EXPECT_TRUE(std::filesystem::is_symlink(bundleDir / "ld.so.cache"));
+    EXPECT_EQ(std::filesystem::read_symlink(bundleDir / "ld.so.cache"),
+              "/run/linglong/etc/ld.so.cache");
+
+    auto found = false;
+    for (const auto &mount : config.at("mounts")) {
+        if (mount.at("destination") == "/etc/ld.so.cache") {
+            found = true;
+            EXPECT_EQ(mount.at("source"), (bundleDir / "ld.so.cache").string());
+        }
+    }
+    EXPECT_TRUE(found);
+}
+
+// Compares applying the builtin generators in process with executing them, run it with
+// `ll-tests --gtest_also_run_disabled_tests --gtest_filter='*Benchmark*'`, and set
+// LINGLONG_GENERATORS_DIR to a config.d directory to execute the generators in it.
+TEST_F(GeneratorsTest, DISABLED_Benchmark)
+{
+    constexpr auto rounds = 100;
+    auto bundleDir = dir / "bundle";
+    std::filesystem::create_directories(bundleDir);
+
+    auto start = std::chrono::steady_clock::now();
+    for (auto i = 0; i < rounds; ++i) {
+        auto config = input;
+        config["annotations"]["org.deepin.linglong.bundleDir"] = bundleDir.string();
+        std::ostringstream log;
+        for (const auto &[name, generator] : generator::builtinGenerators()) {
+            ASSERT_TRUE(generator->apply(config, log)) << name << ": " << log.str();
+        }
+        std::filesystem::remove_all(bundleDir);
+        std::filesystem::create_directories(bundleDir);
+    }
+    auto inProcess = std::chrono::steady_clock::now() - start;
+    std::cout << "in process: "
+              << std::chrono::duration<double, std::milli>(inProcess).count() / rounds
+              << "ms per launch" << std::endl;
+
+    if (generatorsDir.empty()) {
+        return;
+    }
+
+    // every generator reads the output of the previous one, like ContainerBuilder did
+    auto execute = [&bundleDir](const std::filesystem::path &executable,
+                                const std::filesystem::path &in,
+                                const std::filesystem::path &out) {
+        auto pid = ::fork();
+        if (pid == 0) {
+            auto inFd = ::open(in.c_str(), O_RDONLY);
+            auto outFd = ::open(out.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if (::dup2(inFd, STDIN_FILENO) == -1 || ::dup2(outFd, STDOUT_FILENO) == -1
+                || ::chdir(bundleDir.c_str()) == -1) {
+                ::_exit(127);
+            }
+            ::execl(executable.c_str(), executable.c_str(), nullptr);
+            ::_exit(127);
+        }
+
+        int status{ 0 };
+        ::waitpid(pid, &status, 0);
+        return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    };
+
+    auto in = dir / "in.json";
+    auto out = dir / "out.json";
+    start = std::chrono::steady_clock::now();
+    for (auto i = 0; i < rounds; ++i) {
+        std::ofstream{ in } << input.dump();
+        for (const auto &[name, generator] : generator::builtinGenerators()) {
+            auto executable = generatorsDir / name;
+            ASSERT_TRUE(execute(executable, in, out)) << executable;
+            std::filesystem::rename(out, in);
+        }
+        std::filesystem::remove_all(bundleDir);
+        std::filesystem::create_directories(bundleDir);
+    }
+    auto executed = std::chrono::steady_clock::now() - start;
+    std::cout << "executables: "
+              << std::chrono::duration<double, std::milli>(executed).count() / rounds
+              << "ms per launch" << std::endl;
+}
@@ -0,0 +1,178 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <gtest/gtest.h>
+
+#include "linglong/api/types/v1/Generators.hpp"
+#include "linglong/package/uab_digest.h"
+
+#include <QCryptographicHash>
+#include <QFile>
+#include <QTemporaryDir>
+
+#include <cerrno>
+#include <random>
+
+using namespace linglong;
+
+namespace {
+
+constexpr qint64 chunkSize = 4096;
+// the section is prefixed by some other data like the sections before it in an uab file
+constexpr qint64 sectionOffset = 123;
+
+class UABDigestTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        ASSERT_TRUE(dir.isValid());
+
+        std::mt19937 gen(42);
+        section = QByteArray(static_cast<int>(chunkSize * 3 + 1000), Qt::Uninitialized);
+        std::generate(section.begin(), section.end(), [&gen]() {
+            return static_cast<char>(gen());
+        });
+
+        file.setFileName(dir.filePath("test.uab"));
+        ASSERT_TRUE(file.open(QIODevice::ReadWrite));
+        ASSERT_EQ(file.write(QByteArray(sectionOffset, 'h')), sectionOffset);
+        ASSERT_EQ(file.write(section), section.size());
+        ASSERT_TRUE(file.flush());
+    }
+
+    void tamper(qint64 pos)
+    {
+        ASSERT_TRUE(file.seek(sectionOffset + pos));
+        char byte = static_cast<char>(section[static_cast<int>(pos)] ^ 0x1);
+        ASSERT_EQ(file.write(&byte, 1), 1);
+        ASSERT_TRUE(file.flush());
+    }
+
+    QTemporaryDir dir;
+    QFile file;
+    QByteArray section;
+};
+
+} // namespace
+
+TEST_F(UABDigestTest, Calculate)
+{
+    auto digest =
+      package::calculateBundleDigest(file.handle(), sectionOffset, section.size(), chunkSize);
+    ASSERT_TRUE(digest) << digest.error().message().toStdString();
+
+    // the single digest stays the same as the old format
+    EXPECT_EQ(digest->digest,
+              QCryptographicHash::hash(section, QCryptographicHash::Sha256).toHex().toStdString());
+
+    ASSERT_EQ(digest->tree.chunkSize, chunkSize);
+    ASSERT_EQ(digest->tree.chunks.size(), 4U);
+    QByteArray leaves;
+    for (std::size_t i = 0; i < digest->tree.chunks.size(); ++i) {
+        auto chunk = section.mid(static_cast<int>(i * chunkSize), static_cast<int>(chunkSize));
+        auto expected = QCryptographicHash::hash(chunk, QCryptographicHash::Sha256);
+        EXPECT_EQ(digest->tree.chunks[i], expected.toHex().toStdString()) << "chunk " << i;
+        leaves.append(expected);
+    }
+    EXPECT_EQ(digest->tree.root,
+              QCryptographicHash::hash(leaves, QCryptographicHash::Sha256).toHex().toStdString());
+
+    auto verifier =
+      package::ChunkVerifier::New(file.handle(), sectionOffset, section.size(), digest->tree);
+    ASSERT_TRUE(verifier) << verifier.error().message().toStdString();
+    auto ret = (*verifier)->verifyAll();
+    EXPECT_TRUE(ret) << ret.error().message().toStdString();
+    ret = (*verifier)->verifyRange(0, section.size());
+    EXPECT_TRUE(ret) << ret.error().message().toStdString();
+}
+
+TEST_F(UABDigestTest, TamperedChunk)
+{
+    auto digest =
+      package::calculateBundleDigest(file.handle(), sectionOffset, section.size(), chunkSize);
+    ASSERT_TRUE(digest) << digest.error().message().toStdString();
+    tamper(chunkSize * 2 + 10);
+
+    for (unsigned int jobs : { 1, 2, 8 }) {
+        auto verifier =
+          package::ChunkVerifier::New(file.handle(), sectionOffset, section.size(), digest->tree);
+        ASSERT_TRUE(verifier) << verifier.error().message().toStdString();
+        auto ret = (*verifier)->verifyAll(jobs);
+        ASSERT_FALSE(ret) << "jobs " << jobs;
+        EXPECT_EQ(ret.error().code(), EBADMSG);
+    }
+
+    // only the chunks being read are verified lazily
+    auto verifier =
+      package::ChunkVerifier::New(file.handle(), sectionOffset, section.size(), digest->tree);
+    ASSERT_TRUE(verifier) << verifier.error().message().toStdString();
+    EXPECT_TRUE((*verifier)->verifyRange(0, chunkSize * 2));
+    EXPECT_TRUE((*verifier)->verifyRange(chunkSize * 3, section.size() - chunkSize * 3));
+    auto ret = (*verifier)->verifyRange(chunkSize * 2 - 1, 2);
+    ASSERT_FALSE(ret);
+    EXPECT_EQ(ret.error().code(), EBADMSG);
+
+    ret = (*verifier)->verifyRange(section.size() - 1, 2);
+    ASSERT_FALSE(ret);
+    EXPECT_EQ(ret.error().code(), EBADMSG);
+}
+
+TEST_F(UABDigestTest, TamperedTree)
+{
+    auto digest =
+      package::calculateBundleDigest(file.handle(), sectionOffset, section.size(), chunkSize);
+    ASSERT_TRUE(digest) << digest.error().message().toStdString();
+
+    // a chunk digest which is not covered by the root
+    auto tree = digest->tree;
+    tree.chunks[1] = tree.chunks[0];
+    auto verifier = package::ChunkVerifier::New(file.handle(), sectionOffset, section.size(), tree);
+    ASSERT_FALSE(verifier);
+    EXPECT_EQ(verifier.error().code(), EBADMSG);
+
+    // the section is truncated or extended
+    tree = digest->tree;
+    tree.chunks.pop_back();
+    verifier = package::ChunkVerifier::New(file.handle(), sectionOffset, section.size(), tree);
+    ASSERT_FALSE(verifier);
+    EXPECT_EQ(verifier.error().code(), EBADMSG);
+
+    tree = digest->tree;
+    tree.chunkSize = 0;
+    verifier = package::ChunkVerifier::New(file.handle(), sectionOffset, section.size(), tree);
+    ASSERT_FALSE(verifier);
+    EXPECT_EQ(verifier.error().code(), EBADMSG);
+}
+
+TEST(UABMetaInfo, CompatibleWithSingleDigest)
+{
+    // metadata of the uab files created before the digest tree was introduced
+    auto old = nlohmann::json::parse(R"({
+        "digest": "0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef",
+        "layers": [],
+        "sections": { "bundle": "linglong.bundle" },
+        "uuid": "b2f33c7b-615c-4d7d-9181-e1a22010a749",
+        "version": "1"
+    })");
+    auto meta = old.get<api::types::v1::UabMetaInfo>();
+    EXPECT_FALSE(meta.digestTree.has_value());
+    EXPECT_EQ(meta.digest, old["digest"]);
+
+    nlohmann::json content = meta;
+    EXPECT_FALSE(content.contains("digestTree"));
+
+    meta.digestTree = api::types::v1::UabDigestTree{
+        .chunks = { "00" },
+        .chunkSize = chunkSize,
+        .root = "01",
+    };
+    content = meta;
+    auto parsed = content.get<api::types::v1::UabMetaInfo>();
+    ASSERT_TRUE(parsed.digestTree.has_value());
+    EXPECT_EQ(parsed.digestTree->chunks, meta.digestTree->chunks);
+    EXPECT_EQ(parsed.digestTree->chunkSize, chunkSize);
+    EXPECT_EQ(parsed.digestTree->root, "01");
+    EXPECT_EQ(parsed.digest, meta.digest);
+}
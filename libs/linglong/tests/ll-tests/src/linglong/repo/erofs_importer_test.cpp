@@ -0,0 +1,232 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <gtest/gtest.h>
+
+// compatible with old gtest
+#ifndef GTEST_SKIP
+#  define GTEST_SKIP() return
+#endif
+
+#include "linglong/package/erofs_image.h"
+#include "linglong/repo/erofs_importer.h"
+#include "linglong/utils/command/env.h"
+
+#include <QDirIterator>
+#include <QFile>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+
+#include <filesystem>
+#include <random>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace linglong;
+
+namespace {
+
+void writeFile(const QString &path, const QByteArray &content, QFile::Permissions perms = {})
+{
+    QFile file(path);
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    ASSERT_EQ(file.write(content), content.size());
+    file.close();
+    if (perms) {
+        ASSERT_TRUE(file.setPermissions(perms));
+    }
+}
+
+// createLayer creates a directory like a layer, with files covering the erofs data layouts
+void createLayer(const QString &root)
+{
+    QDir dir(root);
+    ASSERT_TRUE(dir.mkpath("files/bin"));
+    ASSERT_TRUE(dir.mkpath("files/share/empty"));
+
+    writeFile(dir.filePath("info.json"), R"({"id":"org.test.erofs","kind":"app"})");
+    writeFile(dir.filePath("files/bin/app"),
+              "#!/bin/sh\necho hello\n",
+              QFile::ReadOwner | QFile::WriteOwner | QFile::ExeOwner | QFile::ReadGroup
+                | QFile::ExeGroup | QFile::ReadOther | QFile::ExeOther);
+    writeFile(dir.filePath("files/share/empty-file"), {});
+
+    // compressible data spans many extents, random data is stored uncompressed
+    QByteArray text;
+    for (int i = 0; text.size() < 6 * 1024 * 1024; ++i) {
+        text.append(QString("line %1 of a large text file\n").arg(i).toUtf8());
+    }
+    writeFile(dir.filePath("files/share/large.txt"), text);
+
+    std::mt19937 gen(42);
+    QByteArray random(300 * 1024 + 123, Qt::Uninitialized);
+    std::generate(random.begin(), random.end(), [&gen]() {
+        return static_cast<char>(gen());
+    });
+    writeFile(dir.filePath("files/share/random.bin"), random);
+
+    ASSERT_TRUE(QFile::link("bin/app", dir.filePath("files/app-link")));
+    ASSERT_TRUE(
+      QFile::link(dir.filePath("files/share/large.txt"), dir.filePath("files/share/abs")));
+    ASSERT_EQ(::link(dir.filePath("files/bin/app").toLocal8Bit().constData(),
+                     dir.filePath("files/bin/app-hardlink").toLocal8Bit().constData()),
+              0);
+}
+
+// packImage packs root like LayerPackager, and prepends a header to test the offset
+utils::error::Result<quint64> packImage(const QString &root,
+                                        const QString &output,
+                                        const QStringList &options)
+{
+    LINGLONG_TRACE("pack erofs image");
+
+    auto image = output + ".erofs";
+    auto ret = utils::command::Exec("mkfs.erofs", options + QStringList{ image, root });
+    if (!ret) {
+        return LINGLONG_ERR(ret);
+    }
+
+    QFile in(image);
+    QFile out(output);
+    if (!in.open(QIODevice::ReadOnly) || !out.open(QIODevice::WriteOnly)) {
+        return LINGLONG_ERR("open image");
+    }
+    const QByteArray header(123, 'h');
+    out.write(header);
+    out.write(in.readAll());
+    return header.size();
+}
+
+void expectSameContent(const package::ErofsImage &image, const QString &root)
+{
+    QDirIterator it(root,
+                    QDir::AllEntries | QDir::System | QDir::Hidden | QDir::NoDotAndDotDot,
+                    QDirIterator::Subdirectories);
+    int count = 0;
+    while (it.hasNext()) {
+        it.next();
+        ++count;
+        auto info = it.fileInfo();
+        auto path = QDir(root).relativeFilePath(info.filePath());
+        auto inode = image.lookup(path.toStdString());
+        ASSERT_TRUE(inode) << path.toStdString() << ": " << inode.error().message().toStdString();
+
+        if (info.isSymLink()) {
+            ASSERT_TRUE(S_ISLNK(inode->mode)) << path.toStdString();
+            auto target = image.readAll(*inode);
+            ASSERT_TRUE(target);
+            auto expected = std::filesystem::read_symlink(info.filePath().toStdString());
+            EXPECT_EQ(target->toStdString(), expected.string()) << path.toStdString();
+            continue;
+        }
+        if (info.isDir()) {
+            EXPECT_TRUE(S_ISDIR(inode->mode)) << path.toStdString();
+            continue;
+        }
+
+        ASSERT_TRUE(S_ISREG(inode->mode)) << path.toStdString();
+        QFile file(info.filePath());
+        ASSERT_TRUE(file.open(QIODevice::ReadOnly));
+        auto content = image.readAll(*inode);
+        ASSERT_TRUE(content) << path.toStdString() << ": "
+                             << content.error().message().toStdString();
+        EXPECT_EQ(*content, file.readAll()) << path.toStdString();
+    }
+    EXPECT_GT(count, 0);
+}
+
+struct TreeChecksum
+{
+    std::string contents;
+    std::string metadata;
+};
+
+// commit root to repo through the mounted directory path and through the erofs importer
+void expectSameTree(OstreeRepo *repo, const package::ErofsImage &image, const QString &root)
+{
+    g_autoptr(GError) gErr = nullptr;
+    ASSERT_TRUE(ostree_repo_prepare_transaction(repo, nullptr, nullptr, &gErr));
+
+    auto writeTree = [repo, &gErr](OstreeMutableTree *mtree) {
+        g_autoptr(GFile) file = nullptr;
+        if (ostree_repo_write_mtree(repo, mtree, &file, nullptr, &gErr) == FALSE) {
+            ADD_FAILURE() << gErr->message;
+            return TreeChecksum{};
+        }
+        auto *repoFile = OSTREE_REPO_FILE(file);
+        return TreeChecksum{ ostree_repo_file_tree_get_contents_checksum(repoFile),
+                             ostree_repo_file_tree_get_metadata_checksum(repoFile) };
+    };
+
+    g_autoptr(OstreeMutableTree) expectedTree = ostree_mutable_tree_new();
+    g_autoptr(OstreeRepoCommitModifier) modifier =
+      ostree_repo_commit_modifier_new(OSTREE_REPO_COMMIT_MODIFIER_FLAGS_CANONICAL_PERMISSIONS,
+                                      nullptr,
+                                      nullptr,
+                                      nullptr);
+    g_autoptr(GFile) rootFile = g_file_new_for_path(root.toLocal8Bit().constData());
+    ASSERT_TRUE(ostree_repo_write_directory_to_mtree(repo,
+                                                     rootFile,
+                                                     expectedTree,
+                                                     modifier,
+                                                     nullptr,
+                                                     &gErr));
+    auto expected = writeTree(expectedTree);
+
+    g_autoptr(OstreeMutableTree) tree = ostree_mutable_tree_new();
+    auto rootInode = image.root();
+    ASSERT_TRUE(rootInode);
+    auto ret = repo::writeErofsToMtree(repo, image, *rootInode, tree);
+    ASSERT_TRUE(ret) << ret.error().message().toStdString();
+    auto actual = writeTree(tree);
+
+    EXPECT_EQ(actual.contents, expected.contents);
+    EXPECT_EQ(actual.metadata, expected.metadata);
+
+    ASSERT_TRUE(ostree_repo_commit_transaction(repo, nullptr, nullptr, &gErr));
+}
+
+} // namespace
+
+TEST(ErofsImporter, SameAsMountedDirectory)
+{
+    if (QStandardPaths::findExecutable("mkfs.erofs").isEmpty()) {
+        GTEST_SKIP();
+    }
+
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    auto root = dir.filePath("layer");
+    createLayer(root);
+
+    // the options used by the packagers, another compressor level and an uncompressed image
+    const QList<QStringList> optionsList{ { "-zlz4hc,9", "-b4096" },
+                                          { "-zlz4", "-b4096" },
+                                          { "-b4096" } };
+    for (const auto &options : optionsList) {
+        SCOPED_TRACE(options.join(' ').toStdString());
+
+        auto layerFile = dir.filePath(QString("test-%1.layer").arg(optionsList.indexOf(options)));
+        auto offset = packImage(root, layerFile, options);
+        ASSERT_TRUE(offset) << offset.error().message().toStdString();
+
+        auto image = package::ErofsImage::New(layerFile, *offset);
+        ASSERT_TRUE(image) << image.error().message().toStdString();
+        expectSameContent(**image, root);
+
+        auto info = (*image)->lookup("info.json");
+        ASSERT_TRUE(info);
+        auto content = (*image)->readAll(*info);
+        ASSERT_TRUE(content);
+        EXPECT_TRUE(content->contains("org.test.erofs"));
+
+        g_autoptr(GError) gErr = nullptr;
+        auto repoDir = layerFile + ".repo";
+        g_autoptr(GFile) repoPath = g_file_new_for_path(repoDir.toLocal8Bit().constData());
+        g_autoptr(OstreeRepo) repo = ostree_repo_new(repoPath);
+        ASSERT_TRUE(ostree_repo_create(repo, OSTREE_REPO_MODE_BARE_USER_ONLY, nullptr, &gErr));
+        expectSameTree(repo, **image, root);
+    }
+}
@@ -0,0 +1,125 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <gtest/gtest.h>
+
+// compatible with old gtest
+#ifndef GTEST_SKIP
+#  define GTEST_SKIP() return
+#endif
+
+#include "linglong/repo/shared_info_updater.h"
+#include "linglong/utils/command/env.h"
+
+#include <QFile>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+
+#include <map>
+
+using namespace linglong;
+
+namespace {
+
+// install an application by linking its desktop file into the share directory, like exportEntries
+void installApp(const QTemporaryDir &dir, const QString &appID)
+{
+    QDir layerDir(dir.filePath("layers/" + appID + "/entries/share/applications"));
+    ASSERT_TRUE(layerDir.mkpath("."));
+    QFile desktop(layerDir.filePath(appID + ".desktop"));
+    ASSERT_TRUE(desktop.open(QIODevice::WriteOnly));
+    desktop.write(QString("[Desktop Entry]\n"
+                          "Type=Application\n"
+                          "Name=%1\n"
+                          "Exec=%1\n"
+                          "MimeType=x-scheme-handler/%1;\n")
+                    .arg(appID)
+                    .toUtf8());
+    desktop.close();
+
+    QDir applications(dir.filePath("share/applications"));
+    ASSERT_TRUE(applications.mkpath("."));
+    ASSERT_TRUE(QFile::link(desktop.fileName(), applications.filePath(appID + ".desktop")));
+}
+
+} // namespace
+
+TEST(SharedInfoUpdater, DebounceBatch)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+
+    std::map<QString, int> runs;
+    repo::SharedInfoUpdater updater(QDir(dir.filePath("share")));
+    updater.setRunner([&runs](const QString &program, const QStringList &args) {
+        runs[program]++;
+        // pretend that the generator wrote its output
+        if (program == "update-desktop-database") {
+            QFile output(QDir(args.first()).filePath("mimeinfo.cache"));
+            output.open(QIODevice::WriteOnly);
+        }
+        return utils::error::Result<QString>{};
+    });
+
+    for (const auto &appID : { "org.test.a", "org.test.b", "org.test.c" }) {
+        installApp(dir, appID);
+        updater.schedule();
+    }
+    EXPECT_TRUE(updater.pending());
+    EXPECT_TRUE(runs.empty());
+
+    updater.flush();
+    EXPECT_FALSE(updater.pending());
+    EXPECT_EQ(runs["update-desktop-database"], 1);
+    // there are no mime packages or schemas to compile
+    EXPECT_EQ(runs["update-mime-database"], 0);
+    EXPECT_EQ(runs["glib-compile-schemas"], 0);
+
+    // nothing changed since the last run
+    updater.schedule();
+    updater.flush();
+    EXPECT_EQ(runs["update-desktop-database"], 1);
+
+    installApp(dir, "org.test.d");
+    updater.schedule();
+    updater.flush();
+    EXPECT_EQ(runs["update-desktop-database"], 2);
+
+    // the generated cache is lost, e.g. exportAllEntries replaced the share directory
+    ASSERT_TRUE(QFile::remove(dir.filePath("share/applications/mimeinfo.cache")));
+    updater.schedule();
+    updater.flush();
+    EXPECT_EQ(runs["update-desktop-database"], 3);
+}
+
+TEST(SharedInfoUpdater, DesktopDatabase)
+{
+    if (QStandardPaths::findExecutable("update-desktop-database").isEmpty()) {
+        GTEST_SKIP();
+    }
+
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+
+    int runs = 0;
+    {
+        repo::SharedInfoUpdater updater(QDir(dir.filePath("share")));
+        updater.setRunner([&runs](const QString &program, const QStringList &args) {
+            runs++;
+            return utils::command::Exec(program, args);
+        });
+        for (const auto &appID : { "org.test.a", "org.test.b" }) {
+            installApp(dir, appID);
+            updater.schedule();
+        }
+        // the pending update runs on destruction
+    }
+    EXPECT_EQ(runs, 1);
+
+    QFile cache(dir.filePath("share/applications/mimeinfo.cache"));
+    ASSERT_TRUE(cache.open(QIODevice::ReadOnly));
+    auto content = QString::fromUtf8(cache.readAll());
+    EXPECT_TRUE(content.contains("x-scheme-handler/org.test.a=org.test.a.desktop;"));
+    EXPECT_TRUE(content.contains("x-scheme-handler/org.test.b=org.test.b.desktop;"));
+}
@@ -0,0 +1,240 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <gtest/gtest.h>
+
+#include "linglong/runtime/config_cache.h"
+#include "linglong/runtime/container_builder.h"
+#include "linglong/utils/serialize/json.h"
+
+#include <QFile>
+#include <QTemporaryDir>
+
+#include <map>
+
+using namespace linglong;
+
+namespace {
+
+void writeFile(const QString &path, const QByteArray &content)
+{
+    QFile file(path);
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    file.write(content);
+}
+
+class ConfigCacheTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        ASSERT_TRUE(dir.isValid());
+        QDir root(dir.path());
+        for (const auto *path : { "container/config.d", "bin", "home", "run", "bundle", "cache" }) {
+            ASSERT_TRUE(root.mkpath(path));
+        }
+
+        configFile = root.filePath("container/config.json");
+        writeFile(configFile, R"({"ociVersion": "1.0.1"})");
+        patchFile = root.filePath("container/config.d/10-patch.json");
+        writeFile(patchFile, R"({"ociVersion": "1.0.1", "patch": []})");
+
+        // the builtin generators installed by linglong
+        for (const auto *name : { "25-host-env", "30-user-home", "40-host-ipc" }) {
+            auto executable = root.filePath(QString("bin/%1-static").arg(name));
+            writeFile(executable, "");
+            ASSERT_TRUE(QFile::setPermissions(executable, QFile::ReadOwner | QFile::ExeOwner));
+            ASSERT_TRUE(
+              QFile::link(executable, root.filePath(QString("container/config.d/") + name)));
+        }
+
+        const std::map<const char *, QString> env{
+            { "HOME", root.filePath("home") },
+            { "XDG_RUNTIME_DIR", root.filePath("run") },
+            { "WAYLAND_DISPLAY", "wayland-0" },
+            { "DISPLAY", ":0" },
+        };
+        for (const auto &[name, value] : env) {
+            this->savedEnv.emplace(name, qgetenv(name));
+            qputenv(name, value.toUtf8());
+        }
+
+        opts.appID = "org.deepin.test";
+        opts.containerID = "test";
+        opts.appDir = QDir(root.filePath("layers/app-commit"));
+        opts.runtimeDir = QDir(root.filePath("layers/runtime-commit"));
+        opts.baseDir = QDir(root.filePath("layers/base-commit"));
+    }
+
+    void TearDown() override
+    {
+        for (const auto &[name, value] : this->savedEnv) {
+            if (value.isNull()) {
+                qunsetenv(name);
+            } else {
+                qputenv(name, value);
+            }
+        }
+    }
+
+    std::string key()
+    {
+        auto ret = runtime::configKey(opts, configFile);
+        EXPECT_TRUE(ret.has_value());
+        return ret.value_or("");
+    }
+
+    QTemporaryDir dir;
+    QString configFile;
+    QString patchFile;
+    runtime::ContainerOptions opts;
+    std::map<const char *, QByteArray> savedEnv;
+};
+
+} // namespace
+
+TEST_F(ConfigCacheTest, KeyIsStable)
+{
+    EXPECT_EQ(key(), key());
+}
+
+TEST_F(ConfigCacheTest, KeyChangesWithLayers)
+{
+    auto original = key();
+
+    opts.appDir = QDir(dir.filePath("layers/app-upgraded"));
+    auto app = key();
+    EXPECT_NE(app, original);
+
+    opts.runtimeDir = QDir(dir.filePath("layers/runtime-upgraded"));
+    auto runtime = key();
+    EXPECT_NE(runtime, app);
+
+    opts.baseDir = QDir(dir.filePath("layers/base-upgraded"));
+    EXPECT_NE(key(), runtime);
+}
+
+TEST_F(ConfigCacheTest, KeyChangesWithPatches)
+{
+    auto original = key();
+
+    writeFile(patchFile, R"({"ociVersion": "1.0.1", "patch": [{"op": "remove", "path": "/a"}]})");
+    auto modified = key();
+    EXPECT_NE(modified, original);
+
+    writeFile(QDir(dir.path()).filePath("container/config.d/20-patch.json"),
+              R"({"ociVersion": "1.0.1", "patch": []})");
+    auto added = key();
+    EXPECT_NE(added, modified);
+
+    opts.patches.push_back({ .ociVersion = "1.0.1", .patch = {} });
+    EXPECT_NE(key(), added);
+}
+
+TEST_F(ConfigCacheTest, KeyChangesWithEnvironment)
+{
+    auto original = key();
+
+    qputenv("DISPLAY", ":1");
+    auto display = key();
+    EXPECT_NE(display, original);
+
+    qunsetenv("DISPLAY");
+    EXPECT_NE(key(), display);
+}
+
+TEST_F(ConfigCacheTest, KeyChangesWithUserHome)
+{
+    auto original = key();
+
+    ASSERT_TRUE(QDir(dir.path()).mkpath("home/.ssh"));
+    EXPECT_NE(key(), original);
+}
+
+TEST_F(ConfigCacheTest, KeyChangesWithIPCSockets)
+{
+    auto original = key();
+
+    // the generator only checks the type of the socket
+    writeFile(QDir(dir.path()).filePath("run/wayland-0"), "");
+    EXPECT_NE(key(), original);
+}
+
+TEST_F(ConfigCacheTest, ThirdPartyGeneratorDisablesCache)
+{
+    auto generator = QDir(dir.path()).filePath("container/config.d/50-custom");
+    writeFile(generator, "#!/bin/sh\ncat\n");
+    ASSERT_TRUE(QFile::setPermissions(generator, QFile::ReadOwner | QFile::ExeOwner));
+    EXPECT_FALSE(runtime::configKey(opts, configFile).has_value());
+
+    // the builtin generators are only recognized through the symlinks installed by linglong
+    ASSERT_TRUE(QFile::remove(generator));
+    generator = QDir(dir.path()).filePath("container/config.d/00-id-mapping");
+    writeFile(generator, "#!/bin/sh\ncat\n");
+    ASSERT_TRUE(QFile::setPermissions(generator, QFile::ReadOwner | QFile::ExeOwner));
+    EXPECT_FALSE(runtime::configKey(opts, configFile).has_value());
+}
+
+TEST_F(ConfigCacheTest, StoreLoadRebase)
+{
+    QDir oldBundle(dir.filePath("bundle"));
+    ASSERT_TRUE(QFile::link("/tmp/.X11-unix/X0", oldBundle.filePath("X0")));
+
+    auto config = nlohmann::json{
+      { "ociVersion", "1.0.1" },
+      { "annotations",
+        { { "org.deepin.linglong.bundleDir", oldBundle.absolutePath().toStdString() } } },
+      { "mounts",
+        { { { "destination", "/tmp/.X11-unix/X0" },
+            { "source", oldBundle.filePath("X0").toStdString() },
+            { "type", "bind" } },
+          { { "destination", "/usr" }, { "source", "/usr" }, { "type", "bind" } } } },
+    }.get<ocppi::runtime::config::types::Config>();
+
+    runtime::ConfigCache cache(QDir(dir.filePath("cache")));
+    EXPECT_FALSE(cache.load(opts.appID, "key").has_value());
+    ASSERT_TRUE(cache.store(opts.appID, "key", oldBundle, config).has_value());
+    EXPECT_FALSE(cache.load(opts.appID, "other").has_value());
+
+    auto entry = cache.load(opts.appID, "key");
+    ASSERT_TRUE(entry.has_value());
+    EXPECT_EQ(entry->links, (std::map<std::string, std::string>{ { "X0", "/tmp/.X11-unix/X0" } }));
+
+    QTemporaryDir newBundle;
+    ASSERT_TRUE(newBundle.isValid());
+    auto rebased = runtime::ConfigCache::rebase(*entry, QDir(newBundle.path()));
+    ASSERT_TRUE(rebased.has_value());
+    EXPECT_EQ(QFileInfo(newBundle.filePath("X0")).symLinkTarget(), "/tmp/.X11-unix/X0");
+    EXPECT_EQ(rebased->mounts->at(0).source, newBundle.filePath("X0").toStdString());
+    EXPECT_EQ(rebased->mounts->at(1).source, "/usr");
+    EXPECT_EQ(rebased->annotations->at("org.deepin.linglong.bundleDir"),
+              QDir(newBundle.path()).absolutePath().toStdString());
+
+    // the symlinks exist in the bundle directory of the running container
+    auto again = runtime::ConfigCache::rebase(*entry, QDir(newBundle.path()));
+    EXPECT_FALSE(again.has_value());
+}
+
+TEST_F(ConfigCacheTest, StoreEnvironment)
+{
+    QDir bundle(dir.filePath("bundle"));
+    auto config = nlohmann::json{ { "ociVersion", "1.0.1" }, { "mounts", nlohmann::json::array() } }
+                    .get<ocppi::runtime::config::types::Config>();
+    const std::vector<std::string> environment{ "PATH=/usr/bin:/bin", "LANG=C.UTF-8" };
+
+    runtime::ConfigCache cache(QDir(dir.filePath("cache")));
+    EXPECT_FALSE(cache.storeEnvironment(opts.appID, "key", environment).has_value());
+
+    ASSERT_TRUE(cache.store(opts.appID, "key", bundle, config).has_value());
+    EXPECT_FALSE(cache.load(opts.appID, "key")->environment.has_value());
+
+    // the configuration is regenerated by another launch
+    EXPECT_FALSE(cache.storeEnvironment(opts.appID, "other", environment).has_value());
+    ASSERT_TRUE(cache.storeEnvironment(opts.appID, "key", environment).has_value());
+    EXPECT_EQ(cache.load(opts.appID, "key")->environment, environment);
+
+    // the environment is captured again for the new configuration
+    ASSERT_TRUE(cache.store(opts.appID, "key", bundle, config).has_value());
+    EXPECT_FALSE(cache.load(opts.appID, "key")->environment.has_value());
+}
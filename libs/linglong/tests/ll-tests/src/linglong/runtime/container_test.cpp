@@ -0,0 +1,24 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <gtest/gtest.h>
+
+#include "linglong/runtime/container.h"
+
+using namespace linglong;
+
+TEST(ContainerTest, ParseEnvironment)
+{
+    using namespace std::string_literals;
+
+    // the output of `env -0` in bash, the values might contain new lines
+    auto content = "PATH=/usr/bin:/bin\0_=/usr/bin/env\0MULTI=a\nb\0EMPTY=\0SHLVL=1\0"
+                   "PWD=/home/user\0OLDPWD=/\0PWDX=1\0"s;
+    std::vector<std::string> expected{ "PATH=/usr/bin:/bin", "MULTI=a\nb", "EMPTY=", "PWDX=1" };
+    EXPECT_EQ(runtime::parseEnvironment(content), expected);
+
+    // the file is truncated or not written at all
+    EXPECT_EQ(runtime::parseEnvironment("LANG=C\0HOME"s), (std::vector<std::string>{ "LANG=C" }));
+    EXPECT_TRUE(runtime::parseEnvironment("").empty());
+}
@@ -0,0 +1,496 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <gtest/gtest.h>
+
+#include "linglong/runtime/mount_planner.h"
+
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <random>
+#include <unordered_set>
+
+namespace fs = std::filesystem;
+using Mount = ocppi::runtime::config::types::Mount;
+
+namespace {
+
+Mount bindMount(const std::string &destination, const std::string &source, bool readonly = true)
+{
+    return Mount{
+        .destination = destination,
+        .gidMappings = {},
+        .options = readonly ? std::vector<std::string>{ "rbind", "ro" }
+                            : std::vector<std::string>{ "rbind" },
+        .source = source,
+        .type = "bind",
+        .uidMappings = {},
+    };
+}
+
+Mount tmpfsMount(const std::string &destination)
+{
+    return Mount{
+        .destination = destination,
+        .gidMappings = {},
+        .options = { { "nodev", "nosuid" } },
+        .source = "tmpfs",
+        .type = "tmpfs",
+        .uidMappings = {},
+    };
+}
+
+// legacyFixMount is the algorithm used before the mount planner, ported from Qt to the standard
+// library, the tests check that the planner makes the same tree visible in the container
+std::vector<Mount> legacyFixMount(const fs::path &originalRoot, std::vector<Mount> mounts)
+{
+    auto cleanPath = [](const std::string &path) {
+        auto ret = fs::path{ path }.lexically_normal().string();
+        if (ret.size() > 1 && ret.back() == '/') {
+            ret.pop_back();
+        }
+        return ret;
+    };
+    auto commonParent = [&cleanPath](const std::string &path1, const std::string &path2) {
+        std::string ret = path2;
+        while (path1.rfind(ret, 0) != 0) {
+            ret.pop_back();
+        }
+        if (ret.empty()) {
+            return ret;
+        }
+        while (ret.back() != '/') {
+            ret.pop_back();
+        }
+        return cleanPath(ret);
+    };
+    auto join = [](const std::vector<std::string> &elem) {
+        std::string ret;
+        for (std::size_t i = 0; i < elem.size(); ++i) {
+            ret += (i == 0 ? "" : "/") + elem[i];
+        }
+        return ret;
+    };
+    // like QDir::entryInfoList, it's empty if the path isn't a directory
+    auto list = [](const fs::path &dir) {
+        std::error_code ec;
+        std::vector<fs::directory_entry> entries{ fs::directory_iterator{ dir, ec },
+                                                  fs::directory_iterator{} };
+        std::sort(entries.begin(), entries.end());
+        return entries;
+    };
+
+    auto originalRootPath = cleanPath(originalRoot.string());
+    std::vector<std::string> tmpfsPath;
+    for (const auto &mount : mounts) {
+        if (mount.destination.empty() || mount.destination.at(0) != '/') {
+            continue;
+        }
+
+        auto hostSource = cleanPath(originalRootPath + "/" + mount.destination.substr(1));
+        if (fs::exists(hostSource)) {
+            continue;
+        }
+
+        std::vector<std::string> elem;
+        std::size_t begin = 0;
+        for (auto end = hostSource.find('/'); end != std::string::npos;
+             begin = end + 1, end = hostSource.find('/', begin)) {
+            elem.push_back(hostSource.substr(begin, end - begin));
+        }
+        elem.push_back(hostSource.substr(begin));
+        while (!elem.empty() && !fs::exists(join(elem))) {
+            elem.pop_back();
+        }
+        if (elem.empty()) {
+            continue;
+        }
+
+        bool newTmp{ true };
+        auto existsPath = join(elem);
+        if (existsPath <= originalRootPath) {
+            continue;
+        }
+
+        for (auto it = tmpfsPath.begin(); it != tmpfsPath.end(); ++it) {
+            if (existsPath == *it) {
+                newTmp = false;
+                continue;
+            }
+
+            if (auto common = commonParent(existsPath, *it); common > originalRootPath) {
+                newTmp = false;
+                *it = common;
+                break;
+            }
+        }
+
+        if (newTmp) {
+            tmpfsPath.push_back(existsPath);
+        }
+    }
+
+    auto pos = mounts.begin();
+    for (const auto &entry : list(originalRoot)) {
+        auto destination = "/" + entry.path().filename().string();
+        pos = mounts.insert(pos, bindMount(destination, entry.path().string()));
+        ++pos;
+    }
+
+    for (const auto &path : tmpfsPath) {
+        auto destination = path.substr(originalRootPath.size());
+        pos = mounts.insert(pos, tmpfsMount(destination));
+        ++pos;
+        for (const auto &entry : list(path)) {
+            auto source = entry.path().string();
+            pos = mounts.insert(pos, bindMount(source.substr(originalRootPath.size()), source));
+            ++pos;
+        }
+    }
+
+    std::unordered_set<std::string> dups;
+    for (auto it = mounts.crbegin(); it != mounts.crend(); ++it) {
+        if (dups.find(it->destination) != dups.end()) {
+            mounts.erase(std::next(it).base());
+            continue;
+        }
+
+        dups.insert(it->destination);
+    }
+
+    return mounts;
+}
+
+// Container simulates what ll-box does with the mounts, without mounting anything
+class Container
+{
+public:
+    // the root is an empty writable directory, or the given directory made writable
+    explicit Container(const std::optional<fs::path> &root = std::nullopt)
+    {
+        this->root.source = root ? root->string() : "";
+    }
+
+    // mount returns false if the mount point doesn't exist and can't be created
+    bool mount(const Mount &mount)
+    {
+        auto *node = &this->root;
+        for (const auto &part : fs::path{ mount.destination }.lexically_normal().relative_path()) {
+            if (part.empty()) {
+                continue;
+            }
+
+            load(*node);
+            auto &child = node->children[part.string()];
+            if (!child) {
+                if (!node->writable || !isDir(*node)) {
+                    return false;
+                }
+                child = std::make_unique<Node>();
+            }
+            node = child.get();
+        }
+
+        if (node == &this->root) {
+            return false;
+        }
+
+        const auto &options = mount.options.value_or(std::vector<std::string>{});
+        *node = Node{};
+        node->source = mount.type == "tmpfs" ? "" : mount.source.value_or("");
+        node->writable = std::find(options.begin(), options.end(), "ro") == options.end();
+        return true;
+    }
+
+    // tree returns every path visible in the container, with the file it's bound from
+    std::map<std::string, std::string> tree()
+    {
+        std::map<std::string, std::string> ret;
+        walk(this->root, "/", ret);
+        return ret;
+    }
+
+private:
+    struct Node
+    {
+        // the file or directory in the host, empty for the directories without content
+        std::string source;
+        bool writable{ true };
+        bool loaded{ false };
+        std::map<std::string, std::unique_ptr<Node>> children;
+    };
+
+    static bool isDir(const Node &node)
+    {
+        return node.source.empty() || fs::is_directory(node.source);
+    }
+
+    static void load(Node &node)
+    {
+        if (node.loaded) {
+            return;
+        }
+
+        node.loaded = true;
+        if (node.source.empty() || !fs::is_directory(node.source)) {
+            return;
+        }
+
+        for (const auto &entry : fs::directory_iterator{ node.source }) {
+            auto child = std::make_unique<Node>();
+            child->source = entry.path().string();
+            child->writable = node.writable;
+            node.children.emplace(entry.path().filename().string(), std::move(child));
+        }
+    }
+
+    static void walk(Node &node, const fs::path &path, std::map<std::string, std::string> &tree)
+    {
+        if (!isDir(node)) {
+            tree.emplace(path.string(), node.source);
+            return;
+        }
+
+        tree.emplace(path.string(), "directory");
+        load(node);
+        for (auto &[name, child] : node.children) {
+            walk(*child, path / name, tree);
+        }
+    }
+
+    Node root;
+};
+
+std::optional<std::map<std::string, std::string>> visibleTree(const std::vector<Mount> &mounts)
+{
+    Container container;
+    for (const auto &mount : mounts) {
+        if (!container.mount(mount)) {
+            return std::nullopt;
+        }
+    }
+    return container.tree();
+}
+
+class MountPlannerTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        auto tmpl = (fs::temp_directory_path() / "mount-planner-XXXXXX").string();
+        ASSERT_NE(::mkdtemp(tmpl.data()), nullptr);
+        dir = tmpl;
+        rootDir = dir / "root";
+        hostDir = dir / "host";
+    }
+
+    void TearDown() override
+    {
+        std::error_code ec;
+        fs::remove_all(dir, ec);
+    }
+
+    static void touch(const fs::path &path)
+    {
+        fs::create_directories(path.parent_path());
+        std::ofstream{ path } << path.filename().string();
+    }
+
+    // expected is the tree visible in the root with the mounts applied on it
+    std::map<std::string, std::string> expected(const std::vector<Mount> &mounts)
+    {
+        Container container{ rootDir };
+        for (const auto &mount : mounts) {
+            EXPECT_TRUE(container.mount(mount)) << mount.destination;
+        }
+        return container.tree();
+    }
+
+    fs::path dir;
+    fs::path rootDir;
+    fs::path hostDir;
+};
+
+} // namespace
+
+TEST_F(MountPlannerTest, BindRootEntries)
+{
+    fs::create_directories(rootDir / "usr" / "lib");
+    touch(rootDir / "etc" / "passwd");
+    fs::create_symlink("usr/lib", rootDir / "lib");
+    fs::create_directories(hostDir / "home");
+
+    std::vector<Mount> mounts{ tmpfsMount("/dev"),
+                               bindMount("/etc", "/etc"),
+                               bindMount("/home", hostDir / "home") };
+    auto planned = linglong::runtime::planMounts(rootDir, mounts);
+
+    ASSERT_EQ(planned.size(), 5U);
+    EXPECT_EQ(planned[0].destination, "/lib");
+    EXPECT_EQ(planned[0].options, (std::vector<std::string>{ "rbind", "ro", "copy-symlink" }));
+    EXPECT_EQ(planned[1].destination, "/usr");
+    EXPECT_EQ(planned[1].source, (rootDir / "usr").string());
+    // /etc of the root is replaced
+    EXPECT_EQ(planned[2].destination, "/dev");
+    EXPECT_EQ(planned[3].destination, "/etc");
+    EXPECT_EQ(planned[3].source, "/etc");
+    EXPECT_EQ(planned[4].destination, "/home");
+}
+
+TEST_F(MountPlannerTest, TmpfsForMissingMountPoints)
+{
+    fs::create_directories(rootDir / "usr" / "lib");
+    fs::create_directories(rootDir / "usr" / "share");
+    touch(rootDir / "usr" / "lib" / "libc.so");
+    fs::create_directories(hostDir / "a");
+    fs::create_directories(hostDir / "b");
+
+    std::vector<Mount> mounts{ bindMount("/usr/lib/a/b", hostDir / "a"),
+                               bindMount("/usr/share/b", hostDir / "b"),
+                               bindMount("/usr/lib/c", hostDir / "b") };
+    auto planned = linglong::runtime::planMounts(rootDir, mounts);
+
+    auto destinations = std::vector<std::string>{};
+    for (const auto &mount : planned) {
+        destinations.push_back(mount.destination);
+    }
+    EXPECT_EQ(destinations,
+              (std::vector<std::string>{ "/usr",
+                                         "/usr/lib",
+                                         "/usr/lib/libc.so",
+                                         "/usr/share",
+                                         "/usr/lib/a/b",
+                                         "/usr/share/b",
+                                         "/usr/lib/c" }));
+    EXPECT_EQ(planned[0].type, "bind");
+    EXPECT_EQ(planned[1].type, "tmpfs");
+    EXPECT_EQ(planned[3].type, "tmpfs");
+
+    auto tree = visibleTree(planned);
+    ASSERT_TRUE(tree.has_value());
+    EXPECT_EQ(*tree, expected(mounts));
+
+    // the legacy algorithm replaces /usr by tmpfs, so /usr/lib/a/b can't be created in the
+    // read-only /usr/lib
+    EXPECT_FALSE(visibleTree(legacyFixMount(rootDir, mounts)).has_value());
+}
+
+TEST_F(MountPlannerTest, ShadowedMounts)
+{
+    fs::create_directories(rootDir / "opt");
+    fs::create_directories(hostDir / "a" / "b");
+    fs::create_directories(hostDir / "c");
+
+    std::vector<Mount> mounts{ bindMount("/opt/a/b", hostDir / "c"),
+                               bindMount("/opt/a", hostDir / "a"),
+                               tmpfsMount("/tmp"),
+                               bindMount("/opt/a/", hostDir / "c"),
+                               bindMount("/tmp/x", hostDir / "a") };
+    auto planned = linglong::runtime::planMounts(rootDir, mounts);
+
+    // /opt of the root is replaced by tmpfs for the missing /opt/a
+    ASSERT_EQ(planned.size(), 4U);
+    EXPECT_EQ(planned[0].type, "tmpfs");
+    EXPECT_EQ(planned[0].destination, "/opt");
+    EXPECT_EQ(planned[1].destination, "/tmp");
+    EXPECT_EQ(planned[2].destination, "/opt/a/");
+    EXPECT_EQ(planned[3].destination, "/tmp/x");
+
+    auto tree = visibleTree(planned);
+    ASSERT_TRUE(tree.has_value());
+    EXPECT_EQ(*tree, expected(mounts));
+}
+
+TEST_F(MountPlannerTest, RandomMounts)
+{
+    const std::vector<std::string> names{ "a", "b", "c", "d", "e" };
+    int compared{ 0 };
+    int comparedWithLegacy{ 0 };
+    std::size_t plannedMounts{ 0 };
+    std::size_t legacyMounts{ 0 };
+
+    for (unsigned int seed = 0; seed < 300; ++seed) {
+        std::mt19937 random{ seed };
+        auto chance = [&random](int percent) {
+            return std::uniform_int_distribution<int>{ 0, 99 }(random) < percent;
+        };
+        auto pick = [&random](const auto &items) {
+            return items[std::uniform_int_distribution<std::size_t>{ 0, items.size() - 1 }(random)];
+        };
+
+        fs::remove_all(rootDir);
+        fs::remove_all(hostDir);
+        fs::create_directories(rootDir);
+
+        // "e" never exists in the root
+        std::function<void(const fs::path &, int)> populate = [&](const fs::path &path,
+                                                                 int depth) {
+            for (const auto &name : { "a", "b", "c", "d" }) {
+                if (depth < 3 && chance(45)) {
+                    fs::create_directories(path / name);
+                    populate(path / name, depth + 1);
+                } else if (chance(20)) {
+                    touch(path / name);
+                }
+            }
+        };
+        populate(rootDir, 0);
+
+        std::vector<std::string> sources;
+        for (int i = 0; i < 3; ++i) {
+            auto source = hostDir / ("dir" + std::to_string(i));
+            fs::create_directories(source / "x");
+            touch(source / "y");
+            sources.push_back(source.string());
+            sources.push_back((source / "y").string());
+        }
+
+        std::vector<Mount> mounts;
+        auto count = std::uniform_int_distribution<int>{ 1, 8 }(random);
+        for (int i = 0; i < count; ++i) {
+            std::string destination;
+            auto depth = std::uniform_int_distribution<int>{ 1, 4 }(random);
+            for (int j = 0; j < depth; ++j) {
+                destination += "/" + pick(names);
+            }
+
+            if (chance(25)) {
+                mounts.push_back(tmpfsMount(destination));
+            } else {
+                mounts.push_back(bindMount(destination, pick(sources), chance(50)));
+            }
+        }
+
+        // skip the mounts that can't be applied on the root either
+        Container container{ rootDir };
+        if (!std::all_of(mounts.begin(), mounts.end(), [&container](const Mount &mount) {
+                return container.mount(mount);
+            })) {
+            continue;
+        }
+        auto expectedTree = container.tree();
+
+        auto planned = linglong::runtime::planMounts(rootDir, mounts);
+        auto tree = visibleTree(planned);
+        ASSERT_TRUE(tree.has_value()) << "seed " << seed;
+        EXPECT_EQ(*tree, expectedTree) << "seed " << seed;
+        ++compared;
+
+        auto legacy = legacyFixMount(rootDir, mounts);
+        if (auto legacyTree = visibleTree(legacy); legacyTree) {
+            EXPECT_EQ(*tree, *legacyTree) << "seed " << seed;
+            ++comparedWithLegacy;
+            plannedMounts += planned.size();
+            legacyMounts += legacy.size();
+        }
+    }
+
+    EXPECT_GT(compared, 150);
+    EXPECT_GT(comparedWithLegacy, 100);
+    EXPECT_LE(plannedMounts, legacyMounts);
+}
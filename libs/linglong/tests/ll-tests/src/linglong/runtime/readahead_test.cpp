@@ -0,0 +1,157 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <gtest/gtest.h>
+
+#include "linglong/runtime/readahead.h"
+
+#include <QFile>
+#include <QTemporaryDir>
+
+using namespace linglong;
+
+namespace {
+
+void writeFile(const QString &path, const QByteArray &content)
+{
+    QFile file(path);
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    file.write(content);
+}
+
+void readFile(const QString &path)
+{
+    QFile file(path);
+    ASSERT_TRUE(file.open(QIODevice::ReadOnly));
+    file.readAll();
+}
+
+} // namespace
+
+TEST(Readahead, StoreAndLoad)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+
+    runtime::Readahead readahead(QDir(dir.filePath("profiles")));
+    EXPECT_FALSE(readahead.load("org.deepin.test", "key").has_value());
+
+    std::vector<runtime::ReadaheadRange> ranges{
+        { .path = "/layers/base/files/lib/libc.so.6", .offset = 0, .length = 8192 },
+        { .path = "/layers/base/files/lib/libc.so.6", .offset = 16384, .length = 4096 },
+    };
+    ASSERT_TRUE(readahead.store("org.deepin.test", "key", ranges).has_value());
+
+    auto loaded = readahead.load("org.deepin.test", "key");
+    ASSERT_TRUE(loaded.has_value());
+    ASSERT_EQ(loaded->size(), 2U);
+    EXPECT_EQ(loaded->at(1).path, ranges.at(1).path);
+    EXPECT_EQ(loaded->at(1).offset, 16384U);
+    EXPECT_EQ(loaded->at(1).length, 4096U);
+
+    // the profile of other layers is recorded again
+    EXPECT_FALSE(readahead.load("org.deepin.test", "other").has_value());
+}
+
+TEST(Readahead, Key)
+{
+    auto key = runtime::readaheadKey({ "/layers/app/1.0.0/files", "/layers/base/1.0.0/files" });
+    EXPECT_EQ(runtime::readaheadKey({ "/layers/app/1.0.0/files", "/layers/base/1.0.0/files" }),
+              key);
+    EXPECT_NE(runtime::readaheadKey({ "/layers/app/1.0.1/files", "/layers/base/1.0.0/files" }),
+              key);
+}
+
+TEST(Readahead, ResidentRanges)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+
+    // the written pages are in the page cache
+    writeFile(dir.filePath("file"), QByteArray(10000, 'a'));
+    auto ranges = runtime::residentRanges(dir.filePath("file").toStdString());
+    ASSERT_TRUE(ranges.has_value());
+    ASSERT_EQ(ranges->size(), 1U);
+    EXPECT_EQ(ranges->at(0).offset, 0U);
+    EXPECT_EQ(ranges->at(0).length, 10000U);
+
+    writeFile(dir.filePath("empty"), "");
+    ranges = runtime::residentRanges(dir.filePath("empty").toStdString());
+    ASSERT_TRUE(ranges.has_value());
+    EXPECT_TRUE(ranges->empty());
+
+    EXPECT_FALSE(runtime::residentRanges(dir.filePath("missing").toStdString()).has_value());
+
+    // the missing files are skipped
+    std::atomic_bool stopped{ false };
+    std::vector<runtime::ReadaheadRange> replayed{
+        { .path = dir.filePath("missing").toStdString(), .offset = 0, .length = 1 },
+        { .path = dir.filePath("file").toStdString(), .offset = 0, .length = 10000 },
+    };
+    runtime::readahead(replayed, stopped);
+}
+
+TEST(ReadaheadRecorder, Record)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    ASSERT_TRUE(QDir(dir.path()).mkpath("layer/lib/x86_64-linux-gnu"));
+    writeFile(dir.filePath("layer/bin"), "bin");
+    writeFile(dir.filePath("layer/lib/x86_64-linux-gnu/libfoo.so"), "lib");
+    writeFile(dir.filePath("outside"), "outside");
+
+    auto recorder = runtime::ReadaheadRecorder::start({ dir.filePath("layer").toStdString() });
+    if (!recorder) {
+        GTEST_SKIP() << "fanotify is unavailable: " << recorder.error().message().toStdString();
+    }
+
+    readFile(dir.filePath("layer/lib/x86_64-linux-gnu/libfoo.so"));
+    readFile(dir.filePath("outside"));
+    (*recorder)->stop();
+
+    auto files = (*recorder)->record(std::chrono::seconds(10));
+    ASSERT_TRUE(files.has_value());
+    std::set<std::filesystem::path> expected{
+        dir.filePath("layer/lib/x86_64-linux-gnu/libfoo.so").toStdString(),
+    };
+    EXPECT_EQ(*files, expected);
+}
+
+TEST(ReadaheadSession, RecordAndReplay)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    ASSERT_TRUE(QDir(dir.path()).mkpath("layer"));
+    writeFile(dir.filePath("layer/file"), QByteArray(10000, 'a'));
+    runtime::Readahead readahead(QDir(dir.filePath("profiles")));
+    std::vector<std::filesystem::path> layers{ dir.filePath("layer").toStdString() };
+
+    // the recording stops when the session is destroyed
+    {
+        runtime::ReadaheadSession session(readahead,
+                                          "org.deepin.test",
+                                          layers,
+                                          std::chrono::hours(1));
+        readFile(dir.filePath("layer/file"));
+    }
+    auto profile = readahead.load("org.deepin.test", runtime::readaheadKey(layers));
+    if (!profile) {
+        GTEST_SKIP() << "fanotify is unavailable";
+    }
+    ASSERT_EQ(profile->size(), 1U);
+    EXPECT_EQ(profile->at(0).path, dir.filePath("layer/file").toStdString());
+
+    // the profile is replayed instead of recorded again
+    writeFile(dir.filePath("layer/other"), "other");
+    {
+        runtime::ReadaheadSession session(readahead,
+                                          "org.deepin.test",
+                                          layers,
+                                          std::chrono::hours(1));
+        readFile(dir.filePath("layer/other"));
+    }
+    profile = readahead.load("org.deepin.test", runtime::readaheadKey(layers));
+    ASSERT_TRUE(profile.has_value());
+    EXPECT_EQ(profile->size(), 1U);
+}
@@ -0,0 +1,109 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <gtest/gtest.h>
+
+#include "linglong/runtime/resource_policy.h"
+
+#include <QTemporaryDir>
+
+#include <fstream>
+
+#include <unistd.h>
+
+using namespace linglong;
+
+TEST(ResourcePolicy, MergeResources)
+{
+    EXPECT_FALSE(runtime::mergeResources(std::nullopt, std::nullopt).has_value());
+
+    runtime::Resources package{ .cpuWeight = 50, .memoryMax = 1024 };
+    auto merged = runtime::mergeResources(package, std::nullopt);
+    ASSERT_TRUE(merged.has_value());
+    EXPECT_EQ(merged->cpuWeight, 50);
+
+    // the values of the user override the ones of the package
+    merged = runtime::mergeResources(package, runtime::Resources{ .memoryMax = 2048 });
+    ASSERT_TRUE(merged.has_value());
+    EXPECT_EQ(merged->cpuWeight, 50);
+    EXPECT_EQ(merged->memoryMax, 2048);
+    EXPECT_FALSE(merged->pidsMax.has_value());
+}
+
+TEST(ResourcePolicy, UnitProperties)
+{
+    auto properties = runtime::unitProperties({
+      .cpuWeight = 20,
+      .ioWeight = 0,
+      .memoryHigh = 512 * 1024 * 1024,
+      .memoryMax = -1,
+      .pidsMax = 64,
+    });
+
+    // the weight out of range and the negative limit are skipped
+    std::vector<std::pair<std::string, std::uint64_t>> expected{
+        { "CPUWeight", 20 },
+        { "MemoryHigh", 512 * 1024 * 1024 },
+        { "TasksMax", 64 },
+    };
+    EXPECT_EQ(properties, expected);
+}
+
+TEST(ResourcePolicy, EscapeUnitName)
+{
+    EXPECT_EQ(runtime::escapeUnitName("org.deepin.calculator"), "org.deepin.calculator");
+    EXPECT_EQ(runtime::escapeUnitName("com.example.my-app"), "com.example.my\\x2dapp");
+    EXPECT_EQ(runtime::escapeUnitName(".hidden app"), "\\x2ehidden\\x20app");
+}
+
+TEST(ResourcePolicy, AppUnitOf)
+{
+    const auto slice = std::string{ "/user.slice/user-1000.slice/user@1000.service/app.slice/" };
+
+    EXPECT_EQ(runtime::appUnitOf(slice + "app-DDE-org.deepin.calculator@1a2b.service",
+                                 "org.deepin.calculator"),
+              "app-DDE-org.deepin.calculator@1a2b.service");
+    EXPECT_EQ(runtime::appUnitOf(slice + "app-linglong-org.deepin.calculator-0123456789ab.scope",
+                                 "org.deepin.calculator"),
+              "app-linglong-org.deepin.calculator-0123456789ab.scope");
+    EXPECT_EQ(
+      runtime::appUnitOf(slice + "app-com.example.my\\x2dapp.service", "com.example.my-app"),
+      "app-com.example.my\\x2dapp.service");
+
+    // the units of other applications, e.g. the terminal which starts the application
+    EXPECT_FALSE(runtime::appUnitOf(slice + "app-gnome-org.gnome.Terminal-1234.scope",
+                                    "org.deepin.calculator"));
+    EXPECT_FALSE(runtime::appUnitOf(slice + "app-DDE-org.deepin.calculator2@1a2b.service",
+                                    "org.deepin.calculator"));
+    EXPECT_FALSE(runtime::appUnitOf("/user.slice/user-1000.slice/session-2.scope",
+                                    "org.deepin.calculator"));
+    EXPECT_FALSE(
+      runtime::appUnitOf(slice + "app-DDE-org.deepin.calculator", "org.deepin.calculator"));
+}
+
+TEST(ResourcePolicy, ResourceUsage)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    auto cgroup = std::filesystem::path(dir.path().toStdString());
+
+    auto usage = runtime::resourceUsage(cgroup);
+    EXPECT_FALSE(usage.cpuUsage.has_value());
+    EXPECT_FALSE(usage.memoryUsage.has_value());
+
+    std::ofstream(cgroup / "cpu.stat") << "usage_usec 1500000\nuser_usec 1000000\n";
+    std::ofstream(cgroup / "memory.current") << "4096\n";
+    std::ofstream(cgroup / "pids.current") << "3\n";
+    usage = runtime::resourceUsage(cgroup);
+    EXPECT_EQ(usage.cpuUsage, 1500000);
+    EXPECT_EQ(usage.memoryUsage, 4096);
+    EXPECT_EQ(usage.tasks, 3);
+
+    // the cgroup of the current process is always known on cgroup v2
+    if (std::filesystem::exists("/sys/fs/cgroup/cgroup.controllers")) {
+        auto self = runtime::cgroupOf(::getpid());
+        ASSERT_TRUE(self.has_value());
+        EXPECT_EQ(self->front(), '/');
+    }
+}
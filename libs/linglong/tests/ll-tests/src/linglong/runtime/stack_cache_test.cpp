@@ -0,0 +1,257 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <gtest/gtest.h>
+
+#include "linglong/package/architecture.h"
+#include "linglong/runtime/container_builder.h"
+#include "linglong/runtime/stack_cache.h"
+#include "linglong/utils/serialize/json.h"
+
+#include <QFile>
+#include <QTemporaryDir>
+
+#include <algorithm>
+
+using namespace linglong;
+
+namespace {
+
+void writeFile(const QString &path, const QByteArray &content)
+{
+    QFile file(path);
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    file.write(content);
+}
+
+class StackCacheTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        auto arch = package::Architecture::currentCPUArchitecture();
+        ASSERT_TRUE(arch.has_value());
+        triplet = arch->getTriplet();
+
+        // the base has fonts, the runtime has GIO modules, neither has gdk-pixbuf or GTK
+        ASSERT_TRUE(dir.isValid());
+        QDir root(dir.path());
+        for (const auto &path : { QString("layers/app-commit/files/lib"),
+                                  "layers/runtime-commit/files/lib/" + triplet + "/gio/modules",
+                                  QString("layers/base-commit/files/usr/lib"),
+                                  QString("layers/base-commit/files/usr/share/fonts"),
+                                  QString("bundles/first"),
+                                  QString("bundles/second") }) {
+            ASSERT_TRUE(root.mkpath(path));
+        }
+        writeFile(root.filePath("layers/base-commit/files/usr/share/fonts/test.ttf"), "");
+        writeFile(root.filePath("layers/runtime-commit/files/lib/" + triplet
+                                + "/gio/modules/libtest.so"),
+                  "");
+
+        opts.appID = "org.deepin.test";
+        opts.appDir = QDir(root.filePath("layers/app-commit"));
+        opts.runtimeDir = QDir(root.filePath("layers/runtime-commit"));
+        opts.baseDir = QDir(root.filePath("layers/base-commit"));
+    }
+
+    static ocppi::runtime::config::types::Config config()
+    {
+        auto hook = nlohmann::json{
+            { "path", "/sbin/ldconfig" },
+            { "args", { "/sbin/ldconfig", "-C", "/run/linglong/etc/ld.so.cache" } },
+        };
+        return nlohmann::json{
+            { "ociVersion", "1.0.1" },
+            { "hooks", { { "startContainer", nlohmann::json::array({ hook }) } } },
+            { "mounts",
+              { { { "destination", "/run/linglong/etc" },
+                  { "options", { "nodev", "nosuid", "mode=700" } },
+                  { "source", "tmpfs" },
+                  { "type", "tmpfs" } } } },
+            { "process",
+              { { "cwd", "/" }, { "env", nlohmann::json::array({ "PATH=/usr/bin:/bin" }) } } },
+        }
+          .get<ocppi::runtime::config::types::Config>();
+    }
+
+    auto generator(const std::string &name) -> runtime::StackCache::Generator
+    {
+        auto generators = runtime::StackCache::generators(config(), opts.appID, triplet);
+        auto it = std::find_if(generators.begin(), generators.end(), [&name](const auto &item) {
+            return item.name == name;
+        });
+        EXPECT_NE(it, generators.end());
+        return it == generators.end() ? runtime::StackCache::Generator{} : *it;
+    }
+
+    std::string key(const std::string &name)
+    {
+        return runtime::stackCacheKey(opts, generator(name));
+    }
+
+    static auto mount(const ocppi::runtime::config::types::Config &config,
+                      const std::string &destination) -> ocppi::runtime::config::types::Mount
+    {
+        auto it = std::find_if(config.mounts->begin(),
+                               config.mounts->end(),
+                               [&destination](const auto &item) {
+                                   return item.destination == destination;
+                               });
+        EXPECT_NE(it, config.mounts->end());
+        return it == config.mounts->end() ? ocppi::runtime::config::types::Mount{} : *it;
+    }
+
+    static bool readOnly(const ocppi::runtime::config::types::Mount &mount)
+    {
+        const auto &options = mount.options.value_or(std::vector<std::string>{});
+        return std::find(options.begin(), options.end(), "ro") != options.end();
+    }
+
+    QTemporaryDir dir;
+    QString triplet;
+    runtime::ContainerOptions opts;
+};
+
+} // namespace
+
+TEST_F(StackCacheTest, KeyChangesWithInputs)
+{
+    auto fontconfig = key("fontconfig");
+    auto gio = key("gio");
+    EXPECT_EQ(key("fontconfig"), fontconfig);
+
+    // only the caches generated from the changed directories are invalidated
+    writeFile(dir.filePath("layers/base-commit/files/usr/share/fonts/other.ttf"), "");
+    EXPECT_NE(key("fontconfig"), fontconfig);
+    EXPECT_EQ(key("gio"), gio);
+
+    auto ld = key("ld.so.cache");
+    EXPECT_EQ(key("ld.so.cache"), ld);
+
+    writeFile(dir.filePath("layers/app-commit/files/lib/libfoo.so"), "");
+    auto app = key("ld.so.cache");
+    EXPECT_NE(app, ld);
+
+    writeFile(dir.filePath("layers/base-commit/files/usr/lib/libbar.so"), "");
+    auto base = key("ld.so.cache");
+    EXPECT_NE(base, app);
+
+    opts.runtimeDir = QDir(dir.filePath("layers/runtime-upgraded"));
+    EXPECT_NE(key("ld.so.cache"), base);
+    EXPECT_NE(key("gio"), gio);
+}
+
+TEST_F(StackCacheTest, GenerateAtFirstLaunch)
+{
+    runtime::StackCache cache(QDir(dir.filePath("cache")));
+    auto cfg = config();
+    ASSERT_TRUE(cache.apply(opts, QDir(dir.filePath("bundles/first")), cfg).has_value());
+
+    // the caches without inputs in the layers aren't generated
+    const auto &hooks = *cfg.hooks->startContainer;
+    ASSERT_EQ(hooks.size(), 3U);
+    EXPECT_EQ(hooks.at(0).path, "/sbin/ldconfig");
+    EXPECT_EQ(nlohmann::json(hooks.at(1)), nlohmann::json(generator("fontconfig").hook));
+    EXPECT_EQ(nlohmann::json(hooks.at(2)), nlohmann::json(generator("gio").hook));
+    EXPECT_EQ(cfg.mounts->size(), 3U);
+
+    for (const auto *destination :
+         { "/run/linglong/etc", "/run/linglong/cache/fontconfig", "/run/linglong/cache/gio" }) {
+        auto staging = mount(cfg, destination);
+        EXPECT_EQ(staging.type, "bind");
+        EXPECT_FALSE(readOnly(staging));
+        EXPECT_TRUE(QFileInfo(QString::fromStdString(staging.source.value_or(""))).isDir());
+    }
+    EXPECT_EQ(cfg.process->env, std::vector<std::string>{ "PATH=/usr/bin:/bin" });
+}
+
+TEST_F(StackCacheTest, CollectAndReuse)
+{
+    runtime::StackCache cache(QDir(dir.filePath("cache")));
+
+    // the hooks of the first launch generate the caches, except the one of GIO is interrupted
+    auto first = config();
+    ASSERT_TRUE(cache.apply(opts, QDir(dir.filePath("bundles/first")), first).has_value());
+    QDir ld(QString::fromStdString(mount(first, "/run/linglong/etc").source.value_or("")));
+    writeFile(ld.filePath("ld.so.cache"), "ld");
+    QDir fontconfig(
+      QString::fromStdString(mount(first, "/run/linglong/cache/fontconfig").source.value_or("")));
+    writeFile(fontconfig.filePath("fonts.conf"), "fonts");
+    writeFile(fontconfig.filePath(".done"), "");
+
+    // the later launch binds the collected caches read-only and skips their hooks
+    auto second = config();
+    ASSERT_TRUE(cache.apply(opts, QDir(dir.filePath("bundles/second")), second).has_value());
+    const auto &hooks = *second.hooks->startContainer;
+    ASSERT_EQ(hooks.size(), 1U);
+    EXPECT_EQ(nlohmann::json(hooks.at(0)), nlohmann::json(generator("gio").hook));
+
+    auto collectedLd = mount(second, "/run/linglong/etc");
+    EXPECT_TRUE(readOnly(collectedLd));
+    QDir collectedLdDir(QString::fromStdString(collectedLd.source.value_or("")));
+    QFile file(collectedLdDir.filePath("ld.so.cache"));
+    ASSERT_TRUE(file.open(QFile::ReadOnly));
+    EXPECT_EQ(file.readAll(), "ld");
+    EXPECT_TRUE(readOnly(mount(second, "/run/linglong/cache/fontconfig")));
+    EXPECT_FALSE(readOnly(mount(second, "/run/linglong/cache/gio")));
+
+    // the environment variables point to the generated files
+    const std::vector<std::string> env{
+        "PATH=/usr/bin:/bin",
+        "FONTCONFIG_FILE=/run/linglong/cache/fontconfig/fonts.conf",
+    };
+    EXPECT_EQ(second.process->env, env);
+
+    // the staging directories are kept while the first container is running
+    EXPECT_TRUE(fontconfig.exists());
+}
+
+TEST_F(StackCacheTest, FailedGenerationIsCached)
+{
+    runtime::StackCache cache(QDir(dir.filePath("cache")));
+
+    // fc-cache fails, so fonts.conf isn't generated
+    auto first = config();
+    ASSERT_TRUE(cache.apply(opts, QDir(dir.filePath("bundles/first")), first).has_value());
+    QDir fontconfig(
+      QString::fromStdString(mount(first, "/run/linglong/cache/fontconfig").source.value_or("")));
+    writeFile(fontconfig.filePath(".done"), "");
+
+    auto second = config();
+    ASSERT_TRUE(cache.apply(opts, QDir(dir.filePath("bundles/second")), second).has_value());
+    EXPECT_TRUE(readOnly(mount(second, "/run/linglong/cache/fontconfig")));
+    EXPECT_EQ(second.process->env, std::vector<std::string>{ "PATH=/usr/bin:/bin" });
+}
+
+TEST_F(StackCacheTest, RemoveStagingOfExitedContainers)
+{
+    runtime::StackCache cache(QDir(dir.filePath("cache")));
+
+    auto first = config();
+    ASSERT_TRUE(cache.apply(opts, QDir(dir.filePath("bundles/first")), first).has_value());
+    auto staging = QString::fromStdString(mount(first, "/run/linglong/etc").source.value_or(""));
+    ASSERT_TRUE(QFileInfo(staging).isDir());
+
+    auto second = config();
+    ASSERT_TRUE(cache.apply(opts, QDir(dir.filePath("bundles/second")), second).has_value());
+    EXPECT_EQ(second.hooks->startContainer->size(), 3U);
+    EXPECT_TRUE(QFileInfo(staging).isDir());
+
+    ASSERT_TRUE(QDir(dir.filePath("bundles/first")).removeRecursively());
+    auto third = config();
+    ASSERT_TRUE(cache.apply(opts, QDir(dir.filePath("bundles/second")), third).has_value());
+    EXPECT_FALSE(QFileInfo(staging).exists());
+}
+
+TEST_F(StackCacheTest, WithoutLdconfigHook)
+{
+    auto cfg = config();
+    cfg.hooks->startContainer->clear();
+
+    runtime::StackCache cache(QDir(dir.filePath("cache")));
+    ASSERT_TRUE(cache.apply(opts, QDir(dir.filePath("bundles/first")), cfg).has_value());
+    EXPECT_EQ(mount(cfg, "/run/linglong/etc").type, "tmpfs");
+    EXPECT_EQ(cfg.hooks->startContainer->size(), 2U);
+}
@@ -0,0 +1,152 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <gtest/gtest.h>
+
+#include "linglong/tracing/tracing.h"
+
+#include <nlohmann/json.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <set>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace tracing = linglong::tracing;
+
+namespace {
+
+// the tracer reads the environment once per process, so every case runs in a child process like
+// the processes launched by ll-cli
+int runInChild(const std::function<void()> &func)
+{
+    auto pid = ::fork();
+    if (pid == 0) {
+        func();
+        ::_exit(0);
+    }
+
+    int status{ 0 };
+    ::waitpid(pid, &status, 0);
+    return status;
+}
+
+nlohmann::json loadTrace(const std::filesystem::path &path)
+{
+    std::ifstream stream{ path };
+    std::string content{ std::istreambuf_iterator<char>{ stream },
+                         std::istreambuf_iterator<char>{} };
+    // what trace viewers do for the array format without the closing bracket
+    while (!content.empty() && (content.back() == '\n' || content.back() == ',')) {
+        content.pop_back();
+    }
+    return nlohmann::json::parse(content + "]");
+}
+
+class TracingTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        auto tmpl = (std::filesystem::temp_directory_path() / "tracing-XXXXXX").string();
+        ASSERT_NE(::mkdtemp(tmpl.data()), nullptr);
+        dir = tmpl;
+        traceFile = dir / "trace.json";
+    }
+
+    void TearDown() override
+    {
+        std::error_code ec;
+        std::filesystem::remove_all(dir, ec);
+    }
+
+    std::filesystem::path dir;
+    std::filesystem::path traceFile;
+};
+
+} // namespace
+
+TEST_F(TracingTest, Disabled)
+{
+    auto status = runInChild([] {
+        ::unsetenv(tracing::fileEnv);
+        if (tracing::enabled()) {
+            ::_exit(1);
+        }
+        tracing::Span span("nothing");
+    });
+    EXPECT_EQ(status, 0);
+    EXPECT_FALSE(std::filesystem::exists(traceFile));
+}
+
+TEST_F(TracingTest, SpansOfProcesses)
+{
+    auto status = runInChild([this] {
+        ::setenv(tracing::fileEnv, traceFile.c_str(), 1);
+        tracing::Span run("ll-cli run");
+        {
+            tracing::Span resolve("resolve \"app\"");
+        }
+
+        // like the generators executed by ll-cli
+        runInChild([] {
+            tracing::setProcessName("generator");
+            tracing::Span generator("generate");
+        });
+
+        tracing::Span box("ll-box");
+        box.end();
+        box.end();
+        tracing::instant("exec");
+    });
+    ASSERT_EQ(status, 0);
+
+    auto trace = loadTrace(traceFile);
+    ASSERT_TRUE(trace.is_array());
+
+    std::set<std::string> spans;
+    std::set<std::string> processes;
+    std::set<long> pids;
+    for (const auto &event : trace) {
+        auto phase = event.at("ph").get<std::string>();
+        pids.insert(event.at("pid").get<long>());
+        if (phase == "M") {
+            processes.insert(event.at("args").at("name").get<std::string>());
+            continue;
+        }
+
+        EXPECT_TRUE(event.at("ts").is_number());
+        if (phase == "X") {
+            EXPECT_GE(event.at("dur").get<double>(), 0);
+        }
+        EXPECT_TRUE(spans.insert(event.at("name").get<std::string>()).second)
+          << event.at("name");
+    }
+
+    EXPECT_EQ(spans,
+              (std::set<std::string>{ "ll-cli run", "resolve \"app\"", "generate", "ll-box",
+                                      "exec" }));
+    EXPECT_EQ(processes.count("generator"), 1U);
+    EXPECT_EQ(processes.size(), 2U);
+    EXPECT_EQ(pids.size(), 2U);
+
+    // the span contains the spans recorded during it
+    double runBegin{ 0 };
+    double runEnd{ 0 };
+    for (const auto &event : trace) {
+        if (event.at("name") == "ll-cli run") {
+            runBegin = event.at("ts").get<double>();
+            runEnd = runBegin + event.at("dur").get<double>();
+        }
+    }
+    for (const auto &event : trace) {
+        if (event.at("ph") == "X" && event.at("name") != "ll-cli run") {
+            EXPECT_GE(event.at("ts").get<double>(), runBegin);
+            EXPECT_LE(event.at("ts").get<double>() + event.at("dur").get<double>(), runEnd);
+        }
+    }
+}
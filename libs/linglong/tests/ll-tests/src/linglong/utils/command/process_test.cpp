@@ -0,0 +1,181 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <gtest/gtest.h>
+
+#include "linglong/utils/command/env.h"
+#include "linglong/utils/command/process.h"
+
+#include <csignal>
+#include <thread>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace linglong::utils;
+using namespace std::chrono_literals;
+
+namespace {
+
+error::Result<command::ProcessResult> run(const QString &script,
+                                          command::ProcessOptions options = {})
+{
+    auto process = command::Process::start("sh", { "-c", script }, std::move(options));
+    if (!process) {
+        return tl::unexpected(std::move(process.error()));
+    }
+    return (*process)->wait();
+}
+
+} // namespace
+
+TEST(Process, ExitStatus)
+{
+    auto result = run("echo out; echo err >&2; exit 3");
+    ASSERT_TRUE(result.has_value()) << result.error().message().toStdString();
+    EXPECT_EQ(result->exitCode, 3);
+    EXPECT_EQ(result->signal, 0);
+    EXPECT_EQ(result->standardOutput, "out\n");
+    EXPECT_EQ(result->standardError, "err\n");
+
+    result = run("kill -TERM $$");
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result->exitCode, -1);
+    EXPECT_EQ(result->signal, SIGTERM);
+
+    EXPECT_FALSE(command::Process::start("/nonexistent/program", {}).has_value());
+}
+
+TEST(Process, LargeOutput)
+{
+    // both pipes are filled at the same time, the process blocks if one of them isn't read
+    constexpr auto size = 8 * 1024 * 1024;
+    auto script = QString("head -c %1 /dev/zero & head -c %1 /dev/zero >&2; wait").arg(size);
+    auto result = run(script);
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result->exitCode, 0);
+    EXPECT_EQ(result->standardOutput.size(), size);
+    EXPECT_EQ(result->standardError.size(), size);
+
+    std::size_t received = 0;
+    int chunks = 0;
+    command::ProcessOptions options;
+    options.onStandardOutput = [&received, &chunks](std::string_view data) {
+        received += data.size();
+        chunks++;
+    };
+    result = run(QString("head -c %1 /dev/zero").arg(4 * size), std::move(options));
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(received, 4U * size);
+    EXPECT_GT(chunks, 1);
+    EXPECT_TRUE(result->standardOutput.isEmpty());
+}
+
+TEST(Process, OutputToFd)
+{
+    char path[] = "/tmp/process-test-XXXXXX";
+    auto fd = ::mkstemp(path);
+    ASSERT_NE(fd, -1);
+    ::unlink(path);
+
+    command::ProcessOptions options;
+    options.standardOutputFd = fd;
+    auto result = run("echo hello", std::move(options));
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result->exitCode, 0);
+    EXPECT_TRUE(result->standardOutput.isEmpty());
+
+    char buffer[16]{};
+    EXPECT_EQ(::pread(fd, buffer, sizeof(buffer), 0), 6);
+    EXPECT_STREQ(buffer, "hello\n");
+    ::close(fd);
+}
+
+TEST(Process, Timeout)
+{
+    command::ProcessOptions options;
+    options.timeout = 100ms;
+    auto start = std::chrono::steady_clock::now();
+    auto result = run("echo started; exec sleep 10", std::move(options));
+    ASSERT_TRUE(result.has_value());
+    EXPECT_TRUE(result->timedOut);
+    EXPECT_FALSE(result->cancelled);
+    EXPECT_EQ(result->signal, SIGKILL);
+    EXPECT_EQ(result->standardOutput, "started\n");
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 5s);
+}
+
+TEST(Process, Cancellation)
+{
+    command::CancellationToken token;
+    command::ProcessOptions options;
+    options.cancellation = token;
+    auto process = command::Process::start("sleep", { "10" }, std::move(options));
+    ASSERT_TRUE(process.has_value());
+
+    std::thread canceller([token] {
+        std::this_thread::sleep_for(100ms);
+        token.cancel();
+    });
+    auto start = std::chrono::steady_clock::now();
+    auto result = (*process)->wait();
+    canceller.join();
+    ASSERT_TRUE(result.has_value());
+    EXPECT_TRUE(result->cancelled);
+    EXPECT_EQ(result->signal, SIGKILL);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 5s);
+
+    // the processes started with a cancelled token are killed at once
+    options = {};
+    options.cancellation = token;
+    result = run("sleep 10", std::move(options));
+    ASSERT_TRUE(result.has_value());
+    EXPECT_TRUE(result->cancelled);
+}
+
+TEST(Process, Concurrent)
+{
+    std::vector<std::unique_ptr<command::Process>> processes;
+    std::vector<command::Process *> pointers;
+    for (auto i = 0; i < 4; ++i) {
+        auto process =
+          command::Process::start("sh", { "-c", QString("sleep 1; echo %1").arg(i) });
+        ASSERT_TRUE(process.has_value());
+        pointers.push_back(process->get());
+        processes.push_back(std::move(*process));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    auto results = command::waitAll(pointers);
+    ASSERT_TRUE(results.has_value());
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 3s);
+    ASSERT_EQ(results->size(), 4U);
+    for (auto i = 0; i < 4; ++i) {
+        EXPECT_EQ(results->at(i).exitCode, 0);
+        EXPECT_EQ(results->at(i).standardOutput, QString("%1\n").arg(i).toUtf8());
+    }
+}
+
+TEST(Process, InheritedPipe)
+{
+    // a daemon like erofsfuse keeps the output pipes open after the process exits
+    auto start = std::chrono::steady_clock::now();
+    auto result = run("sleep 5 & echo started");
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result->exitCode, 0);
+    EXPECT_EQ(result->standardOutput, "started\n");
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 3s);
+}
+
+TEST(Process, Exec)
+{
+    auto output = command::Exec("sh", { "-c", "echo hello" });
+    ASSERT_TRUE(output.has_value());
+    EXPECT_EQ(*output, "hello\n");
+
+    auto failed = command::Exec("sh", { "-c", "echo failure >&2; exit 2" });
+    ASSERT_FALSE(failed.has_value());
+    EXPECT_EQ(failed.error().code(), 2);
+    EXPECT_TRUE(failed.error().message().contains("failure"));
+}
@@ -8,6 +8,9 @@
 
 #include "linglong/utils/error/error.h"
 
+#include <chrono>
+#include <iostream>
+
 using namespace linglong::utils::error;
 
 TEST(Error, New)
@@ -64,3 +67,76 @@ TEST(Error, Wrap)
     ASSERT_EQ(res.error().code(), -1);
     ASSERT_EQ(res.error().message().contains("error"), true);
 }
+
+TEST(Error, LazyTrace)
+{
+    auto formatted = 0;
+    auto fn = [&formatted](int code) -> Result<void> {
+        LINGLONG_TRACE((++formatted, QString("test LINGLONG_TRACE %1").arg(code)));
+        if (code != 0) {
+            return LINGLONG_ERR("message", code);
+        }
+
+        return LINGLONG_OK;
+    };
+
+    // the trace message is only formatted for errors, the calls of the formatting are counted
+    ASSERT_EQ(fn(0).has_value(), true);
+    ASSERT_EQ(formatted, 0);
+
+    auto res = fn(2);
+    ASSERT_EQ(res.has_value(), false);
+    ASSERT_EQ(formatted, 1);
+    ASSERT_EQ(res.error().code(), 2);
+    ASSERT_EQ(res.error().message().endsWith(" test LINGLONG_TRACE 2: message"), true);
+}
+
+namespace {
+
+// eagerTrace formats the trace message on every call, like LINGLONG_TRACE did before
+[[gnu::noinline]] Result<void> eagerTrace(const QString &ref, bool fail)
+{
+    const QString message = "get dir from ref " + ref;
+    LINGLONG_TRACE(message);
+    if (fail) {
+        return LINGLONG_ERR("message", -1);
+    }
+
+    return LINGLONG_OK;
+}
+
+[[gnu::noinline]] Result<void> lazyTrace(const QString &ref, bool fail)
+{
+    LINGLONG_TRACE("get dir from ref " + ref);
+    if (fail) {
+        return LINGLONG_ERR("message", -1);
+    }
+
+    return LINGLONG_OK;
+}
+
+} // namespace
+
+// It measures the time of the successful calls of a function which formats its trace message on
+// every call and of one which uses LINGLONG_TRACE, the allocations are not counted.
+// run with --gtest_also_run_disabled_tests --gtest_filter='Error.DISABLED_LazyTraceBenchmark'
+TEST(Error, DISABLED_LazyTraceBenchmark)
+{
+    constexpr auto rounds = 10000000;
+    const QString ref = "main:org.deepin.test/1.0.0.0/x86_64";
+    volatile bool fail = false;
+
+    auto measure = [&](const char *name, Result<void> (*fn)(const QString &, bool)) {
+        auto begin = std::chrono::steady_clock::now();
+        for (auto i = 0; i < rounds; ++i) {
+            ASSERT_TRUE(fn(ref, fail).has_value());
+        }
+        std::chrono::duration<double, std::nano> elapsed =
+          std::chrono::steady_clock::now() - begin;
+        std::cout << name << ": " << elapsed.count() / rounds << " ns" << std::endl;
+        RecordProperty(name, std::to_string(elapsed.count() / rounds));
+    };
+
+    measure("eager trace", eagerTrace);
+    measure("lazy trace", lazyTrace);
+}
@@ -0,0 +1,336 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <gtest/gtest.h>
+
+#include "linglong/api/types/v1/Fields.hpp"
+#include "linglong/utils/serialize/json_reader.h"
+#include "ocppi/runtime/config/types/Fields.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <random>
+
+using namespace linglong;
+using utils::serialize::readJSON;
+
+namespace {
+
+// the results of the DOM parser and the streaming parser, the failed ones are nullopt
+template<typename T>
+std::pair<std::optional<nlohmann::json>, std::optional<nlohmann::json>>
+parseBoth(const std::string &text)
+{
+    std::pair<std::optional<nlohmann::json>, std::optional<nlohmann::json>> results;
+    try {
+        results.first = nlohmann::json(nlohmann::json::parse(text).get<T>());
+    } catch (const std::exception &) {
+    }
+    try {
+        results.second = nlohmann::json(readJSON<T>(text));
+    } catch (const std::exception &) {
+    }
+    return results;
+}
+
+template<typename T>
+void expectSame(const std::string &text)
+{
+    auto [dom, stream] = parseBoth<T>(text);
+    EXPECT_EQ(dom.has_value(), stream.has_value()) << text;
+    if (dom && stream) {
+        EXPECT_EQ(*dom, *stream) << text;
+    }
+}
+
+class Generator
+{
+public:
+    explicit Generator(std::uint32_t seed)
+        : engine(seed)
+    {
+    }
+
+    bool chance(double probability)
+    {
+        return std::bernoulli_distribution(probability)(this->engine);
+    }
+
+    std::size_t below(std::size_t n)
+    {
+        return std::uniform_int_distribution<std::size_t>(0, n - 1)(this->engine);
+    }
+
+    std::string string()
+    {
+        static const std::vector<std::string> pieces{
+            "a", "org.deepin", "/", "1.0", "\"", "\\", "\n", "中文", "", "x86_64",
+        };
+        std::string result;
+        for (auto n = this->below(4); n > 0; --n) {
+            result += pieces.at(this->below(pieces.size()));
+        }
+        return result;
+    }
+
+    // any value, which doesn't match the type in most cases
+    nlohmann::json garbage(int depth)
+    {
+        switch (this->below(depth > 0 ? 9 : 7)) {
+        case 0:
+            return nullptr;
+        case 1:
+            return this->chance(0.5);
+        case 2:
+            return std::uniform_int_distribution<std::int64_t>(-1000, 1000)(this->engine);
+        case 3:
+            return std::numeric_limits<std::uint64_t>::max() - this->below(10);
+        case 4:
+            return std::uniform_real_distribution<double>(-1e6, 1e6)(this->engine);
+        case 5:
+        case 6:
+            return this->string();
+        case 7: {
+            auto array = nlohmann::json::array();
+            for (auto n = this->below(4); n > 0; --n) {
+                array.push_back(this->garbage(depth - 1));
+            }
+            return array;
+        }
+        default: {
+            auto object = nlohmann::json::object();
+            for (auto n = this->below(4); n > 0; --n) {
+                object[this->string()] = this->garbage(depth - 1);
+            }
+            return object;
+        }
+        }
+    }
+
+    // a value of T, which is replaced by garbage by the probability of mutation
+    template<typename T>
+    nlohmann::json value(int depth)
+    {
+        if (this->chance(this->mutation)) {
+            return this->garbage(2);
+        }
+
+        namespace details = utils::serialize::details;
+        if constexpr (details::HasFields<T>::value) {
+            return this->object<T>(depth);
+        } else if constexpr (details::IsOptional<T>::value) {
+            return this->value<typename T::value_type>(depth);
+        } else if constexpr (std::is_same_v<T, nlohmann::json>) {
+            return this->garbage(depth > 0 ? 2 : 0);
+        } else if constexpr (details::IsVector<T>::value) {
+            auto array = nlohmann::json::array();
+            for (auto n = depth > 0 ? this->below(4) : 0; n > 0; --n) {
+                array.push_back(this->value<typename T::value_type>(depth - 1));
+            }
+            return array;
+        } else if constexpr (details::IsMap<T>::value) {
+            auto object = nlohmann::json::object();
+            for (auto n = depth > 0 ? this->below(4) : 0; n > 0; --n) {
+                object[this->string()] = this->value<typename T::mapped_type>(depth - 1);
+            }
+            return object;
+        } else if constexpr (std::is_enum_v<T>) {
+            return T{};
+        } else if constexpr (std::is_same_v<T, std::string>) {
+            return this->string();
+        } else if constexpr (std::is_same_v<T, bool>) {
+            return this->chance(0.5);
+        } else if constexpr (std::is_integral_v<T>) {
+            return std::uniform_int_distribution<T>(0, 1 << 20)(this->engine);
+        } else {
+            return std::uniform_real_distribution<T>(0, 1)(this->engine);
+        }
+    }
+
+    template<typename T>
+    nlohmann::json object(int depth)
+    {
+        auto object = nlohmann::json::object();
+        std::apply(
+          [this, depth, &object](const auto &...field) {
+              (this->member<T>(object, field, depth), ...);
+          },
+          fields(static_cast<const T *>(nullptr)));
+        if (this->chance(this->mutation)) {
+            object[this->string()] = this->garbage(2);
+        }
+        return object;
+    }
+
+    // the probability to replace a value by garbage, or to drop a required member
+    double mutation{ 0 };
+
+private:
+    template<typename T, typename Field>
+    void member(nlohmann::json &object, const Field &field, int depth)
+    {
+        using Member = std::decay_t<decltype(std::declval<T &>().*(field.second))>;
+        constexpr auto optional = utils::serialize::details::IsOptional<Member>::value
+          || std::is_same_v<Member, nlohmann::json>;
+        if ((optional || this->chance(this->mutation)) && this->chance(0.3)) {
+            return;
+        }
+        if (optional && this->chance(0.1)) {
+            object[field.first] = nullptr;
+            return;
+        }
+        object[field.first] = this->value<Member>(depth - 1);
+    }
+
+    std::mt19937 engine;
+};
+
+// mutate breaks the text, which is rejected by both parsers in most cases
+std::string mutate(Generator &generator, std::string text)
+{
+    static const std::string replacements = "{}[],:\"0-.e a";
+    if (text.empty()) {
+        return text;
+    }
+    auto position = generator.below(text.size());
+    if (generator.chance(0.5)) {
+        text.resize(position);
+    } else {
+        text[position] = replacements.at(generator.below(replacements.size()));
+    }
+    return text;
+}
+
+template<typename T>
+void fuzz(std::uint32_t seed, int rounds)
+{
+    Generator generator(seed);
+    auto succeeded = 0;
+    for (auto i = 0; i < rounds; ++i) {
+        // half of the documents are valid
+        auto valid = generator.chance(0.5);
+        generator.mutation = valid ? 0 : 0.02;
+        auto text = generator.value<T>(6).dump(generator.chance(0.5) ? 2 : -1);
+        if (!valid && generator.chance(0.2)) {
+            text = mutate(generator, std::move(text));
+        }
+
+        auto [dom, stream] = parseBoth<T>(text);
+        ASSERT_EQ(dom.has_value(), stream.has_value()) << text;
+        if (dom && stream) {
+            ASSERT_EQ(*dom, *stream) << text;
+            succeeded++;
+        }
+    }
+
+    EXPECT_GT(succeeded, rounds / 3);
+}
+
+api::types::v1::RepositoryCache repositoryCache(int count)
+{
+    api::types::v1::RepositoryCache cache;
+    cache.version = "1";
+    cache.llVersion = "1.7.0";
+    cache.config.defaultRepo = "stable";
+    cache.config.repos = { { "stable", "https://mirror-repo-linglong.deepin.com" } };
+    cache.config.version = 1;
+    for (auto i = 0; i < count; ++i) {
+        api::types::v1::RepositoryCacheLayersItem item;
+        item.commit = std::string(64, 'a' + static_cast<char>(i % 26));
+        item.repo = "stable";
+        item.info.arch = { "x86_64" };
+        item.info.base = "main:org.deepin.base/23.1.0/x86_64";
+        item.info.channel = "main";
+        item.info.command = std::vector<std::string>{ "/opt/apps/org.deepin.demo/files/bin/demo" };
+        item.info.description = "应用 " + std::to_string(i);
+        item.info.id = "org.deepin.demo" + std::to_string(i);
+        item.info.kind = "app";
+        item.info.packageInfoV2Module = "binary";
+        item.info.name = "demo";
+        item.info.runtime = "main:org.deepin.runtime.dtk/23.1.0/x86_64";
+        item.info.schemaVersion = "1.0";
+        item.info.size = 1024LL * 1024 * i;
+        item.info.version = "1.0.0." + std::to_string(i);
+        cache.layers.push_back(std::move(item));
+    }
+    return cache;
+}
+
+} // namespace
+
+TEST(JSONReader, SameAsDOM)
+{
+    using api::types::v1::PackageInfoV2;
+    using api::types::v1::RepositoryCache;
+
+    auto text = nlohmann::json(repositoryCache(3)).dump();
+    auto cache = readJSON<RepositoryCache>(text);
+    EXPECT_EQ(nlohmann::json(cache), nlohmann::json::parse(text));
+    expectSame<RepositoryCache>(text);
+
+    const std::string info = R"({"arch":["x86_64"],"id":"app","kind":"app","module":"binary",)"
+                             R"("name":"app","schema_version":"1.0","size":1,"version":"1")";
+    expectSame<PackageInfoV2>(info + "}");
+    // unknown keys are skipped, the last one of the duplicated keys wins
+    expectSame<PackageInfoV2>(info + R"(,"unknown":{"id":[1,{"a":null}]},"id":"other"})");
+    expectSame<PackageInfoV2>(info + R"(,"description":"a","description":null})");
+    // the numbers are converted like from_json
+    expectSame<PackageInfoV2>(info + R"(,"size":1.5})");
+    expectSame<PackageInfoV2>(info + R"(,"size":18446744073709551615})");
+    expectSame<PackageInfoV2>(info + R"(,"size":true})");
+    // wrong types, missing keys and broken documents are rejected
+    expectSame<PackageInfoV2>(info + R"(,"size":"1"})");
+    expectSame<PackageInfoV2>(info + R"(,"arch":{"a":"b"}})");
+    expectSame<PackageInfoV2>(info + R"(,"command":[1]})");
+    expectSame<PackageInfoV2>(R"({"id":"app"})");
+    expectSame<PackageInfoV2>(info);
+    expectSame<PackageInfoV2>("[" + info + "}]");
+    expectSame<std::vector<PackageInfoV2>>("[" + info + "}]");
+    expectSame<std::optional<PackageInfoV2>>("null");
+
+    EXPECT_THROW(readJSON<PackageInfoV2>(R"({"id":"app"})"), std::exception);
+    EXPECT_THROW(readJSON<PackageInfoV2>(info), std::exception);
+}
+
+TEST(JSONReader, Fuzz)
+{
+    using namespace api::types::v1;
+    fuzz<RepositoryCache>(1, 2000);
+    fuzz<PackageInfoV2>(2, 2000);
+    fuzz<PackageManager1SearchResult>(3, 2000);
+    fuzz<ApplicationConfiguration>(4, 2000);
+    fuzz<BuilderProject>(5, 2000);
+    fuzz<UabMetaInfo>(6, 2000);
+    fuzz<LinglongAPIV1>(7, 500);
+    fuzz<std::vector<PackageInfoV2>>(8, 1000);
+    fuzz<ocppi::runtime::config::types::Config>(9, 2000);
+}
+
+// run with --gtest_also_run_disabled_tests --gtest_filter='JSONReader.DISABLED_Benchmark'
+TEST(JSONReader, DISABLED_Benchmark)
+{
+    constexpr auto rounds = 10;
+    auto text = nlohmann::json(repositoryCache(20000)).dump();
+
+    auto measure = [](const char *name, const std::function<void()> &fn) {
+        auto begin = std::chrono::steady_clock::now();
+        for (auto i = 0; i < rounds; ++i) {
+            fn();
+        }
+        std::chrono::duration<double, std::milli> elapsed =
+          std::chrono::steady_clock::now() - begin;
+        std::cout << name << ": " << elapsed.count() / rounds << " ms" << std::endl;
+        RecordProperty(name, std::to_string(elapsed.count() / rounds));
+    };
+
+    measure("DOM", [&text] {
+        nlohmann::json::parse(text).get<api::types::v1::RepositoryCache>();
+    });
+    measure("streaming", [&text] {
+        readJSON<api::types::v1::RepositoryCache>(text);
+    });
+}
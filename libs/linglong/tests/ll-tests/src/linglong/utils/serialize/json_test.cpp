@@ -0,0 +1,154 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <gtest/gtest.h>
+
+#include "linglong/utils/serialize/json.h"
+
+#include <QJsonObject>
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <string>
+
+using namespace linglong;
+
+namespace {
+
+api::types::v1::PackageManager1SearchResult searchResult(int count)
+{
+    api::types::v1::PackageManager1SearchResult result;
+    result.code = 0;
+    result.message = "search finished";
+    result.type = "search";
+    result.packages = std::vector<api::types::v1::PackageInfoV2>{};
+    for (auto i = 0; i < count; ++i) {
+        api::types::v1::PackageInfoV2 info;
+        info.arch = { "x86_64" };
+        info.base = "main:org.deepin.base/23.1.0/x86_64";
+        info.channel = "main";
+        info.command = std::vector<std::string>{ "/opt/apps/org.deepin.demo/files/bin/demo" };
+        info.description = "应用 " + std::to_string(i);
+        info.id = "org.deepin.demo" + std::to_string(i);
+        info.kind = "app";
+        info.packageInfoV2Module = "binary";
+        info.name = "demo";
+        info.runtime = "main:org.deepin.runtime.dtk/23.1.0/x86_64";
+        info.schemaVersion = "1.0";
+        info.size = 1024LL * 1024 * 1024 * i;
+        info.version = "1.0.0." + std::to_string(i);
+        result.packages->push_back(std::move(info));
+    }
+    return result;
+}
+
+// the conversions through JSON text, which were used before
+QVariantMap toQVariantMapByText(const nlohmann::json &json)
+{
+    return QJsonDocument::fromJson(QByteArray::fromStdString(json.dump())).object().toVariantMap();
+}
+
+nlohmann::json toJSONByText(const QVariantMap &map)
+{
+    return nlohmann::json::parse(
+      QJsonDocument(QJsonObject::fromVariantMap(map)).toJson().toStdString());
+}
+
+} // namespace
+
+TEST(JSON, ToQVariantMap)
+{
+    auto result = searchResult(3);
+    EXPECT_EQ(utils::serialize::toQVariantMap(result), toQVariantMapByText(result));
+
+    nlohmann::json values = {
+        { "negative", -1 },
+        { "large", std::numeric_limits<uint64_t>::max() },
+        { "float", 1.5 },
+        { "bool", true },
+        { "nested", { { "array", { 1, "a", false } }, { "empty", nlohmann::json::object() } } },
+    };
+    EXPECT_EQ(utils::serialize::toQVariantMap(values), toQVariantMapByText(values));
+}
+
+TEST(JSON, FromQVariantMap)
+{
+    auto result = searchResult(3);
+    auto decoded = utils::serialize::fromQVariantMap<api::types::v1::PackageManager1SearchResult>(
+      utils::serialize::toQVariantMap(result));
+    ASSERT_TRUE(decoded.has_value()) << decoded.error().message().toStdString();
+    EXPECT_EQ(nlohmann::json(*decoded), nlohmann::json(result));
+
+    // the maps built by the other clients
+    QVariantMap map{
+        { "int", -1 },
+        { "uint", 2U },
+        { "longlong", Q_INT64_C(1) << 40 },
+        { "integral", 3.0 },
+        { "double", 2.5 },
+        { "bool", true },
+        { "string", QString("字符串") },
+        { "list", QStringList{ "a", "b" } },
+        { "variants", QVariantList{ 1, "a", QVariantMap{ { "key", "value" } } } },
+        { "hash", QVariantHash{ { "key", 1 } } },
+    };
+    EXPECT_EQ(utils::serialize::toJSON(map), toJSONByText(map));
+    EXPECT_EQ(utils::serialize::toJSON(QVariant(map)), toJSONByText(map));
+    EXPECT_TRUE(utils::serialize::toJSON(map)["integral"].is_number_integer());
+}
+
+// It prints the time of the conversions through JSON text, which were used before, and of the
+// direct ones, both produce the same results on the same search result.
+// run with --gtest_also_run_disabled_tests --gtest_filter='JSON.DISABLED_Benchmark'
+TEST(JSON, DISABLED_Benchmark)
+{
+    constexpr auto rounds = 10;
+    auto result = searchResult(5000);
+    auto map = utils::serialize::toQVariantMap(result);
+    ASSERT_EQ(map, toQVariantMapByText(result));
+    ASSERT_EQ(utils::serialize::toJSON(map), toJSONByText(map));
+
+    auto measure = [](const std::string &name, const std::function<void()> &fn) -> double {
+        auto begin = std::chrono::steady_clock::now();
+        for (auto i = 0; i < rounds; ++i) {
+            fn();
+        }
+        std::chrono::duration<double, std::milli> elapsed =
+          std::chrono::steady_clock::now() - begin;
+        auto average = elapsed.count() / rounds;
+        std::cout << name << ": " << average << " ms" << std::endl;
+        RecordProperty(name, std::to_string(average));
+        return average;
+    };
+    auto compare = [&measure](const char *name,
+                              const std::function<void()> &before,
+                              const std::function<void()> &after) {
+        auto text = measure(std::string(name) + " by text", before);
+        auto direct = measure(name, after);
+        std::cout << name << " speedup: " << text / direct << "x" << std::endl;
+    };
+
+    compare(
+      "toQVariantMap",
+      [&result] {
+          toQVariantMapByText(result);
+      },
+      [&result] {
+          utils::serialize::toQVariantMap(result);
+      });
+    compare(
+      "fromQVariantMap",
+      [&map] {
+          auto doc = QJsonDocument(QJsonObject::fromVariantMap(map)).toJson();
+          ASSERT_TRUE(utils::serialize::LoadJSON<api::types::v1::PackageManager1SearchResult>(
+            doc.constData()));
+      },
+      [&map] {
+          ASSERT_TRUE(
+            utils::serialize::fromQVariantMap<api::types::v1::PackageManager1SearchResult>(map));
+      });
+}
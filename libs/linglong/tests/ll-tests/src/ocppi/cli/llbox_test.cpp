@@ -0,0 +1,340 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <gtest/gtest.h>
+
+#include "linglong/box/seccomp.h"
+#include "linglong/box/state.h"
+#include "nlohmann/json.hpp"
+#include "ocppi/cli/crun/Crun.hpp"
+#include "ocppi/cli/llbox/LLBox.hpp"
+#include "ocppi/runtime/ExecOption.hpp"
+#include "ocppi/runtime/KillOption.hpp"
+#include "ocppi/runtime/ListOption.hpp"
+#include "ocppi/runtime/Signal.hpp"
+#include "ocppi/runtime/StateOption.hpp"
+#include "ocppi/runtime/state/types/State.hpp"
+#include "ocppi/runtime/state/types/Status.hpp"
+#include "ocppi/types/ContainerListItem.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <sstream>
+
+#include <linux/filter.h>
+#include <linux/seccomp.h>
+#include <sched.h>
+#include <signal.h>
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstddef>
+
+namespace {
+
+// FakeContainer records a process in the state files like ll-box does, the process unshares the
+// user, mount and pid namespaces and its child is the init process of the container.
+class FakeContainer
+{
+public:
+    FakeContainer(const std::filesystem::path &root, const std::string &id)
+        : root(root)
+        , id(id)
+    {
+        int fds[2];
+        if (::pipe(fds) == -1) {
+            return;
+        }
+
+        this->boxPid = ::fork();
+        if (this->boxPid == 0) {
+            ::close(fds[0]);
+            pid_t initPid{ -1 };
+            if (::unshare(CLONE_NEWUSER | CLONE_NEWNS | CLONE_NEWPID) == 0) {
+                initPid = ::fork();
+                if (initPid == 0) {
+                    ::prctl(PR_SET_PDEATHSIG, SIGKILL);
+                    ::pause();
+                    ::_exit(0);
+                }
+            }
+            if (::write(fds[1], &initPid, sizeof(initPid)) != sizeof(initPid) || initPid == -1) {
+                ::_exit(1);
+            }
+            ::close(fds[1]);
+            ::pause();
+            ::_exit(0);
+        }
+
+        ::close(fds[1]);
+        if (::read(fds[0], &this->initPid, sizeof(this->initPid)) != sizeof(this->initPid)) {
+            this->initPid = -1;
+        }
+        ::close(fds[0]);
+        if (this->boxPid == -1 || this->initPid == -1) {
+            return;
+        }
+
+        this->state = {
+            { "bundle", (root / "bundle").string() },
+            { "created", "" },
+            { "id", id },
+            { "owner", "" },
+            { "pid", this->boxPid },
+            { "status", "running" },
+            { "initPid", this->initPid },
+        };
+        this->save();
+    }
+
+    void recordSeccomp(const std::filesystem::path &program)
+    {
+        linglong::box::setSeccompRecord(this->state, { .program = program, .flags = 0 });
+        this->save();
+    }
+
+    ~FakeContainer()
+    {
+        if (this->boxPid > 0 && ::kill(this->boxPid, SIGKILL) == 0) {
+            ::waitpid(this->boxPid, nullptr, 0);
+        }
+    }
+
+    FakeContainer(const FakeContainer &) = delete;
+    FakeContainer &operator=(const FakeContainer &) = delete;
+
+    [[nodiscard]] bool valid() const { return this->boxPid > 0 && this->initPid > 0; }
+
+    std::filesystem::path root;
+    std::string id;
+    pid_t boxPid{ -1 };
+    pid_t initPid{ -1 };
+
+private:
+    void save() { std::ofstream(linglong::box::stateFile(this->root, this->id)) << state.dump(4); }
+
+    nlohmann::json state;
+};
+
+struct Backend
+{
+    std::string name;
+    std::unique_ptr<ocppi::cli::CLI> cli;
+};
+
+std::optional<std::filesystem::path> findLLBox()
+{
+    if (const auto *env = ::getenv("LINGLONG_TEST_LL_BOX"); env != nullptr) {
+        return std::filesystem::path(env);
+    }
+
+    const auto *path = ::getenv("PATH");
+    std::istringstream stream(path != nullptr ? path : "");
+    std::string dir;
+    while (std::getline(stream, dir, ':')) {
+        auto bin = std::filesystem::path(dir) / "ll-box";
+        if (::access(bin.c_str(), X_OK) == 0) {
+            return bin;
+        }
+    }
+
+    return std::nullopt;
+}
+
+class LLBoxTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        char dir[] = "/tmp/ll-box-test-XXXXXX";
+        ASSERT_NE(::mkdtemp(dir), nullptr);
+        this->root = dir;
+    }
+
+    void TearDown() override
+    {
+        std::error_code ec;
+        std::filesystem::remove_all(this->root, ec);
+    }
+
+    // the in-process backend runs /bin/false if it falls back to the binary, the commands
+    // which should be handled in process fail then
+    std::vector<Backend> backends()
+    {
+        std::vector<Backend> result;
+        auto inProcess = ocppi::cli::llbox::LLBox::New("/bin/false");
+        EXPECT_TRUE(inProcess.has_value());
+        if (inProcess) {
+            result.push_back({ "in-process", std::move(*inProcess) });
+        }
+
+        if (auto llBox = findLLBox(); llBox) {
+            auto binary = ocppi::cli::crun::Crun::New(*llBox);
+            EXPECT_TRUE(binary.has_value());
+            if (binary) {
+                result.push_back({ "binary", std::move(*binary) });
+            }
+        }
+
+        return result;
+    }
+
+    template<typename Option>
+    Option option()
+    {
+        Option option{};
+        option.root = this->root;
+        return option;
+    }
+
+    std::filesystem::path root;
+};
+
+} // namespace
+
+TEST_F(LLBoxTest, List)
+{
+    for (auto &backend : this->backends()) {
+        SCOPED_TRACE(backend.name);
+        FakeContainer container(this->root, "list-" + backend.name);
+        if (!container.valid()) {
+            GTEST_SKIP() << "unprivileged namespaces are unavailable";
+        }
+
+        auto list = backend.cli->list(this->option<ocppi::runtime::ListOption>());
+        ASSERT_TRUE(list.has_value());
+        ASSERT_EQ(list->size(), 1U);
+        EXPECT_EQ(list->at(0).id, container.id);
+        EXPECT_EQ(list->at(0).pid, container.boxPid);
+        EXPECT_EQ(list->at(0).bundle, (this->root / "bundle").string());
+        EXPECT_EQ(list->at(0).status, "running");
+    }
+
+    // the state files of the exited containers are removed
+    auto stale = this->root / "stale.json";
+    std::ofstream(stale) << R"({"bundle":"","created":"","id":"stale","owner":"","pid":2147483647,
+                               "status":"running"})";
+    auto cli = ocppi::cli::llbox::LLBox::New("/bin/false");
+    ASSERT_TRUE(cli.has_value());
+    auto list = (*cli)->list(this->option<ocppi::runtime::ListOption>());
+    ASSERT_TRUE(list.has_value());
+    EXPECT_TRUE(list->empty());
+    EXPECT_FALSE(std::filesystem::exists(stale));
+}
+
+TEST_F(LLBoxTest, Exec)
+{
+    for (auto &backend : this->backends()) {
+        SCOPED_TRACE(backend.name);
+        FakeContainer container(this->root, "exec-" + backend.name);
+        if (!container.valid()) {
+            GTEST_SKIP() << "unprivileged namespaces are unavailable";
+        }
+
+        // the command runs in the pid namespace of the init process
+        auto ns = std::filesystem::read_symlink("/proc/" + std::to_string(container.initPid)
+                                                + "/ns/pid");
+        auto script = "test \"$(readlink /proc/self/ns/pid)\" = \"" + ns.string() + "\"";
+        auto opt = this->option<ocppi::runtime::ExecOption>();
+        opt.uid = ::getuid();
+        opt.gid = ::getgid();
+        EXPECT_TRUE(backend.cli->exec(container.id, "/bin/sh", { "-c", script }, opt).has_value());
+
+        opt.cwd = "/proc";
+        EXPECT_TRUE(
+          backend.cli->exec(container.id, "/bin/sh", { "-c", "test \"$PWD\" = /proc" }, opt)
+            .has_value());
+
+        EXPECT_FALSE(backend.cli->exec(container.id, "/bin/sh", { "-c", "exit 3" }, opt));
+        EXPECT_FALSE(backend.cli->exec("unknown", "/bin/true", {}, opt));
+    }
+}
+
+TEST_F(LLBoxTest, ExecWithSeccomp)
+{
+    auto cli = ocppi::cli::llbox::LLBox::New("/bin/false");
+    ASSERT_TRUE(cli.has_value());
+    FakeContainer container(this->root, "seccomp");
+    if (!container.valid()) {
+        GTEST_SKIP() << "unprivileged namespaces are unavailable";
+    }
+
+    // uname(2) fails with EPERM, the other syscalls are allowed
+    const std::vector<sock_filter> program{
+        BPF_STMT(BPF_LD | BPF_W | BPF_ABS, offsetof(seccomp_data, nr)),
+        BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, __NR_uname, 0, 1),
+        BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_ERRNO | EPERM),
+        BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
+    };
+    auto file = linglong::box::seccompExecFile(this->root, container.id);
+    ASSERT_TRUE(linglong::box::writeProgram(file, program));
+    container.recordSeccomp(file);
+
+    auto opt = this->option<ocppi::runtime::ExecOption>();
+    EXPECT_TRUE((*cli)->exec(container.id, "/bin/true", {}, opt).has_value());
+    EXPECT_FALSE((*cli)->exec(container.id, "/bin/uname", {}, opt));
+
+    // the commands aren't started without the recorded filter
+    std::ofstream(file, std::ios::trunc) << "bad";
+    EXPECT_FALSE((*cli)->exec(container.id, "/bin/true", {}, opt));
+}
+
+TEST_F(LLBoxTest, Kill)
+{
+    for (auto &backend : this->backends()) {
+        SCOPED_TRACE(backend.name);
+        FakeContainer container(this->root, "kill-" + backend.name);
+        if (!container.valid()) {
+            GTEST_SKIP() << "unprivileged namespaces are unavailable";
+        }
+
+        auto opt = this->option<ocppi::runtime::KillOption>();
+        EXPECT_FALSE(backend.cli->kill("unknown", ocppi::runtime::Signal("SIGTERM"), opt));
+        ASSERT_TRUE(
+          backend.cli->kill(container.id, ocppi::runtime::Signal("SIGTERM"), opt).has_value());
+
+        int wstatus{ 0 };
+        ASSERT_EQ(::waitpid(container.boxPid, &wstatus, 0), container.boxPid);
+        EXPECT_TRUE(WIFSIGNALED(wstatus));
+        EXPECT_EQ(WTERMSIG(wstatus), SIGTERM);
+        container.boxPid = -1;
+
+        auto list = backend.cli->list(this->option<ocppi::runtime::ListOption>());
+        ASSERT_TRUE(list.has_value());
+        EXPECT_TRUE(list->empty());
+    }
+}
+
+TEST_F(LLBoxTest, InProcessOnly)
+{
+    auto cli = ocppi::cli::llbox::LLBox::New("/bin/false");
+    ASSERT_TRUE(cli.has_value());
+    FakeContainer container(this->root, "state");
+    if (!container.valid()) {
+        GTEST_SKIP() << "unprivileged namespaces are unavailable";
+    }
+
+    // ll-box has no state command
+    auto state = (*cli)->state(container.id, this->option<ocppi::runtime::StateOption>());
+    ASSERT_TRUE(state.has_value());
+    EXPECT_EQ(state->id, container.id);
+    EXPECT_EQ(state->pid, container.initPid);
+    EXPECT_EQ(state->bundle, (this->root / "bundle").string());
+    EXPECT_EQ(state->status, ocppi::runtime::state::types::Status::Running);
+    EXPECT_FALSE((*cli)->state("unknown", this->option<ocppi::runtime::StateOption>()));
+
+    auto opt = this->option<ocppi::runtime::KillOption>();
+    EXPECT_FALSE((*cli)->kill(container.id, ocppi::runtime::Signal("SIGNOPE"), opt));
+    EXPECT_TRUE((*cli)->kill(container.id, ocppi::runtime::Signal("0"), opt).has_value());
+
+    // the options unknown to the in-process backend are passed to the binary
+    auto execOpt = this->option<ocppi::runtime::ExecOption>();
+    execOpt.env["KEY"] = "value";
+    EXPECT_FALSE((*cli)->exec(container.id, "/bin/true", {}, execOpt));
+}
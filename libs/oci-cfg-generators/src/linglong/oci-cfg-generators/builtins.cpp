@@ -0,0 +1,46 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "linglong/oci-cfg-generators/builtins.h"
+
+#include "linglong/oci-cfg-generators/devices.h"
+#include "linglong/oci-cfg-generators/host_env.h"
+#include "linglong/oci-cfg-generators/host_ipc.h"
+#include "linglong/oci-cfg-generators/id_mapping.h"
+#include "linglong/oci-cfg-generators/initialize.h"
+#include "linglong/oci-cfg-generators/legacy.h"
+#include "linglong/oci-cfg-generators/user_home.h"
+
+namespace linglong::generator {
+
+namespace {
+
+template<typename T>
+void add(std::map<std::string_view, std::unique_ptr<Generator>> &generators)
+{
+    auto generator = std::make_unique<T>();
+    auto name = generator->name();
+    generators.emplace(name, std::move(generator));
+}
+
+} // namespace
+
+const std::map<std::string_view, std::unique_ptr<Generator>> &builtinGenerators() noexcept
+{
+    static const auto generators = [] {
+        std::map<std::string_view, std::unique_ptr<Generator>> generators;
+        add<IDMapping>(generators);
+        add<Initialize>(generators);
+        add<Devices>(generators);
+        add<HostEnv>(generators);
+        add<UserHome>(generators);
+        add<HostIPC>(generators);
+        add<Legacy>(generators);
+        return generators;
+    }();
+
+    return generators;
+}
+
+} // namespace linglong::generator
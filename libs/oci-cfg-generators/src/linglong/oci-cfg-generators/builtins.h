@@ -0,0 +1,18 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include "linglong/oci-cfg-generators/generator.h"
+
+#include <map>
+#include <memory>
+#include <string_view>
+
+namespace linglong::generator {
+
+// builtinGenerators returns the generators shipped with linglong, indexed by their names.
+const std::map<std::string_view, std::unique_ptr<Generator>> &builtinGenerators() noexcept;
+
+} // namespace linglong::generator
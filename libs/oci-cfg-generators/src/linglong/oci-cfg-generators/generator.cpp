@@ -0,0 +1,105 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "linglong/oci-cfg-generators/generator.h"
+
+#include "linglong/tracing/tracing.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
+#include <sys/stat.h>
+
+namespace linglong::generator {
+
+bool Generator::apply(nlohmann::json &config, std::ostream &log) const noexcept
+{
+    try {
+        if (config.at("ociVersion") != "1.0.1") {
+            log << "OCI version mismatched." << std::endl;
+            return false;
+        }
+
+        auto modified = config;
+        if (!this->generate(modified, log)) {
+            return false;
+        }
+
+        config = std::move(modified);
+        return true;
+    } catch (std::exception &exp) {
+        log << exp.what() << std::endl;
+    } catch (...) {
+        log << "unknown error occurred during generating." << std::endl;
+    }
+
+    return false;
+}
+
+std::optional<std::string> Generator::hostState(const nlohmann::json &config) const noexcept
+{
+    try {
+        std::ostringstream state;
+        this->writeHostState(config, state);
+        return state.str();
+    } catch (...) {
+        return std::nullopt;
+    }
+}
+
+void Generator::writeEnv(std::ostream &state, const char *name)
+{
+    auto *value = ::getenv(name);
+    if (value == nullptr) {
+        state << name << " unset\n";
+        return;
+    }
+
+    state << name << "=" << value << "\n";
+}
+
+void Generator::writePath(std::ostream &state, const std::filesystem::path &path)
+{
+    struct stat st{};
+    if (::lstat(path.c_str(), &st) == -1) {
+        state << path.string() << " " << errno << "\n";
+        return;
+    }
+
+    state << path.string() << " " << std::oct << st.st_mode << std::dec << " " << st.st_uid;
+    if (S_ISREG(st.st_mode)) {
+        state << " " << st.st_size << " " << st.st_mtim.tv_sec << "." << st.st_mtim.tv_nsec;
+    } else if (S_ISLNK(st.st_mode)) {
+        std::error_code ec;
+        state << " -> " << std::filesystem::read_symlink(path, ec).string();
+    }
+    state << "\n";
+}
+
+int runStandalone(const Generator &generator) noexcept
+{
+    tracing::Span span("generate");
+
+    nlohmann::json content;
+    try {
+        content = nlohmann::json::parse(std::cin);
+    } catch (std::exception &exp) {
+        std::cerr << exp.what() << std::endl;
+        return -1;
+    } catch (...) {
+        std::cerr << "unknown error occurred during parsing json." << std::endl;
+        return -1;
+    }
+
+    if (!generator.apply(content, std::cerr)) {
+        return -1;
+    }
+
+    std::cout << content.dump() << std::endl;
+    return 0;
+}
+
+} // namespace linglong::generator
@@ -0,0 +1,55 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include <nlohmann/json.hpp>
+
+#include <filesystem>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+namespace linglong::generator {
+
+// Generator modifies the OCI configuration of linglong containers. The builtin generators are
+// applied in the process of ll-cli on the configuration it's constructing, and are also installed
+// as executables for other runtimes, see misc/lib/linglong/container/README.md.
+class Generator
+{
+public:
+    Generator() = default;
+    Generator(const Generator &) = delete;
+    Generator(Generator &&) = delete;
+    Generator &operator=(const Generator &) = delete;
+    Generator &operator=(Generator &&) = delete;
+    virtual ~Generator() = default;
+
+    // name is the file name of the generator in config.d
+    [[nodiscard]] virtual std::string_view name() const noexcept = 0;
+
+    // apply leaves config untouched if the generator failed, errors and warnings are written to log
+    bool apply(nlohmann::json &config, std::ostream &log) const noexcept;
+
+    // hostState describes the state of the host which the generated configuration depends on, e.g.
+    // the environment variables and the files checked by the generator. The generator generates the
+    // same configuration from the same input while the host state is unchanged.
+    [[nodiscard]] std::optional<std::string> hostState(const nlohmann::json &config) const noexcept;
+
+protected:
+    virtual bool generate(nlohmann::json &config, std::ostream &log) const = 0;
+    virtual void writeHostState(const nlohmann::json &config, std::ostream &state) const = 0;
+
+    static void writeEnv(std::ostream &state, const char *name);
+    // writePath writes the type, owner and permissions of the file, and the size and modification
+    // time of regular files or the target of symlinks, without following symlinks
+    static void writePath(std::ostream &state, const std::filesystem::path &path);
+};
+
+// runStandalone reads the configuration from stdin and prints the modified one to stdout, it's the
+// main function of the generator executables.
+int runStandalone(const Generator &generator) noexcept;
+
+} // namespace linglong::generator
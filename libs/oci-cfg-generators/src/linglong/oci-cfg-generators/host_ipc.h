@@ -0,0 +1,22 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include "linglong/oci-cfg-generators/generator.h"
+
+namespace linglong::generator {
+
+// HostIPC exposes X11, wayland, D-Bus and other IPC sockets of the host
+class HostIPC : public Generator
+{
+public:
+    [[nodiscard]] std::string_view name() const noexcept override { return "40-host-ipc"; }
+
+protected:
+    bool generate(nlohmann::json &config, std::ostream &log) const override;
+    void writeHostState(const nlohmann::json &config, std::ostream &state) const override;
+};
+
+} // namespace linglong::generator
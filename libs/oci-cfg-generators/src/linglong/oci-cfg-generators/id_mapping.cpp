@@ -0,0 +1,34 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "linglong/oci-cfg-generators/id_mapping.h"
+
+#include <unistd.h>
+
+namespace linglong::generator {
+
+bool IDMapping::generate(nlohmann::json &config, [[maybe_unused]] std::ostream &log) const
+{
+    config["linux"]["uidMappings"] = nlohmann::json::array({ nlohmann::json::object({
+      { "containerID", ::getuid() },
+      { "hostID", ::getuid() },
+      { "size", 1 },
+    }) });
+
+    config["linux"]["gidMappings"] = nlohmann::json::array({ nlohmann::json::object({
+      { "containerID", ::getgid() },
+      { "hostID", ::getgid() },
+      { "size", 1 },
+    }) });
+
+    return true;
+}
+
+void IDMapping::writeHostState([[maybe_unused]] const nlohmann::json &config,
+                               std::ostream &state) const
+{
+    state << "uid=" << ::getuid() << "\ngid=" << ::getgid() << "\n";
+}
+
+} // namespace linglong::generator
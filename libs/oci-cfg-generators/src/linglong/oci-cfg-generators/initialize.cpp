@@ -0,0 +1,53 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "linglong/oci-cfg-generators/initialize.h"
+
+#include <filesystem>
+
+namespace linglong::generator {
+
+bool Initialize::generate(nlohmann::json &config, [[maybe_unused]] std::ostream &log) const
+{
+    const auto &annotations = config.at("annotations");
+    std::string appID = annotations.at("org.deepin.linglong.appID");
+
+    auto &mounts = config["mounts"];
+
+    if (annotations.find("org.deepin.linglong.runtimeDir") != annotations.end()) {
+        mounts.push_back({ { "destination", "/runtime" },
+                           { "options", nlohmann::json::array({ "rbind", "ro" }) },
+                           { "source",
+                             std::filesystem::path(
+                               annotations["org.deepin.linglong.runtimeDir"].get<std::string>())
+                               / "files" },
+                           { "type", "bind" } });
+    }
+
+    if (annotations.find("org.deepin.linglong.appDir") != annotations.end()) {
+        mounts.push_back({
+          { "destination", "/opt" },
+          { "options", nlohmann::json::array({ "nodev", "nosuid", "mode=700" }) },
+          { "source", "tmpfs" },
+          { "type", "tmpfs" },
+        });
+
+        mounts.push_back(
+          { { "destination", std::filesystem::path("/opt/apps") / appID / "files" },
+            { "options", nlohmann::json::array({ "rbind", "rw" }) },
+            { "source",
+              std::filesystem::path(annotations["org.deepin.linglong.appDir"].get<std::string>())
+                / "files" },
+            { "type", "bind" } });
+    }
+
+    return true;
+}
+
+void Initialize::writeHostState([[maybe_unused]] const nlohmann::json &config,
+                                [[maybe_unused]] std::ostream &state) const
+{
+}
+
+} // namespace linglong::generator
@@ -0,0 +1,22 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include "linglong/oci-cfg-generators/generator.h"
+
+namespace linglong::generator {
+
+// Initialize mounts the runtime and the application layers
+class Initialize : public Generator
+{
+public:
+    [[nodiscard]] std::string_view name() const noexcept override { return "05-initialize"; }
+
+protected:
+    bool generate(nlohmann::json &config, std::ostream &log) const override;
+    void writeHostState(const nlohmann::json &config, std::ostream &state) const override;
+};
+
+} // namespace linglong::generator
@@ -0,0 +1,113 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "linglong/oci-cfg-generators/legacy.h"
+
+#include <filesystem>
+#include <map>
+
+namespace linglong::generator {
+
+namespace {
+
+// FIXME: time zone in the container does not change when the host time zone changes，need to be
+// repaired later.
+const std::multimap<std::string, std::string> roMountMap{
+    { "/etc/resolvconf", "/run/host/etc/resolvconf" },
+    { "/etc/machine-id", "/run/host/etc/machine-id" },
+    { "/etc/machine-id", "/etc/machine-id" },
+    { "/etc/ssl/certs", "/run/host/etc/ssl/certs" },
+    { "/etc/ssl/certs", "/etc/ssl/certs" },
+    { "/var/cache/fontconfig", "/run/host/appearance/fonts-cache" },
+    // FIXME: app can not display normally due to missing cjk font cache file,so we need bind
+    // /var/cache/fontconfig to container. this is just a temporary solution,need to be repaired
+    // later.
+    { "/var/cache/fontconfig", "/var/cache/fontconfig" },
+    { "/usr/share/fonts", "/usr/share/fonts" },
+    { "/usr/lib/locale/", "/usr/lib/locale/" },
+    { "/usr/share/themes", "/usr/share/themes" },
+    { "/usr/share/icons", "/usr/share/icons" },
+    { "/usr/share/zoneinfo", "/usr/share/zoneinfo" },
+    { "/etc/resolvconf", "/etc/resolvconf" },
+};
+
+} // namespace
+
+bool Legacy::generate(nlohmann::json &config, std::ostream &log) const
+{
+    auto &mounts = config["mounts"];
+
+    for (const auto &[source, destination] : roMountMap) {
+        if (!std::filesystem::exists(source)) {
+            log << source << " not exists on host." << std::endl;
+            continue;
+        }
+
+        mounts.push_back({
+          { "type", "bind" },
+          { "options", nlohmann::json::array({ "ro", "rbind" }) },
+          { "destination", destination },
+          { "source", source },
+        });
+    };
+
+    // FIXME: com.360.browser-stable
+    // 需要一个所有用户都有可读可写权限的目录(/apps-data/private/com.360.browser-stable)
+    std::string appID = config.at("annotations").at("org.deepin.linglong.appID");
+    if ("com.360.browser-stable" != appID) {
+        return true;
+    }
+
+    auto *home = ::getenv("HOME");
+    if (home == nullptr) {
+        log << "Couldn't get HOME." << std::endl;
+        return false;
+    }
+
+    auto homeDir = std::filesystem::path(home);
+    if (!std::filesystem::exists(homeDir)) {
+        log << "Home " << homeDir << "doesn't exists." << std::endl;
+        return false;
+    }
+
+    std::error_code ec;
+    std::string app360DataSourcePath = homeDir / ".linglong" / appID / "share" / "appdata";
+
+    auto appDataDir = std::filesystem::path(app360DataSourcePath);
+    std::filesystem::create_directories(appDataDir, ec);
+    if (ec) {
+        log << "Check appDataDir failed:" << ec.message() << std::endl;
+        return false;
+    }
+
+    std::string app360DataPath = "/apps-data";
+    std::string app360DataDesPath = app360DataPath + "/private/com.360.browser-stable";
+
+    mounts.push_back({
+      { "destination", app360DataPath },
+      { "options", nlohmann::json::array({ "nodev", "nosuid", "mode=777" }) },
+      { "source", "tmpfs" },
+      { "type", "tmpfs" },
+    });
+
+    mounts.push_back({
+      { "destination", app360DataDesPath },
+      { "options", nlohmann::json::array({ "rw", "rbind" }) },
+      { "source", app360DataSourcePath },
+      { "type", "bind" },
+    });
+
+    return true;
+}
+
+void Legacy::writeHostState([[maybe_unused]] const nlohmann::json &config,
+                            std::ostream &state) const
+{
+    writeEnv(state, "HOME");
+    for (const auto &[source, destination] : roMountMap) {
+        writePath(state, source);
+    }
+}
+
+} // namespace linglong::generator
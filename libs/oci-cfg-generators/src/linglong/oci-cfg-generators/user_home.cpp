@@ -0,0 +1,473 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "linglong/oci-cfg-generators/user_home.h"
+
+#include "linglong/api/types/v1/ApplicationAccessPrivileges.hpp"
+#include "linglong/api/types/v1/Generators.hpp"
+
+#include <linux/limits.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include <unistd.h>
+
+namespace linglong::generator {
+
+bool UserHome::generate(nlohmann::json &config, std::ostream &log) const // NOLINT
+{
+    std::string appID = config.at("annotations").at("org.deepin.linglong.appID");
+
+    auto &mounts = config["mounts"];
+    auto &env = config["process"]["env"];
+
+    auto *homeEnv = ::getenv("HOME");
+    auto *userNameEnv = ::getenv("USER");
+    if (homeEnv == nullptr || userNameEnv == nullptr) {
+        log << "Couldn't get HOME or USER from env." << std::endl;
+        return false;
+    }
+
+    auto hostHomeDir = std::filesystem::path(homeEnv);
+    auto cognitiveHomeDir = std::filesystem::path{ "/home" } / userNameEnv;
+    if (!std::filesystem::exists(hostHomeDir)) {
+        log << "Home " << hostHomeDir << "doesn't exists." << std::endl;
+        return false;
+    }
+
+    mounts.push_back({
+      { "destination", "/home" },
+      { "options", nlohmann::json::array({ "nodev", "nosuid", "mode=700" }) },
+      { "source", "tmpfs" },
+      { "type", "tmpfs" },
+    });
+
+    auto envExist = [&env](const std::string &key) {
+        auto prefix = key + "=";
+        auto it = std::find_if(env.cbegin(), env.cend(), [&prefix](const std::string &item) {
+            return (item.rfind(prefix, 0) == 0);
+        });
+        return it != env.cend();
+    };
+
+    auto mountDir = [&mounts, &log](const std::string &hostDir, const std::string &containerDir) {
+        std::error_code ec;
+        if (!std::filesystem::exists(hostDir, ec)) {
+            if (ec) {
+                log << "failed to get state of directories " << hostDir << ":" << ec.message()
+                    << std::endl;
+                return false;
+            }
+
+            if (!std::filesystem::create_directories(hostDir, ec) && ec) {
+                log << "failed to create directories " << hostDir << ":" << ec.message()
+                    << std::endl;
+                return false;
+            }
+        }
+
+        mounts.push_back({
+          { "destination", containerDir },
+          { "options", nlohmann::json::array({ "rbind" }) },
+          { "source", hostDir },
+          { "type", "bind" },
+        });
+
+        return true;
+    };
+
+    if (!mountDir(hostHomeDir, cognitiveHomeDir)) {
+        return false;
+    }
+    if (envExist("HOME")) {
+        log << "HOME already exist." << std::endl;
+        return false;
+    }
+    env.emplace_back("HOME=" + cognitiveHomeDir.string());
+
+    // process XDG_* environment variables.
+    std::error_code ec;
+    auto privateAppDir = hostHomeDir / ".linglong" / appID;
+
+    if (!std::filesystem::create_directories(privateAppDir, ec) && ec) {
+        log << "failed to create " << privateAppDir << ": " << ec.message() << std::endl;
+        return false;
+    }
+
+    // XDG_DATA_HOME
+    auto *ptr = ::getenv("XDG_DATA_HOME");
+    std::filesystem::path XDGDataHome = ptr == nullptr ? "" : std::string{ ptr };
+    if (XDGDataHome.empty()) {
+        XDGDataHome = hostHomeDir / ".local" / "share";
+    }
+
+    std::filesystem::path cognitiveDataHome = cognitiveHomeDir / ".local" / "share";
+    if (!mountDir(XDGDataHome, cognitiveDataHome)) {
+        return false;
+    }
+
+    if (envExist("XDG_DATA_HOME")) {
+        log << "XDG_DATA_HOME already exist." << std::endl;
+        return false;
+    }
+    env.emplace_back("XDG_DATA_HOME=" + cognitiveDataHome.string());
+
+    // XDG_CONFIG_HOME
+    ptr = ::getenv("XDG_CONFIG_HOME");
+    std::filesystem::path XDGConfigHome = ptr == nullptr ? "" : std::string{ ptr };
+    if (XDGConfigHome.empty()) {
+        XDGConfigHome = hostHomeDir / ".config";
+    }
+    if (auto privateConfigDir = privateAppDir / "config";
+        std::filesystem::exists(privateConfigDir, ec)) {
+        XDGConfigHome = privateConfigDir;
+    }
+    ec.clear();
+
+    auto cognitiveConfigHome = cognitiveHomeDir / ".config";
+    if (!mountDir(XDGConfigHome, cognitiveConfigHome)) {
+        return false;
+    }
+
+    if (envExist("XDG_CONFIG_HOME")) {
+        log << "XDG_CONFIG_HOME already exist." << std::endl;
+        return false;
+    }
+    env.emplace_back("XDG_CONFIG_HOME=" + cognitiveConfigHome.string());
+
+    // XDG_CACHE_HOME
+    ptr = ::getenv("XDG_CACHE_HOME");
+    std::filesystem::path XDGCacheHome = ptr == nullptr ? "" : std::string{ ptr };
+    if (XDGCacheHome.empty()) {
+        XDGCacheHome = hostHomeDir / ".cache";
+    }
+    if (auto privateCacheDir = privateAppDir / "cache";
+        std::filesystem::exists(privateCacheDir, ec)) {
+        XDGCacheHome = privateCacheDir;
+    }
+    ec.clear();
+
+    auto cognitiveCacheHome = cognitiveHomeDir / ".cache";
+    if (!mountDir(XDGCacheHome, cognitiveCacheHome)) {
+        return false;
+    }
+
+    if (envExist("XDG_CACHE_HOME")) {
+        log << "XDG_CACHE_HOME already exist." << std::endl;
+        return false;
+    }
+    env.emplace_back("XDG_CACHE_HOME=" + cognitiveCacheHome.string());
+
+    // XDG_STATE_HOME
+    ptr = ::getenv("XDG_STATE_HOME");
+    std::filesystem::path XDGStateHome = ptr == nullptr ? "" : std::string{ ptr };
+    if (XDGStateHome.empty()) {
+        XDGStateHome = hostHomeDir / ".local" / "state";
+    }
+    if (auto privateStateDir = privateAppDir / "config";
+        std::filesystem::exists(privateStateDir, ec)) {
+        XDGStateHome = privateStateDir;
+    }
+    ec.clear();
+
+    auto cognitiveStateHome = cognitiveHomeDir / ".local" / "state";
+    if (!mountDir(XDGStateHome, cognitiveStateHome)) {
+        return false;
+    }
+
+    if (envExist("XDG_STATE_HOME")) {
+        log << "XDG_STATE_HOME already exist." << std::endl;
+        return false;
+    }
+    env.emplace_back("XDG_STATE_HOME=" + cognitiveStateHome.string());
+
+    // systemd user path
+    auto hostSystemdUserDir = XDGConfigHome / "systemd" / "user";
+    if (std::filesystem::exists(hostSystemdUserDir, ec)) {
+        auto cognitiveSystemdUserDir = cognitiveConfigHome / "systemd" / "user";
+        if (!mountDir(hostSystemdUserDir, cognitiveSystemdUserDir)) {
+            return false;
+        }
+    }
+
+    // FIXME: Many applications get configurations from dconf, so we expose dconf to all
+    // applications for now. If there is a better solution to fix this issue, please change the
+    // following codes
+    auto hostUserDconfPath = XDGConfigHome / "dconf";
+    if (std::filesystem::exists(hostUserDconfPath, ec)) {
+        auto cognitiveAppDconfPath = cognitiveConfigHome / "dconf";
+        if (!mountDir(hostUserDconfPath, cognitiveAppDconfPath)) {
+            return false;
+        }
+    }
+
+    // for dde application theme
+    auto hostDDEApiPath = XDGCacheHome / "deepin" / "dde-api";
+    if (std::filesystem::exists(hostDDEApiPath, ec)) {
+        auto cognitiveDDEApiPath = cognitiveCacheHome / "deepin" / "dde-api";
+        if (!mountDir(hostDDEApiPath, cognitiveDDEApiPath)) {
+            return false;
+        }
+    }
+
+    // for xdg-user-dirs
+    auto XDGUserDirs = XDGConfigHome / "user-dirs.dirs";
+    if (std::filesystem::exists(XDGUserDirs, ec)) {
+        mounts.push_back({
+          { "destination", cognitiveConfigHome / "user-dirs.dirs" },
+          { "options", nlohmann::json::array({ "rbind" }) },
+          { "source", XDGUserDirs },
+          { "type", "bind" },
+        });
+    }
+
+    auto XDGUserLocale = XDGConfigHome / "user-dirs.locale";
+    if (std::filesystem::exists(XDGUserLocale, ec)) {
+        mounts.push_back({
+          { "destination", cognitiveConfigHome / "user-dirs.locale" },
+          { "options", nlohmann::json::array({ "rbind" }) },
+          { "source", XDGUserLocale },
+          { "type", "bind" },
+        });
+    }
+
+    // NOTE:
+    // Running ~/.bashrc from user home is meaningless in linglong container,
+    // and might cause some issues, so we mask it with the default one.
+    // https://github.com/linuxdeepin/linglong/issues/459
+    constexpr auto defaultBashrc = "/etc/skel/.bashrc";
+    if (std::filesystem::exists(defaultBashrc)) {
+        mounts.push_back({
+          { "destination", hostHomeDir / ".bashrc" },
+          { "options", nlohmann::json::array({ "ro", "rbind" }) },
+          { "source", defaultBashrc },
+          { "type", "bind" },
+        });
+    } else {
+        log << "failed to mask bashrc" << std::endl;
+    }
+
+    // hide self data
+    auto linglongDataDir = hostHomeDir / ".linglong";
+    if (!mountDir(linglongDataDir / "data", cognitiveHomeDir / ".linglong")) {
+        return false;
+    }
+
+    auto privileges = api::types::v1::ApplicationAccessPrivileges{};
+    auto permissionsFile = privateAppDir / "permissions.json";
+    if (std::filesystem::exists(permissionsFile, ec)) {
+        auto input = std::ifstream(permissionsFile);
+        if (!input.is_open()) {
+            log << "couldn't open config file " << permissionsFile.c_str() << std::endl;
+            return false;
+        }
+
+        try {
+            auto content = nlohmann::json::parse(input);
+            privileges = content.get<api::types::v1::ApplicationAccessPrivileges>();
+        } catch (nlohmann::json::parse_error &e) {
+            log << "deserialize error:" << e.what() << std::endl;
+            return false;
+        } catch (std::exception &e) {
+            log << "unknown exception:" << e.what() << std::endl;
+            return false;
+        }
+    }
+    if (ec) {
+        log << "failed to get status of " << permissionsFile.c_str() << ": " << ec.message()
+            << std::endl;
+        return false;
+    }
+    auto directories = privileges.userDirectories.value_or(api::types::v1::UserDirectories{});
+
+    // FIXME: we should resolve real home through env GNUPGHOME
+    // FIXME: we should resolve user dirs through ${XDG_CONFIG_HOME}/user-dirs.dirs
+
+    // process blocklist
+    static const std::unordered_set<std::string_view> blackList = { ".gnupg", ".ssh" };
+    auto disallowedDirs = directories.disallowed.value_or(std::vector<std::string>{});
+    disallowedDirs.insert(disallowedDirs.end(), blackList.begin(), blackList.end());
+    std::sort(disallowedDirs.begin(), disallowedDirs.end());
+    auto dupIt = std::unique(disallowedDirs.begin(), disallowedDirs.end());
+    disallowedDirs.erase(dupIt, disallowedDirs.end());
+
+    for (const std::filesystem::path relative : disallowedDirs) {
+        if (relative.empty() || relative.is_absolute()) {
+            log << "invalid path:" << relative << std::endl;
+            return false;
+        }
+
+        if (auto hostLocation = hostHomeDir / relative;
+            !std::filesystem::exists(hostLocation, ec)) {
+            if (ec) {
+                log << "failed to get state of " << hostLocation << ": " << ec.message()
+                    << std::endl;
+                return false;
+            }
+
+            continue;
+        }
+
+        // we don't need to concern about source is symlink
+        if (!mountDir(privateAppDir / relative, cognitiveHomeDir / relative)) {
+            return false;
+        }
+    }
+
+    // process whitelist
+    auto allowedDirs = directories.allowed.value_or(std::vector<std::string>{});
+    std::sort(allowedDirs.begin(), allowedDirs.end());
+    dupIt = std::unique(allowedDirs.begin(), allowedDirs.end());
+    allowedDirs.erase(dupIt, allowedDirs.end());
+    for (std::filesystem::path relative : allowedDirs) {
+        if (relative.empty() || relative.is_absolute()) {
+            log << "invalid path:" << relative << std::endl;
+            return false;
+        }
+
+        if (blackList.find(relative.string()) != blackList.end()) {
+            continue;
+        }
+
+        auto hostLocation = hostHomeDir / relative;
+        std::filesystem::file_status status = std::filesystem::symlink_status(hostLocation, ec);
+        if (ec) {
+            if (ec == std::errc::no_such_file_or_directory) {
+                continue;
+            }
+
+            log << "failed to get file type of" << hostLocation << ": " << ec.message()
+                << std::endl;
+            return false;
+        }
+
+        if (status.type() != std::filesystem::file_type::symlink) {
+            if (!mountDir(hostLocation, cognitiveHomeDir / relative)) {
+                return false;
+            }
+
+            continue;
+        }
+
+        std::array<char, PATH_MAX + 1> buf{};
+        auto *resolved = ::realpath(hostLocation.c_str(), buf.data());
+        if (resolved == nullptr) {
+            log << "failed to resolve symlink " << hostLocation << ": " << ::strerror(errno)
+                << std::endl;
+            return false;
+        }
+
+        auto realHostLocation = std::filesystem::path(resolved);
+        if (!std::filesystem::exists(realHostLocation, ec)) {
+            if (ec) {
+                log << "failed to get state of " << realHostLocation << ": " << ec.message()
+                    << std::endl;
+                return false;
+            }
+
+            continue;
+        }
+
+        if (auto realHostLocationStr = realHostLocation.string();
+            realHostLocationStr.rfind(hostHomeDir, 0) != 0) {
+            log << "real host directory doesn't in user's home:" << realHostLocation << std::endl;
+            return false;
+        }
+
+        mounts.push_back({
+          { "destination", hostLocation.string() },
+          { "options", nlohmann::json::array({ "rbind", "copy-symlink" }) },
+          { "source", hostLocation.string() },
+          { "type", "bind" },
+        });
+    }
+
+    return true;
+}
+
+void UserHome::writeHostState(const nlohmann::json &config, std::ostream &state) const
+{
+    std::string appID = config.at("annotations").at("org.deepin.linglong.appID");
+    for (const auto *name : { "HOME",
+                              "USER",
+                              "XDG_DATA_HOME",
+                              "XDG_CONFIG_HOME",
+                              "XDG_CACHE_HOME",
+                              "XDG_STATE_HOME" }) {
+        writeEnv(state, name);
+    }
+
+    auto *homeEnv = ::getenv("HOME");
+    if (homeEnv == nullptr) {
+        return;
+    }
+
+    auto hostHomeDir = std::filesystem::path(homeEnv);
+    auto privateAppDir = hostHomeDir / ".linglong" / appID;
+    auto xdgDir = [](const char *name, const std::filesystem::path &defaultDir) {
+        auto *ptr = ::getenv(name);
+        return ptr == nullptr || ptr[0] == '\0' ? defaultDir : std::filesystem::path{ ptr };
+    };
+
+    // the private directories of the application take precedence over the XDG base directories
+    auto dataHome = xdgDir("XDG_DATA_HOME", hostHomeDir / ".local" / "share");
+    auto stateHome = xdgDir("XDG_STATE_HOME", hostHomeDir / ".local" / "state");
+    for (const auto &path : { hostHomeDir,
+                              dataHome,
+                              stateHome,
+                              hostHomeDir / ".linglong" / "data",
+                              privateAppDir / "config",
+                              privateAppDir / "cache",
+                              privateAppDir / "permissions.json",
+                              std::filesystem::path{ "/etc/skel/.bashrc" } }) {
+        writePath(state, path);
+    }
+
+    for (const auto &configHome :
+         { xdgDir("XDG_CONFIG_HOME", hostHomeDir / ".config"), privateAppDir / "config" }) {
+        writePath(state, configHome);
+        writePath(state, configHome / "systemd" / "user");
+        writePath(state, configHome / "dconf");
+        writePath(state, configHome / "user-dirs.dirs");
+        writePath(state, configHome / "user-dirs.locale");
+    }
+
+    for (const auto &cacheHome :
+         { xdgDir("XDG_CACHE_HOME", hostHomeDir / ".cache"), privateAppDir / "cache" }) {
+        writePath(state, cacheHome);
+        writePath(state, cacheHome / "deepin" / "dde-api");
+    }
+
+    std::vector<std::string> directories{ ".gnupg", ".ssh" };
+    if (std::ifstream input{ privateAppDir / "permissions.json" }; input.is_open()) {
+        auto privileges =
+          nlohmann::json::parse(input).get<api::types::v1::ApplicationAccessPrivileges>();
+        auto userDirectories =
+          privileges.userDirectories.value_or(api::types::v1::UserDirectories{});
+        for (const auto &dirs : { userDirectories.allowed, userDirectories.disallowed }) {
+            if (dirs) {
+                directories.insert(directories.end(), dirs->begin(), dirs->end());
+            }
+        }
+    }
+
+    for (const auto &relative : directories) {
+        writePath(state, hostHomeDir / relative);
+        writePath(state, privateAppDir / relative);
+
+        std::error_code ec;
+        if (std::filesystem::is_symlink(hostHomeDir / relative, ec)) {
+            writePath(state, std::filesystem::canonical(hostHomeDir / relative, ec));
+        }
+    }
+}
+
+} // namespace linglong::generator
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <exception>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ocppi/cli/CommonCLI.hpp"
+#include "tl/expected.hpp"
+
+namespace ocppi::cli::llbox
+{
+
+// LLBox reads the state files of ll-box and enters the namespaces of the
+// containers in process, the other commands are run by the ll-box binary.
+class LLBox final : public CommonCLI {
+        using CommonCLI::CommonCLI;
+
+    public:
+        static auto New(const std::filesystem::path &bin) noexcept
+                -> tl::expected<std::unique_ptr<LLBox>, std::exception_ptr>;
+
+#ifdef OCPPI_WITH_SPDLOG
+        static auto New(const std::filesystem::path &bin,
+                        const std::shared_ptr<spdlog::logger> &logger) noexcept
+                -> tl::expected<std::unique_ptr<LLBox>, std::exception_ptr>;
+#endif
+
+        using CommonCLI::exec;
+        using CommonCLI::kill;
+        using CommonCLI::list;
+        using CommonCLI::state;
+
+        [[nodiscard]]
+        auto state(const runtime::ContainerID &id,
+                   const runtime::StateOption &option) const noexcept
+                -> tl::expected<runtime::state::types::State,
+                                std::exception_ptr> override;
+
+        [[nodiscard]]
+        auto kill(const runtime::ContainerID &id, const runtime::Signal &signal,
+                  const runtime::KillOption &option) noexcept
+                -> tl::expected<void, std::exception_ptr> override;
+
+        [[nodiscard]]
+        auto exec(const runtime::ContainerID &id, const std::string &executable,
+                  const std::vector<std::string> &command,
+                  const runtime::ExecOption &option) noexcept
+                -> tl::expected<void, std::exception_ptr> override;
+
+        [[nodiscard]]
+        auto list(const runtime::ListOption &option) noexcept
+                -> tl::expected<std::vector<types::ContainerListItem>,
+                                std::exception_ptr> override;
+};
+}
@@ -0,0 +1,475 @@
+// This file is generated by tools/codegen.sh
+// DO NOT EDIT IT.
+
+// clang-format off
+
+// The members and their keys, see linglong/utils/serialize/json_reader.h
+
+#pragma once
+
+#include <tuple>
+#include <utility>
+
+#include "ocppi/runtime/config/types/Generators.hpp"
+
+namespace ocppi {
+namespace runtime {
+namespace config {
+namespace types {
+
+inline auto fields(const Hook *) {
+return std::make_tuple(
+std::make_pair("args", &Hook::args),
+std::make_pair("env", &Hook::env),
+std::make_pair("path", &Hook::path),
+std::make_pair("timeout", &Hook::timeout));
+}
+
+inline auto fields(const Hooks *) {
+return std::make_tuple(
+std::make_pair("createContainer", &Hooks::createContainer),
+std::make_pair("createRuntime", &Hooks::createRuntime),
+std::make_pair("poststart", &Hooks::poststart),
+std::make_pair("poststop", &Hooks::poststop),
+std::make_pair("prestart", &Hooks::prestart),
+std::make_pair("startContainer", &Hooks::startContainer));
+}
+
+inline auto fields(const LinuxDevice *) {
+return std::make_tuple(
+std::make_pair("fileMode", &LinuxDevice::fileMode),
+std::make_pair("gid", &LinuxDevice::gid),
+std::make_pair("major", &LinuxDevice::major),
+std::make_pair("minor", &LinuxDevice::minor),
+std::make_pair("path", &LinuxDevice::path),
+std::make_pair("type", &LinuxDevice::type),
+std::make_pair("uid", &LinuxDevice::uid));
+}
+
+inline auto fields(const IdMapping *) {
+return std::make_tuple(
+std::make_pair("containerID", &IdMapping::containerID),
+std::make_pair("hostID", &IdMapping::hostID),
+std::make_pair("size", &IdMapping::size));
+}
+
+inline auto fields(const IntelRdt *) {
+return std::make_tuple(
+std::make_pair("closID", &IntelRdt::closID),
+std::make_pair("enableCMT", &IntelRdt::enableCMT),
+std::make_pair("enableMBM", &IntelRdt::enableMBM),
+std::make_pair("l3CacheSchema", &IntelRdt::l3CacheSchema),
+std::make_pair("memBwSchema", &IntelRdt::memBWSchema));
+}
+
+inline auto fields(const NamespaceReference *) {
+return std::make_tuple(
+std::make_pair("path", &NamespaceReference::path),
+std::make_pair("type", &NamespaceReference::type));
+}
+
+inline auto fields(const Personality *) {
+return std::make_tuple(
+std::make_pair("domain", &Personality::domain),
+std::make_pair("flags", &Personality::flags));
+}
+
+inline auto fields(const BlockIODeviceThrottle *) {
+return std::make_tuple(
+std::make_pair("major", &BlockIODeviceThrottle::major),
+std::make_pair("minor", &BlockIODeviceThrottle::minor),
+std::make_pair("rate", &BlockIODeviceThrottle::rate));
+}
+
+inline auto fields(const BlockIODeviceWeight *) {
+return std::make_tuple(
+std::make_pair("major", &BlockIODeviceWeight::major),
+std::make_pair("minor", &BlockIODeviceWeight::minor),
+std::make_pair("leafWeight", &BlockIODeviceWeight::leafWeight),
+std::make_pair("weight", &BlockIODeviceWeight::weight));
+}
+
+inline auto fields(const BlockIO *) {
+return std::make_tuple(
+std::make_pair("leafWeight", &BlockIO::leafWeight),
+std::make_pair("throttleReadBpsDevice", &BlockIO::throttleReadBpsDevice),
+std::make_pair("throttleReadIOPSDevice", &BlockIO::throttleReadIOPSDevice),
+std::make_pair("throttleWriteBpsDevice", &BlockIO::throttleWriteBpsDevice),
+std::make_pair("throttleWriteIOPSDevice", &BlockIO::throttleWriteIOPSDevice),
+std::make_pair("weight", &BlockIO::weight),
+std::make_pair("weightDevice", &BlockIO::weightDevice));
+}
+
+inline auto fields(const PurpleCPU *) {
+return std::make_tuple(
+std::make_pair("burst", &PurpleCPU::burst),
+std::make_pair("cpus", &PurpleCPU::cpus),
+std::make_pair("idle", &PurpleCPU::idle),
+std::make_pair("mems", &PurpleCPU::mems),
+std::make_pair("period", &PurpleCPU::period),
+std::make_pair("quota", &PurpleCPU::quota),
+std::make_pair("realtimePeriod", &PurpleCPU::realtimePeriod),
+std::make_pair("realtimeRuntime", &PurpleCPU::realtimeRuntime),
+std::make_pair("shares", &PurpleCPU::shares));
+}
+
+inline auto fields(const DeviceCgroup *) {
+return std::make_tuple(
+std::make_pair("access", &DeviceCgroup::access),
+std::make_pair("allow", &DeviceCgroup::allow),
+std::make_pair("major", &DeviceCgroup::major),
+std::make_pair("minor", &DeviceCgroup::minor),
+std::make_pair("type", &DeviceCgroup::type));
+}
+
+inline auto fields(const HugepageLimit *) {
+return std::make_tuple(
+std::make_pair("limit", &HugepageLimit::limit),
+std::make_pair("pageSize", &HugepageLimit::pageSize));
+}
+
+inline auto fields(const PurpleMemory *) {
+return std::make_tuple(
+std::make_pair("checkBeforeUpdate", &PurpleMemory::checkBeforeUpdate),
+std::make_pair("disableOOMKiller", &PurpleMemory::disableOOMKiller),
+std::make_pair("kernel", &PurpleMemory::kernel),
+std::make_pair("kernelTCP", &PurpleMemory::kernelTCP),
+std::make_pair("limit", &PurpleMemory::limit),
+std::make_pair("reservation", &PurpleMemory::reservation),
+std::make_pair("swap", &PurpleMemory::swap),
+std::make_pair("swappiness", &PurpleMemory::swappiness),
+std::make_pair("useHierarchy", &PurpleMemory::useHierarchy));
+}
+
+inline auto fields(const NetworkInterfacePriority *) {
+return std::make_tuple(
+std::make_pair("name", &NetworkInterfacePriority::name),
+std::make_pair("priority", &NetworkInterfacePriority::priority));
+}
+
+inline auto fields(const ResourcesNetwork *) {
+return std::make_tuple(
+std::make_pair("classID", &ResourcesNetwork::classID),
+std::make_pair("priorities", &ResourcesNetwork::priorities));
+}
+
+inline auto fields(const Pids *) {
+return std::make_tuple(
+std::make_pair("limit", &Pids::limit));
+}
+
+inline auto fields(const Rdma *) {
+return std::make_tuple(
+std::make_pair("hcaHandles", &Rdma::hcaHandles),
+std::make_pair("hcaObjects", &Rdma::hcaObjects));
+}
+
+inline auto fields(const LinuxResources *) {
+return std::make_tuple(
+std::make_pair("blockIO", &LinuxResources::blockIO),
+std::make_pair("cpu", &LinuxResources::cpu),
+std::make_pair("devices", &LinuxResources::devices),
+std::make_pair("hugepageLimits", &LinuxResources::hugepageLimits),
+std::make_pair("memory", &LinuxResources::memory),
+std::make_pair("network", &LinuxResources::network),
+std::make_pair("pids", &LinuxResources::pids),
+std::make_pair("rdma", &LinuxResources::rdma),
+std::make_pair("unified", &LinuxResources::unified));
+}
+
+inline auto fields(const SyscallArg *) {
+return std::make_tuple(
+std::make_pair("index", &SyscallArg::index),
+std::make_pair("op", &SyscallArg::op),
+std::make_pair("value", &SyscallArg::value),
+std::make_pair("valueTwo", &SyscallArg::valueTwo));
+}
+
+inline auto fields(const Syscall *) {
+return std::make_tuple(
+std::make_pair("action", &Syscall::action),
+std::make_pair("args", &Syscall::args),
+std::make_pair("errnoRet", &Syscall::errnoRet),
+std::make_pair("names", &Syscall::names));
+}
+
+inline auto fields(const Seccomp *) {
+return std::make_tuple(
+std::make_pair("architectures", &Seccomp::architectures),
+std::make_pair("defaultAction", &Seccomp::defaultAction),
+std::make_pair("defaultErrnoRet", &Seccomp::defaultErrnoRet),
+std::make_pair("flags", &Seccomp::flags),
+std::make_pair("listenerMetadata", &Seccomp::listenerMetadata),
+std::make_pair("listenerPath", &Seccomp::listenerPath),
+std::make_pair("syscalls", &Seccomp::syscalls));
+}
+
+inline auto fields(const BoottimeClass *) {
+return std::make_tuple(
+std::make_pair("nanosecs", &BoottimeClass::nanosecs),
+std::make_pair("secs", &BoottimeClass::secs));
+}
+
+inline auto fields(const TimeOffsets *) {
+return std::make_tuple(
+std::make_pair("boottime", &TimeOffsets::boottime),
+std::make_pair("monotonic", &TimeOffsets::monotonic));
+}
+
+inline auto fields(const Linux *) {
+return std::make_tuple(
+std::make_pair("cgroupsPath", &Linux::cgroupsPath),
+std::make_pair("devices", &Linux::devices),
+std::make_pair("gidMappings", &Linux::gidMappings),
+std::make_pair("intelRdt", &Linux::intelRdt),
+std::make_pair("maskedPaths", &Linux::maskedPaths),
+std::make_pair("mountLabel", &Linux::mountLabel),
+std::make_pair("namespaces", &Linux::namespaces),
+std::make_pair("personality", &Linux::personality),
+std::make_pair("readonlyPaths", &Linux::readonlyPaths),
+std::make_pair("resources", &Linux::resources),
+std::make_pair("rootfsPropagation", &Linux::rootfsPropagation),
+std::make_pair("seccomp", &Linux::seccomp),
+std::make_pair("sysctl", &Linux::sysctl),
+std::make_pair("timeOffsets", &Linux::timeOffsets),
+std::make_pair("uidMappings", &Linux::uidMappings));
+}
+
+inline auto fields(const Mount *) {
+return std::make_tuple(
+std::make_pair("destination", &Mount::destination),
+std::make_pair("gidMappings", &Mount::gidMappings),
+std::make_pair("options", &Mount::options),
+std::make_pair("source", &Mount::source),
+std::make_pair("type", &Mount::type),
+std::make_pair("uidMappings", &Mount::uidMappings));
+}
+
+inline auto fields(const Capabilities *) {
+return std::make_tuple(
+std::make_pair("ambient", &Capabilities::ambient),
+std::make_pair("bounding", &Capabilities::bounding),
+std::make_pair("effective", &Capabilities::effective),
+std::make_pair("inheritable", &Capabilities::inheritable),
+std::make_pair("permitted", &Capabilities::permitted));
+}
+
+inline auto fields(const ConsoleSize *) {
+return std::make_tuple(
+std::make_pair("height", &ConsoleSize::height),
+std::make_pair("width", &ConsoleSize::width));
+}
+
+inline auto fields(const IoPriority *) {
+return std::make_tuple(
+std::make_pair("class", &IoPriority::ioPriorityClass),
+std::make_pair("priority", &IoPriority::priority));
+}
+
+inline auto fields(const Rlimit *) {
+return std::make_tuple(
+std::make_pair("hard", &Rlimit::hard),
+std::make_pair("soft", &Rlimit::soft),
+std::make_pair("type", &Rlimit::type));
+}
+
+inline auto fields(const Scheduler *) {
+return std::make_tuple(
+std::make_pair("deadline", &Scheduler::deadline),
+std::make_pair("flags", &Scheduler::flags),
+std::make_pair("nice", &Scheduler::nice),
+std::make_pair("period", &Scheduler::period),
+std::make_pair("policy", &Scheduler::policy),
+std::make_pair("priority", &Scheduler::priority),
+std::make_pair("runtime", &Scheduler::runtime));
+}
+
+inline auto fields(const User *) {
+return std::make_tuple(
+std::make_pair("additionalGids", &User::additionalGids),
+std::make_pair("gid", &User::gid),
+std::make_pair("uid", &User::uid),
+std::make_pair("umask", &User::umask),
+std::make_pair("username", &User::username));
+}
+
+inline auto fields(const Process *) {
+return std::make_tuple(
+std::make_pair("apparmorProfile", &Process::apparmorProfile),
+std::make_pair("args", &Process::args),
+std::make_pair("capabilities", &Process::capabilities),
+std::make_pair("commandLine", &Process::commandLine),
+std::make_pair("consoleSize", &Process::consoleSize),
+std::make_pair("cwd", &Process::cwd),
+std::make_pair("env", &Process::env),
+std::make_pair("ioPriority", &Process::ioPriority),
+std::make_pair("noNewPrivileges", &Process::noNewPrivileges),
+std::make_pair("oomScoreAdj", &Process::oomScoreAdj),
+std::make_pair("rlimits", &Process::rlimits),
+std::make_pair("scheduler", &Process::scheduler),
+std::make_pair("selinuxLabel", &Process::selinuxLabel),
+std::make_pair("terminal", &Process::terminal),
+std::make_pair("user", &Process::user));
+}
+
+inline auto fields(const Root *) {
+return std::make_tuple(
+std::make_pair("path", &Root::path),
+std::make_pair("readonly", &Root::readonly));
+}
+
+inline auto fields(const Anet *) {
+return std::make_tuple(
+std::make_pair("allowedAddress", &Anet::allowedAddress),
+std::make_pair("configureAllowedAddress", &Anet::configureAllowedAddress),
+std::make_pair("defrouter", &Anet::defrouter),
+std::make_pair("linkname", &Anet::linkname),
+std::make_pair("linkProtection", &Anet::linkProtection),
+std::make_pair("lowerLink", &Anet::lowerLink),
+std::make_pair("macAddress", &Anet::macAddress));
+}
+
+inline auto fields(const CappedCPU *) {
+return std::make_tuple(
+std::make_pair("ncpus", &CappedCPU::ncpus));
+}
+
+inline auto fields(const CappedMemory *) {
+return std::make_tuple(
+std::make_pair("physical", &CappedMemory::physical),
+std::make_pair("swap", &CappedMemory::swap));
+}
+
+inline auto fields(const Solaris *) {
+return std::make_tuple(
+std::make_pair("anet", &Solaris::anet),
+std::make_pair("cappedCPU", &Solaris::cappedCPU),
+std::make_pair("cappedMemory", &Solaris::cappedMemory),
+std::make_pair("limitpriv", &Solaris::limitpriv),
+std::make_pair("maxShmMemory", &Solaris::maxShmMemory),
+std::make_pair("milestone", &Solaris::milestone));
+}
+
+inline auto fields(const Hypervisor *) {
+return std::make_tuple(
+std::make_pair("parameters", &Hypervisor::parameters),
+std::make_pair("path", &Hypervisor::path));
+}
+
+inline auto fields(const Image *) {
+return std::make_tuple(
+std::make_pair("format", &Image::format),
+std::make_pair("path", &Image::path));
+}
+
+inline auto fields(const Kernel *) {
+return std::make_tuple(
+std::make_pair("initrd", &Kernel::initrd),
+std::make_pair("parameters", &Kernel::parameters),
+std::make_pair("path", &Kernel::path));
+}
+
+inline auto fields(const Vm *) {
+return std::make_tuple(
+std::make_pair("hypervisor", &Vm::hypervisor),
+std::make_pair("image", &Vm::image),
+std::make_pair("kernel", &Vm::kernel));
+}
+
+inline auto fields(const WindowsDevice *) {
+return std::make_tuple(
+std::make_pair("id", &WindowsDevice::id),
+std::make_pair("idType", &WindowsDevice::idType));
+}
+
+inline auto fields(const Hyperv *) {
+return std::make_tuple(
+std::make_pair("utilityVMPath", &Hyperv::utilityVMPath));
+}
+
+inline auto fields(const WindowsNetwork *) {
+return std::make_tuple(
+std::make_pair("allowUnqualifiedDNSQuery", &WindowsNetwork::allowUnqualifiedDNSQuery),
+std::make_pair("DNSSearchList", &WindowsNetwork::dnsSearchList),
+std::make_pair("endpointList", &WindowsNetwork::endpointList),
+std::make_pair("networkNamespace", &WindowsNetwork::networkNamespace),
+std::make_pair("networkSharedContainerName", &WindowsNetwork::networkSharedContainerName));
+}
+
+inline auto fields(const FluffyCPU *) {
+return std::make_tuple(
+std::make_pair("count", &FluffyCPU::count),
+std::make_pair("maximum", &FluffyCPU::maximum),
+std::make_pair("shares", &FluffyCPU::shares));
+}
+
+inline auto fields(const FluffyMemory *) {
+return std::make_tuple(
+std::make_pair("limit", &FluffyMemory::limit));
+}
+
+inline auto fields(const Storage *) {
+return std::make_tuple(
+std::make_pair("bps", &Storage::bps),
+std::make_pair("iops", &Storage::iops),
+std::make_pair("sandboxSize", &Storage::sandboxSize));
+}
+
+inline auto fields(const WindowsResources *) {
+return std::make_tuple(
+std::make_pair("cpu", &WindowsResources::cpu),
+std::make_pair("memory", &WindowsResources::memory),
+std::make_pair("storage", &WindowsResources::storage));
+}
+
+inline auto fields(const Windows *) {
+return std::make_tuple(
+std::make_pair("credentialSpec", &Windows::credentialSpec),
+std::make_pair("devices", &Windows::devices),
+std::make_pair("hyperv", &Windows::hyperv),
+std::make_pair("ignoreFlushesDuringBoot", &Windows::ignoreFlushesDuringBoot),
+std::make_pair("layerFolders", &Windows::layerFolders),
+std::make_pair("network", &Windows::network),
+std::make_pair("resources", &Windows::resources),
+std::make_pair("servicing", &Windows::servicing));
+}
+
+inline auto fields(const ZosDevice *) {
+return std::make_tuple(
+std::make_pair("fileMode", &ZosDevice::fileMode),
+std::make_pair("gid", &ZosDevice::gid),
+std::make_pair("major", &ZosDevice::major),
+std::make_pair("minor", &ZosDevice::minor),
+std::make_pair("path", &ZosDevice::path),
+std::make_pair("type", &ZosDevice::type),
+std::make_pair("uid", &ZosDevice::uid));
+}
+
+inline auto fields(const Zos *) {
+return std::make_tuple(
+std::make_pair("devices", &Zos::devices));
+}
+
+inline auto fields(const Config *) {
+return std::make_tuple(
+std::make_pair("annotations", &Config::annotations),
+std::make_pair("domainname", &Config::domainname),
+std::make_pair("hooks", &Config::hooks),
+std::make_pair("hostname", &Config::hostname),
+std::make_pair("linux", &Config::linux_),
+std::make_pair("mounts", &Config::mounts),
+std::make_pair("ociVersion", &Config::ociVersion),
+std::make_pair("process", &Config::process),
+std::make_pair("root", &Config::root),
+std::make_pair("solaris", &Config::solaris),
+std::make_pair("vm", &Config::vm),
+std::make_pair("windows", &Config::windows),
+std::make_pair("zos", &Config::zos));
+}
+
+}
+}
+}
+}
+
+// clang-format on
@@ -69,7 +69,7 @@ int runProcess(const std::string &binaryPath,
 
         int interruptTimes = 0;
         while (true) {
-            if (::wait(&ret) == -1) {
+            if (::waitpid(childId, &ret, 0) == -1) {
                 if (errno == EINTR) {
                     interruptTimes < 2 ? ++interruptTimes : kill(childId, SIGKILL);
                     continue; 
@@ -111,7 +111,7 @@ int runProcess(const std::string &binaryPath,
 
         int interruptTimes = 0;
         while (true) {
-            if (::wait(&ret) == -1) {
+            if (::waitpid(childId, &ret, 0) == -1) {
                 if (errno == EINTR) {
                     interruptTimes < 2 ? ++interruptTimes : kill(childId, SIGKILL);
                     continue; 
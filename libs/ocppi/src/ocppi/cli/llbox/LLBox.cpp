@@ -0,0 +1,357 @@
+#include "ocppi/cli/llbox/LLBox.hpp"
+
+#include <errno.h>
+#include <linux/filter.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <map>
+#include <numeric>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "linglong/box/namespaces.h"
+#include "linglong/box/seccomp.h"
+#include "linglong/box/state.h"
+#include "nlohmann/json.hpp"
+#include "ocppi/InvalidArgumentError.hpp"
+#include "ocppi/cli/CommandFailedError.hpp"
+#include "ocppi/runtime/ExecOption.hpp"
+#include "ocppi/runtime/KillOption.hpp"
+#include "ocppi/runtime/ListOption.hpp"
+#include "ocppi/runtime/Signal.hpp"
+#include "ocppi/runtime/StateOption.hpp"
+#include "ocppi/runtime/configure.hpp"
+#include "ocppi/runtime/state/types/Generators.hpp" // IWYU pragma: keep
+#include "ocppi/runtime/state/types/State.hpp"
+#include "ocppi/runtime/state/types/Status.hpp"
+#include "ocppi/types/ContainerListItem.hpp"
+#include "ocppi/types/Generators.hpp" // IWYU pragma: keep
+
+#ifdef OCPPI_WITH_SPDLOG
+#include "spdlog/spdlog.h"
+#endif
+
+namespace ocppi::cli::llbox
+{
+
+namespace
+{
+
+auto stateRoot(const runtime::GlobalOption &option) -> std::filesystem::path
+{
+        if (option.root) {
+                return *option.root;
+        }
+
+        return linglong::box::defaultStateRoot();
+}
+
+auto toSignal(const runtime::Signal &signal) -> int
+{
+        static const std::map<std::string, int> signals = {
+                { "HUP", SIGHUP },     { "INT", SIGINT },
+                { "QUIT", SIGQUIT },   { "ILL", SIGILL },
+                { "TRAP", SIGTRAP },   { "ABRT", SIGABRT },
+                { "BUS", SIGBUS },     { "FPE", SIGFPE },
+                { "KILL", SIGKILL },   { "USR1", SIGUSR1 },
+                { "SEGV", SIGSEGV },   { "USR2", SIGUSR2 },
+                { "PIPE", SIGPIPE },   { "ALRM", SIGALRM },
+                { "TERM", SIGTERM },   { "CHLD", SIGCHLD },
+                { "CONT", SIGCONT },   { "STOP", SIGSTOP },
+                { "TSTP", SIGTSTP },   { "TTIN", SIGTTIN },
+                { "TTOU", SIGTTOU },   { "WINCH", SIGWINCH },
+        };
+
+        if (signal.empty()) {
+                return SIGTERM;
+        }
+
+        if (signal.size() < 4 &&
+            std::all_of(signal.begin(), signal.end(), ::isdigit)) {
+                return std::stoi(signal);
+        }
+
+        auto name = signal.rfind("SIG", 0) == 0 ? signal.substr(3) :
+                                                  std::string(signal);
+        auto it = signals.find(name);
+        if (it == signals.end()) {
+                throw common::InvalidArgumentError("signal " + signal);
+        }
+
+        return it->second;
+}
+
+auto notFound(const runtime::ContainerID &id) -> std::system_error
+{
+        return { ESRCH, std::generic_category(), "container " + id };
+}
+
+// Seccomp is the BPF program of the container recorded by ll-box, which is
+// loaded by the processes started by exec like the init process.
+struct Seccomp {
+        std::vector<sock_filter> program;
+        unsigned int flags{ 0 };
+};
+
+auto readSeccomp(const nlohmann::json &container) -> std::optional<Seccomp>
+{
+        auto record = linglong::box::seccompRecord(container);
+        if (!record) {
+                return std::nullopt;
+        }
+
+        auto program = linglong::box::readProgram(record->program);
+        if (!program) {
+                throw std::system_error(EINVAL, std::generic_category(),
+                                        "seccomp filter " +
+                                                record->program.string());
+        }
+
+        return Seccomp{ .program = std::move(*program),
+                        .flags = record->flags };
+}
+
+// enterContainer runs the command in the namespaces of the init process of
+// the container like ll-box exec does, only async-signal-safe functions are
+// called after fork.
+auto enterContainer(pid_t initPid, const std::filesystem::path &cwd,
+                    const std::vector<const char *> &argv,
+                    const std::optional<Seccomp> &seccomp) -> int
+{
+        linglong::box::Namespaces namespaces;
+        if (!namespaces.open(initPid)) {
+                throw std::system_error(errno, std::generic_category(),
+                                        "open namespaces of " +
+                                                std::to_string(initPid));
+        }
+
+        auto pid = ::fork();
+        if (pid == -1) {
+                throw std::system_error(errno, std::generic_category(), "fork");
+        }
+
+        if (pid == 0) {
+                if (namespaces.enter() == -1 || ::chdir(cwd.c_str()) == -1) {
+                        ::_exit(255);
+                }
+
+                // the pid namespace is entered by the children only
+                auto child = ::fork();
+                if (child == -1) {
+                        ::_exit(255);
+                }
+
+                if (child == 0) {
+                        if (seccomp &&
+                            linglong::box::loadProgram(seccomp->program,
+                                                       seccomp->flags) == -1) {
+                                ::_exit(127);
+                        }
+                        ::execvp(argv[0], const_cast<char **>(argv.data()));
+                        ::_exit(127);
+                }
+
+                int wstatus{ 0 };
+                while (::waitpid(child, &wstatus, 0) == -1) {
+                        if (errno != EINTR) {
+                                ::_exit(255);
+                        }
+                }
+
+                if (WIFSIGNALED(wstatus)) {
+                        ::signal(WTERMSIG(wstatus), SIG_DFL);
+                        ::kill(::getpid(), WTERMSIG(wstatus));
+                }
+
+                ::_exit(WIFEXITED(wstatus) ? WEXITSTATUS(wstatus) : 255);
+        }
+
+        int wstatus{ 0 };
+        while (::waitpid(pid, &wstatus, 0) == -1) {
+                if (errno != EINTR) {
+                        throw std::system_error(errno, std::generic_category(),
+                                                "waitpid");
+                }
+        }
+
+        return wstatus;
+}
+
+}
+
+#ifdef OCPPI_WITH_SPDLOG
+auto LLBox::New(const std::filesystem::path &bin) noexcept
+        -> tl::expected<std::unique_ptr<LLBox>, std::exception_ptr>
+try {
+        return std::unique_ptr<LLBox>(new LLBox(bin, spdlog::default_logger()));
+} catch (...) {
+        return tl::unexpected(std::current_exception());
+}
+
+auto LLBox::New(const std::filesystem::path &bin,
+                const std::shared_ptr<spdlog::logger> &logger) noexcept
+        -> tl::expected<std::unique_ptr<LLBox>, std::exception_ptr>
+try {
+        return std::unique_ptr<LLBox>(new LLBox(bin, logger));
+} catch (...) {
+        return tl::unexpected(std::current_exception());
+}
+
+#else
+
+auto LLBox::New(const std::filesystem::path &bin) noexcept
+        -> tl::expected<std::unique_ptr<LLBox>, std::exception_ptr>
+try {
+        return std::unique_ptr<LLBox>(new LLBox(bin));
+} catch (...) {
+        return tl::unexpected(std::current_exception());
+}
+
+#endif
+
+auto LLBox::state(const runtime::ContainerID &id,
+                  const runtime::StateOption &option) const noexcept
+        -> tl::expected<runtime::state::types::State, std::exception_ptr>
+try {
+        if (!option.extra.empty() || !option.GlobalOption::extra.empty()) {
+                return CommonCLI::state(id, option);
+        }
+
+        auto container = linglong::box::findState(stateRoot(option), id);
+        if (!container) {
+                throw notFound(id);
+        }
+
+        runtime::state::types::State state;
+        state.bundle = container->value("bundle", "");
+        state.id = id;
+        state.ociVersion = runtime::oci_runtime_spec_min;
+        state.pid = container->value("initPid", container->value("pid", -1));
+        state.status = runtime::state::types::Status::Running;
+        return state;
+} catch (...) {
+        return tl::unexpected(std::current_exception());
+}
+
+auto LLBox::kill(const runtime::ContainerID &id, const runtime::Signal &signal,
+                 const runtime::KillOption &option) noexcept
+        -> tl::expected<void, std::exception_ptr>
+try {
+        if (!option.extra.empty() || !option.GlobalOption::extra.empty()) {
+                return CommonCLI::kill(id, signal, option);
+        }
+
+        auto sig = toSignal(signal);
+        auto container = linglong::box::findState(stateRoot(option), id);
+        if (!container) {
+                throw notFound(id);
+        }
+
+        // the signal is sent to the ll-box process like ll-box kill does
+        if (::kill(container->value("pid", -1), sig) == -1) {
+                throw std::system_error(errno, std::generic_category(), "kill");
+        }
+
+        return {};
+} catch (...) {
+        return tl::unexpected(std::current_exception());
+}
+
+auto LLBox::exec(const runtime::ContainerID &id, const std::string &executable,
+                 const std::vector<std::string> &command,
+                 const runtime::ExecOption &option) noexcept
+        -> tl::expected<void, std::exception_ptr>
+try {
+        // ll-box ignores the user like nsenter --preserve-credentials, the
+        // other options are left to it
+        if (option.tty || !option.env.empty() || !option.extra.empty() ||
+            !option.GlobalOption::extra.empty()) {
+                return CommonCLI::exec(id, executable, command, option);
+        }
+
+        // the init process isn't recorded by the old ll-box, or before the
+        // container is ready
+        auto container = linglong::box::findState(stateRoot(option), id);
+        auto initPid = container ? container->value("initPid", -1) : -1;
+        if (initPid == -1 || ::kill(initPid, 0) != 0) {
+                return CommonCLI::exec(id, executable, command, option);
+        }
+
+#ifdef OCPPI_WITH_SPDLOG
+        SPDLOG_LOGGER_DEBUG(this->logger(),
+                            R"(Executing "{}" in container "{}" in process)",
+                            executable, id);
+#endif
+
+        std::vector<const char *> argv{ executable.c_str() };
+        for (const auto &arg : command) {
+                argv.push_back(arg.c_str());
+        }
+        argv.push_back(nullptr);
+
+        // the filter is read before the mount namespace is entered
+        auto wstatus = enterContainer(
+                initPid, option.cwd.value_or(std::filesystem::path("/")), argv,
+                readSeccomp(*container));
+        if (wstatus != 0) {
+                auto args = this->generateGlobalOptions(option);
+                args.emplace_back("exec");
+                auto options = this->generateSubcommandOptions(option);
+                args.insert(args.end(), options.begin(), options.end());
+                args.push_back(id);
+                args.push_back(executable);
+                args.insert(args.end(), command.begin(), command.end());
+                throw CommandFailedError(
+                        wstatus,
+                        std::accumulate(args.begin(), args.end(),
+                                        this->bin().string(),
+                                        [](const std::string &a,
+                                           const std::string &b)
+                                                -> std::string {
+                                                return a + " " + b;
+                                        }));
+        }
+
+        return {};
+} catch (...) {
+        return tl::unexpected(std::current_exception());
+}
+
+auto LLBox::list(const runtime::ListOption &option) noexcept
+        -> tl::expected<std::vector<types::ContainerListItem>,
+                        std::exception_ptr>
+try {
+        if (!option.extra.empty() || !option.GlobalOption::extra.empty()) {
+                return CommonCLI::list(option);
+        }
+
+        std::vector<types::ContainerListItem> containers;
+        std::error_code ec;
+        for (const auto &entry :
+             std::filesystem::directory_iterator(stateRoot(option), ec)) {
+                // the directories of the zygotes and the seccomp filters
+                if (!entry.is_regular_file(ec)) {
+                        continue;
+                }
+
+                auto container = linglong::box::readState(entry.path());
+                if (!container) {
+                        continue;
+                }
+                containers.push_back(
+                        container->get<types::ContainerListItem>());
+        }
+
+        return containers;
+} catch (...) {
+        return tl::unexpected(std::current_exception());
+}
+
+}
@@ -0,0 +1,225 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+// refer: https://docs.google.com/document/d/1CvAClvFfyA5R-PhYUmn5OOQtYMH4h6I0nSsKchNAySU
+
+#include "linglong/tracing/tracing.h"
+
+#include <array>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <mutex>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace linglong::tracing {
+
+namespace {
+
+struct Tracer
+{
+    std::mutex mutex;
+    bool initialized{ false };
+    int fd{ -1 };
+    // the pid which is shown in the trace, 0 if the process hasn't been named
+    long pid{ 0 };
+};
+
+Tracer &tracer() noexcept
+{
+    static Tracer instance;
+    return instance;
+}
+
+double now() noexcept
+{
+    timespec ts{};
+    ::clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<double>(ts.tv_sec) * 1e6 + static_cast<double>(ts.tv_nsec) / 1e3;
+}
+
+// tracedPid returns the pid in the outermost pid namespace visible from /proc, so the processes in
+// the pid namespaces created by ll-box won't all be shown as pid 1
+long tracedPid() noexcept
+{
+    std::ifstream status{ "/proc/self/status" };
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.rfind("NSpid:", 0) != 0) {
+            continue;
+        }
+
+        auto pid = std::strtol(line.c_str() + std::strlen("NSpid:"), nullptr, 10);
+        if (pid > 0) {
+            return pid;
+        }
+        break;
+    }
+
+    return ::getpid();
+}
+
+long tracedTid(const Tracer &t) noexcept
+{
+    auto tid = static_cast<long>(::syscall(SYS_gettid));
+    return tid == ::getpid() ? t.pid : tid;
+}
+
+std::string escape(std::string_view str) noexcept
+{
+    std::string result;
+    result.reserve(str.size());
+    for (auto c : str) {
+        switch (c) {
+        case '"':
+            result.append("\\\"");
+            break;
+        case '\\':
+            result.append("\\\\");
+            break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                std::array<char, 8> buf{};
+                std::snprintf(buf.data(), buf.size(), "\\u%04x", static_cast<unsigned int>(c));
+                result.append(buf.data());
+            } else {
+                result.push_back(c);
+            }
+            break;
+        }
+    }
+    return result;
+}
+
+void initialize(Tracer &t) noexcept
+{
+    if (t.initialized) {
+        return;
+    }
+    t.initialized = true;
+
+    auto *path = ::getenv(fileEnv);
+    if (path == nullptr || path[0] == '\0') {
+        return;
+    }
+
+    // the file is kept opened, so the events can be recorded after pivot_root
+    t.fd = ::open(path, O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+    if (t.fd == -1) {
+        std::fprintf(stderr, "couldn't open trace file %s: %s\n", path, std::strerror(errno));
+        return;
+    }
+
+    // the first process starts the array, the closing bracket is optional for trace viewers
+    ::flock(t.fd, LOCK_EX);
+    struct stat st{};
+    if (::fstat(t.fd, &st) == 0 && st.st_size == 0) {
+        [[maybe_unused]] auto ret = ::write(t.fd, "[\n", 2);
+    }
+    ::flock(t.fd, LOCK_UN);
+}
+
+// every event is written by a single write(2) with O_APPEND, so the events of processes won't be
+// interleaved
+void append(const Tracer &t, const std::string &event) noexcept
+{
+    auto line = event + ",\n";
+    [[maybe_unused]] auto ret = ::write(t.fd, line.data(), line.size());
+}
+
+void nameProcess(Tracer &t, std::string_view name) noexcept
+{
+    t.pid = tracedPid();
+    append(t,
+           "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" + std::to_string(t.pid)
+             + ",\"tid\":" + std::to_string(t.pid) + ",\"args\":{\"name\":\"" + escape(name)
+             + "\"}}");
+}
+
+void record(std::string_view eventName, const char *phase, double ts, double dur) noexcept
+{
+    auto &t = tracer();
+    std::lock_guard<std::mutex> lock(t.mutex);
+    initialize(t);
+    if (t.fd == -1) {
+        return;
+    }
+
+    if (t.pid == 0) {
+        nameProcess(t, program_invocation_short_name);
+    }
+
+    std::array<char, 64> times{};
+    if (dur < 0) {
+        std::snprintf(times.data(), times.size(), "\"ts\":%.3f,\"s\":\"p\"", ts);
+    } else {
+        std::snprintf(times.data(), times.size(), "\"ts\":%.3f,\"dur\":%.3f", ts, dur);
+    }
+
+    append(t,
+           "{\"name\":\"" + escape(eventName) + "\",\"cat\":\"linglong\",\"ph\":\"" + phase + "\","
+             + times.data() + ",\"pid\":" + std::to_string(t.pid)
+             + ",\"tid\":" + std::to_string(tracedTid(t)) + "}");
+}
+
+} // namespace
+
+bool enabled() noexcept
+{
+    auto &t = tracer();
+    std::lock_guard<std::mutex> lock(t.mutex);
+    initialize(t);
+    return t.fd != -1;
+}
+
+void setProcessName(std::string_view processName) noexcept
+{
+    auto &t = tracer();
+    std::lock_guard<std::mutex> lock(t.mutex);
+    initialize(t);
+    if (t.fd == -1) {
+        return;
+    }
+
+    nameProcess(t, processName);
+}
+
+void instant(std::string_view name) noexcept
+{
+    record(name, "i", now(), -1);
+}
+
+Span::Span(std::string name) noexcept
+    : name(std::move(name))
+    , ended(!enabled())
+{
+    if (!this->ended) {
+        this->begin = now();
+    }
+}
+
+Span::~Span()
+{
+    this->end();
+}
+
+void Span::end() noexcept
+{
+    if (this->ended) {
+        return;
+    }
+    this->ended = true;
+
+    record(this->name, "X", this->begin, now() - this->begin);
+}
+
+} // namespace linglong::tracing
@@ -0,0 +1,47 @@
+// SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include <string>
+#include <string_view>
+
+// Opt-in tracing of the launch phases, enabled by setting LINGLONG_TRACING_FILE to the path of a
+// trace file. ll-cli, the OCI configuration generators and ll-box inherit the variable and append
+// their events to the same file in the JSON array format of Chrome trace event, which can be
+// loaded by chrome://tracing or https://ui.perfetto.dev directly.
+namespace linglong::tracing {
+
+constexpr auto fileEnv = "LINGLONG_TRACING_FILE";
+
+[[nodiscard]] bool enabled() noexcept;
+
+// setProcessName names the current process in the trace. A process is named after its executable
+// by default, the processes cloned without exec, like the ones in ll-box, must call it before
+// recording anything.
+void setProcessName(std::string_view name) noexcept;
+
+// instant records an event without duration, e.g. exec which never returns
+void instant(std::string_view name) noexcept;
+
+// Span records a complete event from its construction to end() or its destruction.
+class Span
+{
+public:
+    explicit Span(std::string name) noexcept;
+    Span(const Span &) = delete;
+    Span(Span &&) = delete;
+    Span &operator=(const Span &) = delete;
+    Span &operator=(Span &&) = delete;
+    ~Span();
+
+    void end() noexcept;
+
+private:
+    std::string name;
+    double begin{ 0 };
+    bool ended{ false };
+};
+
+} // namespace linglong::tracing
@@ -6,6 +6,8 @@
 
 #include "env.h"
 
+#include "linglong/utils/command/process.h"
+
 #include <QProcessEnvironment>
 
 namespace linglong::utils::command {
@@ -64,20 +66,26 @@ linglong::utils::error::Result<QString> Exec(QString command, QStringList args)
 {
     LINGLONG_TRACE(QString("exec %1 %2").arg(command).arg(args.join(" ")));
     qDebug() << "exec" << command << args;
-    QProcess process;
-    process.setProgram(command);
-    process.setArguments(args);
-    process.start();
+    auto process = Process::start(command, args);
+    if (!process) {
+        return LINGLONG_ERR(process);
+    }
+
+    auto result = (*process)->wait();
+    if (!result) {
+        return LINGLONG_ERR(result);
+    }
 
-    if (!process.waitForFinished(-1)) {
-        return LINGLONG_ERR(process.errorString(), process.error());
+    if (result->signal != 0) {
+        return LINGLONG_ERR(
+          QString("killed by signal %1: %2").arg(result->signal).arg(result->standardError));
     }
 
-    if (process.exitCode() != 0) {
-        return LINGLONG_ERR(process.readAllStandardError(), process.exitCode());
+    if (result->exitCode != 0) {
+        return LINGLONG_ERR(result->standardError, result->exitCode);
     }
 
-    return process.readAllStandardOutput();
+    return result->standardOutput;
 }
 
 } // namespace linglong::utils::command
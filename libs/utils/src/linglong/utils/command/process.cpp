@@ -0,0 +1,394 @@
+/*
+ * SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#include "linglong/utils/command/process.h"
+
+#include "linglong/utils/finally/finally.h"
+
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <string>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <spawn.h>
+#include <unistd.h>
+
+extern char **environ; // NOLINT
+
+namespace linglong::utils::command {
+
+namespace {
+
+// the processes without a pidfd (linux < 5.3) and the tokens without an eventfd are checked
+// periodically
+constexpr auto pollInterval = std::chrono::milliseconds(50);
+constexpr auto readBufferSize = 64 * 1024;
+
+int openPidFd(pid_t pid) noexcept
+{
+#ifdef SYS_pidfd_open
+    return static_cast<int>(::syscall(SYS_pidfd_open, pid, 0));
+#else
+    return -1;
+#endif
+}
+
+void closeFd(int &fd) noexcept
+{
+    if (fd != -1) {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+void forwardOutput(int &fd,
+                   const std::function<void(std::string_view)> &callback,
+                   QByteArray &output)
+{
+    std::array<char, readBufferSize> buffer{};
+    while (fd != -1) {
+        auto size = ::read(fd, buffer.data(), buffer.size());
+        if (size == -1 && errno == EINTR) {
+            continue;
+        }
+
+        if (size == -1 && errno == EAGAIN) {
+            return;
+        }
+
+        if (size <= 0) {
+            closeFd(fd);
+            return;
+        }
+
+        if (callback) {
+            callback(std::string_view(buffer.data(), size));
+        } else {
+            output.append(buffer.data(), static_cast<int>(size));
+        }
+
+        // let the other processes run, the rest is read in the next round
+        if (size < static_cast<ssize_t>(buffer.size())) {
+            return;
+        }
+    }
+}
+
+} // namespace
+
+struct CancellationToken::State
+{
+    State() noexcept
+        : fd(::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK))
+    {
+    }
+
+    State(const State &) = delete;
+    State &operator=(const State &) = delete;
+
+    ~State() { closeFd(this->fd); }
+
+    std::atomic_bool cancelled{ false };
+    int fd;
+};
+
+CancellationToken::CancellationToken()
+    : state(std::make_shared<State>())
+{
+}
+
+void CancellationToken::cancel() const noexcept
+{
+    if (this->state->cancelled.exchange(true)) {
+        return;
+    }
+
+    // the counter is never read, the fd stays readable for all the waiting threads
+    if (this->state->fd != -1) {
+        uint64_t value = 1;
+        [[maybe_unused]] auto ret = ::write(this->state->fd, &value, sizeof(value));
+    }
+}
+
+bool CancellationToken::isCancelled() const noexcept
+{
+    return this->state->cancelled.load();
+}
+
+int CancellationToken::fd() const noexcept
+{
+    return this->state->fd;
+}
+
+Process::Process(ProcessOptions options) noexcept
+    : options(std::move(options))
+{
+}
+
+Process::~Process()
+{
+    if (this->processID != -1 && !this->exited) {
+        this->terminate();
+        int status{ 0 };
+        while (::waitpid(this->processID, &status, 0) == -1 && errno == EINTR) { }
+    }
+
+    closeFd(this->pidFd);
+    closeFd(this->standardOutputPipe);
+    closeFd(this->standardErrorPipe);
+}
+
+error::Result<std::unique_ptr<Process>>
+Process::start(const QString &program, const QStringList &args, ProcessOptions options) noexcept
+{
+    LINGLONG_TRACE(QString{ "start %1" }.arg(program));
+
+    std::unique_ptr<Process> process(new Process(std::move(options)));
+
+    posix_spawn_file_actions_t actions;
+    if (auto ret = ::posix_spawn_file_actions_init(&actions); ret != 0) {
+        return LINGLONG_ERR(QString{ "posix_spawn_file_actions_init: %1" }.arg(::strerror(ret)),
+                            ret);
+    }
+    auto destroyActions = finally::finally([&actions] {
+        ::posix_spawn_file_actions_destroy(&actions);
+    });
+
+    ::posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+
+    // the write ends are closed on exec, the read ends never block the loop in waitAll
+    std::array<int, 2> writeEnds{ -1, -1 };
+    auto closeWriteEnds = finally::finally([&writeEnds] {
+        closeFd(writeEnds[0]);
+        closeFd(writeEnds[1]);
+    });
+    std::array<std::pair<int, int *>, 2> channels{
+        std::pair{ process->options.standardOutputFd, &process->standardOutputPipe },
+        std::pair{ process->options.standardErrorFd, &process->standardErrorPipe },
+    };
+    for (std::size_t i = 0; i < channels.size(); ++i) {
+        auto target = static_cast<int>(STDOUT_FILENO + i);
+        auto [fd, readEnd] = channels.at(i);
+        if (fd != -1) {
+            ::posix_spawn_file_actions_adddup2(&actions, fd, target);
+            continue;
+        }
+
+        std::array<int, 2> fds{ -1, -1 };
+        if (::pipe2(fds.data(), O_CLOEXEC) == -1) {
+            return LINGLONG_ERR(QString{ "pipe2: %1" }.arg(::strerror(errno)), errno);
+        }
+        ::fcntl(fds[0], F_SETFL, ::fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+        *readEnd = fds[0];
+        writeEnds.at(i) = fds[1];
+        ::posix_spawn_file_actions_adddup2(&actions, fds[1], target);
+    }
+
+    // the signal mask and the ignored SIGPIPE of the caller are inherited by exec
+    posix_spawnattr_t attr;
+    if (auto ret = ::posix_spawnattr_init(&attr); ret != 0) {
+        return LINGLONG_ERR(QString{ "posix_spawnattr_init: %1" }.arg(::strerror(ret)), ret);
+    }
+    auto destroyAttr = finally::finally([&attr] {
+        ::posix_spawnattr_destroy(&attr);
+    });
+
+    sigset_t signals;
+    sigemptyset(&signals);
+    ::posix_spawnattr_setsigmask(&attr, &signals);
+    sigaddset(&signals, SIGPIPE);
+    ::posix_spawnattr_setsigdefault(&attr, &signals);
+    ::posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF);
+
+    std::vector<QByteArray> arguments{ program.toLocal8Bit() };
+    for (const auto &arg : args) {
+        arguments.push_back(arg.toLocal8Bit());
+    }
+    std::vector<char *> argv;
+    argv.reserve(arguments.size() + 1);
+    for (auto &arg : arguments) {
+        argv.push_back(arg.data());
+    }
+    argv.push_back(nullptr);
+
+    pid_t pid{ -1 };
+    if (auto ret = ::posix_spawnp(&pid, argv[0], &actions, &attr, argv.data(), environ);
+        ret != 0) {
+        return LINGLONG_ERR(QString{ "posix_spawnp: %1" }.arg(::strerror(ret)), ret);
+    }
+
+    process->processID = pid;
+    process->pidFd = openPidFd(pid);
+    if (process->options.timeout.count() > 0) {
+        process->deadline = std::chrono::steady_clock::now() + process->options.timeout;
+    }
+
+    return process;
+}
+
+void Process::forward() noexcept
+{
+    forwardOutput(this->standardOutputPipe,
+                  this->options.onStandardOutput,
+                  this->result.standardOutput);
+    forwardOutput(this->standardErrorPipe,
+                  this->options.onStandardError,
+                  this->result.standardError);
+}
+
+void Process::terminate() noexcept
+{
+    if (this->killed) {
+        return;
+    }
+    this->killed = true;
+
+#ifdef SYS_pidfd_send_signal
+    if (this->pidFd != -1
+        && ::syscall(SYS_pidfd_send_signal, this->pidFd, SIGKILL, nullptr, 0) == 0) {
+        return;
+    }
+#endif
+    ::kill(this->processID, SIGKILL);
+}
+
+bool Process::reap() noexcept
+{
+    int status{ 0 };
+    pid_t ret{ -1 };
+    while ((ret = ::waitpid(this->processID, &status, WNOHANG)) == -1 && errno == EINTR) { }
+    if (ret != this->processID) {
+        return false;
+    }
+
+    this->exited = true;
+    if (WIFEXITED(status)) {
+        this->result.exitCode = WEXITSTATUS(status);
+    } else if (WIFSIGNALED(status)) {
+        this->result.exitCode = -1;
+        this->result.signal = WTERMSIG(status);
+    }
+
+    // the output written before exit is still in the pipes, the children which inherit the pipes
+    // may write more later, which is dropped
+    this->forward();
+    closeFd(this->standardOutputPipe);
+    closeFd(this->standardErrorPipe);
+    closeFd(this->pidFd);
+    return true;
+}
+
+error::Result<ProcessResult> Process::wait() noexcept
+{
+    LINGLONG_TRACE(QString{ "wait process %1" }.arg(this->processID));
+
+    auto results = waitAll({ this });
+    if (!results) {
+        return LINGLONG_ERR(results);
+    }
+
+    return std::move(results->front());
+}
+
+error::Result<std::vector<ProcessResult>> waitAll(const std::vector<Process *> &processes) noexcept
+{
+    LINGLONG_TRACE("wait processes");
+
+    std::vector<pollfd> fds;
+    while (true) {
+        fds.clear();
+        auto now = std::chrono::steady_clock::now();
+        std::optional<std::chrono::steady_clock::duration> timeout;
+        auto shorten = [&timeout](std::chrono::steady_clock::duration duration) {
+            timeout = timeout ? std::min(*timeout, duration) : duration;
+        };
+
+        for (auto *process : processes) {
+            if (process->exited) {
+                continue;
+            }
+
+            const auto &token = process->options.cancellation;
+            if (token && token->isCancelled()) {
+                process->result.cancelled = true;
+                process->terminate();
+            }
+            if (process->deadline && now >= *process->deadline && !process->killed) {
+                process->result.timedOut = true;
+                process->terminate();
+            }
+
+            if (process->reap()) {
+                continue;
+            }
+
+            for (auto fd : { process->pidFd,
+                             process->standardOutputPipe,
+                             process->standardErrorPipe }) {
+                if (fd != -1) {
+                    fds.push_back({ .fd = fd, .events = POLLIN, .revents = 0 });
+                }
+            }
+
+            if (process->pidFd == -1) {
+                shorten(pollInterval);
+            }
+            if (token && !process->killed) {
+                if (token->fd() != -1) {
+                    fds.push_back({ .fd = token->fd(), .events = POLLIN, .revents = 0 });
+                } else {
+                    shorten(pollInterval);
+                }
+            }
+            if (process->deadline && !process->killed) {
+                shorten(*process->deadline - now);
+            }
+        }
+
+        if (std::all_of(processes.begin(), processes.end(), [](const Process *process) {
+                return process->exited;
+            })) {
+            break;
+        }
+
+        int timeoutMs{ -1 };
+        if (timeout) {
+            // round up, the deadline is checked after poll returns
+            timeoutMs = static_cast<int>(
+              std::chrono::ceil<std::chrono::milliseconds>(*timeout).count());
+        }
+
+        if (::poll(fds.data(), fds.size(), timeoutMs) == -1 && errno != EINTR) {
+            return LINGLONG_ERR(QString{ "poll: %1" }.arg(::strerror(errno)), errno);
+        }
+
+        for (auto *process : processes) {
+            if (process->exited) {
+                continue;
+            }
+            process->forward();
+        }
+    }
+
+    std::vector<ProcessResult> results;
+    results.reserve(processes.size());
+    for (auto *process : processes) {
+        results.push_back(std::move(process->result));
+    }
+
+    return results;
+}
+
+} // namespace linglong::utils::command
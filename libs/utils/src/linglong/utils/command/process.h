@@ -0,0 +1,117 @@
+/*
+ * SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#pragma once
+
+#include "linglong/utils/error/error.h"
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include <sys/types.h>
+
+namespace linglong::utils::command {
+
+// CancellationToken is shared by its copies, cancel() from any thread kills the processes which
+// are started with it.
+class CancellationToken
+{
+public:
+    CancellationToken();
+
+    void cancel() const noexcept;
+    [[nodiscard]] bool isCancelled() const noexcept;
+
+    // fd becomes readable after cancel(), it's polled with the output of the processes
+    [[nodiscard]] int fd() const noexcept;
+
+private:
+    struct State;
+    std::shared_ptr<State> state;
+};
+
+struct ProcessOptions
+{
+    // the callbacks receive the output as soon as it's read and must not throw, the output is kept
+    // in ProcessResult if they're unset
+    std::function<void(std::string_view)> onStandardOutput;
+    std::function<void(std::string_view)> onStandardError;
+    // the process writes to the file descriptors directly if they aren't -1
+    int standardOutputFd{ -1 };
+    int standardErrorFd{ -1 };
+    // the process is killed after timeout, zero disables the timeout
+    std::chrono::milliseconds timeout{ 0 };
+    std::optional<CancellationToken> cancellation;
+};
+
+struct ProcessResult
+{
+    // exitCode is -1 if the process is killed by signal
+    int exitCode{ -1 };
+    int signal{ 0 };
+    bool timedOut{ false };
+    bool cancelled{ false };
+    QByteArray standardOutput;
+    QByteArray standardError;
+};
+
+class Process;
+
+// waitAll forwards the output of the processes in the calling thread until all of them exit, the
+// results are moved out of the processes in their order.
+error::Result<std::vector<ProcessResult>> waitAll(const std::vector<Process *> &processes) noexcept;
+
+// Process runs a program by posix_spawn, with stdin redirected to /dev/null. The exit of the
+// process is watched by a pidfd, so a child which inherits the output pipes doesn't block wait.
+class Process
+{
+public:
+    // start looks up program in PATH like execvp
+    static error::Result<std::unique_ptr<Process>>
+    start(const QString &program, const QStringList &args, ProcessOptions options = {}) noexcept;
+
+    Process(const Process &) = delete;
+    Process(Process &&) = delete;
+    Process &operator=(const Process &) = delete;
+    Process &operator=(Process &&) = delete;
+
+    // the process is killed and reaped if it's still running
+    ~Process();
+
+    [[nodiscard]] pid_t pid() const noexcept { return this->processID; }
+
+    error::Result<ProcessResult> wait() noexcept;
+
+private:
+    friend error::Result<std::vector<ProcessResult>>
+    waitAll(const std::vector<Process *> &processes) noexcept;
+
+    explicit Process(ProcessOptions options) noexcept;
+
+    void forward() noexcept;
+    void terminate() noexcept;
+    bool reap() noexcept;
+
+    ProcessOptions options;
+    ProcessResult result;
+    std::optional<std::chrono::steady_clock::time_point> deadline;
+    pid_t processID{ -1 };
+    int pidFd{ -1 };
+    int standardOutputPipe{ -1 };
+    int standardErrorPipe{ -1 };
+    bool killed{ false };
+    bool exited{ false };
+};
+
+} // namespace linglong::utils::command
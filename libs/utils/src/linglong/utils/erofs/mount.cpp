@@ -0,0 +1,185 @@
+/*
+ * SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#include "linglong/utils/erofs/mount.h"
+
+#include "linglong/utils/command/env.h"
+#include "linglong/utils/finally/finally.h"
+
+#include <linux/loop.h>
+#include <sys/ioctl.h>
+#include <sys/mount.h>
+
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace linglong::utils::erofs {
+
+namespace {
+
+struct LoopDevice
+{
+    int fd;
+    QString path;
+};
+
+// attachLoopDevice returns a read-only loop device backed by file at offset, the loop device is
+// detached automatically after the last reference to it is dropped. The caller must keep the
+// returned fd open until the device is mounted, otherwise the device may be detached and reused
+// by others before that.
+error::Result<LoopDevice> attachLoopDevice(int fileFd, quint64 offset) noexcept
+{
+    LINGLONG_TRACE("attach loop device");
+
+    auto ctlFd = ::open("/dev/loop-control", O_RDWR | O_CLOEXEC);
+    if (ctlFd == -1) {
+        return LINGLONG_ERR(QString{ "open /dev/loop-control: %1" }.arg(::strerror(errno)), errno);
+    }
+    auto closeCtl = finally::finally([ctlFd] {
+        ::close(ctlFd);
+    });
+
+    // another process may take the free loop device before we configure it, retry in this case
+    constexpr auto maxRetry = 8;
+    for (auto i = 0; i < maxRetry; ++i) {
+        auto nr = ::ioctl(ctlFd, LOOP_CTL_GET_FREE);
+        if (nr < 0) {
+            return LINGLONG_ERR(QString{ "LOOP_CTL_GET_FREE: %1" }.arg(::strerror(errno)), errno);
+        }
+
+        auto device = QString{ "/dev/loop%1" }.arg(nr);
+        auto loopFd = ::open(device.toLocal8Bit().constData(), O_RDONLY | O_CLOEXEC);
+        if (loopFd == -1) {
+            return LINGLONG_ERR(QString{ "open %1: %2" }.arg(device, ::strerror(errno)), errno);
+        }
+        auto closeLoop = finally::finally([&loopFd] {
+            if (loopFd != -1) {
+                ::close(loopFd);
+            }
+        });
+
+        loop_info64 info{};
+        info.lo_offset = offset;
+        info.lo_flags = LO_FLAGS_READ_ONLY | LO_FLAGS_AUTOCLEAR;
+
+#ifdef LOOP_CONFIGURE
+        loop_config config{};
+        config.fd = fileFd;
+        config.info = info;
+        if (::ioctl(loopFd, LOOP_CONFIGURE, &config) == 0) {
+            return LoopDevice{ std::exchange(loopFd, -1), device };
+        }
+        if (errno == EBUSY) {
+            continue;
+        }
+        // LOOP_CONFIGURE is available since linux 5.8, fallback to the legacy ioctls
+        if (errno != EINVAL && errno != ENOTTY) {
+            return LINGLONG_ERR(QString{ "LOOP_CONFIGURE %1: %2" }.arg(device, ::strerror(errno)),
+                                errno);
+        }
+#endif
+
+        if (::ioctl(loopFd, LOOP_SET_FD, fileFd) == -1) {
+            if (errno == EBUSY) {
+                continue;
+            }
+            return LINGLONG_ERR(QString{ "LOOP_SET_FD %1: %2" }.arg(device, ::strerror(errno)),
+                                errno);
+        }
+
+        if (::ioctl(loopFd, LOOP_SET_STATUS64, &info) == -1) {
+            auto savedErrno = errno;
+            ::ioctl(loopFd, LOOP_CLR_FD, 0);
+            return LINGLONG_ERR(
+              QString{ "LOOP_SET_STATUS64 %1: %2" }.arg(device, ::strerror(savedErrno)),
+              savedErrno);
+        }
+
+        return LoopDevice{ std::exchange(loopFd, -1), device };
+    }
+
+    return LINGLONG_ERR("no free loop device", EBUSY);
+}
+
+} // namespace
+
+error::Result<void>
+mountKernel(const QString &file, quint64 offset, const QString &mountPoint) noexcept
+{
+    LINGLONG_TRACE(QString{ "mount %1 at %2 by kernel erofs" }.arg(file, mountPoint));
+
+    auto fileFd = ::open(file.toLocal8Bit().constData(), O_RDONLY | O_CLOEXEC);
+    if (fileFd == -1) {
+        return LINGLONG_ERR(QString{ "open: %1" }.arg(::strerror(errno)), errno);
+    }
+    auto closeFile = finally::finally([fileFd] {
+        ::close(fileFd);
+    });
+
+    auto device = attachLoopDevice(fileFd, offset);
+    if (!device) {
+        return LINGLONG_ERR(device);
+    }
+    // hold the loop device until it is mounted, then it will be released on umount, or
+    // immediately if the mount failed
+    auto closeLoop = finally::finally([loopFd = device->fd] {
+        ::close(loopFd);
+    });
+
+    if (::mount(device->path.toLocal8Bit().constData(),
+                mountPoint.toLocal8Bit().constData(),
+                "erofs",
+                MS_RDONLY | MS_NODEV | MS_NOSUID,
+                nullptr)
+        == -1) {
+        return LINGLONG_ERR(QString{ "mount %1: %2" }.arg(device->path, ::strerror(errno)),
+                            errno);
+    }
+
+    return LINGLONG_OK;
+}
+
+error::Result<void>
+mountFuse(const QString &file, quint64 offset, const QString &mountPoint) noexcept
+{
+    LINGLONG_TRACE(QString{ "mount %1 at %2 by erofsfuse" }.arg(file, mountPoint));
+
+    auto ret =
+      command::Exec("erofsfuse", { QString{ "--offset=%1" }.arg(offset), file, mountPoint });
+    if (!ret) {
+        return LINGLONG_ERR(ret);
+    }
+
+    qDebug() << "erofsfuse output:" << *ret;
+    return LINGLONG_OK;
+}
+
+error::Result<MountMethod>
+mount(const QString &file, quint64 offset, const QString &mountPoint) noexcept
+{
+    LINGLONG_TRACE(QString{ "mount erofs image %1" }.arg(file));
+
+    if (qEnvironmentVariableIsEmpty("LINGLONG_EROFS_FORCE_FUSE")) {
+        auto ret = mountKernel(file, offset, mountPoint);
+        if (ret) {
+            return MountMethod::Kernel;
+        }
+        qDebug() << "fallback to erofsfuse:" << ret.error().message();
+    }
+
+    auto ret = mountFuse(file, offset, mountPoint);
+    if (!ret) {
+        return LINGLONG_ERR(ret);
+    }
+
+    return MountMethod::Fuse;
+}
+
+} // namespace linglong::utils::erofs
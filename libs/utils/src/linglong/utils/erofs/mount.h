@@ -0,0 +1,31 @@
+/*
+ * SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#pragma once
+
+#include "linglong/utils/error/error.h"
+
+#include <QString>
+
+namespace linglong::utils::erofs {
+
+enum class MountMethod { Kernel, Fuse };
+
+// mountKernel attaches the erofs image which starts at offset of file to a read-only loop device
+// and mounts it with the in-kernel erofs driver. It requires CAP_SYS_ADMIN.
+error::Result<void>
+mountKernel(const QString &file, quint64 offset, const QString &mountPoint) noexcept;
+
+// mountFuse mounts the erofs image which starts at offset of file by erofsfuse.
+error::Result<void>
+mountFuse(const QString &file, quint64 offset, const QString &mountPoint) noexcept;
+
+// mount prefers the in-kernel erofs driver and falls back to erofsfuse if the kernel mount is not
+// permitted or not supported. Set LINGLONG_EROFS_FORCE_FUSE to always use erofsfuse.
+error::Result<MountMethod>
+mount(const QString &file, quint64 offset, const QString &mountPoint) noexcept;
+
+} // namespace linglong::utils::erofs
@@ -262,7 +262,12 @@ using Result = tl::expected<Value, Error>;
 } // namespace linglong::utils::error
 
 // Use this macro to define trace message at the begining of function
-#define LINGLONG_TRACE(message) QString linglong_trace_message = message;
+// The message is formatted only when an error is created, so it must not depend on the variables
+// changed after LINGLONG_TRACE.
+#define LINGLONG_TRACE(message) /*NOLINT*/                            \
+    [[maybe_unused]] auto linglong_trace_message = [&]() -> QString { \
+        return message;                                               \
+    };
 
 // Use this macro to create new error or wrap an existing error
 // LINGLONG_ERR(message, code =-1)
@@ -285,26 +290,26 @@ using Result = tl::expected<Value, Error>;
     (__VA_ARGS__)
 
 // std::move is used for Result<Value>
-#define LINGLONG_ERR_1(_1) /*NOLINT*/                                           \
-    tl::unexpected(::linglong::utils::error::Error::Err(QT_MESSAGELOG_FILE,     \
-                                                        QT_MESSAGELOG_LINE,     \
-                                                        linglong_trace_message, \
+#define LINGLONG_ERR_1(_1) /*NOLINT*/                                             \
+    tl::unexpected(::linglong::utils::error::Error::Err(QT_MESSAGELOG_FILE,       \
+                                                        QT_MESSAGELOG_LINE,       \
+                                                        linglong_trace_message(), \
                                                         std::move((_1)) /*NOLINT*/))
 
 // std::move is used for Result<Value>
-#define LINGLONG_ERR_2(_1, _2) /*NOLINT*/                                       \
-    tl::unexpected(::linglong::utils::error::Error::Err(QT_MESSAGELOG_FILE,     \
-                                                        QT_MESSAGELOG_LINE,     \
-                                                        linglong_trace_message, \
-                                                        (_1),                   \
+#define LINGLONG_ERR_2(_1, _2) /*NOLINT*/                                         \
+    tl::unexpected(::linglong::utils::error::Error::Err(QT_MESSAGELOG_FILE,       \
+                                                        QT_MESSAGELOG_LINE,       \
+                                                        linglong_trace_message(), \
+                                                        (_1),                     \
                                                         std::move((_2)) /*NOLINT*/))
 
-#define LINGLONG_ERR_3(_1, _2, _3) /*NOLINT*/                                   \
-    tl::unexpected(::linglong::utils::error::Error::Err(QT_MESSAGELOG_FILE,     \
-                                                        QT_MESSAGELOG_LINE,     \
-                                                        linglong_trace_message, \
-                                                        (_1),                   \
-                                                        (_2),                   \
+#define LINGLONG_ERR_3(_1, _2, _3) /*NOLINT*/                                     \
+    tl::unexpected(::linglong::utils::error::Error::Err(QT_MESSAGELOG_FILE,       \
+                                                        QT_MESSAGELOG_LINE,       \
+                                                        linglong_trace_message(), \
+                                                        (_1),                     \
+                                                        (_2),                     \
                                                         (_3)))
 
 #define LINGLONG_OK \
@@ -8,6 +8,11 @@
 
 #include <qdbusargument.h>
 
+#include <QDBusVariant>
+
+#include <cmath>
+#include <limits>
+
 namespace linglong::utils::serialize {
 namespace {
 static QVariant decodeQDBusArgument(const QVariant &v)
@@ -43,8 +48,212 @@ static QVariant decodeQDBusArgument(const QVariant &v)
     }
 }
 
+// the numbers without fraction are integers in JSON text, keep them as integers like parsing the
+// text does
+nlohmann::json doubleToJSON(double value) noexcept
+{
+    constexpr auto maxSafeInteger = double(1ULL << std::numeric_limits<double>::digits);
+    if (std::trunc(value) != value || std::abs(value) > maxSafeInteger) {
+        return value;
+    }
+    if (value < 0) {
+        return static_cast<int64_t>(value);
+    }
+    return static_cast<uint64_t>(value);
+}
+
+nlohmann::json QJsonValueToJSON(const QJsonValue &value) noexcept
+{
+    switch (value.type()) {
+    case QJsonValue::Bool:
+        return value.toBool();
+    case QJsonValue::Double:
+        return doubleToJSON(value.toDouble());
+    case QJsonValue::String:
+        return value.toString().toStdString();
+    case QJsonValue::Array: {
+        auto array = nlohmann::json::array();
+        for (const auto &item : value.toArray()) {
+            array.push_back(QJsonValueToJSON(item));
+        }
+        return array;
+    }
+    case QJsonValue::Object: {
+        auto object = nlohmann::json::object();
+        const auto obj = value.toObject();
+        for (auto it = obj.begin(); it != obj.end(); ++it) {
+            object[it.key().toStdString()] = QJsonValueToJSON(it.value());
+        }
+        return object;
+    }
+    default:
+        return nullptr;
+    }
+}
+
+nlohmann::json QDBusArgumentToJSON(const QDBusArgument &argument) noexcept
+{
+    switch (argument.currentType()) {
+    case QDBusArgument::MapType: {
+        auto object = nlohmann::json::object();
+        argument.beginMap();
+        while (!argument.atEnd()) {
+            argument.beginMapEntry();
+            auto key = argument.asVariant().toString().toStdString();
+            object[std::move(key)] = QDBusArgumentToJSON(argument);
+            argument.endMapEntry();
+        }
+        argument.endMap();
+        return object;
+    }
+    case QDBusArgument::ArrayType: {
+        auto array = nlohmann::json::array();
+        argument.beginArray();
+        while (!argument.atEnd()) {
+            array.push_back(QDBusArgumentToJSON(argument));
+        }
+        argument.endArray();
+        return array;
+    }
+    case QDBusArgument::StructureType: {
+        auto array = nlohmann::json::array();
+        argument.beginStructure();
+        while (!argument.atEnd()) {
+            array.push_back(QDBusArgumentToJSON(argument));
+        }
+        argument.endStructure();
+        return array;
+    }
+    case QDBusArgument::BasicType:
+    case QDBusArgument::VariantType:
+        return toJSON(argument.asVariant());
+    default:
+        return nullptr;
+    }
+}
+
 } // namespace
 
+QVariant toQVariant(const nlohmann::json &json) noexcept
+{
+    switch (json.type()) {
+    case nlohmann::json::value_t::boolean:
+        return json.get<bool>();
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    case nlohmann::json::value_t::number_integer:
+        return static_cast<qlonglong>(json.get<int64_t>());
+    case nlohmann::json::value_t::number_unsigned:
+        if (json.get<uint64_t>()
+            <= static_cast<uint64_t>(std::numeric_limits<qlonglong>::max())) {
+            return static_cast<qlonglong>(json.get<uint64_t>());
+        }
+        return json.get<double>();
+#else
+    // all numbers of QJsonValue are double in Qt 5
+    case nlohmann::json::value_t::number_integer:
+    case nlohmann::json::value_t::number_unsigned:
+#endif
+    case nlohmann::json::value_t::number_float:
+        if (!std::isfinite(json.get<double>())) {
+            return QVariant::fromValue(nullptr);
+        }
+        return json.get<double>();
+    case nlohmann::json::value_t::string: {
+        const auto &str = json.get_ref<const std::string &>();
+        return QString::fromUtf8(str.data(), static_cast<int>(str.size()));
+    }
+    case nlohmann::json::value_t::array: {
+        QVariantList list;
+        list.reserve(static_cast<int>(json.size()));
+        for (const auto &item : json) {
+            list.push_back(toQVariant(item));
+        }
+        return list;
+    }
+    case nlohmann::json::value_t::object: {
+        // the keys are sorted already, append them to the end of map
+        QVariantMap map;
+        for (auto it = json.begin(); it != json.end(); ++it) {
+            map.insert(map.cend(), QString::fromStdString(it.key()), toQVariant(it.value()));
+        }
+        return map;
+    }
+    default:
+        return QVariant::fromValue(nullptr);
+    }
+}
+
+nlohmann::json toJSON(const QVariant &variant) noexcept
+{
+    const auto type = variant.userType();
+    if (type == qMetaTypeId<QDBusArgument>()) {
+        return QDBusArgumentToJSON(variant.value<QDBusArgument>());
+    }
+    if (type == qMetaTypeId<QDBusVariant>()) {
+        return toJSON(variant.value<QDBusVariant>().variant());
+    }
+
+    switch (type) {
+    case QMetaType::UnknownType:
+    case QMetaType::Nullptr:
+        return nullptr;
+    case QMetaType::Bool:
+        return variant.toBool();
+    case QMetaType::Short:
+    case QMetaType::Int:
+    case QMetaType::Long:
+    case QMetaType::LongLong:
+        return static_cast<int64_t>(variant.toLongLong());
+    case QMetaType::UChar:
+    case QMetaType::UShort:
+    case QMetaType::UInt:
+    case QMetaType::ULong:
+    case QMetaType::ULongLong:
+        return static_cast<uint64_t>(variant.toULongLong());
+    case QMetaType::Float:
+    case QMetaType::Double:
+        return doubleToJSON(variant.toDouble());
+    case QMetaType::QString:
+        return variant.toString().toStdString();
+    case QMetaType::QStringList: {
+        auto array = nlohmann::json::array();
+        for (const auto &str : variant.toStringList()) {
+            array.push_back(str.toStdString());
+        }
+        return array;
+    }
+    case QMetaType::QVariantList: {
+        auto array = nlohmann::json::array();
+        const auto list = variant.toList();
+        for (const auto &item : list) {
+            array.push_back(toJSON(item));
+        }
+        return array;
+    }
+    case QMetaType::QVariantMap:
+        return toJSON(variant.toMap());
+    case QMetaType::QVariantHash: {
+        auto object = nlohmann::json::object();
+        const auto hash = variant.toHash();
+        for (auto it = hash.cbegin(); it != hash.cend(); ++it) {
+            object[it.key().toStdString()] = toJSON(it.value());
+        }
+        return object;
+    }
+    default:
+        return QJsonValueToJSON(QJsonValue::fromVariant(variant));
+    }
+}
+
+nlohmann::json toJSON(const QVariantMap &map) noexcept
+{
+    auto object = nlohmann::json::object();
+    for (auto it = map.cbegin(); it != map.cend(); ++it) {
+        object[it.key().toStdString()] = toJSON(it.value());
+    }
+    return object;
+}
+
 QJsonObject QJsonObjectfromVariantMap(const QVariantMap &map) noexcept
 {
     QVariantMap newMap;
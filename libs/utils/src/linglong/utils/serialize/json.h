@@ -7,15 +7,19 @@
 #pragma once
 
 // NOTE: DO NOT REMOVE THIS HEADER, nlohmann::json need this header to lookup function 'from_json'
+#include "linglong/api/types/v1/Fields.hpp"
 #include "linglong/api/types/v1/Generators.hpp"
 #include "linglong/utils/error/error.h"
+#include "linglong/utils/serialize/json_reader.h"
 #include "nlohmann/json.hpp"
+#include "ocppi/runtime/config/types/Fields.hpp"
 
 #include <gio/gio.h>
 
 #include <QFileInfo>
 #include <QJsonArray>
 #include <QJsonDocument>
+#include <QVariant>
 
 #include <filesystem>
 #include <fstream>
@@ -24,6 +28,14 @@ namespace linglong::utils::serialize {
 
 QJsonObject QJsonObjectfromVariantMap(const QVariantMap &vmap) noexcept;
 
+// toQVariant converts json like QJsonValue::toVariant, without dumping it to text
+QVariant toQVariant(const nlohmann::json &json) noexcept;
+
+// toJSON converts variant like QJsonValue::fromVariant, the maps and arrays received from D-Bus
+// are decoded from QDBusArgument directly
+nlohmann::json toJSON(const QVariant &variant) noexcept;
+nlohmann::json toJSON(const QVariantMap &map) noexcept;
+
 template<typename T>
 QJsonDocument toQJsonDocument(const T &x) noexcept
 {
@@ -35,9 +47,9 @@ QJsonDocument toQJsonDocument(const T &x) noexcept
 template<typename T>
 QVariantMap toQVariantMap(const T &x) noexcept
 {
-    QJsonDocument doc = toQJsonDocument(x);
-    Q_ASSERT(doc.isObject());
-    return doc.object().toVariantMap();
+    nlohmann::json json = x;
+    Q_ASSERT(json.is_object());
+    return toQVariant(json).toMap();
 }
 
 template<typename T, typename Source>
@@ -46,8 +58,13 @@ error::Result<T> LoadJSON(const Source &content) noexcept
     LINGLONG_TRACE("load json");
 
     try {
-        auto json = nlohmann::json::parse(content);
-        return json.template get<T>();
+        // the generated types are filled by the parser directly, without the document
+        if constexpr (isReadableJSON<T>) {
+            return readJSON<T>(content);
+        } else {
+            auto json = nlohmann::json::parse(content);
+            return json.template get<T>();
+        }
     } catch (const std::exception &e) {
         return LINGLONG_ERR(content, e);
     }
@@ -71,8 +88,13 @@ error::Result<T> LoadJSON(Source &content) noexcept
     LINGLONG_TRACE("load json");
 
     try {
-        auto json = nlohmann::json::parse(content);
-        return json.template get<T>();
+        // the generated types are filled by the parser directly, without the document
+        if constexpr (isReadableJSON<T>) {
+            return readJSON<T>(content);
+        } else {
+            auto json = nlohmann::json::parse(content);
+            return json.template get<T>();
+        }
     } catch (const std::exception &e) {
         return LINGLONG_ERR(content, e);
     }
@@ -174,7 +196,8 @@ error::Result<T> fromQJsonValue(const QJsonValue &v) noexcept
 template<typename T>
 error::Result<T> fromQVariantMap(const QVariantMap &vmap)
 {
-    return fromQJsonObject<T>(QJsonObjectfromVariantMap(vmap));
+    const auto json = toJSON(vmap);
+    return LoadJSON<T>(json);
 }
 
 } // namespace linglong::utils::serialize
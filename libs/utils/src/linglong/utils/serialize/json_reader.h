@@ -0,0 +1,574 @@
+/*
+ * SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+ *
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+#pragma once
+
+#include "nlohmann/json.hpp"
+
+#include <array>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// readJSON fills the generated types from the SAX events of the parser, without building the
+// document. The members are looked up in the tables generated by tools/codegen.sh (Fields.hpp),
+// the values which don't match the expected shape are built as json and converted by from_json,
+// so the result and the failures are the same as parsing the document and calling get<T>().
+
+namespace linglong::utils::serialize {
+
+namespace details {
+
+template<typename T, typename = void>
+struct HasFields : std::false_type
+{
+};
+
+// fields is found by ADL in the namespace of T
+template<typename T>
+struct HasFields<T, std::void_t<decltype(fields(static_cast<const T *>(nullptr)))>>
+    : std::true_type
+{
+};
+
+template<typename T>
+struct IsOptional : std::false_type
+{
+};
+
+template<typename T>
+struct IsOptional<std::optional<T>> : std::true_type
+{
+};
+
+template<typename T>
+struct IsVector : std::false_type
+{
+};
+
+// std::vector<bool> doesn't return a reference from emplace_back
+template<typename T>
+struct IsVector<std::vector<T>> : std::negation<std::is_same<T, bool>>
+{
+};
+
+template<typename T>
+struct IsMap : std::false_type
+{
+};
+
+template<typename T>
+struct IsMap<std::map<std::string, T>> : std::true_type
+{
+};
+
+// IsReadable is true if the objects or arrays of T contain the generated types
+template<typename T>
+struct IsReadable : HasFields<T>
+{
+};
+
+template<typename T>
+struct IsReadable<std::vector<T>> : IsReadable<T>
+{
+};
+
+template<typename T>
+struct IsReadable<std::map<std::string, T>> : IsReadable<T>
+{
+};
+
+template<typename T>
+struct IsReadable<std::optional<T>> : IsReadable<T>
+{
+};
+
+// Frame receives the values in an object or an array, or the value of the document
+class Frame
+{
+public:
+    Frame() = default;
+    Frame(const Frame &) = delete;
+    Frame(Frame &&) = delete;
+    Frame &operator=(const Frame &) = delete;
+    Frame &operator=(Frame &&) = delete;
+    virtual ~Frame() = default;
+
+    // key selects the target of the next value in an object
+    virtual void key(std::string & /*key*/) { }
+
+    virtual void value(nlohmann::json &&value) = 0;
+
+    virtual void value(std::string &&value) { this->value(nlohmann::json(std::move(value))); }
+
+    // object and array return the frame of the nested value, nullptr skips it
+    virtual std::unique_ptr<Frame> object() = 0;
+    virtual std::unique_ptr<Frame> array() = 0;
+
+    // end is called at the end of the object or the array
+    virtual void end() { }
+};
+
+template<typename T>
+void assign(T &target, nlohmann::json &&value)
+{
+    if constexpr (std::is_same_v<T, nlohmann::json>) {
+        target = std::move(value);
+    } else if constexpr (IsOptional<T>::value) {
+        if (value.is_null()) {
+            target = value.template get<T>();
+            return;
+        }
+        assign(target.emplace(), std::move(value));
+    } else {
+        target = value.template get<T>();
+    }
+}
+
+template<typename T>
+void assign(T &target, std::string &&value)
+{
+    if constexpr (std::is_same_v<T, std::string>) {
+        target = std::move(value);
+    } else if constexpr (IsOptional<T>::value) {
+        assign(target.emplace(), std::move(value));
+    } else {
+        assign(target, nlohmann::json(std::move(value)));
+    }
+}
+
+template<typename T>
+std::unique_ptr<Frame> objectFrame(T &target);
+template<typename T>
+std::unique_ptr<Frame> arrayFrame(T &target);
+
+// DocumentFrame builds the values like the DOM parser, the last one of the duplicated keys wins
+class DocumentFrame : public Frame
+{
+public:
+    using Frame::value;
+
+    explicit DocumentFrame(nlohmann::json &target)
+        : target(target)
+    {
+    }
+
+    void key(std::string &key) override { this->current = &this->target[std::move(key)]; }
+
+    void value(nlohmann::json &&value) override { this->next() = std::move(value); }
+
+    std::unique_ptr<Frame> object() override
+    {
+        auto &next = this->next();
+        next = nlohmann::json::object();
+        return std::make_unique<DocumentFrame>(next);
+    }
+
+    std::unique_ptr<Frame> array() override
+    {
+        auto &next = this->next();
+        next = nlohmann::json::array();
+        return std::make_unique<DocumentFrame>(next);
+    }
+
+private:
+    nlohmann::json &next()
+    {
+        if (this->target.is_array()) {
+            this->target.push_back(nullptr);
+            return this->target.back();
+        }
+        return *this->current;
+    }
+
+    nlohmann::json &target;
+    nlohmann::json *current{ nullptr };
+};
+
+// ConvertFrame builds an object or an array which isn't expected by T, and converts it by
+// from_json at the end, which usually throws the same error as get<T>()
+template<typename T>
+class ConvertFrame : public Frame
+{
+public:
+    using Frame::value;
+
+    ConvertFrame(T &target, nlohmann::json initial)
+        : target(target)
+        , document(std::move(initial))
+        , frame(this->document)
+    {
+    }
+
+    void key(std::string &key) override { this->frame.key(key); }
+
+    void value(nlohmann::json &&value) override { this->frame.value(std::move(value)); }
+
+    std::unique_ptr<Frame> object() override { return this->frame.object(); }
+
+    std::unique_ptr<Frame> array() override { return this->frame.array(); }
+
+    void end() override { assign(this->target, std::move(this->document)); }
+
+private:
+    T &target;
+    nlohmann::json document;
+    DocumentFrame frame;
+};
+
+template<typename T>
+class StructFrame : public Frame
+{
+public:
+    explicit StructFrame(T &target)
+        : target(target)
+    {
+        this->target = T{};
+    }
+
+    void key(std::string &key) override
+    {
+        this->current = size;
+        std::apply(
+          [this, &key](const auto &...field) {
+              std::size_t index = 0;
+              ((key == field.first ? (this->current = index) : 0, ++index), ...);
+          },
+          table());
+        if (this->current != size) {
+            this->seen.at(this->current) = true;
+        }
+    }
+
+    void value(nlohmann::json &&value) override
+    {
+        this->visit([&value](auto &member) {
+            // the optional members are reset by null, like get_stack_optional
+            using Member = std::decay_t<decltype(member)>;
+            if constexpr (IsOptional<Member>::value) {
+                if (value.is_null()) {
+                    member.reset();
+                    return;
+                }
+            }
+            assign(member, std::move(value));
+        });
+    }
+
+    void value(std::string &&value) override
+    {
+        this->visit([&value](auto &member) {
+            assign(member, std::move(value));
+        });
+    }
+
+    std::unique_ptr<Frame> object() override
+    {
+        std::unique_ptr<Frame> frame;
+        this->visit([&frame](auto &member) {
+            frame = objectFrame(member);
+        });
+        return frame;
+    }
+
+    std::unique_ptr<Frame> array() override
+    {
+        std::unique_ptr<Frame> frame;
+        this->visit([&frame](auto &member) {
+            frame = arrayFrame(member);
+        });
+        return frame;
+    }
+
+    // the required members are the ones which are neither optional nor untyped
+    void end() override
+    {
+        std::apply(
+          [this](const auto &...field) {
+              std::size_t index = 0;
+              (this->check(field, this->seen.at(index++)), ...);
+          },
+          table());
+    }
+
+private:
+    using Table = decltype(fields(static_cast<const T *>(nullptr)));
+
+    static const Table &table()
+    {
+        static const Table table = fields(static_cast<const T *>(nullptr));
+        return table;
+    }
+
+    static constexpr auto size = std::tuple_size_v<Table>;
+
+    template<typename Field>
+    static void check(const Field &field, bool seen)
+    {
+        using Member = std::decay_t<decltype(std::declval<T &>().*(field.second))>;
+        if constexpr (!IsOptional<Member>::value && !std::is_same_v<Member, nlohmann::json>) {
+            if (!seen) {
+                throw std::out_of_range(std::string("key '") + field.first + "' not found");
+            }
+        }
+    }
+
+    // visit calls fn with the member of the current key, the unknown keys are skipped
+    template<typename Fn>
+    void visit(Fn &&fn)
+    {
+        std::apply(
+          [this, &fn](const auto &...field) {
+              std::size_t index = 0;
+              ((index++ == this->current ? fn(this->target.*(field.second)) : void()), ...);
+          },
+          table());
+    }
+
+    T &target;
+    std::size_t current{ size };
+    std::array<bool, size> seen{};
+};
+
+template<typename T>
+class VectorFrame : public Frame
+{
+public:
+    explicit VectorFrame(std::vector<T> &target)
+        : target(target)
+    {
+        this->target.clear();
+    }
+
+    void value(nlohmann::json &&value) override
+    {
+        assign(this->target.emplace_back(), std::move(value));
+    }
+
+    void value(std::string &&value) override
+    {
+        assign(this->target.emplace_back(), std::move(value));
+    }
+
+    std::unique_ptr<Frame> object() override { return objectFrame(this->target.emplace_back()); }
+
+    std::unique_ptr<Frame> array() override { return arrayFrame(this->target.emplace_back()); }
+
+private:
+    std::vector<T> &target;
+};
+
+template<typename T>
+class MapFrame : public Frame
+{
+public:
+    explicit MapFrame(std::map<std::string, T> &target)
+        : target(target)
+    {
+        this->target.clear();
+    }
+
+    void key(std::string &key) override { this->current = &this->target[std::move(key)]; }
+
+    void value(nlohmann::json &&value) override { assign(*this->current, std::move(value)); }
+
+    void value(std::string &&value) override { assign(*this->current, std::move(value)); }
+
+    std::unique_ptr<Frame> object() override { return objectFrame(*this->current); }
+
+    std::unique_ptr<Frame> array() override { return arrayFrame(*this->current); }
+
+private:
+    std::map<std::string, T> &target;
+    T *current{ nullptr };
+};
+
+template<typename T>
+std::unique_ptr<Frame> objectFrame(T &target)
+{
+    if constexpr (std::is_same_v<T, nlohmann::json>) {
+        target = nlohmann::json::object();
+        return std::make_unique<DocumentFrame>(target);
+    } else if constexpr (IsOptional<T>::value) {
+        return objectFrame(target.emplace());
+    } else if constexpr (HasFields<T>::value) {
+        return std::make_unique<StructFrame<T>>(target);
+    } else if constexpr (IsMap<T>::value) {
+        return std::make_unique<MapFrame<typename T::mapped_type>>(target);
+    } else {
+        return std::make_unique<ConvertFrame<T>>(target, nlohmann::json::object());
+    }
+}
+
+template<typename T>
+std::unique_ptr<Frame> arrayFrame(T &target)
+{
+    if constexpr (std::is_same_v<T, nlohmann::json>) {
+        target = nlohmann::json::array();
+        return std::make_unique<DocumentFrame>(target);
+    } else if constexpr (IsOptional<T>::value) {
+        return arrayFrame(target.emplace());
+    } else if constexpr (IsVector<T>::value) {
+        return std::make_unique<VectorFrame<typename T::value_type>>(target);
+    } else {
+        return std::make_unique<ConvertFrame<T>>(target, nlohmann::json::array());
+    }
+}
+
+// RootFrame receives the value of the document
+template<typename T>
+class RootFrame : public Frame
+{
+public:
+    explicit RootFrame(T &target)
+        : target(target)
+    {
+    }
+
+    void value(nlohmann::json &&value) override { assign(this->target, std::move(value)); }
+
+    void value(std::string &&value) override { assign(this->target, std::move(value)); }
+
+    std::unique_ptr<Frame> object() override { return objectFrame(this->target); }
+
+    std::unique_ptr<Frame> array() override { return arrayFrame(this->target); }
+
+private:
+    T &target;
+};
+
+// Reader implements the SAX interface of nlohmann::json
+class Reader
+{
+public:
+    explicit Reader(std::unique_ptr<Frame> root) { this->frames.push_back(std::move(root)); }
+
+    bool null() { return this->scalar(nullptr); }
+
+    bool boolean(bool value) { return this->scalar(value); }
+
+    bool number_integer(nlohmann::json::number_integer_t value) { return this->scalar(value); }
+
+    bool number_unsigned(nlohmann::json::number_unsigned_t value) { return this->scalar(value); }
+
+    bool number_float(nlohmann::json::number_float_t value, const std::string & /*raw*/)
+    {
+        return this->scalar(value);
+    }
+
+    bool string(std::string &value)
+    {
+        if (this->skipped == 0) {
+            this->frames.back()->value(std::move(value));
+        }
+        return true;
+    }
+
+    // the parser of JSON text never reports binary values
+    template<typename Binary>
+    bool binary(Binary & /*value*/)
+    {
+        return false;
+    }
+
+    bool start_object(std::size_t /*size*/) { return this->start(&Frame::object); }
+
+    bool key(std::string &key)
+    {
+        if (this->skipped == 0) {
+            this->frames.back()->key(key);
+        }
+        return true;
+    }
+
+    bool end_object() { return this->end(); }
+
+    bool start_array(std::size_t /*size*/) { return this->start(&Frame::array); }
+
+    bool end_array() { return this->end(); }
+
+    template<typename Exception>
+    bool parse_error(std::size_t /*position*/,
+                     const std::string & /*token*/,
+                     const Exception &exception)
+    {
+        this->error = exception.what();
+        return false;
+    }
+
+    [[nodiscard]] const std::string &errorMessage() const noexcept { return this->error; }
+
+private:
+    bool scalar(nlohmann::json value)
+    {
+        if (this->skipped == 0) {
+            this->frames.back()->value(std::move(value));
+        }
+        return true;
+    }
+
+    bool start(std::unique_ptr<Frame> (Frame::*nested)())
+    {
+        if (this->skipped > 0) {
+            this->skipped++;
+            return true;
+        }
+
+        auto frame = (this->frames.back().get()->*nested)();
+        if (!frame) {
+            this->skipped = 1;
+            return true;
+        }
+        this->frames.push_back(std::move(frame));
+        return true;
+    }
+
+    bool end()
+    {
+        if (this->skipped > 0) {
+            this->skipped--;
+            return true;
+        }
+
+        this->frames.back()->end();
+        this->frames.pop_back();
+        return true;
+    }
+
+    std::vector<std::unique_ptr<Frame>> frames;
+    // the depth in the skipped value of an unknown key
+    std::size_t skipped{ 0 };
+    std::string error;
+};
+
+} // namespace details
+
+template<typename T>
+constexpr bool isReadableJSON = details::IsReadable<T>::value;
+
+// readJSON throws the errors of the parser and from_json
+template<typename T, typename Source>
+T readJSON(Source &&content)
+{
+    T result{};
+    details::Reader reader(std::make_unique<details::RootFrame<T>>(result));
+    if (!nlohmann::json::sax_parse(std::forward<Source>(content), &reader)) {
+        if (reader.errorMessage().empty()) {
+            throw std::invalid_argument("unexpected binary value");
+        }
+        throw std::invalid_argument(reader.errorMessage());
+    }
+    return result;
+}
+
+} // namespace linglong::utils::serialize
@@ -0,0 +1,123 @@
+#!/usr/bin/env bash
+
+# SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+#
+# SPDX-License-Identifier: LGPL-3.0-or-later
+
+# 该工具用于比较内核erofs驱动与erofsfuse挂载同一个layer/uab文件时的读取吞吐量和应用启动时间
+# 用法：
+#   sudo ./benchmark-erofs-mount.sh <file.layer|file.uab> [rounds]
+# 每一轮测试前都会清空page cache，因此需要root权限
+
+set -e
+
+prepareEnv() {
+	if [ "$(id -u)" -ne 0 ]; then
+		echo "This tool needs root privilege to mount erofs by kernel and drop caches"
+		exit 255
+	fi
+
+	for tool in hexdump erofsfuse readelf losetup; do
+		if ! command -v ${tool} >/dev/null 2>&1; then
+			echo "This tool needs '${tool}'"
+			exit 255
+		fi
+	done
+}
+
+getLayerOffset() {
+	layerPath=$1
+	declare -i layerHeaderLength=40
+	declare -i infoLength=4
+	declare -i infoSize
+	infoSize=$(hexdump -n ${infoLength} -s ${layerHeaderLength} -e '1/4 "%u\n"' "${layerPath}")
+	echo $((layerHeaderLength + infoLength + infoSize))
+}
+
+getUabOffset() {
+	readelf -W -S "$1" | awk '$2 == "linglong.bundle" { print strtonum("0x" $5) }'
+}
+
+dropCaches() {
+	sync
+	echo 3 >/proc/sys/vm/drop_caches
+}
+
+now() {
+	date +%s.%N
+}
+
+mountKernel() {
+	device=$(losetup --find --show --read-only --offset "$2" "$1")
+	mount -t erofs -o ro "${device}" "$3"
+	losetup -d "${device}"
+}
+
+mountFuse() {
+	erofsfuse --offset="$2" "$1" "$3" >/dev/null 2>&1
+}
+
+# readAll 读取挂载点下所有文件并输出吞吐量(MiB/s)
+readAll() {
+	local start end bytes
+	start=$(now)
+	bytes=$(find "$1" -type f -print0 | xargs -0 cat 2>/dev/null | wc -c)
+	end=$(now)
+	echo "${bytes} ${start} ${end}" | awk '{ printf "%.2f", $1 / 1048576 / ($3 - $2) }'
+}
+
+# startApp 测量uab从启动到退出的时间(秒)，使用 -- 之后的参数传递给loader
+# 注意：PATH中存在ll-cli时uab会被导入到玲珑中运行，测试前需要确保ll-cli不可用
+startApp() {
+	local start end
+	start=$(now)
+	env "$@" >/dev/null 2>&1 || true
+	end=$(now)
+	echo "${start} ${end}" | awk '{ printf "%.3f", $2 - $1 }'
+}
+
+main() {
+	file=$(realpath "$1")
+	rounds=${2:-3}
+
+	case "${file}" in
+	*.layer) offset=$(getLayerOffset "${file}") ;;
+	*.uab) offset=$(getUabOffset "${file}") ;;
+	*)
+		echo "unsupported file ${file}"
+		exit 255
+		;;
+	esac
+
+	mountPoint=$(mktemp -d)
+	trap 'umount -l "${mountPoint}" 2>/dev/null || true; rmdir "${mountPoint}"' EXIT
+
+	printf "%-8s %-6s %-16s %s\n" "method" "round" "read(MiB/s)" "start(s)"
+	for method in kernel fuse; do
+		for round in $(seq 1 "${rounds}"); do
+			dropCaches
+			mount${method^} "${file}" "${offset}" "${mountPoint}"
+			throughput=$(readAll "${mountPoint}")
+			umount "${mountPoint}"
+
+			startTime="-"
+			if [[ "${file}" == *.uab ]]; then
+				dropCaches
+				if [ "${method}" = "fuse" ]; then
+					startTime=$(startApp UAB_EROFS_FORCE_FUSE=1 "${file}" -- true)
+				else
+					startTime=$(startApp "${file}" -- true)
+				fi
+			fi
+
+			printf "%-8s %-6s %-16s %s\n" "${method}" "${round}" "${throughput}" "${startTime}"
+		done
+	done
+}
+
+prepareEnv
+if [ $# -lt 1 ]; then
+	echo "usage: $0 <file.layer|file.uab> [rounds]"
+	exit 255
+fi
+main "$@"
@@ -0,0 +1,162 @@
+#!/usr/bin/env bash
+
+# SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+#
+# SPDX-License-Identifier: LGPL-3.0-or-later
+
+# 该工具用于比较容器中动态链接器缓存的三种方式下，依赖大量动态库的程序的启动开销
+# 用法：
+#   ./benchmark-ld-cache.sh [rounds] [libraries]
+# probe: 没有包含应用动态库的缓存，动态链接器在 LD_LIBRARY_PATH 的各个目录中逐个查找
+# ldconfig: 每次启动时由 startContainer hook 运行 ldconfig 生成缓存，即未缓存时的行为
+# prebuilt: 挂载第一次启动时生成的缓存，不再运行 ldconfig
+# 输出启动耗时的中位数，动态链接器尝试打开的文件数，以及安装了 strace 时整个启动过程的文件相关系统调用数
+# 默认使用 PATH 中的 ll-box，可以通过 LL_BOX 环境变量指定
+
+set -e
+
+llBox=${LL_BOX:-ll-box}
+appid=org.example.ldcache
+
+# shellcheck source=tools/ll-box-bundle.sh
+source "$(dirname "$(realpath "$0")")/ll-box-bundle.sh"
+
+# buildApp <dir> <libraries> 生成依赖指定数量动态库的程序，动态库位于 lib/<triplet> 下
+buildApp() {
+	local dir=$1 count=$2 i libs=""
+	mkdir -p "${dir}/bin" "${dir}/lib/${triplet}" "${dir}/src"
+	for i in $(seq 1 "${count}"); do
+		echo "int dep${i}(void) { return ${i}; }" >"${dir}/src/dep${i}.c"
+		gcc -shared -fPIC -o "${dir}/lib/${triplet}/libdep${i}.so" "${dir}/src/dep${i}.c"
+		libs="${libs} -ldep${i}"
+	done
+	echo "int main(void) { return 0; }" >"${dir}/src/main.c"
+	# shellcheck disable=SC2086
+	gcc -o "${dir}/bin/app" "${dir}/src/main.c" -Wl,--no-as-needed -L"${dir}/lib/${triplet}" ${libs}
+}
+
+# makeEtc <dir> 生成容器的 /etc，ld.so.cache 是指向 /run/linglong/etc 的软链接，与玲珑容器相同
+makeEtc() {
+	local dir=$1
+	mkdir -p "${dir}/ld.so.conf.d"
+	cp /etc/ld.so.conf.d/*.conf "${dir}/ld.so.conf.d/"
+	echo "include /etc/ld.so.conf.d/*.conf" >"${dir}/ld.so.conf"
+	printf "%s\n" "${libDirs[@]}" >"${dir}/ld.so.conf.d/zz_deepin-linglong-app.conf"
+	ln -s /run/linglong/etc/ld.so.cache "${dir}/ld.so.cache"
+}
+
+# makeModeBundle <dir> <mode> <cache dir> <env>
+makeModeBundle() {
+	local dir=$1 mode=$2 cacheDir=$3 env=$4 cacheMount hooks='{}'
+	makeBundle "${dir}" "${appid}" "" 0 "/opt/apps/${appid}/files/bin/app"
+	if [ "${mode}" = "probe" ] || [ "${mode}" = "ldconfig" ]; then
+		cacheMount='{ "destination": "/run/linglong/etc", "type": "tmpfs", "source": "tmpfs", "options": ["nodev", "nosuid"] }'
+	else
+		cacheMount="{ \"destination\": \"/run/linglong/etc\", \"type\": \"bind\", \"source\": \"${cacheDir}\", \"options\": [\"rbind\"] }"
+	fi
+	if [ "${mode}" = "ldconfig" ] || [ "${mode}" = "generate" ]; then
+		hooks='{ "startContainer": [{ "path": "/sbin/ldconfig", "args": ["/sbin/ldconfig", "-C", "/run/linglong/etc/ld.so.cache"] }] }'
+	fi
+
+	jq --arg etc "${workDir}/etc" --arg files "${workDir}/app" --argjson cache "${cacheMount}" \
+		--argjson hooks "${hooks}" --arg env "${env}" '
+		.mounts |= map(if .destination == "/etc" then .source = $etc
+			elif .destination | endswith("/files") then .source = $files else . end)
+		| .mounts += [$cache]
+		| .hooks = $hooks
+		| if $env != "" then .process.env += [$env] else . end' \
+		"${dir}/config.json" >"${dir}/config.json.tmp"
+	mv "${dir}/config.json.tmp" "${dir}/config.json"
+}
+
+# startContainer 测量容器从启动到退出的时间(纳秒)
+startContainer() {
+	local start end
+	start=$(date +%s%N)
+	"${llBox}" --root "${stateRoot}" run -b "$1" "$2" </dev/null >/dev/null 2>&1
+	end=$(date +%s%N)
+	echo $((end - start))
+}
+
+# countSyscalls <bundle> <id> 统计启动过程中所有进程的文件相关系统调用数
+countSyscalls() {
+	if ! command -v strace >/dev/null 2>&1; then
+		echo "n/a"
+		return
+	fi
+
+	strace -f -qq -o "${workDir}/strace.log" -e trace=%file,%desc \
+		"${llBox}" --root "${stateRoot}" run -b "$1" "$2" </dev/null >/dev/null 2>&1
+	wc -l <"${workDir}/strace.log"
+}
+
+main() {
+	rounds=${1:-20}
+	libraries=${2:-100}
+
+	for tool in "${llBox}" gcc jq; do
+		if ! command -v "${tool}" >/dev/null 2>&1; then
+			echo "This tool needs '${tool}'"
+			exit 255
+		fi
+	done
+
+	workDir=$(mktemp -d)
+	stateRoot=${workDir}/state
+	trap 'rm -rf "${workDir}"' EXIT
+
+	triplet=$(gcc -print-multiarch)
+	# 与 Container::run 生成的 ld.so.conf 相同
+	libDirs=(/runtime/lib "/runtime/lib/${triplet}" "/opt/apps/${appid}/files/lib"
+		"/opt/apps/${appid}/files/lib/${triplet}")
+	buildApp "${workDir}/app" "${libraries}"
+	makeEtc "${workDir}/etc"
+
+	# 第一次启动生成缓存
+	mkdir -p "${workDir}/cache"
+	makeModeBundle "${workDir}/generate" generate "${workDir}/cache" ""
+	startContainer "${workDir}/generate" generate >/dev/null
+	[ -f "${workDir}/cache/ld.so.cache" ] || {
+		echo "ldconfig hook doesn't generate the cache"
+		exit 1
+	}
+
+	printf "%-10s %-12s %-8s %s\n" "mode" "median(ms)" "probes" "syscalls"
+	for mode in probe ldconfig prebuilt; do
+		env=""
+		if [ "${mode}" = "probe" ]; then
+			env="LD_LIBRARY_PATH=$(
+				IFS=:
+				echo "${libDirs[*]}"
+			)"
+		fi
+
+		results=""
+		for round in $(seq 0 "${rounds}"); do
+			bundle=${workDir}/${mode}/${round}
+			makeModeBundle "${bundle}" "${mode}" "${workDir}/cache" "${env}"
+			elapsed=$(startContainer "${bundle}" "${mode}-${round}")
+			# 第一轮用于预热 page cache，不计入结果
+			[ "${round}" -eq 0 ] || results="${results}${elapsed}"$'\n'
+		done
+
+		# 动态链接器每次尝试打开文件时输出 trying file=
+		bundle=${workDir}/${mode}/debug
+		makeModeBundle "${bundle}" "${mode}" "${workDir}/cache" "${env}"
+		jq '.process.env += ["LD_DEBUG=libs"]' "${bundle}/config.json" >"${bundle}/config.json.tmp"
+		mv "${bundle}/config.json.tmp" "${bundle}/config.json"
+		probes=$("${llBox}" --root "${stateRoot}" run -b "${bundle}" "${mode}-debug" </dev/null 2>&1 |
+			grep -c "trying file=" || true)
+
+		bundle=${workDir}/${mode}/strace
+		makeModeBundle "${bundle}" "${mode}" "${workDir}/cache" "${env}"
+		syscalls=$(countSyscalls "${bundle}" "${mode}-strace")
+
+		printf "%s" "${results}" | sort -n | awk -v mode="${mode}" -v probes="${probes}" \
+			-v syscalls="${syscalls}" '
+			{ values[NR] = $1 }
+			END { printf "%-10s %-12.2f %-8s %s\n", mode, values[int((NR + 1) / 2)] / 1e6, probes, syscalls }'
+	done
+}
+
+main "$@"
@@ -0,0 +1,91 @@
+#!/usr/bin/env bash
+
+# SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+#
+# SPDX-License-Identifier: LGPL-3.0-or-later
+
+# 该工具用于比较 ll-box 开启调试日志时，逐条写入日志与缓冲日志的容器启动耗时
+# 用法：
+#   ./benchmark-ll-box-logging.sh [rounds] [extra mounts]
+# sync 为 LINGLONG_BOX_LOG_SYNC=1 时每条日志立即写入，buffered 为默认的缓冲写入，
+# error 为默认的日志等级，调试日志不会被格式化
+# 安装了 strace 时输出每次启动中写日志相关的系统调用数
+# 默认使用 PATH 中的 ll-box，可以通过 LL_BOX 环境变量指定
+
+set -e
+
+llBox=${LL_BOX:-ll-box}
+
+# shellcheck source=tools/ll-box-bundle.sh
+source "$(dirname "$(realpath "$0")")/ll-box-bundle.sh"
+
+# startContainer 测量容器从启动到退出的时间(纳秒)，日志写入文件
+startContainer() {
+	local start end
+	start=$(date +%s%N)
+	"${llBox}" --root "${stateRoot}" run -b "$1" "$2" </dev/null >"${workDir}/output.log" 2>&1 || true
+	end=$(date +%s%N)
+	echo $((end - start))
+}
+
+# countSyscalls <bundle> <id> 统计启动过程中所有进程写日志相关的系统调用数
+countSyscalls() {
+	if ! command -v strace >/dev/null 2>&1; then
+		echo "n/a"
+		return
+	fi
+
+	strace -f -qq -o "${workDir}/strace.log" -e trace=write,sendto,sendmsg,readlink \
+		"${llBox}" --root "${stateRoot}" run -b "$1" "$2" </dev/null >/dev/null 2>&1 || true
+	wc -l <"${workDir}/strace.log"
+}
+
+main() {
+	rounds=${1:-20}
+	extra=${2:-50}
+
+	if ! command -v "${llBox}" >/dev/null 2>&1; then
+		echo "This tool needs '${llBox}'"
+		exit 255
+	fi
+
+	workDir=$(mktemp -d)
+	stateRoot=${workDir}/state
+	trap 'rm -rf "${workDir}"' EXIT
+	unset LINGLONG_BOX_ZYGOTE
+
+	printf "%-10s %-14s %-10s %-8s %s\n" "mode" "median(ms)" "min(ms)" "lines" "syscalls"
+	for mode in sync buffered error; do
+		case "${mode}" in
+		sync)
+			export LINGLONG_LOG_LEVEL=Debug LINGLONG_BOX_LOG_SYNC=1
+			;;
+		buffered)
+			export LINGLONG_LOG_LEVEL=Debug LINGLONG_BOX_LOG_SYNC=0
+			;;
+		error)
+			export LINGLONG_LOG_LEVEL=Error LINGLONG_BOX_LOG_SYNC=0
+			;;
+		esac
+
+		# 第一轮用于预热 page cache，不计入结果
+		results=""
+		for round in $(seq 0 "${rounds}"); do
+			bundle=${workDir}/${mode}/${round}
+			makeBundle "${bundle}" "org.example.app${round}" "${workDir}/base" "${extra}" /bin/true
+			elapsed=$(startContainer "${bundle}" "${mode}-${round}")
+			[ "${round}" -eq 0 ] || results="${results}${elapsed}"$'\n'
+		done
+		lines=$(wc -l <"${workDir}/output.log")
+
+		bundle=${workDir}/${mode}/strace
+		makeBundle "${bundle}" "org.example.strace" "${workDir}/base" "${extra}" /bin/true
+		syscalls=$(countSyscalls "${bundle}" "${mode}-strace")
+
+		printf "%s" "${results}" | sort -n | awk -v mode="${mode}" -v lines="${lines}" -v syscalls="${syscalls}" '
+			{ values[NR] = $1 }
+			END { printf "%-10s %-14.2f %-10.2f %-8s %s\n", mode, values[int((NR + 1) / 2)] / 1e6, values[1] / 1e6, lines, syscalls }'
+	done
+}
+
+main "$@"
@@ -0,0 +1,85 @@
+#!/usr/bin/env bash
+
+# SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+#
+# SPDX-License-Identifier: LGPL-3.0-or-later
+
+# 该工具用于比较 ll-box 使用新的挂载 API(open_tree/move_mount/mount_setattr)与 mount(2) 挂载时的容器启动耗时
+# 用法：
+#   ./benchmark-ll-box-mount.sh [rounds] [extra mounts]
+# 容器的 bundle 使用宿主机的 /usr 等目录作为 base，extra mounts 指定额外的只读绑定挂载数量
+# 安装了 strace 时输出每次启动中挂载相关的系统调用数
+# 默认使用 PATH 中的 ll-box，可以通过 LL_BOX 环境变量指定
+
+set -e
+
+llBox=${LL_BOX:-ll-box}
+
+# shellcheck source=tools/ll-box-bundle.sh
+source "$(dirname "$(realpath "$0")")/ll-box-bundle.sh"
+
+# startContainer 测量容器从启动到退出的时间(纳秒)
+startContainer() {
+	local start end
+	start=$(date +%s%N)
+	"${llBox}" --root "${stateRoot}" run -b "$1" "$2" </dev/null >/dev/null 2>&1 || true
+	end=$(date +%s%N)
+	echo $((end - start))
+}
+
+# countSyscalls <bundle> <id> 统计启动过程中所有进程的挂载相关系统调用数，包括检查挂载目标的 open 和 readlink
+countSyscalls() {
+	if ! command -v strace >/dev/null 2>&1; then
+		echo "n/a"
+		return
+	fi
+
+	strace -f -qq -o "${workDir}/strace.log" \
+		-e trace=mount,open_tree,move_mount,mount_setattr,open,openat,readlink,statfs,stat,lstat,newfstatat \
+		"${llBox}" --root "${stateRoot}" run -b "$1" "$2" </dev/null >/dev/null 2>&1 || true
+	wc -l <"${workDir}/strace.log"
+}
+
+main() {
+	rounds=${1:-20}
+	extra=${2:-50}
+
+	if ! command -v "${llBox}" >/dev/null 2>&1; then
+		echo "This tool needs '${llBox}'"
+		exit 255
+	fi
+
+	workDir=$(mktemp -d)
+	stateRoot=${workDir}/state
+	trap 'rm -rf "${workDir}"' EXIT
+	# zygote 会复用以另一种方式准备的挂载
+	unset LINGLONG_BOX_ZYGOTE
+
+	printf "%-8s %-14s %-10s %s\n" "mode" "median(ms)" "min(ms)" "syscalls"
+	for mode in mount new-api; do
+		if [ "${mode}" = "new-api" ]; then
+			export LINGLONG_BOX_MOUNT_API=1
+		else
+			export LINGLONG_BOX_MOUNT_API=0
+		fi
+
+		# 第一轮用于预热 page cache，不计入结果
+		results=""
+		for round in $(seq 0 "${rounds}"); do
+			bundle=${workDir}/${mode}/${round}
+			makeBundle "${bundle}" "org.example.app${round}" "${workDir}/base" "${extra}" /bin/true
+			elapsed=$(startContainer "${bundle}" "${mode}-${round}")
+			[ "${round}" -eq 0 ] || results="${results}${elapsed}"$'\n'
+		done
+
+		bundle=${workDir}/${mode}/strace
+		makeBundle "${bundle}" "org.example.strace" "${workDir}/base" "${extra}" /bin/true
+		syscalls=$(countSyscalls "${bundle}" "${mode}-strace")
+
+		printf "%s" "${results}" | sort -n | awk -v mode="${mode}" -v syscalls="${syscalls}" '
+			{ values[NR] = $1 }
+			END { printf "%-8s %-14.2f %-10.2f %s\n", mode, values[int((NR + 1) / 2)] / 1e6, values[1] / 1e6, syscalls }'
+	done
+}
+
+main "$@"
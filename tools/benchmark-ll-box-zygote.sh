@@ -0,0 +1,67 @@
+#!/usr/bin/env bash
+
+# SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+#
+# SPDX-License-Identifier: LGPL-3.0-or-later
+
+# 该工具用于比较 ll-box 直接启动容器与通过 zygote 启动容器的耗时
+# 用法：
+#   ./benchmark-ll-box-zygote.sh [rounds] [extra mounts]
+# 容器的 bundle 使用宿主机的 /usr 等目录作为 base，extra mounts 指定额外的只读绑定挂载数量
+# 默认使用 PATH 中的 ll-box，可以通过 LL_BOX 环境变量指定
+
+set -e
+
+llBox=${LL_BOX:-ll-box}
+
+# shellcheck source=tools/ll-box-bundle.sh
+source "$(dirname "$(realpath "$0")")/ll-box-bundle.sh"
+
+# startContainer 测量容器从启动到退出的时间(纳秒)
+startContainer() {
+	local start end
+	start=$(date +%s%N)
+	"${llBox}" --root "${stateRoot}" run -b "$1" "$2" </dev/null >/dev/null 2>&1 || true
+	end=$(date +%s%N)
+	echo $((end - start))
+}
+
+main() {
+	rounds=${1:-20}
+	extra=${2:-0}
+
+	if ! command -v "${llBox}" >/dev/null 2>&1; then
+		echo "This tool needs '${llBox}'"
+		exit 255
+	fi
+
+	workDir=$(mktemp -d)
+	stateRoot=${workDir}/state
+	trap 'pkill -f -- "--root ${stateRoot}" || true; rm -rf "${workDir}"' EXIT
+
+	printf "%-8s %-14s %s\n" "mode" "median(ms)" "min(ms)"
+	for mode in cold zygote; do
+		if [ "${mode}" = "zygote" ]; then
+			export LINGLONG_BOX_ZYGOTE=1
+		else
+			unset LINGLONG_BOX_ZYGOTE
+		fi
+
+		# 第一轮用于启动 zygote 和预热 page cache，不计入结果
+		results=""
+		for round in $(seq 0 "${rounds}"); do
+			bundle=${workDir}/${mode}/${round}
+			makeBundle "${bundle}" "org.example.app${round}" "${workDir}/base" "${extra}" /bin/true
+			# zygote 在空闲时才准备下一个容器
+			sleep 0.2
+			elapsed=$(startContainer "${bundle}" "${mode}-${round}")
+			[ "${round}" -eq 0 ] || results="${results}${elapsed}"$'\n'
+		done
+
+		printf "%s" "${results}" | sort -n | awk -v mode="${mode}" '
+			{ values[NR] = $1 }
+			END { printf "%-8s %-14.2f %.2f\n", mode, values[int((NR + 1) / 2)] / 1e6, values[1] / 1e6 }'
+	done
+}
+
+main "$@"
@@ -0,0 +1,81 @@
+#!/usr/bin/env bash
+
+# SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+#
+# SPDX-License-Identifier: LGPL-3.0-or-later
+
+# 该工具用于比较清空 page cache 后，应用在有无 readahead 回放时的启动耗时
+# 用法：
+#   ./benchmark-readahead.sh <appid> [rounds] [-- command...]
+# command 是在容器中执行的命令，需要能自行退出，默认为 true
+# 首先在清空 page cache 后记录应用的 readahead profile，然后每一轮分别在不回放与回放 profile 时启动应用
+# 清空 page cache 需要 root 权限，ll-cli 以当前用户运行，因此需要以普通用户运行并且可以使用 sudo
+
+set -e
+
+if [ $# -lt 1 ]; then
+	echo "Usage: $0 <appid> [rounds] [-- command...]"
+	exit 255
+fi
+
+appid=$1
+shift
+rounds=5
+if [ $# -gt 0 ] && [ "$1" != "--" ]; then
+	rounds=$1
+	shift
+fi
+[ "$1" = "--" ] && shift
+command=("$@")
+[ ${#command[@]} -gt 0 ] || command=(true)
+
+for tool in ll-cli sudo; do
+	if ! command -v ${tool} >/dev/null 2>&1; then
+		echo "This tool needs '${tool}'"
+		exit 255
+	fi
+done
+
+profile="${XDG_CACHE_HOME:-${HOME}/.cache}/linglong/readahead/${appid}.json"
+
+dropCaches() {
+	sync
+	echo 3 | sudo tee /proc/sys/vm/drop_caches >/dev/null
+}
+
+# launch <LINGLONG_READAHEAD> 输出应用从启动到退出的时间(纳秒)
+launch() {
+	local start end
+	start=$(date +%s%N)
+	LINGLONG_READAHEAD=$1 ll-cli run "${appid}" -- "${command[@]}" </dev/null >/dev/null 2>&1
+	end=$(date +%s%N)
+	echo $((end - start))
+}
+
+median() {
+	sort -n | awk '{ values[NR] = $1 } END { printf "%.2f", values[int((NR + 1) / 2)] / 1e6 }'
+}
+
+# 清空 page cache 后记录的 profile 只包含应用启动时读取的范围
+rm -f "${profile}"
+dropCaches
+launch 1 >/dev/null
+if [ ! -f "${profile}" ]; then
+	echo "readahead profile isn't recorded, fanotify may be unavailable"
+	exit 1
+fi
+echo "profile: ${profile}"
+echo "ranges: $(grep -o '"length"' "${profile}" | wc -l)"
+
+without=""
+with=""
+for _ in $(seq 1 "${rounds}"); do
+	dropCaches
+	without="${without}$(launch 0)"$'\n'
+	dropCaches
+	with="${with}$(launch 1)"$'\n'
+done
+
+printf "%-10s %s\n" "mode" "median(ms)"
+printf "%-10s %s\n" "without" "$(printf "%s" "${without}" | median)"
+printf "%-10s %s\n" "with" "$(printf "%s" "${with}" | median)"
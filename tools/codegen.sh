@@ -106,6 +106,98 @@ generate() {
         } >>"$filename"
 }
 
+# generate_fields writes the member tables of the structs in Generators.hpp to Fields.hpp, which
+# are used by the streaming parser in libs/utils/src/linglong/utils/serialize/json_reader.h.
+# A member is required, optional or untyped by its type, so from_json must not mix them.
+generate_fields() {
+        generators="$1"
+        shift
+        namespace="$1"
+        shift
+        include="$1"
+
+        awk -v namespace="$namespace" -v include="$include" '
+function fail(message) {
+        print FILENAME ":" FNR ": " message > "/dev/stderr"
+        failed = 1
+        exit 1
+}
+
+BEGIN {
+        print "// This file is generated by tools/codegen.sh"
+        print "// DO NOT EDIT IT."
+        print ""
+        print "// clang-format off"
+        print ""
+        print "// The members and their keys, see linglong/utils/serialize/json_reader.h"
+        print ""
+        print "#pragma once"
+        print ""
+        print "#include <tuple>"
+        print "#include <utility>"
+        print ""
+        print "#include \"" include "/Generators.hpp\""
+        print ""
+        count = split(namespace, names, "::")
+        for (i = 1; i <= count; i++) {
+                print "namespace " names[i] " {"
+        }
+        print ""
+}
+
+/^inline void from_json\(const json & j, [A-Za-z0-9_]+& x\) \{$/ {
+        type = $0
+        sub(/^inline void from_json\(const json & j, /, "", type)
+        sub(/& x\) \{$/, "", type)
+        members = 0
+        next
+}
+
+type != "" && /^}$/ {
+        print "inline auto fields(const " type " *) {"
+        printf "return std::make_tuple("
+        for (i = 1; i <= members; i++) {
+                printf "%s\n%s", (i == 1 ? "" : ","), table[i]
+        }
+        print ");"
+        print "}"
+        print ""
+        type = ""
+        next
+}
+
+type != "" {
+        if (!match($0, /^x\.[A-Za-z0-9_]+ = /)) {
+                fail("unexpected line in from_json of " type)
+        }
+        member = substr($0, 3, RLENGTH - 5)
+        value = substr($0, RLENGTH + 1)
+        if (value ~ /^j\.at\("[^"]*"\)\.get<.*>\(\);$/) {
+                if (value ~ /get<(nlohmann::)?json>|get<std::optional</) {
+                        fail("required member " member " of " type " is untyped or optional")
+                }
+        } else if (value !~ /^get_stack_optional<.*>\(j, "[^"]*"\);$/ &&
+                value !~ /^get_untyped\(j, "[^"]*"\);$/) {
+                fail("unexpected member " member " of " type)
+        }
+        match(value, /"[^"]*"/)
+        key = substr(value, RSTART, RLENGTH)
+        table[++members] = "std::make_pair(" key ", &" type "::" member ")"
+}
+
+END {
+        if (failed) {
+                exit 1
+        }
+        for (i = count; i >= 1; i--) {
+                print "}"
+        }
+        print ""
+        print "// clang-format on"
+}
+' "$generators" >"$(dirname "$generators")/Fields.hpp"
+}
+
 # yq should use which written in go instead of python. https://github.com/mikefarah/yq
 YQ=${YQ:=$(command -v yq)}
 
@@ -126,3 +218,15 @@ generate \
         "linglong::api::types::v1" \
         "/libs/api/src/" \
         "linglong/api/types/v1"
+
+generate_fields \
+        "$repoRoot/libs/api/src/linglong/api/types/v1/Generators.hpp" \
+        "linglong::api::types::v1" \
+        "linglong/api/types/v1"
+
+# The types of ocppi are generated by libs/ocppi/tools/codegen.sh, only the OCI config is parsed
+# by linglong.
+generate_fields \
+        "$repoRoot/libs/ocppi/include/ocppi/runtime/config/types/Generators.hpp" \
+        "ocppi::runtime::config::types" \
+        "ocppi/runtime/config/types"
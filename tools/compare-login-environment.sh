@@ -0,0 +1,58 @@
+#!/usr/bin/env bash
+
+# SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+#
+# SPDX-License-Identifier: LGPL-3.0-or-later
+
+# 该工具用于比较应用通过 bash --login 启动与跳过登录shell(LINGLONG_NO_LOGIN_SHELL=1)启动时的环境变量
+# 用法：
+#   ./compare-login-environment.sh <appid>
+# 跳过登录shell时，第一次启动仍然使用登录shell并缓存其环境变量，第二次启动才会直接执行应用
+
+set -e
+
+if [ $# -lt 1 ]; then
+	echo "Usage: $0 <appid>"
+	exit 255
+fi
+
+if ! command -v ll-cli >/dev/null 2>&1; then
+	echo "This tool needs 'll-cli'"
+	exit 255
+fi
+
+appid=$1
+workDir=$(mktemp -d)
+trap 'rm -rf "${workDir}"' EXIT
+
+# dumpEnv 输出应用进程的环境变量，`_` 是 shell 执行的命令的路径，SHLVL 和 OLDPWD 由 shell 设置，
+# 不参与比较
+dumpEnv() {
+	ll-cli run "${appid}" -- env -0 </dev/null | tr '\0' '\n' | grep -Ev '^(_|SHLVL|OLDPWD)=' | sort
+}
+
+startTime() {
+	local start end
+	start=$(date +%s%N)
+	ll-cli run "${appid}" -- true </dev/null
+	end=$(date +%s%N)
+	echo $((end - start)) | awk '{ printf "%.1f", $1 / 1e6 }'
+}
+
+unset LINGLONG_NO_LOGIN_SHELL
+dumpEnv >"${workDir}/login"
+login=$(startTime)
+
+export LINGLONG_NO_LOGIN_SHELL=1
+dumpEnv >"${workDir}/capture"
+dumpEnv >"${workDir}/direct"
+direct=$(startTime)
+
+echo "login shell: ${login} ms, direct: ${direct} ms"
+if ! diff -u "${workDir}/login" "${workDir}/direct"; then
+	echo "FAIL: the environments are different"
+	exit 1
+fi
+
+diff -u "${workDir}/login" "${workDir}/capture" >/dev/null || echo "WARN: the capturing launch differs"
+echo "PASS"
@@ -0,0 +1,55 @@
+#!/usr/bin/env bash
+
+# SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+#
+# SPDX-License-Identifier: LGPL-3.0-or-later
+
+# 该文件由 ll-box 的测试工具引用，用于生成使用宿主机的 /usr 等目录作为 base 的 bundle
+# 用法：
+#   source ll-box-bundle.sh
+#   makeBundle <dir> <appid> <extra mounts dir> <extra mounts> <command...>
+# extra mounts 指定额外的只读绑定挂载数量，挂载源为 extra mounts dir 下的 d1、d2 等目录
+
+makeBundle() {
+	local dir=$1 appid=$2 extraDir=$3 extra=$4
+	shift 4
+	local mounts="" entry options i args
+	for entry in bin etc lib lib32 lib64 libx32 sbin usr; do
+		[ -e "/${entry}" ] || continue
+		options='"rbind", "ro"'
+		[ -L "/${entry}" ] && options="${options}, \"copy-symlink\""
+		mounts="${mounts}{ \"destination\": \"/${entry}\", \"type\": \"bind\", \"source\": \"/${entry}\", \"options\": [${options}] },"
+	done
+	for i in $(seq 1 "${extra}"); do
+		mkdir -p "${extraDir}/d${i}"
+		mounts="${mounts}{ \"destination\": \"/d${i}\", \"type\": \"bind\", \"source\": \"${extraDir}/d${i}\", \"options\": [\"rbind\", \"ro\"] },"
+	done
+	args=$(printf '"%s",' "$@")
+
+	mkdir -p "${dir}/rootfs" "${dir}/files"
+	cat >"${dir}/config.json" <<EOF
+{
+	"ociVersion": "1.0.1",
+	"hostname": "linglong",
+	"annotations": {
+		"org.deepin.linglong.appID": "${appid}",
+		"org.deepin.linglong.baseDir": "/"
+	},
+	"root": { "path": "rootfs" },
+	"linux": {
+		"namespaces": [{ "type": "pid" }, { "type": "mount" }, { "type": "uts" }, { "type": "user" }],
+		"uidMappings": [{ "containerID": $(id -u), "hostID": $(id -u), "size": 1 }],
+		"gidMappings": [{ "containerID": $(id -g), "hostID": $(id -g), "size": 1 }]
+	},
+	"mounts": [
+		${mounts}
+		{ "destination": "/proc", "type": "proc", "source": "proc" },
+		{ "destination": "/dev", "type": "tmpfs", "source": "tmpfs", "options": ["nosuid", "mode=0755"] },
+		{ "destination": "/tmp", "type": "tmpfs", "source": "tmpfs", "options": ["nosuid", "nodev"] },
+		{ "destination": "/run", "type": "tmpfs", "source": "tmpfs", "options": ["nosuid", "nodev", "mode=0755"] },
+		{ "destination": "/opt/apps/${appid}/files", "type": "bind", "source": "${dir}/files", "options": ["rbind", "rw"] }
+	],
+	"process": { "env": ["PATH=/usr/bin:/bin"], "cwd": "/", "args": [${args%,}] }
+}
+EOF
+}
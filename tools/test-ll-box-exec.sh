@@ -0,0 +1,87 @@
+#!/usr/bin/env bash
+
+# SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+#
+# SPDX-License-Identifier: LGPL-3.0-or-later
+
+# 该工具用于检查 ll-box exec 是否进入了正在运行的容器，并比较直接 setns 与回退到 nsenter 的耗时
+# 用法：
+#   ./test-ll-box-exec.sh [rounds]
+# 分别测试 ll-box 直接启动的容器和通过 zygote 启动的容器
+# 默认使用 PATH 中的 ll-box，可以通过 LL_BOX 环境变量指定
+
+set -e
+
+llBox=${LL_BOX:-ll-box}
+
+# shellcheck source=tools/ll-box-bundle.sh
+source "$(dirname "$(realpath "$0")")/ll-box-bundle.sh"
+
+fail() {
+	echo "FAIL: $*"
+	exit 1
+}
+
+# execRounds <id> <appid> <rounds> 多次 exec 进入容器并检查结果，输出平均耗时(毫秒)
+execRounds() {
+	local id=$1 appid=$2 rounds=$3 start end output round
+	start=$(date +%s%N)
+	for round in $(seq 1 "${rounds}"); do
+		# 容器的进程写入了 /tmp/marker，只有在同一个 mount 和 pid namespace 中才能读到并找到该进程
+		output=$("${llBox}" --root "${stateRoot}" exec "${id}" /bin/sh -c \
+			'kill -0 "$(cat /tmp/marker)" && ls /opt/apps') || fail "exec into ${id} failed"
+		[ "${output}" = "${appid}" ] || fail "exec into ${id} got '${output}'"
+	done
+	end=$(date +%s%N)
+	echo $((end - start)) "${rounds}" | awk '{ printf "%.2f", $1 / 1e6 / $2 }'
+}
+
+main() {
+	rounds=${1:-20}
+
+	for tool in "${llBox}" jq; do
+		if ! command -v "${tool}" >/dev/null 2>&1; then
+			echo "This tool needs '${tool}'"
+			exit 255
+		fi
+	done
+
+	workDir=$(mktemp -d)
+	stateRoot=${workDir}/state
+	trap 'pkill -f -- "--root ${stateRoot}" || true; rm -rf "${workDir}"' EXIT
+
+	printf "%-8s %-12s %s\n" "mode" "setns(ms)" "nsenter(ms)"
+	for mode in cold zygote; do
+		if [ "${mode}" = "zygote" ]; then
+			export LINGLONG_BOX_ZYGOTE=1
+		else
+			unset LINGLONG_BOX_ZYGOTE
+		fi
+
+		id=${mode}
+		appid=org.example.${mode}
+		makeBundle "${workDir}/${mode}" "${appid}" "" 0 /bin/sh -c 'echo $$ >/tmp/marker; exec sleep 60'
+		"${llBox}" --root "${stateRoot}" run -b "${workDir}/${mode}" "${id}" </dev/null &
+		box=$!
+
+		state=${stateRoot}/${id}.json
+		for _ in $(seq 1 50); do
+			[ -f "${state}" ] && [ "$(jq '.initPid // -1' "${state}")" -gt 0 ] && break
+			sleep 0.1
+		done
+		[ "$(jq '.initPid // -1' "${state}")" -gt 0 ] || fail "initPid of ${id} isn't recorded"
+
+		direct=$(execRounds "${id}" "${appid}" "${rounds}")
+
+		# 没有 initPid 时 ll-box 查找容器中最后一个 ll-box 进程并执行 nsenter
+		jq 'del(.initPid)' "${state}" >"${state}.tmp"
+		mv "${state}.tmp" "${state}"
+		fallback=$(execRounds "${id}" "${appid}" "${rounds}")
+
+		printf "%-8s %-12s %s\n" "${mode}" "${direct}" "${fallback}"
+		kill "${box}"
+		wait "${box}" || true
+	done
+}
+
+main "$@"
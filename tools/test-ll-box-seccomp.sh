@@ -0,0 +1,126 @@
+#!/usr/bin/env bash
+
+# SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+#
+# SPDX-License-Identifier: LGPL-3.0-or-later
+
+# 该工具用于检查 ll-box 的 seccomp 过滤器是否生效，并比较编译过滤器与使用缓存的耗时
+# 用法：
+#   ./test-ll-box-seccomp.sh [rounds]
+# 分别测试 ll-box 直接启动的容器和通过 zygote 启动的容器，第一次启动时编译过滤器并写入缓存
+# 同时检查 ll-box exec 启动的进程也加载了过滤器
+# 默认使用 PATH 中的 ll-box，可以通过 LL_BOX 环境变量指定
+
+set -e
+
+llBox=${LL_BOX:-ll-box}
+
+# shellcheck source=tools/ll-box-bundle.sh
+source "$(dirname "$(realpath "$0")")/ll-box-bundle.sh"
+
+fail() {
+	echo "FAIL: $*"
+	exit 1
+}
+
+# 拒绝 mkdir 以及将权限修改为 0777 的 chmod，未知的系统调用会被跳过
+seccomp='{
+	"defaultAction": "SCMP_ACT_ALLOW",
+	"architectures": ["SCMP_ARCH_X86_64", "SCMP_ARCH_X86", "SCMP_ARCH_AARCH64", "SCMP_ARCH_LOONGARCH64"],
+	"syscalls": [
+		{ "names": ["mkdir", "mkdirat", "no_such_syscall"], "action": "SCMP_ACT_ERRNO" },
+		{ "names": ["chmod"], "action": "SCMP_ACT_ERRNO", "errnoRet": 13,
+		  "args": [{ "index": 1, "value": 511, "op": "SCMP_CMP_EQ" }] },
+		{ "names": ["fchmodat"], "action": "SCMP_ACT_ERRNO", "errnoRet": 13,
+		  "args": [{ "index": 2, "value": 511, "op": "SCMP_CMP_EQ" }] }
+	]
+}'
+
+expected='mkdir /tmp/d: denied
+touch /tmp/f: ok
+chmod 644 /tmp/f: ok
+chmod 777 /tmp/f: denied'
+
+# runRounds <id> <rounds> 多次启动容器并检查结果，输出平均耗时(毫秒)
+runRounds() {
+	local id=$1 rounds=$2 start end output round
+	start=$(date +%s%N)
+	for round in $(seq 1 "${rounds}"); do
+		output=$("${llBox}" --root "${stateRoot}" run -b "${workDir}/bundle" "${id}-${round}" </dev/null) ||
+			fail "run ${id} failed"
+		[ "${output}" = "${expected}" ] || fail "run ${id} got '${output}'"
+	done
+	end=$(date +%s%N)
+	echo $((end - start)) "${rounds}" | awk '{ printf "%.2f", $1 / 1e6 / $2 }'
+}
+
+# checkExec <id> 启动一个等待中的容器，检查 exec 进入容器的进程也被过滤
+checkExec() {
+	local id=$1 pid output i
+	"${llBox}" --root "${stateRoot}" run -b "${workDir}/exec" "${id}" </dev/null >/dev/null &
+	pid=$!
+	for i in $(seq 1 50); do
+		jq -e '.initPid' "${stateRoot}/${id}.json" >/dev/null 2>&1 && break
+		sleep 0.1
+	done
+	output=$("${llBox}" --root "${stateRoot}" exec "${id}" /bin/sh "/opt/apps/${appid}/files/test.sh") ||
+		fail "exec into ${id} failed"
+	"${llBox}" --root "${stateRoot}" kill "${id}" KILL || true
+	wait "${pid}" || true
+	[ "${output}" = "${expected}" ] || fail "exec into ${id} got '${output}'"
+	[ ! -e "${stateRoot}/seccomp/exec/${id}.bpf" ] || fail "the filter of ${id} isn't removed"
+}
+
+main() {
+	rounds=${1:-20}
+
+	for tool in "${llBox}" jq; do
+		if ! command -v "${tool}" >/dev/null 2>&1; then
+			echo "This tool needs '${tool}'"
+			exit 255
+		fi
+	done
+
+	workDir=$(mktemp -d)
+	stateRoot=${workDir}/state
+	trap 'pkill -f -- "--root ${stateRoot}" || true; rm -rf "${workDir}"' EXIT
+
+	appid=org.example.seccomp
+	makeBundle "${workDir}/bundle" "${appid}" "" 0 /bin/sh "/opt/apps/${appid}/files/test.sh"
+	cat >"${workDir}/bundle/files/test.sh" <<'EOF'
+for s in "mkdir /tmp/d" "touch /tmp/f" "chmod 644 /tmp/f" "chmod 777 /tmp/f"; do
+	if $s 2>/dev/null; then echo "$s: ok"; else echo "$s: denied"; fi
+done
+EOF
+	jq --argjson seccomp "${seccomp}" '.linux.seccomp = $seccomp' "${workDir}/bundle/config.json" \
+		>"${workDir}/config.json"
+	mv "${workDir}/config.json" "${workDir}/bundle/config.json"
+
+	makeBundle "${workDir}/exec" "${appid}" "" 0 /bin/sleep 60
+	cp "${workDir}/bundle/files/test.sh" "${workDir}/exec/files/"
+	jq --argjson seccomp "${seccomp}" '.linux.seccomp = $seccomp' "${workDir}/exec/config.json" \
+		>"${workDir}/config.json"
+	mv "${workDir}/config.json" "${workDir}/exec/config.json"
+	checkExec exec-cached
+	LINGLONG_BOX_SECCOMP_CACHE=0 checkExec exec-compile
+
+	runRounds first 1 >/dev/null
+	[ -n "$(ls "${stateRoot}"/seccomp/*.bpf 2>/dev/null)" ] || fail "the filter isn't cached"
+
+	printf "%-8s %-12s %s\n" "mode" "compile(ms)" "cached(ms)"
+	for mode in cold zygote; do
+		if [ "${mode}" = "zygote" ]; then
+			export LINGLONG_BOX_ZYGOTE=1
+		else
+			unset LINGLONG_BOX_ZYGOTE
+		fi
+
+		compile=$(LINGLONG_BOX_SECCOMP_CACHE=0 runRounds "${mode}-compile" "${rounds}")
+		cached=$(runRounds "${mode}-cached" "${rounds}")
+		printf "%-8s %-12s %s\n" "${mode}" "${compile}" "${cached}"
+	done
+
+	echo "PASS"
+}
+
+main "$@"
@@ -0,0 +1,58 @@
+#!/usr/bin/env bash
+
+# SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+#
+# SPDX-License-Identifier: LGPL-3.0-or-later
+
+# 该工具用于检查同一个 zygote 启动的容器之间是否隔离
+# 用法：
+#   ./test-ll-box-zygote.sh
+# 第一个容器在 /tmp 和根目录下创建文件并保持运行，第二个容器不应该看到这些文件和第一个容器的进程
+# 默认使用 PATH 中的 ll-box，可以通过 LL_BOX 环境变量指定
+
+set -e
+
+llBox=${LL_BOX:-ll-box}
+
+# shellcheck source=tools/ll-box-bundle.sh
+source "$(dirname "$(realpath "$0")")/ll-box-bundle.sh"
+
+run() {
+	LINGLONG_BOX_ZYGOTE=1 "${llBox}" --root "${stateRoot}" run -b "$1" "$2" </dev/null
+}
+
+fail() {
+	echo "FAIL: $*"
+	exit 1
+}
+
+if ! command -v "${llBox}" >/dev/null 2>&1; then
+	echo "This tool needs '${llBox}'"
+	exit 255
+fi
+
+workDir=$(mktemp -d)
+stateRoot=${workDir}/state
+trap 'pkill -f -- "--root ${stateRoot}" || true; rm -rf "${workDir}"' EXIT
+
+makeBundle "${workDir}/app1" org.example.app1 "" 0 /bin/sh -c \
+	'mkdir /leaked && echo secret >/tmp/leaked && touch /opt/apps/leaked && exec sleep 3'
+makeBundle "${workDir}/app2" org.example.app2 "" 0 /bin/sh -c \
+	'ls -d /leaked /tmp/leaked /opt/apps/leaked 2>/dev/null; cat /proc/[0-9]*/comm; ls /opt/apps'
+
+run "${workDir}/app1" app1 &
+app1=$!
+sleep 1
+output=$(run "${workDir}/app2" app2) || fail "app2 exited with $?"
+wait ${app1} || fail "app1 exited with $?"
+
+sockets=$(find "${stateRoot}/zygote" -name '*.sock' | wc -l)
+[ "${sockets}" -eq 1 ] || fail "expect 1 zygote, got ${sockets}"
+
+echo "${output}" | grep -q leaked && fail "app2 sees the files of app1: ${output}"
+echo "${output}" | grep -qx sleep && fail "app2 sees the processes of app1: ${output}"
+echo "${output}" | grep -qx org.example.app1 && fail "app2 sees the mount points of app1: ${output}"
+echo "${output}" | grep -qx org.example.app2 || fail "app2 doesn't see itself: ${output}"
+[ -e "${workDir}/app1/rootfs/leaked" ] && fail "app1 writes to the rootfs of its bundle"
+
+echo "PASS"
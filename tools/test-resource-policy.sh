@@ -0,0 +1,94 @@
+#!/usr/bin/env bash
+
+# SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+#
+# SPDX-License-Identifier: LGPL-3.0-or-later
+
+# 该工具用于检查应用的资源限制是否应用到了 cgroup v2 中
+# 用法：
+#   ./test-resource-policy.sh <appid>
+# 在用户配置中为应用设置资源限制，然后在容器中运行占满 CPU 的进程，
+# 检查应用所在的 systemd unit 的 cgroup 配置以及 ll-cli ps 输出的资源占用
+# 需要 cgroup v2 以及 systemd 用户实例，已有的用户配置会在结束后恢复
+
+set -e
+
+if [ $# -lt 1 ]; then
+	echo "Usage: $0 <appid>"
+	exit 255
+fi
+
+appid=$1
+
+for tool in ll-cli jq systemctl; do
+	if ! command -v ${tool} >/dev/null 2>&1; then
+		echo "This tool needs '${tool}'"
+		exit 255
+	fi
+done
+
+if [ ! -f /sys/fs/cgroup/cgroup.controllers ]; then
+	echo "This tool needs cgroup v2"
+	exit 255
+fi
+
+fail() {
+	echo "FAIL: $*"
+	exit 1
+}
+
+configDir="${XDG_CONFIG_HOME:-${HOME}/.config}/linglong/${appid}"
+config="${configDir}/config.yaml"
+backup=$(mktemp)
+if [ -f "${config}" ]; then
+	cp "${config}" "${backup}"
+fi
+
+cleanup() {
+	ll-cli kill "${appid}" >/dev/null 2>&1 || true
+	if [ -s "${backup}" ]; then
+		cp "${backup}" "${config}"
+	else
+		rm -f "${config}"
+	fi
+	rm -f "${backup}"
+}
+trap cleanup EXIT
+
+mkdir -p "${configDir}"
+cat >"${config}" <<EOF
+version: "1"
+permissions:
+  resources:
+    cpuWeight: 20
+    memoryHigh: 268435456
+    memoryMax: 536870912
+    pidsMax: 64
+EOF
+
+ll-cli kill "${appid}" >/dev/null 2>&1 || true
+ll-cli run "${appid}" -- /bin/sh -c 'while :; do :; done' </dev/null >/dev/null 2>&1 &
+sleep 3
+
+container=$(ll-cli ps --json | jq -c "map(select(.package | contains(\"${appid}\"))) | first")
+[ "${container}" != "null" ] || fail "the application isn't running"
+
+pid=$(echo "${container}" | jq .pid)
+cgroup=/sys/fs/cgroup$(sed -n 's/^0:://p' "/proc/${pid}/cgroup")
+echo "cgroup: ${cgroup}"
+case "$(basename "${cgroup}")" in
+app-*) ;;
+*) fail "the container isn't in an application unit" ;;
+esac
+
+[ "$(cat "${cgroup}/cpu.weight")" = 20 ] || fail "cpu.weight is $(cat "${cgroup}/cpu.weight")"
+[ "$(cat "${cgroup}/memory.high")" = 268435456 ] || fail "memory.high is $(cat "${cgroup}/memory.high")"
+[ "$(cat "${cgroup}/memory.max")" = 536870912 ] || fail "memory.max is $(cat "${cgroup}/memory.max")"
+[ "$(cat "${cgroup}/pids.max")" = 64 ] || fail "pids.max is $(cat "${cgroup}/pids.max")"
+
+# 占满 CPU 的进程运行了 3 秒，CPU 时间应该超过 1 秒
+cpuUsage=$(echo "${container}" | jq '.cpuUsage // 0')
+[ "${cpuUsage}" -gt 1000000 ] || fail "cpuUsage is ${cpuUsage}"
+ll-cli ps
+
+echo "PASS"
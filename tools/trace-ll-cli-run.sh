@@ -0,0 +1,72 @@
+#!/usr/bin/env bash
+
+# SPDX-FileCopyrightText: 2024 UnionTech Software Technology Co., Ltd.
+#
+# SPDX-License-Identifier: LGPL-3.0-or-later
+
+# 该工具用于记录 ll-cli run 各阶段的耗时，并检查 trace 文件中是否包含所有预期的阶段
+# 用法：
+#   ./trace-ll-cli-run.sh <appid> [trace file]
+# 生成的 trace 文件可以直接用 chrome://tracing 或 https://ui.perfetto.dev 打开
+
+set -e
+
+if [ $# -lt 1 ]; then
+	echo "Usage: $0 <appid> [trace file]"
+	exit 255
+fi
+
+for tool in ll-cli jq; do
+	if ! command -v ${tool} >/dev/null 2>&1; then
+		echo "This tool needs '${tool}'"
+		exit 255
+	fi
+done
+
+appid=$1
+traceFile=$(realpath -m "${2:-ll-cli-run.trace.json}")
+rm -f "${traceFile}"
+
+# the generators are skipped if the configuration of the application is cached
+rm -f "${XDG_CACHE_HOME:-${HOME}/.cache}/linglong/oci-config/${appid}.json"
+
+LINGLONG_TRACING_FILE="${traceFile}" ll-cli run "${appid}" -- true
+
+# the trace file is an unterminated json array
+events=$(sed '$ s/,$//' "${traceFile}"; echo "]")
+
+expected=(
+	"ll-cli run"
+	"create pid file"
+	"clearReference app"
+	"getMergedModuleDir app"
+	"clearReference base"
+	"getMergedModuleDir base"
+	"getCurrentContainers"
+	"ContainerBuilder::create"
+	"getOCIConfig"
+	"fixMount"
+	"Container::run"
+	"generator 00-id-mapping"
+	"generator 30-user-home"
+	"generator 40-host-ipc"
+	"parse config"
+	"clone entry"
+	"mounts"
+	"pivot_root"
+	"clone init"
+	"mount proc"
+	"exec /bin/bash"
+)
+
+ret=0
+for name in "${expected[@]}"; do
+	if ! jq -e --arg name "${name}" 'any(.[]; .name == $name)' <<<"${events}" >/dev/null; then
+		echo "missing span: ${name}"
+		ret=1
+	fi
+done
+
+jq -r '.[] | select(.ph == "X") | "\(.dur / 1000 | floor)ms\t\(.name)"' <<<"${events}"
+echo "trace file: ${traceFile}"
+exit ${ret}